@@ -163,6 +163,9 @@ private void EmitTensorCall(Op op)
             case IR.Math.Unary top:
                 Emitter.T.Unary(top.UnaryOp);
                 break;
+            case IR.Math.WeightOnlyMatMul top:
+                Emitter.T.WeightOnlyMatMul(top.Bits, top.GroupSize);
+                break;
             case IR.Tensors.Bitcast top:
                 Emitter.T.Bitcast(top.Type, top.NewType);
                 break;
@@ -256,6 +259,12 @@ private void EmitTensorCall(Op op)
             case IR.Tensors.Unsqueeze top:
                 Emitter.T.Unsqueeze();
                 break;
+            case IR.Tensors.VariableRead top:
+                Emitter.T.VariableRead(top.Name, top.Type, top.CanFoldConstCall);
+                break;
+            case IR.Tensors.VariableUpdate top:
+                Emitter.T.VariableUpdate(top.Axis, top.CanFoldConstCall);
+                break;
             case IR.Tensors.Where top:
                 Emitter.T.Where(top.IsTfWhere);
                 break;
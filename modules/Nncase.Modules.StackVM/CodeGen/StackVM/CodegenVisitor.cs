@@ -118,6 +118,7 @@ internal class CodeGenContext
 {
     private readonly List<BasicBlock> _basicBlocks = new();
     private readonly HashSet<ModuleType> _custom_call_modules = new();
+    private readonly Dictionary<string, TensorType> _states = new();
 
     public CodeGenContext(BinaryWriter rdataWriter)
     {
@@ -134,6 +135,11 @@ public CodeGenContext(BinaryWriter rdataWriter)
 
     public IReadOnlySet<ModuleType> CustomCallModules => _custom_call_modules;
 
+    /// <summary>
+    /// Gets state variables read by the function.
+    /// </summary>
+    public IReadOnlyDictionary<string, TensorType> States => _states;
+
     public void AddBasicBlock(BasicBlock basicBlock)
     {
         _basicBlocks.Add(basicBlock);
@@ -143,6 +149,16 @@ public void AddCustomCallModule(ModuleType moduleType)
     {
         _custom_call_modules.Add(moduleType);
     }
+
+    public void AddState(string name, TensorType type)
+    {
+        if (_states.TryGetValue(name, out var declared) && declared != type)
+        {
+            throw new InvalidOperationException($"State {name} is read as both {declared} and {type}");
+        }
+
+        _states[name] = type;
+    }
 }
 
 internal partial class CodeGenVisitor : ExprVisitor<TextSnippet, IRType>
@@ -301,6 +317,11 @@ protected override TextSnippet VisitLeafCall(Call expr)
         }
         else if (expr.Target is Op op)
         {
+            if (op is VariableRead read)
+            {
+                _context.AddState(read.Name, (TensorType)expr.CheckedType);
+            }
+
             EmitTensorCall(op);
         }
         else if (expr.Target is PrimFunctionWrapper wrapper)
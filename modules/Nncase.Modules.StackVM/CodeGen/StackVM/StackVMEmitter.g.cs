@@ -1338,10 +1338,38 @@ public void UnsqueezeShape()
         }
 
         ///<summary>.</summary>
-        public void Where(bool isTfWhere)
+        public void VariableRead(string name, DataType type, bool canFoldConstCall)
         {
             _emitter.Write((byte)100);
             _emitter.Write((ushort)94);
+            _emitter.Write(name);
+            _emitter.Write(type);
+            _emitter.Write(canFoldConstCall);
+        }
+
+        ///<summary>.</summary>
+        public void VariableUpdate(int axis, bool canFoldConstCall)
+        {
+            _emitter.Write((byte)100);
+            _emitter.Write((ushort)95);
+            _emitter.Write(axis);
+            _emitter.Write(canFoldConstCall);
+        }
+
+        ///<summary>.</summary>
+        public void WeightOnlyMatMul(int bits, int groupSize)
+        {
+            _emitter.Write((byte)100);
+            _emitter.Write((ushort)96);
+            _emitter.Write(bits);
+            _emitter.Write(groupSize);
+        }
+
+        ///<summary>.</summary>
+        public void Where(bool isTfWhere)
+        {
+            _emitter.Write((byte)100);
+            _emitter.Write((ushort)97);
             _emitter.Write(isTfWhere);
         }
     }
@@ -35,7 +35,7 @@ public StackVMFunctionBuilder(uint id, SectionManager sectionManager)
 
     protected override ILinkableFunction CreateLinkableFunction(uint id, BaseFunction callable, IReadOnlyList<FunctionRef> functionRefs, Stream text)
     {
-        return new StackVMLinkableFunction(id, callable, functionRefs, _localsAllocator.MaxCount, text, _context.CustomCallModules);
+        return new StackVMLinkableFunction(id, callable, functionRefs, _localsAllocator.MaxCount, text, _context.CustomCallModules, _context.States);
     }
 
     protected override void Compile(BaseFunction callable)
@@ -12,7 +12,7 @@ namespace Nncase.CodeGen.StackVM;
 
 internal class StackVMLinkableFunction : ILinkableFunction
 {
-    public StackVMLinkableFunction(uint id, BaseFunction sourceFunction, IEnumerable<FunctionRef> functionRefs, ushort maxLocals, Stream text, IReadOnlySet<ModuleType> custom_call_modules)
+    public StackVMLinkableFunction(uint id, BaseFunction sourceFunction, IEnumerable<FunctionRef> functionRefs, ushort maxLocals, Stream text, IReadOnlySet<ModuleType> custom_call_modules, IReadOnlyDictionary<string, TensorType> states)
     {
         Id = id;
         SourceFunction = sourceFunction;
@@ -20,6 +20,7 @@ public StackVMLinkableFunction(uint id, BaseFunction sourceFunction, IEnumerable
         MaxLocals = maxLocals;
         Text = text;
         CustomCallModules = custom_call_modules;
+        States = states;
     }
 
     public uint Id { get; }
@@ -35,4 +36,6 @@ public StackVMLinkableFunction(uint id, BaseFunction sourceFunction, IEnumerable
     public IReadOnlyList<ILinkedSection> Sections => Array.Empty<ILinkedSection>();
 
     public IReadOnlySet<ModuleType> CustomCallModules { get; init; }
+
+    public IReadOnlyDictionary<string, TensorType> States { get; init; }
 }
@@ -6,20 +6,32 @@
 using System.Linq;
 using System.Text;
 using System.Threading.Tasks;
+using Nncase.IR;
 
 namespace Nncase.CodeGen.StackVM;
 
 internal class StackVMLinkableModule : LinkableModule
 {
     private readonly HashSet<ModuleType> _customCallModules;
+    private readonly Dictionary<string, TensorType> _states;
 
     public StackVMLinkableModule(IReadOnlyList<ILinkableFunction> functions, SectionManager sectionManager)
         : base(functions, sectionManager)
     {
         _customCallModules = new();
+        _states = new();
         foreach (var funcs in functions.OfType<StackVMLinkableFunction>())
         {
             _customCallModules.UnionWith(funcs.CustomCallModules);
+            foreach (var (name, type) in funcs.States)
+            {
+                if (_states.TryGetValue(name, out var declared) && declared != type)
+                {
+                    throw new InvalidOperationException($"State {name} is read as both {declared} and {type}");
+                }
+
+                _states[name] = type;
+            }
         }
 
         var writer = SectionManager.GetWriter(".custom_calls");
@@ -28,6 +40,27 @@ public StackVMLinkableModule(IReadOnlyList<ILinkableFunction> functions, Section
         {
             writer.Write(item.Types.AsSpan());
         }
+
+        // state section layout:
+        // 1. states count
+        // 2. states
+        //    - name, null terminated
+        //    - typecode
+        //    - rank, dims
+        writer = SectionManager.GetWriter(".states");
+        var typeEmitter = new StackVMEmitter(writer);
+        writer.Write((uint)_states.Count);
+        foreach (var (name, type) in _states)
+        {
+            writer.Write(Encoding.UTF8.GetBytes(name));
+            writer.Write((byte)0);
+            typeEmitter.Write(type.DType);
+            writer.Write((uint)type.Shape.Rank);
+            foreach (var dim in type.Shape)
+            {
+                writer.Write((ulong)dim.FixedValue);
+            }
+        }
     }
 
     protected override ILinkedModule CreateLinkedModule(IReadOnlyList<LinkedFunction> linkedFunctions, Stream text)
@@ -36,6 +69,7 @@ protected override ILinkedModule CreateLinkedModule(IReadOnlyList<LinkedFunction
             linkedFunctions,
             text,
             SectionManager.GetContent(WellknownSectionNames.Rdata),
-            SectionManager.GetContent(".custom_calls"));
+            SectionManager.GetContent(".custom_calls"),
+            SectionManager.GetContent(".states"));
     }
 }
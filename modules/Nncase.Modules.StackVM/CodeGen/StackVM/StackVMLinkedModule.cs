@@ -12,7 +12,7 @@ namespace Nncase.CodeGen.StackVM;
 
 internal class StackVMLinkedModule : ILinkedModule
 {
-    public StackVMLinkedModule(IReadOnlyList<LinkedFunction> functions, Stream text, Stream? rdata, Stream? custom_calls)
+    public StackVMLinkedModule(IReadOnlyList<LinkedFunction> functions, Stream text, Stream? rdata, Stream? custom_calls, Stream? states)
     {
         Functions = functions;
         Sections = new[]
@@ -20,6 +20,7 @@ public StackVMLinkedModule(IReadOnlyList<LinkedFunction> functions, Stream text,
             new LinkedSection(text, ".text", 0, 8, (ulong)text.Length),
             new LinkedSection(rdata, ".rdata", 0, 8, (ulong)(rdata?.Length ?? 0)),
             new LinkedSection(custom_calls, ".custom_calls", 0, 8, (ulong)(custom_calls?.Length ?? 0)),
+            new LinkedSection(states, ".states", 0, 8, (ulong)(states?.Length ?? 0)),
         };
     }
 
@@ -21,9 +21,9 @@ public class StackVMRTModule : RTModule
     public static readonly string Kind = Callable.StackVMModuleKind;
 
     /// <summary>
-    /// StackVM module version.
+    /// StackVM module version, bumped when the tensor functions are renumbered.
     /// </summary>
-    public static readonly uint Version = 1;
+    public static readonly uint Version = 3;
 
     /// <summary>
     /// Initializes a new instance of the <see cref="StackVMRTModule"/> class.
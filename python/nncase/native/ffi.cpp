@@ -348,6 +348,29 @@ PYBIND11_MODULE(_nncase, m) {
              [](interpreter &interp, size_t index, runtime_tensor tensor) {
                  return interp.output_tensor(index, tensor).unwrap_or_throw();
              })
+        .def_property_readonly("states_size", &interpreter::states_size)
+        .def("get_state_tensor",
+             [](interpreter &interp, size_t index) {
+                 return interp.state_tensor(index).unwrap_or_throw();
+             })
+        .def("set_state_tensor",
+             [](interpreter &interp, size_t index, runtime_tensor tensor) {
+                 return interp.state_tensor(index, tensor).unwrap_or_throw();
+             })
+        .def("find_state_by_name",
+             [](interpreter &interp, const std::string &name) {
+                 return interp.find_state_by_name(name).unwrap_or_throw();
+             })
+        .def("reset_states",
+             [](interpreter &interp) {
+                 interp.reset_states().unwrap_or_throw();
+             })
+        .def("set_autotune_cache_dir",
+             [](interpreter &interp, const std::string &path) {
+                 interp.options()
+                     .set(autotune_cache_dir_option, path)
+                     .unwrap_or_throw();
+             })
         .def("run",
              [](interpreter &interp) { interp.run().unwrap_or_throw(); });
 }
@@ -51,6 +51,15 @@ NNCASE_API int nncase_interp_load_model(nncase::runtime::interpreter *interp,
 NNCASE_API int nncase_interp_set_dump_root(nncase::runtime::interpreter *interp,
                                            const char *path);
 NNCASE_API int
+nncase_interp_start_async_dump(nncase::runtime::interpreter *interp,
+                               const char *ops, uint32_t request_interval,
+                               uint64_t max_queue_bytes);
+NNCASE_API int
+nncase_interp_stop_async_dump(nncase::runtime::interpreter *interp);
+NNCASE_API int
+nncase_interp_set_autotune_cache_dir(nncase::runtime::interpreter *interp,
+                                     const char *path);
+NNCASE_API int
 nncase_interp_get_entry_func(nncase::runtime::interpreter *interp,
                              nncase::runtime::runtime_function **func);
 
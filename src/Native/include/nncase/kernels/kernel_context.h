@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #pragma once
+#include <nncase/runtime/autotuner.h>
 #include <nncase/runtime/dump_manager.h>
 #include <nncase/runtime/result.h>
 
@@ -21,8 +22,16 @@ BEGIN_NS_NNCASE_KERNELS
 struct NNCASE_API kernel_context {
     uint32_t num_threads;
     std::shared_ptr<runtime::dump_manager> dump_manager;
+    /** @brief Picks between kernel variants when it is enabled */
+    std::shared_ptr<runtime::autotuner> autotuner;
 };
 
 NNCASE_API kernel_context &default_kernel_context();
 
+/** @brief Run body(user_data, i) for i in [0, count) on context.num_threads
+ * threads */
+NNCASE_API void parallel_for(const kernel_context &context, size_t count,
+                             void (*body)(void *user_data, size_t index),
+                             void *user_data) noexcept;
+
 END_NS_NNCASE_KERNELS
\ No newline at end of file
@@ -246,6 +246,15 @@ inline void set_resize_bilinear(size_t value, float scale,
                   static_cast<int32_t>(shape_size - 1));
 }
 
+/** @brief Interpolated pixel to T, integers round half up like the
+ * fixed-point 8-bit path so negative values are not truncated toward 0 */
+template <class T> inline T resize_round(float value) noexcept {
+    if constexpr (std::is_integral_v<T>)
+        return static_cast<T>(std::floor(value + .5f));
+    else
+        return static_cast<T>(value);
+}
+
 template <class T>
 inline size_t get_nearest_neighbor(T input_value, size_t shape_size,
                                    float scale, bool align_corners,
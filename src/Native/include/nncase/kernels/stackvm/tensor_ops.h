@@ -466,6 +466,18 @@ NNCASE_API result<value_t>
 unsqueeze_shape(value_t input_shape, value_t dim, value_t output = nullptr,
                 kernel_context &context = default_kernel_context());
 
+/** @brief Write update into state at offset along axis in place, the state
+ * is returned unless another output is given */
+NNCASE_API result<value_t>
+variable_update(int32_t axis, value_t state, value_t update, value_t offset,
+                value_t output = nullptr,
+                kernel_context &context = default_kernel_context());
+
+NNCASE_API result<value_t>
+weight_only_mat_mul(int32_t bits, int32_t group_size, value_t input,
+                    value_t weights, value_t scales, value_t output = nullptr,
+                    kernel_context &context = default_kernel_context());
+
 NNCASE_API result<value_t>
 where(bool is_tf_where, value_t cond, value_t x, value_t y,
       value_t output = nullptr,
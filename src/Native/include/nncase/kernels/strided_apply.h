@@ -0,0 +1,182 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <nncase/kernels/kernel_context.h>
+#include <nncase/runtime/datatypes.h>
+
+BEGIN_NS_NNCASE_KERNELS_MODULE(stackvm)
+
+/** @brief Elements of one work unit visited per call of the body */
+NNCASE_INLINE_VAR constexpr size_t strided_tile_size = 16384;
+
+/** @brief A run of count elements along the innermost dim. Operand i starts
+ * at element offsets[i] and steps strides[i] elements, 0 when it is
+ * broadcast along the run. */
+template <size_t N> struct strided_run {
+    std::array<size_t, N> offsets;
+    std::array<size_t, N> strides;
+    size_t count;
+
+    bool contiguous() const noexcept {
+        return std::all_of(strides.begin(), strides.end(),
+                           [](size_t s) { return s == 1; });
+    }
+};
+
+/** @brief Iteration space of N strided operands sharing one shape, operand 0
+ * is usually the output. Unit dims are dropped and the dims every operand
+ * walks as one are merged, so most elementwise ops end up with one or two
+ * dims. */
+template <size_t N> class strided_plan {
+  public:
+    /** @brief strides[i] holds the element strides of operand i, one per dim
+     * of shape, 0 repeats the operand along that dim */
+    strided_plan(gsl::span<const size_t> shape,
+                 const std::array<gsl::span<const size_t>, N> &strides) {
+        for (size_t d = 0; d < shape.size(); d++) {
+            if (shape[d] == 1)
+                continue;
+            auto merge = !shape_.empty();
+            for (size_t i = 0; merge && i < N; i++)
+                merge = strides_[i].back() == strides[i][d] * shape[d];
+            if (merge) {
+                shape_.back() *= shape[d];
+                for (size_t i = 0; i < N; i++)
+                    strides_[i].back() = strides[i][d];
+            } else {
+                shape_.push_back(shape[d]);
+                for (size_t i = 0; i < N; i++)
+                    strides_[i].push_back(strides[i][d]);
+            }
+        }
+
+        if (shape_.empty()) {
+            shape_.push_back(1);
+            for (size_t i = 0; i < N; i++)
+                strides_[i].push_back(0);
+        }
+    }
+
+    /** @brief Numpy broadcast of operands to out_shape, shapes[i] is right
+     * aligned with out_shape and its unit dims are repeated */
+    static strided_plan
+    broadcast(gsl::span<const size_t> out_shape,
+              const std::array<gsl::span<const size_t>, N> &shapes,
+              const std::array<gsl::span<const size_t>, N> &strides) {
+        std::array<strides_t, N> full_strides;
+        std::array<gsl::span<const size_t>, N> views;
+        for (size_t i = 0; i < N; i++) {
+            auto ext = out_shape.size() - shapes[i].size();
+            full_strides[i].resize(out_shape.size(), 0);
+            for (size_t d = 0; d < shapes[i].size(); d++) {
+                if (shapes[i][d] != 1 || out_shape[d + ext] == 1)
+                    full_strides[i][d + ext] = strides[i][d];
+            }
+            views[i] = full_strides[i];
+        }
+        return strided_plan(out_shape, views);
+    }
+
+    size_t rank() const noexcept { return shape_.size(); }
+    const dims_t &shape() const noexcept { return shape_; }
+    const strides_t &strides(size_t operand) const noexcept {
+        return strides_[operand];
+    }
+
+  private:
+    dims_t shape_;
+    std::array<strides_t, N> strides_;
+};
+
+/** @brief Calls body(const strided_run<N> &) over the whole plan.
+ *
+ * The plan is cut into work units of about tile_size elements: long inner
+ * dims are split into tiles, short ones are batched into blocks of rows. The
+ * units run on context.num_threads threads, so body must only write the
+ * elements of its run. */
+template <size_t N, class Callable>
+void strided_apply(const strided_plan<N> &plan, Callable &&body,
+                   NNCASE_UNUSED const kernel_context &context =
+                       default_kernel_context(),
+                   size_t tile_size = strided_tile_size) noexcept {
+    auto &shape = plan.shape();
+    auto outer_rank = plan.rank() - 1;
+    auto inner = shape[outer_rank];
+    size_t rows = 1;
+    for (size_t d = 0; d < outer_rank; d++)
+        rows *= shape[d];
+    if (rows == 0 || inner == 0)
+        return;
+
+    auto col_tiles = (inner + tile_size - 1) / tile_size;
+    auto rows_per_unit = col_tiles > 1 ? 1 : std::max((size_t)1,
+                                                      tile_size / inner);
+    auto units = col_tiles > 1 ? (int64_t)(rows * col_tiles)
+                               : (int64_t)((rows + rows_per_unit - 1) /
+                                           rows_per_unit);
+
+    std::array<size_t, N> inner_strides;
+    for (size_t i = 0; i < N; i++)
+        inner_strides[i] = plan.strides(i)[outer_rank];
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads) if (units > 1)
+#endif
+    for (int64_t unit = 0; unit < units; unit++) {
+        size_t row_begin, row_end, col_begin, col_end;
+        if (col_tiles > 1) {
+            row_begin = unit / col_tiles;
+            row_end = row_begin + 1;
+            col_begin = (unit % col_tiles) * tile_size;
+            col_end = std::min(inner, col_begin + tile_size);
+        } else {
+            row_begin = unit * rows_per_unit;
+            row_end = std::min(rows, row_begin + rows_per_unit);
+            col_begin = 0;
+            col_end = inner;
+        }
+
+        // Position the row odometer once, then step it row by row
+        dims_t index(outer_rank, 0);
+        strided_run<N> run{{}, inner_strides, col_end - col_begin};
+        for (size_t d = outer_rank, rest = row_begin; d-- > 0;) {
+            index[d] = rest % shape[d];
+            rest /= shape[d];
+        }
+        for (size_t i = 0; i < N; i++) {
+            auto &strides = plan.strides(i);
+            run.offsets[i] = col_begin * inner_strides[i];
+            for (size_t d = 0; d < outer_rank; d++)
+                run.offsets[i] += index[d] * strides[d];
+        }
+
+        for (auto row = row_begin; row < row_end; row++) {
+            body(run);
+            for (size_t d = outer_rank; d-- > 0;) {
+                for (size_t i = 0; i < N; i++)
+                    run.offsets[i] += plan.strides(i)[d];
+                if (++index[d] < shape[d])
+                    break;
+                for (size_t i = 0; i < N; i++)
+                    run.offsets[i] -= plan.strides(i)[d] * shape[d];
+                index[d] = 0;
+            }
+        }
+    }
+}
+
+END_NS_NNCASE_KERNELS_MODULE
@@ -117,6 +117,12 @@ template <class T> class object_t {
 
     bool empty() const noexcept { return !object_; }
 
+    /** @brief Is this the only reference to the object */
+    bool unique() const noexcept {
+        return object_ &&
+               object_->ref_count_.load(std::memory_order_acquire) == 1;
+    }
+
     object_t value_or(object_t &&other) const noexcept {
         if (!empty())
             return *this;
@@ -133,7 +139,7 @@ template <class T> class object_t {
         return is_a(U::node_type::kind());
     }
 
-    template <class U> result<U> as() const noexcept {
+    template <class U> result<U> as() const &noexcept {
         if (is_a<U>()) {
             return ok(U(static_cast<typename U::node_type *>(object_)));
         } else {
@@ -141,6 +147,17 @@ template <class T> class object_t {
         }
     }
 
+    /** @brief Move the reference into the specific type, the object is left
+     * untouched on failure */
+    template <class U> result<U> as() &&noexcept {
+        if (is_a<U>()) {
+            return ok(U(std::in_place,
+                        static_cast<typename U::node_type *>(detach())));
+        } else {
+            return err(std::errc::invalid_argument);
+        }
+    }
+
     /** @brief Is the object equal to another instance */
     template <class U> bool equals(const U &other) const noexcept {
         if (get() == other.get())
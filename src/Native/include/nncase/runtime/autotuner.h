@@ -0,0 +1,89 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "datatypes.h"
+#include "result.h"
+#include <functional>
+#include <gsl/gsl-lite.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+
+BEGIN_NS_NNCASE_RUNTIME
+
+/** @brief Interpreter option: directory of the kernel autotuner cache
+ * (string), read by load_model. Unset, the default, disables the autotuner. */
+NNCASE_INLINE_VAR constexpr const char *autotune_cache_dir_option =
+    "autotune.cache_dir";
+
+/** @brief Key of one autotuned kernel call, e.g.
+ * "conv2d:f32:t4:1x3x224x224:16x3x3x3:1:1" */
+class NNCASE_API autotune_key {
+  public:
+    autotune_key(std::string_view op, typecode_t type, uint32_t threads);
+
+    autotune_key &operator<<(gsl::span<const size_t> dims);
+    autotune_key &operator<<(gsl::span<const int64_t> axes);
+    autotune_key &operator<<(int64_t value);
+
+    const std::string &str() const noexcept { return key_; }
+
+  private:
+    std::string key_;
+};
+
+/** @brief Picks the fastest of the variants of a kernel, e.g. an optimized
+ * and a reference implementation or several tile sizes.
+ *
+ * The first call of a key times every variant. The winner is appended to
+ * <cache_dir>/<model hash>-<cpu model>.tune, so later sessions of the same
+ * model on the same cpu load it and only run the winner. */
+class NNCASE_API autotuner {
+  public:
+    /** @brief Runs one variant, which must fully write the outputs */
+    using variant_func = std::function<result<void>(size_t variant)>;
+
+    /** @brief Opens the cache of a model, creating cache_dir if needed */
+    static result<std::shared_ptr<autotuner>>
+    create(std::string_view cache_dir, uint64_t model_hash) noexcept;
+
+    /** @brief FNV-1a of data, pass the last hash as seed to hash in chunks */
+    static uint64_t hash(gsl::span<const gsl::byte> data,
+                         uint64_t seed = 0xcbf29ce484222325) noexcept;
+
+    /** @brief Cpu brand string, "generic" when it is unknown */
+    static std::string cpu_model();
+
+    const std::string &cache_path() const noexcept;
+
+    /** @brief The variant cached for key, -1 if it is not tuned yet */
+    int32_t find(const autotune_key &key) const noexcept;
+
+    /** @brief Runs the cached variant of key. Otherwise times the variants,
+     * skipping those returning an error, caches the fastest one and leaves
+     * its outputs. */
+    result<void> run(const autotune_key &key, size_t variants,
+                     const variant_func &func) noexcept;
+
+  private:
+    struct impl;
+
+    autotuner(std::shared_ptr<impl> impl) noexcept;
+
+  private:
+    std::shared_ptr<impl> impl_;
+};
+
+END_NS_NNCASE_RUNTIME
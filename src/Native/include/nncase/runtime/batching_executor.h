@@ -0,0 +1,101 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "interpreter.h"
+#include "result.h"
+#include "runtime_tensor.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+BEGIN_NS_NNCASE_RUNTIME
+
+struct batching_options {
+    /** @brief Max time the first request of a batch waits for others */
+    std::chrono::microseconds max_latency{2000};
+};
+
+/** @brief Coalesces single requests into batched interpreter runs
+ *
+ * The kmodel must be compiled with fixed input shapes whose first dimension
+ * is the batch bucket. Requests coming from any thread are concatenated along
+ * that dimension until the bucket is full or the latency budget of the oldest
+ * request expires, then a single inference runs on the executor thread.
+ * Unused rows of the bucket are zero-filled. Outputs handed back to the
+ * requests are slices of the batched outputs, they share the same buffers.
+ *
+ * The interpreter must not be used by anyone else while the executor lives.
+ */
+class NNCASE_API batching_executor {
+  public:
+    using outputs_t = std::vector<runtime_tensor>;
+    using callback_t = std::function<void(result<outputs_t>)>;
+
+    static result<std::unique_ptr<batching_executor>>
+    create(interpreter &interp, batching_options options = {}) noexcept;
+
+    batching_executor(const batching_executor &) = delete;
+    batching_executor &operator=(const batching_executor &) = delete;
+
+    /** @brief Fails the queued requests and stops the executor thread */
+    ~batching_executor();
+
+    size_t max_batch_size() const noexcept { return max_batch_size_; }
+
+    /** @brief Enqueue a request, callback runs on the executor thread */
+    result<void> submit(std::vector<runtime_tensor> inputs,
+                        callback_t callback) noexcept;
+
+    std::future<result<outputs_t>>
+    submit(std::vector<runtime_tensor> inputs) noexcept;
+
+  private:
+    struct request {
+        std::vector<runtime_tensor> inputs;
+        size_t batch;
+        callback_t callback;
+        std::chrono::steady_clock::time_point arrival;
+    };
+
+    batching_executor(interpreter &interp, batching_options options) noexcept;
+
+    result<void> initialize() noexcept;
+    result<size_t> validate(gsl::span<const runtime_tensor> inputs) noexcept;
+    void executor_main() noexcept;
+    result<std::vector<outputs_t>> run_batch(std::vector<request> &batch,
+                                             size_t rows) noexcept;
+
+  private:
+    interpreter &interp_;
+    batching_options options_;
+    runtime_function *entry_;
+    size_t max_batch_size_;
+    std::vector<tensor_type> input_types_;
+    std::vector<dims_t> input_shapes_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<request> queue_;
+    size_t queued_rows_;
+    bool stop_;
+    std::thread thread_;
+};
+
+END_NS_NNCASE_RUNTIME
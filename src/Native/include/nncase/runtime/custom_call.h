@@ -0,0 +1,94 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* C ABI of the custom call kernels.
+ *
+ * Kernels are registered by name before the kmodel is loaded and resolved
+ * once per CUSCALL instruction, they may live in a shared library built with
+ * another compiler. The major version is bumped on any breaking change of the
+ * structures below, kernels built for another major version are rejected. */
+#define NNCASE_CUSTOM_CALL_ABI_VERSION_MAJOR 1
+#define NNCASE_CUSTOM_CALL_ABI_VERSION_MINOR 0
+#define NNCASE_CUSTOM_CALL_ABI_VERSION                                         \
+    ((NNCASE_CUSTOM_CALL_ABI_VERSION_MAJOR << 16) |                            \
+     NNCASE_CUSTOM_CALL_ABI_VERSION_MINOR)
+
+#ifdef __cplusplus
+#include <nncase/compiler_defs.h>
+extern "C" {
+#else
+#define NNCASE_API
+#endif
+
+/** @brief Borrowed view of a host tensor, only valid during the call */
+typedef struct nncase_tensor_view {
+    /** @brief nncase typecode_t */
+    uint32_t typecode;
+    uint32_t rank;
+    const size_t *shape;
+    /** @brief Strides in elements */
+    const size_t *strides;
+    void *data;
+} nncase_tensor_view_t;
+
+typedef struct nncase_custom_call_context nncase_custom_call_context_t;
+
+typedef void (*nncase_parallel_body_t)(void *user_data, size_t index);
+
+struct nncase_custom_call_context {
+    /** @brief ABI version of the runtime */
+    uint32_t abi_version;
+    /** @brief Threads the kernel is allowed to use */
+    uint32_t num_threads;
+
+    /** @brief Scratch memory, released when the kernel returns.
+     * alignment must be a power of 2, 0 for the default one. Returns NULL
+     * when out of memory. */
+    void *(*scratch_alloc)(nncase_custom_call_context_t *ctx, size_t bytes,
+                           size_t alignment);
+
+    /** @brief Run body for index in [0, count) on the kernel threads */
+    void (*parallel_for)(nncase_custom_call_context_t *ctx, size_t count,
+                         nncase_parallel_body_t body, void *user_data);
+
+    /** @brief Allocate a contiguous output tensor and map it into view.
+     * Outputs are returned in allocation order, a tuple is returned when
+     * more than one is allocated. Returns 0 on success. */
+    int (*alloc_output)(nncase_custom_call_context_t *ctx, uint32_t typecode,
+                        uint32_t rank, const size_t *shape,
+                        nncase_tensor_view_t *view);
+
+    /** @brief Owned by the runtime */
+    void *runtime_data;
+};
+
+/** @brief Custom call kernel, returns 0 on success */
+typedef int (*nncase_custom_call_fn)(nncase_custom_call_context_t *ctx,
+                                     const void *fields, size_t fields_bytes,
+                                     const nncase_tensor_view_t *args,
+                                     size_t args_count);
+
+/** @brief Register a kernel for the CUSCALL instructions named name.
+ * Returns 0 on success. */
+NNCASE_API int nncase_register_custom_call(uint32_t abi_version,
+                                           const char *name,
+                                           nncase_custom_call_fn fn);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,23 +1,48 @@
 #pragma once
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <nncase/runtime/datatypes.h>
 #include <nncase/runtime/host_buffer.h>
+#include <nncase/runtime/result.h>
 #include <nncase/runtime/stackvm/opcode.h>
 #include <nncase/tensor.h>
 #include <nncase/type.h>
 #include <nncase/value.h>
 #include <sstream>
+#include <vector>
 
 BEGIN_NS_NNCASE_RUNTIME
 
+/** @brief Sampling and memory limits of the asynchronous binary dump */
+struct dump_async_options {
+    /** @brief Names of the ops to dump, every op when empty */
+    std::vector<std::string> ops;
+    /** @brief Dump one request out of every request_interval */
+    size_t request_interval = 1;
+    /** @brief Bytes of tensor data waiting for the writer. Records over it
+     * are dropped instead of blocking the inference thread. */
+    size_t max_queue_bytes = 64 * 1024 * 1024;
+};
+
+/* The asynchronous dump appends records to <dump_root>/Runtime/dump.bin,
+ * after the 8 bytes magic "NNCDUMP1". Every record is little endian:
+ *   uint64 request (0 based, counting the requests not sampled),
+ *   uint32 op_index, uint8 kind (0 input, 1 output),
+ *   uint8 typecode, uint16 name_bytes, uint32 rank, uint64 data_bytes,
+ *   char name[name_bytes] ("op$arg"), uint64 shape[rank],
+ *   uint64 strides[rank] (elements), data[data_bytes]
+ * data is the raw buffer from the first to the last element. */
 class NNCASE_API dump_manager {
 
   private:
+    struct async_writer;
+
     bool append_;
     int count_ = 1;
     std::string current_op_;
     std::string dump_root_;
+    std::shared_ptr<async_writer> async_;
 
   public:
     void set_current_op(const std::string &op) { current_op_ = op; }
@@ -50,6 +75,21 @@ class NNCASE_API dump_manager {
     void dump_output(nncase::value_t value);
 
     void dump_input(nncase::value_t value, std::string name);
+
+    /** @brief Dump into a binary file from a background thread, the dump
+     * root must be set first */
+    result<void> start_async(dump_async_options options);
+
+    /** @brief Write the queued records and go back to the text dump */
+    void stop_async();
+
+    bool is_async() const noexcept { return async_ != nullptr; }
+
+    /** @brief Called once per request by the entry function */
+    void begin_request();
+
+    /** @brief Records dropped because the queue was full */
+    size_t dropped_records() const noexcept;
 };
 
 END_NS_NNCASE_RUNTIME
\ No newline at end of file
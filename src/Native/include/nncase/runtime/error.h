@@ -33,6 +33,7 @@ enum class nncase_errc {
     stackvm_stack_underflow = 0x0103,
     stackvm_unknow_custom_call = 0x0104,
     stackvm_duplicate_custom_call = 0x0105,
+    stackvm_custom_call_failed = 0x0106,
     nnil_illegal_instruction = 0x0200,
 };
 
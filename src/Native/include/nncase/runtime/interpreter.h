@@ -14,6 +14,7 @@
  */
 #pragma once
 #include "allocator.h"
+#include "autotuner.h"
 #include "dump_manager.h"
 #include "model.h"
 #include "result.h"
@@ -25,6 +26,7 @@
 #include <nncase/shape.h>
 #include <nncase/tensor.h>
 #include <nncase/type.h>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 
@@ -102,19 +104,54 @@ class NNCASE_API interpreter {
         return dump_manager_;
     }
 
+    /** @brief The kernel autotuner, null unless autotune_cache_dir_option is
+     * set when the model is loaded */
+    std::shared_ptr<nncase::runtime::autotuner> autotuner() noexcept {
+        return autotuner_;
+    }
+
+    /* State APIs
+     * State variables persist across runs, e.g. the kv cache of incremental
+     * decoding. They are declared by the kmodel, allocated once when it is
+     * loaded and zero initialized. */
+
+    size_t states_size() const noexcept;
+    result<size_t> find_state_by_name(std::string_view name) const noexcept;
+    result<std::string_view> state_name(size_t index) const noexcept;
+    /** @brief The state itself, not a copy, it is updated by later runs */
+    result<runtime_tensor> state_tensor(size_t index) noexcept;
+    /** @brief Copy tensor into the state */
+    result<void> state_tensor(size_t index, runtime_tensor tensor) noexcept;
+    /** @brief Zero all the states, e.g. to start a new sequence */
+    result<void> reset_states() noexcept;
+
+    /** @brief Declare a state, called by the modules when loaded. States of
+     * the same name are shared by all the modules and must match. */
+    result<runtime_tensor> add_state(std::string_view name, typecode_t datatype,
+                                     gsl::span<const size_t> shape) noexcept;
+
   private:
+    struct state_variable {
+        std::string name;
+        runtime_tensor tensor;
+    };
+
     tensor_type input_tensor_type(size_t index) const noexcept;
     tensor_type output_tensor_type(size_t index) const noexcept;
 
     result<void> initialize_model(const model_header &header) noexcept;
+    result<void> initialize_autotuner(uint64_t model_hash) noexcept;
+    bool autotune_enabled() noexcept;
 
   private:
     std::shared_ptr<nncase::runtime::dump_manager> dump_manager_;
+    std::shared_ptr<nncase::runtime::autotuner> autotuner_;
     std::vector<std::unique_ptr<runtime_module>> modules_;
     runtime_function *entry_function_;
     options_dict options_;
     std::vector<runtime_tensor> input_tensors_;
     std::vector<runtime_tensor> output_tensors_;
+    std::vector<state_variable> states_;
 };
 
 END_NS_NNCASE_RUNTIME
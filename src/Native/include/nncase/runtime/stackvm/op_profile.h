@@ -16,6 +16,8 @@
 #include "opcode.h"
 #include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -23,8 +25,10 @@ extern "C" {
 double get_ms_time();
 }
 
-class op_profile {
+class NNCASE_API op_profile {
   public:
+    using timing_t = std::tuple<std::string, uint8_t, double, double>;
+
     op_profile(const std::string &op_name, uint8_t op_type)
         : op_name_(op_name), op_type_(op_type) {
         begin_ = get_ms_time();
@@ -32,16 +36,23 @@ class op_profile {
 
     ~op_profile() {
         end_ = get_ms_time();
+        std::lock_guard<std::mutex> guard(lock_);
         op_timing_.push_back(std::make_tuple(op_name_, op_type_, begin_, end_));
     }
 
     static void print();
 
+    /** @brief Move out the timings recorded so far, for tools aggregating
+     * many runs */
+    static std::vector<timing_t> take();
+
   public:
-    static std::vector<std::tuple<std::string, uint8_t, double, double>>
-        op_timing_;
+    static std::vector<timing_t> op_timing_;
+    /** @brief Print the profile after each run of the entry function */
+    static bool print_on_invoke;
 
   private:
+    static std::mutex lock_;
     double begin_;
     double end_;
     std::string op_name_;
@@ -1490,6 +1490,37 @@ template <> struct tensor_op_reader<tensor_function_t::unsqueeze_shape> {
     }
 };
 
+template <> struct tensor_op_reader<tensor_function_t::variable_read> {
+    tensor_variable_read_op_t
+    operator()(NNCASE_UNUSED span_reader &reader) const {
+        tensor_variable_read_op_t op;
+        op.name = reader.read_string();
+        op.type = static_cast<typecode_t>(reader.read_unaligned<uint8_t>());
+        op.can_fold_const_call = reader.read_unaligned<bool>();
+        return op;
+    }
+};
+
+template <> struct tensor_op_reader<tensor_function_t::variable_update> {
+    tensor_variable_update_op_t
+    operator()(NNCASE_UNUSED span_reader &reader) const {
+        tensor_variable_update_op_t op;
+        op.axis = reader.read_unaligned<int32_t>();
+        op.can_fold_const_call = reader.read_unaligned<bool>();
+        return op;
+    }
+};
+
+template <> struct tensor_op_reader<tensor_function_t::weight_only_mat_mul> {
+    tensor_weight_only_mat_mul_op_t
+    operator()(NNCASE_UNUSED span_reader &reader) const {
+        tensor_weight_only_mat_mul_op_t op;
+        op.bits = reader.read_unaligned<int32_t>();
+        op.group_size = reader.read_unaligned<int32_t>();
+        return op;
+    }
+};
+
 template <> struct tensor_op_reader<tensor_function_t::where> {
     tensor_where_op_t operator()(NNCASE_UNUSED span_reader &reader) const {
         tensor_where_op_t op;
@@ -1880,6 +1911,18 @@ class NNCASE_API tensor_op_visitor {
         return default_visit(tensor_function_t::unsqueeze_shape, &op);
     }
     virtual result<void>
+    visit(NNCASE_UNUSED const tensor_variable_read_op_t &op) noexcept {
+        return default_visit(tensor_function_t::variable_read, &op);
+    }
+    virtual result<void>
+    visit(NNCASE_UNUSED const tensor_variable_update_op_t &op) noexcept {
+        return default_visit(tensor_function_t::variable_update, &op);
+    }
+    virtual result<void>
+    visit(NNCASE_UNUSED const tensor_weight_only_mat_mul_op_t &op) noexcept {
+        return default_visit(tensor_function_t::weight_only_mat_mul, &op);
+    }
+    virtual result<void>
     visit(NNCASE_UNUSED const tensor_where_op_t &op) noexcept {
         return default_visit(tensor_function_t::where, &op);
     }
@@ -207,7 +207,10 @@ enum class tensor_function_t : uint16_t {
     transpose = 86,
     trilu = 88,
     unsqueeze = 92,
-    where = 94,
+    variable_read = 94,
+    variable_update = 95,
+    weight_only_mat_mul = 96,
+    where = 97,
     broadcast_shape = 5,
     conv2d_shape = 15,
     conv2d_transpose_shape = 17,
@@ -839,6 +842,22 @@ struct tensor_unsqueeze_op_t {};
 
 struct tensor_unsqueeze_shape_op_t {};
 
+struct tensor_variable_read_op_t {
+    std::string name;
+    typecode_t type;
+    bool can_fold_const_call;
+};
+
+struct tensor_variable_update_op_t {
+    int32_t axis;
+    bool can_fold_const_call;
+};
+
+struct tensor_weight_only_mat_mul_op_t {
+    int32_t bits;
+    int32_t group_size;
+};
+
 struct tensor_where_op_t {
     bool is_tf_where;
 };
@@ -1003,6 +1022,12 @@ inline std::string to_string(tensor_function_t tensor_funct) {
         return "trilu";
     case tensor_function_t::unsqueeze:
         return "unsqueeze";
+    case tensor_function_t::variable_read:
+        return "variable_read";
+    case tensor_function_t::variable_update:
+        return "variable_update";
+    case tensor_function_t::weight_only_mat_mul:
+        return "weight_only_mat_mul";
     case tensor_function_t::where:
         return "where";
     case tensor_function_t::broadcast_shape:
@@ -19,7 +19,26 @@ BEGIN_NS_NNCASE_RT_MODULE(stackvm)
 
 NNCASE_INLINE_VAR constexpr module_kind_t stackvm_module_kind =
     to_module_kind("stackvm");
-NNCASE_INLINE_VAR constexpr uint32_t stackvm_module_version = 1;
+/** @brief Bumped when tensor_function_t is renumbered, which happens when an
+ * op is added since the tensor functions are numbered by op name */
+NNCASE_INLINE_VAR constexpr uint32_t stackvm_module_version = 3;
+
+/** @brief Interpreter option: worker threads used to run independent tensor
+ * ops concurrently (uint32 scalar). 0, the default, runs every op in order on
+ * the calling thread. */
+NNCASE_INLINE_VAR constexpr const char *stackvm_dataflow_threads_option =
+    "stackvm.dataflow_threads";
+
+/** @brief Interpreter option: max tensor ops in flight in dataflow mode
+ * (uint32 scalar), which bounds the intermediates kept alive. */
+NNCASE_INLINE_VAR constexpr const char *stackvm_dataflow_max_inflight_option =
+    "stackvm.dataflow_max_inflight";
+
+/** @brief Interpreter option: number of input shape combinations whose shape
+ * arithmetic results are kept per function (uint32 scalar). 0 disables the
+ * plan cache. */
+NNCASE_INLINE_VAR constexpr const char *stackvm_plan_cache_capacity_option =
+    "stackvm.plan_cache_capacity";
 
 NNCASE_API result<std::unique_ptr<runtime_module>>
 create_stackvm_runtime_module();
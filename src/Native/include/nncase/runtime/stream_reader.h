@@ -66,6 +66,12 @@ class stream_reader {
         }
     }
 
+    std::string read_string() {
+        std::string value;
+        std::getline(stream_, value, '\0');
+        return value;
+    }
+
     void skip(size_t count) { stream_.seekg(count, std::ios::cur); }
 
   private:
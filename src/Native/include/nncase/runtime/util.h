@@ -512,6 +512,17 @@ inline tensor tensor_reshape(tensor in_tensor,
                   in_tensor->buffer());
 }
 
+/** @brief Contiguous tensor of new_shape over the memory of in_tensor from
+ * offset bytes on, writes to either are seen by both */
+inline tensor tensor_view(tensor in_tensor, gsl::span<const size_t> new_shape,
+                          size_t offset) {
+    auto &buffer = in_tensor->buffer();
+    auto size = get_bytes(in_tensor->dtype(), new_shape);
+    return tensor(std::in_place, in_tensor->dtype(), new_shape,
+                  get_default_strides(new_shape),
+                  buffer_slice(buffer.buffer(), buffer.start() + offset, size));
+}
+
 inline bool is_scalar(tensor t) noexcept { return t->shape().empty(); }
 inline bool is_scalar(gsl::span<const size_t> t) noexcept { return t.empty(); }
 
@@ -12,11 +12,13 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
 #include <nncase/api.h>
 #include <nncase/object.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/dbg.h>
 #include <nncase/runtime/interpreter.h>
+#include <string_view>
 
 using namespace nncase;
 using namespace nncase::runtime;
@@ -121,6 +123,55 @@ int nncase_interp_set_dump_root(nncase::runtime::interpreter *interp,
     return -EINVAL;
 }
 
+// ops is a comma separated list of op names, every op is dumped when empty.
+int nncase_interp_start_async_dump(nncase::runtime::interpreter *interp,
+                                   [[maybe_unused]] const char *ops,
+                                   [[maybe_unused]] uint32_t request_interval,
+                                   [[maybe_unused]] uint64_t max_queue_bytes) {
+    if (interp) {
+#ifndef NNCASE_BAREMETAL
+        nncase::runtime::dump_async_options options;
+        if (ops) {
+            std::string_view names(ops);
+            while (!names.empty()) {
+                auto end = std::min(names.find(','), names.size());
+                if (end)
+                    options.ops.emplace_back(names.substr(0, end));
+                names.remove_prefix(std::min(end + 1, names.size()));
+            }
+        }
+        options.request_interval = request_interval;
+        options.max_queue_bytes = (size_t)max_queue_bytes;
+        c_try(interp->dump_manager()->start_async(std::move(options)));
+        return 0;
+#else
+        return -ENOTSUP;
+#endif
+    }
+    return -EINVAL;
+}
+
+int nncase_interp_stop_async_dump(nncase::runtime::interpreter *interp) {
+    if (interp) {
+#ifndef NNCASE_BAREMETAL
+        interp->dump_manager()->stop_async();
+#endif
+        return 0;
+    }
+    return -EINVAL;
+}
+
+// Call it before loading the model, the cache is keyed by the model hash.
+int nncase_interp_set_autotune_cache_dir(nncase::runtime::interpreter *interp,
+                                         const char *path) {
+    if (interp && path) {
+        c_try(interp->options().set(nncase::runtime::autotune_cache_dir_option,
+                                    std::string(path)));
+        return 0;
+    }
+    return -EINVAL;
+}
+
 int nncase_interp_get_entry_func(nncase::runtime::interpreter *interp,
                                  nncase::runtime::runtime_function **func) {
     if (interp && func) {
@@ -0,0 +1,517 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <nncase/io_utils.h>
+#include <nncase/kernels/kernel_context.h>
+#include <nncase/runtime/interpreter.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/runtime/stackvm/op_profile.h>
+#include <nncase/runtime/stackvm/runtime_module.h>
+#include <nncase/version.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using bench_clock = std::chrono::steady_clock;
+
+namespace {
+enum class load_mode { closed, open };
+
+struct bench_options {
+    std::string kmodel_path;
+    std::vector<std::string> input_paths;
+    size_t sessions = 1;
+    load_mode mode = load_mode::closed;
+    double qps = 0;
+    double duration = 10;
+    size_t requests = 0;
+    size_t warmup = 5;
+    uint32_t kernel_threads = 0;
+    uint32_t dataflow_threads = 0;
+    bool op_profile = false;
+    std::string json_path;
+};
+
+/** @brief One interpreter with its own inputs, driven by one thread */
+struct session {
+    interpreter interp;
+    runtime_function *entry = nullptr;
+    std::vector<value_t> parameters;
+    std::vector<double> latencies;
+    size_t errors = 0;
+    std::string first_error;
+    bench_clock::time_point last_end;
+};
+
+struct op_stat {
+    std::string name;
+    size_t count;
+    double total_ms;
+};
+
+struct bench_report {
+    double wall_seconds;
+    size_t completed;
+    size_t errors;
+    std::string first_error;
+    std::vector<double> latencies;
+    double peak_rss_mb;
+    bool has_ops;
+    std::vector<op_stat> ops;
+};
+
+/** @brief Releases the sessions together once all of them are warm */
+class start_gate {
+  public:
+    explicit start_gate(size_t sessions) : waiting_(sessions) {}
+
+    void arrive_and_wait() {
+        std::unique_lock<std::mutex> lock(lock_);
+        if (--waiting_ == 0)
+            all_ready_.notify_all();
+        opened_.wait(lock, [this] { return open_; });
+    }
+
+    void wait_all_ready() {
+        std::unique_lock<std::mutex> lock(lock_);
+        all_ready_.wait(lock, [this] { return waiting_ == 0; });
+    }
+
+    void open() {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            open_ = true;
+        }
+        opened_.notify_all();
+    }
+
+  private:
+    std::mutex lock_;
+    std::condition_variable all_ready_;
+    std::condition_variable opened_;
+    size_t waiting_;
+    bool open_ = false;
+};
+
+void print_usage() {
+    std::cerr
+        << "Usage: nncasebench_cli [options] kmodel [input0.bin ...]\n"
+           "  --sessions N          concurrent sessions, one interpreter and "
+           "thread each (1)\n"
+           "  --mode closed|open    closed loop, or open loop at a fixed "
+           "rate (closed)\n"
+           "  --qps R               arrival rate of the open loop\n"
+           "  --duration S          measured seconds (10)\n"
+           "  --requests N          stop after N measured requests, 0 for "
+           "no limit (0)\n"
+           "  --warmup N            runs per session before measuring (5)\n"
+           "  --kernel-threads N    threads of each kernel (runtime "
+           "default)\n"
+           "  --dataflow-threads N  stackvm dataflow workers per session "
+           "(0)\n"
+           "  --op-profile          per-op breakdown, needs a runtime built "
+           "with ENABLE_OP_PROFILE\n"
+           "  --json PATH           write the report as json, - for stdout\n"
+           "Inputs not given are zero filled.\n";
+}
+
+bool parse_options(int argc, char **argv, bench_options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char * {
+            return i + 1 < argc ? argv[++i] : nullptr;
+        };
+
+        if (arg == "--op-profile") {
+            options.op_profile = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            auto v = value();
+            if (!v)
+                return false;
+            if (arg == "--sessions")
+                options.sessions = std::stoul(v);
+            else if (arg == "--mode" && !strcmp(v, "closed"))
+                options.mode = load_mode::closed;
+            else if (arg == "--mode" && !strcmp(v, "open"))
+                options.mode = load_mode::open;
+            else if (arg == "--qps")
+                options.qps = std::stod(v);
+            else if (arg == "--duration")
+                options.duration = std::stod(v);
+            else if (arg == "--requests")
+                options.requests = std::stoul(v);
+            else if (arg == "--warmup")
+                options.warmup = std::stoul(v);
+            else if (arg == "--kernel-threads")
+                options.kernel_threads = (uint32_t)std::stoul(v);
+            else if (arg == "--dataflow-threads")
+                options.dataflow_threads = (uint32_t)std::stoul(v);
+            else if (arg == "--json")
+                options.json_path = v;
+            else
+                return false;
+        } else if (options.kmodel_path.empty()) {
+            options.kmodel_path = arg;
+        } else {
+            options.input_paths.push_back(arg);
+        }
+    }
+
+    return !options.kmodel_path.empty() && options.sessions > 0 &&
+           (options.mode == load_mode::closed || options.qps > 0) &&
+           (options.duration > 0 || options.requests > 0);
+}
+
+/** @brief Peak resident set of the process in MiB, 0 when unknown */
+double peak_rss_mb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                             sizeof(counters)))
+        return counters.PeakWorkingSetSize / 1048576.0;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1048576.0;
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+result<void> open_session(session &s, const bench_options &options,
+                          gsl::span<const gsl::byte> kmodel,
+                          std::vector<std::vector<uint8_t>> &inputs) {
+    if (options.dataflow_threads)
+        try_(s.interp.options().set(stackvm::stackvm_dataflow_threads_option,
+                                    scalar(options.dataflow_threads)));
+    try_(s.interp.load_model(kmodel, false));
+    try_set(s.entry, s.interp.entry_function());
+
+    // Every session owns its inputs, so sessions only share the model
+    for (size_t i = 0; i < s.entry->parameters_size(); i++) {
+        try_var(type, s.entry->parameter_type(i));
+        try_var(ts_type, type.as<tensor_type>());
+        try_var(dims, ts_type->shape().as_fixed());
+        auto bytes = compute_size(dims) * ts_type->dtype()->size_bytes();
+        if (inputs.size() <= i)
+            inputs.emplace_back(bytes);
+        CHECK_WITH_ERR(inputs[i].size() == bytes,
+                       std::errc::invalid_argument);
+        gsl::span<gsl::byte> data = {
+            reinterpret_cast<gsl::byte *>(inputs[i].data()), bytes};
+        try_var(input,
+                hrt::create(ts_type->dtype()->typecode(), dims, data, true));
+        s.parameters.emplace_back(input.impl());
+    }
+    return ok();
+}
+
+/** @brief Closed loop: every session sends its next request as soon as the
+ * last one returns. Open loop: requests arrive every 1 / qps seconds and
+ * their latency counts from the arrival, so time queued behind busy
+ * sessions is included. */
+void run_session(session &s, const bench_options &options, start_gate &gate,
+                 const bench_clock::time_point &start,
+                 std::atomic<size_t> &next_request) {
+    for (size_t i = 0; i < options.warmup; i++)
+        (void)s.entry->invoke(s.parameters);
+    gate.arrive_and_wait();
+
+    auto deadline =
+        start + std::chrono::duration_cast<bench_clock::duration>(
+                    std::chrono::duration<double>(options.duration));
+    auto period = options.mode == load_mode::open
+                      ? std::chrono::duration<double>(1 / options.qps)
+                      : std::chrono::duration<double>(0);
+    while (true) {
+        auto request = next_request++;
+        if (options.requests && request >= options.requests)
+            break;
+
+        auto begin = bench_clock::now();
+        if (options.mode == load_mode::open) {
+            begin = start + std::chrono::duration_cast<bench_clock::duration>(
+                                period * (double)request);
+            if (options.duration > 0 && begin >= deadline)
+                break;
+            std::this_thread::sleep_until(begin);
+        } else if (options.duration > 0 && begin >= deadline) {
+            break;
+        }
+
+        auto ret = s.entry->invoke(s.parameters);
+        auto end = bench_clock::now();
+        if (ret.is_ok()) {
+            s.latencies.push_back(
+                std::chrono::duration<double, std::milli>(end - begin)
+                    .count());
+        } else if (s.errors++ == 0) {
+            s.first_error = ret.unwrap_err().message();
+        }
+        s.last_end = end;
+    }
+}
+
+#ifdef ENABLE_OP_PROFILE
+std::vector<op_stat> collect_ops(size_t requests) {
+    std::map<std::string, op_stat> stats;
+    for (auto &&[name, type, begin, end] : op_profile::take()) {
+        (void)type;
+        auto &stat = stats.emplace(name, op_stat{name, 0, 0}).first->second;
+        stat.count++;
+        stat.total_ms += end - begin;
+    }
+
+    std::vector<op_stat> ops;
+    for (auto &stat : stats) {
+        stat.second.total_ms /= std::max(requests, (size_t)1);
+        ops.push_back(stat.second);
+    }
+    std::sort(ops.begin(), ops.end(), [](const op_stat &a, const op_stat &b) {
+        return a.total_ms > b.total_ms;
+    });
+    return ops;
+}
+#endif
+
+result<bench_report> run_bench(const bench_options &options) {
+    auto kmodel = read_file(options.kmodel_path);
+    std::vector<std::vector<uint8_t>> inputs;
+    for (auto &path : options.input_paths)
+        inputs.emplace_back(read_file(path));
+    if (options.kernel_threads)
+        kernels::default_kernel_context().num_threads = options.kernel_threads;
+    op_profile::print_on_invoke = false;
+
+    std::vector<std::unique_ptr<session>> sessions;
+    for (size_t i = 0; i < options.sessions; i++) {
+        sessions.emplace_back(std::make_unique<session>());
+        try_(open_session(
+            *sessions.back(), options,
+            {reinterpret_cast<const gsl::byte *>(kmodel.data()),
+             kmodel.size()},
+            inputs));
+    }
+
+    start_gate gate(options.sessions);
+    bench_clock::time_point start;
+    std::atomic<size_t> next_request(0);
+    std::vector<std::thread> threads;
+    for (auto &s : sessions) {
+        threads.emplace_back(run_session, std::ref(*s), std::cref(options),
+                             std::ref(gate), std::cref(start),
+                             std::ref(next_request));
+    }
+    gate.wait_all_ready();
+    (void)op_profile::take();
+    start = bench_clock::now();
+    gate.open();
+    for (auto &t : threads)
+        t.join();
+
+    bench_report report{};
+    auto end = start;
+    for (auto &s : sessions) {
+        report.latencies.insert(report.latencies.end(), s->latencies.begin(),
+                                s->latencies.end());
+        if (s->errors && !report.errors)
+            report.first_error = s->first_error;
+        report.errors += s->errors;
+        end = std::max(end, s->last_end);
+    }
+    std::sort(report.latencies.begin(), report.latencies.end());
+    report.completed = report.latencies.size();
+    report.wall_seconds = std::chrono::duration<double>(end - start).count();
+    report.peak_rss_mb = peak_rss_mb();
+#ifdef ENABLE_OP_PROFILE
+    report.has_ops = options.op_profile;
+    if (report.has_ops)
+        report.ops = collect_ops(report.completed + report.errors);
+#else
+    report.has_ops = false;
+    if (options.op_profile)
+        std::cerr << "Per-op breakdown needs a runtime built with "
+                     "ENABLE_OP_PROFILE, skipped"
+                  << std::endl;
+#endif
+    return ok(std::move(report));
+}
+
+/** @brief Nearest-rank percentile of sorted latencies */
+double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    auto rank = (size_t)std::ceil(p / 100 * sorted.size());
+    return sorted[std::clamp(rank, (size_t)1, sorted.size()) - 1];
+}
+
+constexpr double report_percentiles[] = {50, 90, 99, 99.9};
+
+double throughput(const bench_report &report) {
+    return report.wall_seconds > 0 ? report.completed / report.wall_seconds
+                                   : 0;
+}
+
+void print_report(std::ostream &os, const bench_options &options,
+                  const bench_report &report) {
+    os << std::fixed << std::setprecision(3);
+    os << "nncase benchmark " NNCASE_VERSION NNCASE_VERSION_SUFFIX << "\n"
+       << "model:       " << options.kmodel_path << "\n"
+       << "mode:        "
+       << (options.mode == load_mode::open ? "open" : "closed");
+    if (options.mode == load_mode::open)
+        os << " @ " << options.qps << " qps";
+    os << ", " << options.sessions << " session(s)\n"
+       << "requests:    " << report.completed << " ok, " << report.errors
+       << " failed in " << report.wall_seconds << " s\n"
+       << "throughput:  " << throughput(report) << " req/s\n"
+       << "latency ms:  min " << percentile(report.latencies, 0);
+    for (auto p : report_percentiles)
+        os << ", p" << p << " " << percentile(report.latencies, p);
+    os << ", max "
+       << (report.latencies.empty() ? 0 : report.latencies.back()) << "\n"
+       << "peak rss:    " << report.peak_rss_mb << " MiB\n";
+    if (report.errors)
+        os << "first error: " << report.first_error << "\n";
+
+    if (report.has_ops) {
+        double total = 0;
+        for (auto &op : report.ops)
+            total += op.total_ms;
+        os << "\n|" << std::setw(24) << std::left << "op"
+           << "|" << std::setw(10) << "count/req"
+           << "|" << std::setw(12) << "ms/req"
+           << "|" << std::setw(10) << "percent"
+           << "|\n";
+        auto requests = std::max(report.completed + report.errors, (size_t)1);
+        for (auto &op : report.ops) {
+            os << "|" << std::setw(24) << op.name << "|" << std::setw(10)
+               << (double)op.count / requests << "|" << std::setw(12)
+               << op.total_ms << "|" << std::setw(10)
+               << (total > 0 ? op.total_ms / total * 100 : 0) << "|\n";
+        }
+    }
+    os.flush();
+}
+
+std::string json_string(const std::string &value) {
+    std::string s = "\"";
+    for (auto c : value) {
+        if (c == '"' || c == '\\')
+            s += '\\';
+        if ((unsigned char)c >= 0x20)
+            s += c;
+    }
+    return s + "\"";
+}
+
+void write_json(std::ostream &os, const bench_options &options,
+                const bench_report &report) {
+    os << std::setprecision(6) << "{\n"
+       << "  \"version\": "
+       << json_string(NNCASE_VERSION NNCASE_VERSION_SUFFIX) << ",\n"
+       << "  \"model\": " << json_string(options.kmodel_path) << ",\n"
+       << "  \"mode\": \""
+       << (options.mode == load_mode::open ? "open" : "closed") << "\",\n"
+       << "  \"qps\": " << options.qps << ",\n"
+       << "  \"sessions\": " << options.sessions << ",\n"
+       << "  \"kernel_threads\": "
+       << kernels::default_kernel_context().num_threads << ",\n"
+       << "  \"dataflow_threads\": " << options.dataflow_threads << ",\n"
+       << "  \"completed\": " << report.completed << ",\n"
+       << "  \"errors\": " << report.errors << ",\n"
+       << "  \"wall_seconds\": " << report.wall_seconds << ",\n"
+       << "  \"throughput\": " << throughput(report) << ",\n"
+       << "  \"latency_ms\": {\"min\": " << percentile(report.latencies, 0);
+    for (auto p : report_percentiles) {
+        std::ostringstream key;
+        key << "p" << p;
+        os << ", " << json_string(key.str()) << ": "
+           << percentile(report.latencies, p);
+    }
+    os << ", \"max\": "
+       << (report.latencies.empty() ? 0 : report.latencies.back()) << "},\n"
+       << "  \"peak_rss_mb\": " << report.peak_rss_mb << ",\n"
+       << "  \"ops\": ";
+    if (!report.has_ops) {
+        os << "null\n";
+    } else {
+        os << "[";
+        for (size_t i = 0; i < report.ops.size(); i++) {
+            auto &op = report.ops[i];
+            os << (i ? ",\n    " : "\n    ") << "{\"name\": "
+               << json_string(op.name) << ", \"count\": " << op.count
+               << ", \"ms_per_request\": " << op.total_ms << "}";
+        }
+        os << "\n  ]\n";
+    }
+    os << "}" << std::endl;
+}
+} // namespace
+
+/**
+ * @brief Load generator for capacity sizing and release comparisons.
+ *  nncasebench_cli [options] kmodel [input0 ... inputN]
+ */
+int main(int argc, char **argv) {
+    bench_options options;
+    bool parsed;
+    try {
+        parsed = parse_options(argc, argv, options);
+    } catch (std::exception &) {
+        parsed = false;
+    }
+    if (!parsed) {
+        print_usage();
+        return 1;
+    }
+
+    auto report = run_bench(options).unwrap_or_throw();
+    if (options.json_path == "-") {
+        write_json(std::cout, options, report);
+    } else {
+        print_report(std::cout, options, report);
+        if (!options.json_path.empty()) {
+            std::ofstream json(options.json_path);
+            write_json(json, options, report);
+        }
+    }
+    return report.errors ? 2 : 0;
+}
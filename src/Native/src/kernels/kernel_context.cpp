@@ -40,3 +40,14 @@ kernel_context &kernels::default_kernel_context() {
     static default_kernel_context_holder holder;
     return holder.ctx;
 }
+
+void kernels::parallel_for(NNCASE_UNUSED const kernel_context &context,
+                           size_t count,
+                           void (*body)(void *user_data, size_t index),
+                           void *user_data) noexcept {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t i = 0; i < (int64_t)count; i++)
+        body(user_data, (size_t)i);
+}
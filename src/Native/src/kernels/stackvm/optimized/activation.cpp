@@ -0,0 +1,577 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_fp16.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+#if __AVX__
+#include "x86_64/avx_mathfun.h"
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Elements given to one thread at a time
+constexpr size_t block_size = 16384;
+constexpr float sqrt1_2 = 0.70710678118654752f;
+
+size_t float_bytes(typecode_t type) noexcept {
+    return type == dt_float16 ? sizeof(half) : sizeof(float);
+}
+
+/** @brief Scalar parameter of the input type, float32 or float16 */
+float load_param(typecode_t type, const gsl::byte *value) noexcept {
+    if (!value)
+        return 0.f;
+    return type == dt_float16 ? static_cast<float>(*IN_CAST(half, value))
+                              : *IN_CAST(float, value);
+}
+
+/** @brief Parameters of a float32 or float16 tensor widened to float */
+std::vector<float> load_params(typecode_t type, const gsl::byte *values,
+                               size_t count) {
+    if (type == dt_float16)
+        return fp16_to_fp32(IN_CAST(half, values), count);
+    auto begin = IN_CAST(float, values);
+    return std::vector<float>(begin, begin + count);
+}
+
+#if __AVX__
+/** @brief erf by Abramowitz and Stegun 7.1.26, absolute error below 1.5e-7 */
+__m256 erf256_ps(__m256 x) noexcept {
+    auto sign_bit = _mm256_set1_ps(-0.0f);
+    auto ax = _mm256_andnot_ps(sign_bit, x);
+    auto t = _mm256_div_ps(_mm256_set1_ps(1.f),
+                           _mm256_fmadd_1_ps(_mm256_set1_ps(1.f), ax,
+                                             0.3275911f));
+    auto p = _mm256_fmadd_1_ps(_mm256_set1_ps(-1.453152027f), t,
+                               1.061405429f);
+    p = _mm256_comp_fmadd_ps(p, t, _mm256_set1_ps(1.421413741f));
+    p = _mm256_comp_fmadd_ps(p, t, _mm256_set1_ps(-0.284496736f));
+    p = _mm256_comp_fmadd_ps(p, t, _mm256_set1_ps(0.254829592f));
+    p = _mm256_mul_ps(p, t);
+    auto e =
+        exp256_ps(_mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(ax, ax)));
+    auto y = _mm256_comp_fnmadd_ps(p, e, _mm256_set1_ps(1.f));
+    return _mm256_or_ps(y, _mm256_and_ps(sign_bit, x));
+}
+
+/** @brief log(1 + x) for x >= 0. log(u) * x / (u - 1) with u = 1 + x
+ * cancels the rounding of u, and x itself is returned when u rounds to 1 */
+__m256 log1p256_ps(__m256 x) noexcept {
+    auto u = _mm256_add_ps(_mm256_set1_ps(1.f), x);
+    auto d = _mm256_sub_ps(u, _mm256_set1_ps(1.f));
+    auto y = _mm256_mul_ps(log256_ps(u), _mm256_div_ps(x, d));
+    return _mm256_blendv_ps(y, x,
+                            _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_EQ_OQ));
+}
+
+__m256 neg_mask(__m256 x) noexcept {
+    return _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ);
+}
+
+__m256 saturate(__m256 x) noexcept {
+    return _mm256_min_ps(_mm256_max_ps(x, _mm256_setzero_ps()),
+                         _mm256_set1_ps(1.f));
+}
+#endif
+
+/* Each op computes one element with operator() and, with AVX, 8 elements
+ * with pack(). Parameters are broadcast once when the op is built. */
+struct activation_op_relu {
+    float operator()(float x) const { return std::max(x, 0.f); }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        return _mm256_max_ps(x, _mm256_setzero_ps());
+    }
+#endif
+};
+
+struct activation_op_leaky_relu {
+    explicit activation_op_leaky_relu(float alpha) : alpha_(alpha) {}
+
+    float operator()(float x) const { return x < 0 ? alpha_ * x : x; }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        return _mm256_blendv_ps(x, _mm256_mul_ps(x, _mm256_set1_ps(alpha_)),
+                                neg_mask(x));
+    }
+#endif
+
+  private:
+    float alpha_;
+};
+
+struct activation_op_elu {
+    explicit activation_op_elu(float alpha) : alpha_(alpha) {}
+
+    float operator()(float x) const {
+        return x < 0 ? alpha_ * (std::exp(x) - 1) : x;
+    }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        auto neg = _mm256_mul_ps(
+            _mm256_set1_ps(alpha_),
+            _mm256_sub_ps(exp256_ps(x), _mm256_set1_ps(1.f)));
+        return _mm256_blendv_ps(x, neg, neg_mask(x));
+    }
+#endif
+
+  private:
+    float alpha_;
+};
+
+struct activation_op_celu {
+    explicit activation_op_celu(float alpha) : alpha_(alpha) {}
+
+    float operator()(float x) const {
+        return std::max(0.f, x) +
+               std::min(0.f, alpha_ * (std::exp(x / alpha_) - 1));
+    }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        auto alpha = _mm256_set1_ps(alpha_);
+        auto neg = _mm256_mul_ps(
+            alpha, _mm256_sub_ps(exp256_ps(_mm256_div_ps(x, alpha)),
+                                 _mm256_set1_ps(1.f)));
+        return _mm256_add_ps(_mm256_max_ps(x, _mm256_setzero_ps()),
+                             _mm256_min_ps(neg, _mm256_setzero_ps()));
+    }
+#endif
+
+  private:
+    float alpha_;
+};
+
+struct activation_op_selu {
+    activation_op_selu(float alpha, float gamma)
+        : alpha_(alpha), gamma_(gamma) {}
+
+    float operator()(float x) const {
+        return x <= 0 ? gamma_ * (alpha_ * std::exp(x) - alpha_) : x * gamma_;
+    }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        auto gamma = _mm256_set1_ps(gamma_);
+        auto neg = _mm256_mul_ps(
+            _mm256_set1_ps(gamma_ * alpha_),
+            _mm256_sub_ps(exp256_ps(x), _mm256_set1_ps(1.f)));
+        return _mm256_blendv_ps(
+            _mm256_mul_ps(x, gamma), neg,
+            _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LE_OQ));
+    }
+#endif
+
+  private:
+    float alpha_;
+    float gamma_;
+};
+
+struct activation_op_hard_sigmoid {
+    activation_op_hard_sigmoid(float alpha, float gamma)
+        : alpha_(alpha), gamma_(gamma) {}
+
+    float operator()(float x) const {
+        return std::max(0.f, std::min(1.f, x * alpha_ + gamma_));
+    }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        return saturate(_mm256_comp_fmadd_ps(x, _mm256_set1_ps(alpha_),
+                                             _mm256_set1_ps(gamma_)));
+    }
+#endif
+
+  private:
+    float alpha_;
+    float gamma_;
+};
+
+struct activation_op_hard_swish {
+    float operator()(float x) const {
+        return x * std::max(0.f, std::min(1.f, x / 6 + 0.5f));
+    }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        return _mm256_mul_ps(
+            x, saturate(_mm256_fmadd_1_ps(_mm256_set1_ps(0.5f), x, 1.f / 6)));
+    }
+#endif
+};
+
+struct activation_op_sigmoid {
+    float operator()(float x) const { return 1 / (1 + std::exp(-x)); }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        auto one = _mm256_set1_ps(1.f);
+        return _mm256_div_ps(
+            one, _mm256_add_ps(
+                     one, exp256_ps(_mm256_sub_ps(_mm256_setzero_ps(), x))));
+    }
+#endif
+};
+
+struct activation_op_swish {
+    float operator()(float x) const { return x / (1 + std::exp(-x)); }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        return _mm256_mul_ps(x, activation_op_sigmoid().pack(x));
+    }
+#endif
+};
+
+struct activation_op_softplus {
+    // log(1 + e^x) without overflow for large x
+    float operator()(float x) const {
+        return std::max(x, 0.f) + std::log1p(std::exp(-std::abs(x)));
+    }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        auto sign_bit = _mm256_set1_ps(-0.0f);
+        auto e = exp256_ps(_mm256_or_ps(x, sign_bit));
+        return _mm256_add_ps(_mm256_max_ps(x, _mm256_setzero_ps()),
+                             log1p256_ps(e));
+    }
+#endif
+};
+
+struct activation_op_softsign {
+    float operator()(float x) const { return x / (1 + std::abs(x)); }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        auto ax = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+        return _mm256_div_ps(x, _mm256_add_ps(_mm256_set1_ps(1.f), ax));
+    }
+#endif
+};
+
+struct activation_op_erf {
+    float operator()(float x) const { return std::erf(x); }
+#if __AVX__
+    __m256 pack(__m256 x) const { return erf256_ps(x); }
+#endif
+};
+
+struct activation_op_gelu {
+    explicit activation_op_gelu(float alpha) : alpha_(alpha) {}
+
+    float operator()(float x) const {
+        auto y = alpha_ * x;
+        return 0.5f * y * (1.f + std::erf(y * sqrt1_2));
+    }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        auto y = _mm256_mul_ps(x, _mm256_set1_ps(alpha_));
+        auto cdf = _mm256_fmadd_1_ps(
+            _mm256_set1_ps(0.5f),
+            erf256_ps(_mm256_mul_ps(y, _mm256_set1_ps(sqrt1_2))),
+            0.5f);
+        return _mm256_mul_ps(y, cdf);
+    }
+#endif
+
+  private:
+    float alpha_;
+};
+
+struct activation_op_clamp {
+    activation_op_clamp(float low, float high) : low_(low), high_(high) {}
+
+    float operator()(float x) const {
+        return std::min(std::max(x, low_), high_);
+    }
+#if __AVX__
+    __m256 pack(__m256 x) const {
+        return _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(low_)),
+                             _mm256_set1_ps(high_));
+    }
+#endif
+
+  private:
+    float low_;
+    float high_;
+};
+
+/** @brief output = x * scale + shift over count elements */
+void scale_shift(const float *input, float *output, size_t count, float scale,
+                 float shift) noexcept {
+    size_t i = 0;
+#if __AVX__
+    auto vscale = _mm256_set1_ps(scale);
+    auto vshift = _mm256_set1_ps(shift);
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(output + i,
+                         _mm256_comp_fmadd_ps(_mm256_loadu_ps(input + i),
+                                              vscale, vshift));
+    }
+#endif
+    for (; i < count; i++)
+        output[i] = input[i] * scale + shift;
+}
+
+template <class TOp>
+void activation_run(const TOp &op, const float *input, float *output,
+                    size_t count) noexcept {
+    size_t i = 0;
+#if __AVX__
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(output + i, op.pack(_mm256_loadu_ps(input + i)));
+#endif
+    for (; i < count; i++)
+        output[i] = op(input[i]);
+}
+
+/** @brief Calls fn(in, out, count) on count contiguous elements as float,
+ * float16 is computed on fp32 tiles */
+template <class TFunc>
+void map_float(typecode_t type, const gsl::byte *input, gsl::byte *output,
+               size_t count, TFunc &&fn) noexcept {
+    if (type == dt_float16)
+        fp16_map(IN_CAST(half, input), OUT_CAST(half, output), count, fn);
+    else
+        fn(IN_CAST(float, input), OUT_CAST(float, output), count);
+}
+
+template <class TOp>
+void activation_impl(const TOp &op, typecode_t type, const gsl::byte *input,
+                     gsl::byte *output, size_t count,
+                     NNCASE_UNUSED kernel_context &context) noexcept {
+    auto elem_size = float_bytes(type);
+    auto blocks = (int64_t)((count + block_size - 1) / block_size);
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t b = 0; b < blocks; b++) {
+        auto begin = (size_t)b * block_size;
+        map_float(type, input + begin * elem_size, output + begin * elem_size,
+                  std::min(block_size, count - begin),
+                  [&](const float *in, float *out, size_t n) {
+                      activation_run(op, in, out, n);
+                  });
+    }
+}
+
+bool is_float(typecode_t type) noexcept {
+    return type == dt_float32 || type == dt_float16;
+}
+} // namespace
+
+result<void> optimized::activation(activation_op_t op, typecode_t type,
+                                   const gsl::byte *input, gsl::byte *output,
+                                   size_t count, const gsl::byte *alpha,
+                                   const gsl::byte *gamma,
+                                   kernel_context &context) noexcept {
+    if (!is_float(type))
+        return err(std::errc::not_supported);
+
+    auto a = load_param(type, alpha);
+    auto g = load_param(type, gamma);
+    auto run = [&](const auto &impl) {
+        activation_impl(impl, type, input, output, count, context);
+        return ok();
+    };
+    switch (op) {
+    case activation_op_t::celu:
+        return run(activation_op_celu(a));
+    case activation_op_t::elu:
+        return run(activation_op_elu(a));
+    case activation_op_t::erf:
+        return run(activation_op_erf());
+    case activation_op_t::gelu:
+        return run(activation_op_gelu(a));
+    case activation_op_t::hard_sigmoid:
+        return run(activation_op_hard_sigmoid(a, g));
+    case activation_op_t::hard_swish:
+        return run(activation_op_hard_swish());
+    case activation_op_t::leaky_relu:
+        return run(activation_op_leaky_relu(a));
+    case activation_op_t::relu:
+        return run(activation_op_relu());
+    case activation_op_t::selu:
+        return run(activation_op_selu(a, g));
+    case activation_op_t::sigmoid:
+        return run(activation_op_sigmoid());
+    case activation_op_t::softplus:
+        return run(activation_op_softplus());
+    case activation_op_t::softsign:
+        return run(activation_op_softsign());
+    case activation_op_t::swish:
+        return run(activation_op_swish());
+    default:
+        return err(std::errc::not_supported);
+    }
+}
+
+result<void> optimized::clamp(typecode_t type, const gsl::byte *input,
+                              const gsl::byte *min, const gsl::byte *max,
+                              gsl::byte *output,
+                              gsl::span<const size_t> in_shape,
+                              gsl::span<const size_t> in_strides,
+                              gsl::span<const size_t> out_strides,
+                              kernel_context &context) noexcept {
+    if (!is_float(type) || !is_contiguous(in_shape, out_strides)) {
+        return reference::clamp(type, input, min, max, output, in_shape,
+                                in_strides, out_strides, context);
+    }
+
+    activation_impl(
+        activation_op_clamp(load_param(type, min), load_param(type, max)),
+        type, input, output, compute_size(in_shape), context);
+    return ok();
+}
+
+/* y = (x - mean) / sqrt(var + eps) * scale + bias is folded into one
+ * multiply-add per element, y = x * a + b with a = scale / sqrt(var + eps)
+ * and b = bias - mean * a computed once per channel. */
+result<void> optimized::batchnorm(
+    typecode_t typecode, const gsl::byte *input, const gsl::byte *scale,
+    const gsl::byte *bias, const gsl::byte *input_mean,
+    const gsl::byte *input_var, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides, float epsilon,
+    kernel_context &context) noexcept {
+    if (!is_float(typecode) || in_shape.size() < 2 ||
+        !is_contiguous(in_shape, out_strides)) {
+        return reference::batchnorm(typecode, input, scale, bias, input_mean,
+                                    input_var, output, in_shape, in_strides,
+                                    out_strides, epsilon, context);
+    }
+
+    const auto channels = in_shape[1];
+    auto a = load_params(typecode, scale, channels);
+    auto b = load_params(typecode, bias, channels);
+    auto mean = load_params(typecode, input_mean, channels);
+    auto var = load_params(typecode, input_var, channels);
+    for (size_t c = 0; c < channels; c++) {
+        a[c] = a[c] / std::sqrt(var[c] + epsilon);
+        b[c] = b[c] - mean[c] * a[c];
+    }
+
+    const auto elem_size = float_bytes(typecode);
+    const auto inner = compute_size(in_shape.subspan(2));
+    const auto planes = (int64_t)(in_shape[0] * channels);
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t plane = 0; plane < planes; plane++) {
+        auto c = (size_t)plane % channels;
+        auto offset = (size_t)plane * inner * elem_size;
+        map_float(typecode, input + offset, output + offset, inner,
+                  [&](const float *in, float *out, size_t n) {
+                      scale_shift(in, out, n, a[c], b[c]);
+                  });
+    }
+    return ok();
+}
+
+/* The slope broadcast to the input keeps only the dims [first, last] which
+ * match the input, so the input is viewed as [outer, channels, inner] with
+ * a slope per channel. inner is 1 when the slope runs along the last dims,
+ * then each row takes the slopes as a vector. */
+result<void> optimized::prelu(
+    typecode_t type, const gsl::byte *input, const gsl::byte *slope,
+    gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> input_strides, gsl::span<const size_t> slope_shape,
+    gsl::span<const size_t> slope_strides, gsl::span<const size_t> out_shape,
+    gsl::span<const size_t> out_strides, kernel_context &context) noexcept {
+    auto fallback = [&] {
+        return reference::prelu(type, input, slope, output, in_shape,
+                                input_strides, slope_shape, slope_strides,
+                                out_shape, out_strides, context);
+    };
+    if (!is_float(type) || slope_shape.size() > in_shape.size() ||
+        !is_contiguous(slope_shape, slope_strides) ||
+        !is_contiguous(out_shape, out_strides) ||
+        compute_size(out_shape) != compute_size(in_shape))
+        return fallback();
+
+    if (compute_size(slope_shape) == 1) {
+        activation_impl(activation_op_leaky_relu(load_param(type, slope)),
+                        type, input, output, compute_size(in_shape), context);
+        return ok();
+    }
+
+    const auto rank = in_shape.size();
+    const auto pad = rank - slope_shape.size();
+    size_t first = rank, last = 0;
+    for (size_t i = pad; i < rank; i++) {
+        if (slope_shape[i - pad] == 1)
+            continue;
+        if (slope_shape[i - pad] != in_shape[i])
+            return fallback();
+        first = std::min(first, i);
+        last = i;
+    }
+    for (size_t i = first; i < last; i++) {
+        if (slope_shape[i - pad] != in_shape[i])
+            return fallback();
+    }
+
+    const auto outer = compute_size(in_shape.first(first));
+    const auto channels = compute_size(slope_shape);
+    const auto inner = compute_size(in_shape.subspan(last + 1));
+    const auto elem_size = float_bytes(type);
+    auto slopes = load_params(type, slope, channels);
+    if (inner == 1) {
+        const auto rows = (int64_t)outer;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t row = 0; row < rows; row++) {
+            auto offset = (size_t)row * channels * elem_size;
+            size_t begin = 0;
+            map_float(type, input + offset, output + offset, channels,
+                      [&](const float *in, float *out, size_t n) {
+                          auto k = slopes.data() + begin;
+                          size_t i = 0;
+#if __AVX__
+                          for (; i + 8 <= n; i += 8) {
+                              auto x = _mm256_loadu_ps(in + i);
+                              auto y = _mm256_mul_ps(
+                                  x, _mm256_loadu_ps(k + i));
+                              _mm256_storeu_ps(
+                                  out + i,
+                                  _mm256_blendv_ps(x, y, neg_mask(x)));
+                          }
+#endif
+                          for (; i < n; i++)
+                              out[i] = in[i] < 0 ? k[i] * in[i] : in[i];
+                          begin += n;
+                      });
+        }
+    } else {
+        const auto planes = (int64_t)(outer * channels);
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t plane = 0; plane < planes; plane++) {
+            auto offset = (size_t)plane * inner * elem_size;
+            activation_op_leaky_relu op(slopes[(size_t)plane % channels]);
+            map_float(type, input + offset, output + offset, inner,
+                      [&](const float *in, float *out, size_t n) {
+                          activation_run(op, in, out, n);
+                      });
+        }
+    }
+    return ok();
+}
@@ -0,0 +1,146 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/* The input batch is split into [block..., batch] and each block offset is
+ * interleaved back into its spatial axis [..., spatial, block], then crops
+ * are dropped. Spatial axes are the trailing ones. An output row of the last
+ * spatial axis takes every last-block-th element from last_block contiguous
+ * input rows, one per block offset, so when the last block is 1 a row is a
+ * single copy. */
+template <class T>
+void batch_to_space_impl(const T *input, T *output,
+                         gsl::span<const size_t> in_shape,
+                         gsl::span<const size_t> block_shape,
+                         const paddings_t &crops,
+                         gsl::span<const size_t> out_shape,
+                         NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto rank = in_shape.size();
+    const auto m = block_shape.size();
+    const auto spatial_start = rank - m;
+    const auto batch = out_shape[0];
+    const auto mid = compute_size(in_shape.subspan(1, spatial_start - 1));
+    const auto last_block = block_shape[m - 1];
+    const auto last_crop = (size_t)crops[m - 1].before;
+    const auto last_in = in_shape[rank - 1];
+    const auto last_out = out_shape[rank - 1];
+    const auto in_batch_size = compute_size(in_shape.subspan(1));
+
+    // Rows are indexed by [batch, mid, out spatial[:-1]...]
+    const auto rows = (int64_t)(compute_size(out_shape) / last_out);
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t row = 0; row < rows; row++) {
+        auto out_row = output + (size_t)row * last_out;
+        auto rest = (size_t)row;
+
+        // Block offset and input index of the leading spatial axes
+        size_t block_index = 0, block_stride = 1, in_row = 0,
+               in_row_stride = 1;
+        for (size_t i = m - 1; i > 0; i--) {
+            auto dim = spatial_start + i - 1;
+            auto o = rest % out_shape[dim] + (size_t)crops[i - 1].before;
+            rest /= out_shape[dim];
+            block_index += o % block_shape[i - 1] * block_stride;
+            block_stride *= block_shape[i - 1];
+            in_row += o / block_shape[i - 1] * in_row_stride;
+            in_row_stride *= in_shape[dim];
+        }
+        const auto m_index = rest % mid;
+        const auto n = rest / mid;
+        in_row += m_index * in_row_stride;
+
+        for (size_t offset = 0; offset < last_block; offset++) {
+            // First output column of this block offset after the crop
+            auto first = (offset + last_block - last_crop % last_block) %
+                         last_block;
+            if (first >= last_out)
+                continue;
+            auto src_col = (first + last_crop) / last_block;
+            auto in_batch = (block_index * last_block + offset) * batch + n;
+            auto src = input + in_batch * in_batch_size + in_row * last_in +
+                       src_col;
+            auto count = std::min((last_out - first + last_block - 1) /
+                                      last_block,
+                                  last_in - src_col);
+            if (last_block == 1) {
+                std::copy_n(src, count, out_row + first);
+            } else {
+                auto dest = out_row + first;
+                for (size_t i = 0; i < count; i++)
+                    dest[i * last_block] = src[i];
+            }
+        }
+    }
+}
+
+#define BATCH_TO_SPACE_IMPL(size, type)                                        \
+    case size:                                                                 \
+        batch_to_space_impl(IN_CAST(type, input), OUT_CAST(type, output),      \
+                            in_shape, block_shape, crops, out_shape, context); \
+        return ok()
+
+bool is_crop_shape(gsl::span<const size_t> in_shape,
+                   gsl::span<const size_t> block_shape, const paddings_t &crops,
+                   gsl::span<const size_t> out_shape) noexcept {
+    const auto rank = in_shape.size();
+    const auto m = block_shape.size();
+    if (m == 0 || rank < m + 1 || out_shape.size() != rank ||
+        crops.size() < m ||
+        out_shape[0] * compute_size(block_shape) != in_shape[0])
+        return false;
+    for (size_t i = 1; i < rank - m; i++) {
+        if (out_shape[i] != in_shape[i])
+            return false;
+    }
+    for (size_t i = 0; i < m; i++) {
+        auto dim = rank - m + i;
+        if (crops[i].before < 0 || crops[i].after < 0 ||
+            out_shape[dim] + crops[i].sum() != in_shape[dim] * block_shape[i])
+            return false;
+    }
+    return true;
+}
+} // namespace
+
+result<void> optimized::batch_to_space(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &crops, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context) noexcept {
+    if (!is_crop_shape(in_shape, block_shape, crops, out_shape) ||
+        !is_contiguous(out_shape, out_strides) ||
+        compute_size(out_shape) == 0) {
+        return reference::batch_to_space(type, input, output, in_shape,
+                                         block_shape, crops, in_strides,
+                                         out_shape, out_strides, context);
+    }
+
+    TYPE_IMPL_SELECT(type, BATCH_TO_SPACE_IMPL);
+}
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "../reference/ref_ops.h"
+#include "opt_fp16.h"
 #include "opt_ops.h"
 #include <iostream>
 #include <nncase/kernels/kernel_utils.h>
@@ -26,6 +27,60 @@ using namespace nncase::kernels;
 using namespace nncase::kernels::stackvm;
 using namespace nncase::kernels::stackvm::optimized;
 
+namespace {
+template <class TOp>
+void binary_fp16_impl(TOp &&op, const half *lhs, const half *rhs, half *output,
+                      size_t count, bool lhs_scalar, bool rhs_scalar) noexcept {
+    float lhs_tile[fp16_tile_size];
+    float rhs_tile[fp16_tile_size];
+    float out_tile[fp16_tile_size];
+    if (lhs_scalar)
+        std::fill_n(lhs_tile, fp16_tile_size, (float)lhs[0]);
+    if (rhs_scalar)
+        std::fill_n(rhs_tile, fp16_tile_size, (float)rhs[0]);
+
+    for (size_t i = 0; i < count; i += fp16_tile_size) {
+        auto n = std::min(fp16_tile_size, count - i);
+        if (!lhs_scalar)
+            fp16_to_fp32(lhs + i, lhs_tile, n);
+        if (!rhs_scalar)
+            fp16_to_fp32(rhs + i, rhs_tile, n);
+        for (size_t j = 0; j < n; j++)
+            out_tile[j] = op(lhs_tile[j], rhs_tile[j]);
+        fp32_to_fp16(out_tile, output + i, n);
+    }
+}
+
+#define BINARY_FP16_IMPL_OP(op, funct)                                         \
+    case binary_op_t::op:                                                      \
+        binary_fp16_impl(funct, lhs, rhs, output, count, lhs_scalar,           \
+                         rhs_scalar);                                          \
+        return true
+
+/* Same shape or scalar operands, the other broadcasts are widened whole and
+ * computed by the fp32 kernel. */
+bool binary_fp16_impl(binary_op_t op, const half *lhs, const half *rhs,
+                      half *output, size_t count, bool lhs_scalar,
+                      bool rhs_scalar) noexcept {
+    switch (op) {
+        BINARY_FP16_IMPL_OP(add, std::plus<float>());
+        BINARY_FP16_IMPL_OP(sub, std::minus<float>());
+        BINARY_FP16_IMPL_OP(mul, std::multiplies<float>());
+        BINARY_FP16_IMPL_OP(div, std::divides<float>());
+        BINARY_FP16_IMPL_OP(min,
+                            [](float a, float b) { return std::min(a, b); });
+        BINARY_FP16_IMPL_OP(max,
+                            [](float a, float b) { return std::max(a, b); });
+        BINARY_FP16_IMPL_OP(pow,
+                            [](float a, float b) { return std::pow(a, b); });
+        BINARY_FP16_IMPL_OP(mod,
+                            [](float a, float b) { return std::fmod(a, b); });
+    default:
+        return false;
+    }
+}
+} // namespace
+
 result<void> optimized::binary(
     typecode_t typecode, runtime::stackvm::binary_op_t op, const gsl::byte *lhs,
     const gsl::byte *rhs, gsl::byte *out, gsl::span<const size_t> in_a_shape,
@@ -33,6 +88,33 @@ result<void> optimized::binary(
     gsl::span<const size_t> rhs_strides, gsl::span<const size_t> out_shape,
     gsl::span<const size_t> out_strides,
     NNCASE_UNUSED kernel_context &context) noexcept {
+    if (typecode == dt_float16 && is_contiguous(in_a_shape, lhs_strides) &&
+        is_contiguous(in_b_shape, rhs_strides) &&
+        is_contiguous(out_shape, out_strides)) {
+        auto count = compute_size(out_shape);
+        auto lhs_size = compute_size(in_a_shape);
+        auto rhs_size = compute_size(in_b_shape);
+        auto lhs_scalar = lhs_size == 1;
+        auto rhs_scalar = rhs_size == 1;
+        if ((lhs_scalar || lhs_size == count) &&
+            (rhs_scalar || rhs_size == count)) {
+            if (binary_fp16_impl(op, IN_CAST(half, lhs), IN_CAST(half, rhs),
+                                 OUT_CAST(half, out), count, lhs_scalar,
+                                 rhs_scalar))
+                return ok();
+        } else {
+            auto lhs_fp32 = fp16_to_fp32(IN_CAST(half, lhs), lhs_size);
+            auto rhs_fp32 = fp16_to_fp32(IN_CAST(half, rhs), rhs_size);
+            std::vector<float> out_fp32(count);
+            try_(optimized::binary(
+                dt_float32, op, IN_BYTE_CAST(lhs_fp32.data()),
+                IN_BYTE_CAST(rhs_fp32.data()), OUT_BYTE_CAST(out_fp32.data()),
+                in_a_shape, lhs_strides, in_b_shape, rhs_strides, out_shape,
+                out_strides, context));
+            fp32_to_fp16(out_fp32.data(), OUT_CAST(half, out), count);
+            return ok();
+        }
+    }
     return stackvm::reference::binary(typecode, op, lhs, rhs, out, in_a_shape,
                                       lhs_strides, in_b_shape, rhs_strides,
                                       out_shape, out_strides, context);
@@ -0,0 +1,210 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_fp16.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <memory>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Floats of the column block of one output channel: the filter taps of the
+// input rows it covers, sized to stay in L2
+constexpr size_t col_block_size = 16384;
+
+struct conv2d_transpose_params {
+    size_t in_h, in_w, out_h, out_w, g_ic, g_oc;
+    int32_t filter_h, filter_w, stride_h, stride_w, dilation_h, dilation_w;
+    int32_t pad_top, pad_left;
+};
+
+/** @brief cols[k][p] = sum(ic) w[ic][k] * input[ic][p] for the taps k of one
+ * output channel and the n pixels p starting at input */
+void gemm_taps(const float *w, const float *input, float *cols, size_t g_ic,
+               size_t taps, size_t in_hw, size_t n) noexcept {
+    std::fill_n(cols, taps * n, 0.f);
+    size_t ic = 0;
+    for (; ic + 4 <= g_ic; ic += 4) {
+        auto x0 = input + ic * in_hw;
+        auto x1 = x0 + in_hw;
+        auto x2 = x1 + in_hw;
+        auto x3 = x2 + in_hw;
+        for (size_t k = 0; k < taps; k++) {
+            auto w0 = w[ic * taps + k];
+            auto w1 = w[(ic + 1) * taps + k];
+            auto w2 = w[(ic + 2) * taps + k];
+            auto w3 = w[(ic + 3) * taps + k];
+            auto col = cols + k * n;
+            for (size_t p = 0; p < n; p++)
+                col[p] += w0 * x0[p] + w1 * x1[p] + w2 * x2[p] + w3 * x3[p];
+        }
+    }
+
+    for (; ic < g_ic; ic++) {
+        auto x = input + ic * in_hw;
+        for (size_t k = 0; k < taps; k++) {
+            auto w0 = w[ic * taps + k];
+            auto col = cols + k * n;
+            for (size_t p = 0; p < n; p++)
+                col[p] += w0 * x[p];
+        }
+    }
+}
+
+/** @brief Accumulates the columns of input rows [iy_begin, iy_end) into the
+ * output plane of their channel */
+void col2im(const float *cols, float *output, size_t iy_begin, size_t iy_end,
+            const conv2d_transpose_params &p) noexcept {
+    auto n = (iy_end - iy_begin) * p.in_w;
+    for (int32_t ky = 0; ky < p.filter_h; ky++) {
+        for (int32_t kx = 0; kx < p.filter_w; kx++) {
+            auto col = cols + (ky * p.filter_w + kx) * n;
+
+            // ox = ix * stride_w - x_shift lies in [0, out_w) for
+            // ix in [ix_begin, ix_end)
+            int64_t x_shift = p.pad_left - (int64_t)kx * p.dilation_w;
+            int64_t ix_begin =
+                x_shift > 0 ? (x_shift + p.stride_w - 1) / p.stride_w : 0;
+            int64_t x_limit = (int64_t)p.out_w + x_shift;
+            int64_t ix_end =
+                x_limit > 0
+                    ? std::min((int64_t)p.in_w,
+                               (x_limit + p.stride_w - 1) / p.stride_w)
+                    : 0;
+            if (ix_begin >= ix_end)
+                continue;
+
+            for (auto iy = iy_begin; iy < iy_end; iy++) {
+                int64_t oy = (int64_t)iy * p.stride_h - p.pad_top +
+                             (int64_t)ky * p.dilation_h;
+                if (oy < 0 || oy >= (int64_t)p.out_h)
+                    continue;
+                auto in_row = col + (iy - iy_begin) * p.in_w + ix_begin;
+                auto out_row = output + oy * p.out_w +
+                               (ix_begin * p.stride_w - x_shift);
+                auto count = ix_end - ix_begin;
+                if (p.stride_w == 1) {
+                    for (int64_t i = 0; i < count; i++)
+                        out_row[i] += in_row[i];
+                } else {
+                    for (int64_t i = 0; i < count; i++)
+                        out_row[i * p.stride_w] += in_row[i];
+                }
+            }
+        }
+    }
+}
+
+/* Transposed convolution as a GEMM of the transposed weights with the input
+ * followed by col2im. Every output channel owns its plane, so the channels
+ * run in parallel without atomics, each on blocks of input rows. */
+result<void> conv2d_transpose_f32(
+    const float *input, float *output, const float *weights, const float *bias,
+    gsl::span<const size_t> in_shape, int32_t groups,
+    gsl::span<const size_t> out_shape, const conv2d_transpose_params &p,
+    value_range<float> fused_activation,
+    NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto batches = in_shape[0];
+    const auto out_channels = out_shape[1];
+    const size_t taps = (size_t)p.filter_h * p.filter_w;
+    const auto in_hw = p.in_h * p.in_w;
+    const auto out_hw = p.out_h * p.out_w;
+    const auto block_rows = std::min(
+        p.in_h, std::max((size_t)1, col_block_size / (taps * p.in_w)));
+    const auto units = (int64_t)(batches * out_channels);
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t unit = 0; unit < units; unit++) {
+        const auto batch = (size_t)unit / out_channels;
+        const auto oc = (size_t)unit % out_channels;
+        const auto g = oc / p.g_oc;
+        auto in_group = input + (batch * groups + g) * p.g_ic * in_hw;
+        auto w_oc = weights + oc * p.g_ic * taps;
+        auto out_plane = output + unit * out_hw;
+        std::unique_ptr<float[]> cols(new float[taps * block_rows * p.in_w]);
+
+        std::fill_n(out_plane, out_hw, bias[oc]);
+        for (size_t iy = 0; iy < p.in_h; iy += block_rows) {
+            auto iy_end = std::min(p.in_h, iy + block_rows);
+            gemm_taps(w_oc, in_group + iy * p.in_w, cols.get(), p.g_ic, taps,
+                      in_hw, (iy_end - iy) * p.in_w);
+            col2im(cols.get(), out_plane, iy, iy_end, p);
+        }
+        for (size_t i = 0; i < out_hw; i++)
+            out_plane[i] = kernels::detail::apply_activation(out_plane[i],
+                                                             fused_activation);
+    }
+    return ok();
+}
+} // namespace
+
+result<void> optimized::conv2d_transpose(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *weights, const gsl::byte *bias,
+    gsl::span<const size_t> in_shape, int32_t groups,
+    gsl::span<const size_t> out_shape, int32_t filter_h, int32_t filter_w,
+    int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    const padding &padding_h, const padding &padding_w,
+    const value_range<float> &fused_activation,
+    kernel_context &context) noexcept {
+    if (typecode != dt_float32 && typecode != dt_float16) {
+        return reference::conv2d_transpose(
+            typecode, input, output, weights, bias, in_shape, groups,
+            out_shape, filter_h, filter_w, stride_h, stride_w, dilation_h,
+            dilation_w, padding_h, padding_w, fused_activation, context);
+    }
+
+    conv2d_transpose_params p{in_shape[2],          in_shape[3],
+                              out_shape[2],         out_shape[3],
+                              in_shape[1] / groups, out_shape[1] / groups,
+                              filter_h,             filter_w,
+                              stride_h,             stride_w,
+                              dilation_h,           dilation_w,
+                              padding_h.before,     padding_w.before};
+    if (typecode == dt_float32) {
+        return conv2d_transpose_f32(IN_CAST(float, input),
+                                    OUT_CAST(float, output),
+                                    IN_CAST(float, weights),
+                                    IN_CAST(float, bias), in_shape, groups,
+                                    out_shape, p, fused_activation, context);
+    }
+
+    // fp16 widens the operands, convolves in fp32 and rounds the output once
+    auto input_fp32 =
+        fp16_to_fp32(IN_CAST(half, input), compute_size(in_shape));
+    auto weights_fp32 = fp16_to_fp32(IN_CAST(half, weights),
+                                     out_shape[1] * p.g_ic * filter_h *
+                                         filter_w);
+    auto bias_fp32 = fp16_to_fp32(IN_CAST(half, bias), out_shape[1]);
+    std::vector<float> output_fp32(compute_size(out_shape));
+    try_(conv2d_transpose_f32(input_fp32.data(), output_fp32.data(),
+                              weights_fp32.data(), bias_fp32.data(), in_shape,
+                              groups, out_shape, p, fused_activation,
+                              context));
+    fp32_to_fp16(output_fp32.data(), OUT_CAST(half, output),
+                 output_fp32.size());
+    return ok();
+}
@@ -14,9 +14,11 @@
  */
 #include "../reference/ref_ops.h"
 #include "nncase/runtime/util.h"
+#include "opt_fp16.h"
 #include "opt_ops.h"
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
+#include <memory>
 #include <utility>
 #ifdef NNCASE_HALIDE
 #include <hkg/export/HalideBuffer.h>
@@ -32,21 +34,25 @@
         bias_strides, out_strides, padding_h, padding_w, groups, stride_h,     \
         stride_w, dilation_h, dilation_w, fused_activation, context
 
+#define CONV2D_TILED(kernel, n, m, s)                                          \
+    return tile_rows == 4 ? kernel<4, n, m, s, s>(CONV_ARGS)                   \
+                          : kernel<8, n, m, s, s>(CONV_ARGS)
+
 #define CONV2D_NXM_S1_S2(n, m)                                                 \
     if (filter_h == n && filter_w == m) {                                      \
         if (stride_h == 1 && stride_w == 1) {                                  \
-            return conv2d_nxm<8, n, m, 1, 1>(CONV_ARGS);                       \
+            CONV2D_TILED(conv2d_nxm, n, m, 1);                                 \
         } else if (stride_h == 2 && stride_w == 2) {                           \
-            return conv2d_nxm<8, n, m, 2, 2>(CONV_ARGS);                       \
+            CONV2D_TILED(conv2d_nxm, n, m, 2);                                 \
         }                                                                      \
     }
 
 #define CONV2D_DEPTHWISE_NXM_S1_S2(n, m)                                       \
     if (filter_h == n && filter_w == m) {                                      \
         if (stride_h == 1 && stride_w == 1) {                                  \
-            return conv2d_depthwise_nxm<8, n, m, 1, 1>(CONV_ARGS);             \
+            CONV2D_TILED(conv2d_depthwise_nxm, n, m, 1);                       \
         } else if (stride_h == 2 && stride_w == 2) {                           \
-            return conv2d_depthwise_nxm<8, n, m, 2, 2>(CONV_ARGS);             \
+            CONV2D_TILED(conv2d_depthwise_nxm, n, m, 2);                       \
         }                                                                      \
     }
 
@@ -608,6 +614,100 @@ result<void> conv2d_depthwise_nxm(
 
 #endif
 
+namespace {
+// Widened input rows of a band, about 256KB of fp32.
+constexpr size_t fp16_band_size = 64 * 1024;
+
+/* Convolves bands of output rows: the input rows a band reads are widened,
+ * run through the fp32 kernels and the band is rounded once. The weights
+ * and bias are widened once for all bands. */
+result<void> conv2d_fp16(
+    const gsl::byte *input, const gsl::byte *weights, const gsl::byte *bias,
+    gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> w_shape,
+    gsl::span<const size_t> w_strides, gsl::span<const size_t> bias_strides,
+    gsl::span<const size_t> out_strides, const padding &padding_h,
+    const padding &padding_w, int32_t groups, int32_t stride_h,
+    int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    value_range<float> fused_activation, kernels::kernel_context &context,
+    size_t tile_rows) noexcept {
+    auto out_h = kernels::detail::get_windowed_output_size(
+        in_shape[2], (int32_t)w_shape[2], stride_h, dilation_h, padding_h);
+    auto out_w = kernels::detail::get_windowed_output_size(
+        in_shape[3], (int32_t)w_shape[3], stride_w, dilation_w, padding_w);
+    dims_t out_shape{in_shape[0], w_shape[0], out_h, out_w};
+    dims_t bias_shape{w_shape[0]};
+    if (!is_contiguous(in_shape, in_strides) ||
+        !is_contiguous(w_shape, w_strides) ||
+        !is_contiguous(bias_shape, bias_strides) ||
+        !is_contiguous(out_shape, out_strides)) {
+        return nncase::kernels::stackvm::reference::conv2d(
+            dt_float16, input, weights, bias, output, in_shape, in_strides,
+            w_shape, w_strides, bias_strides, out_strides, padding_h,
+            padding_w, groups, stride_h, stride_w, dilation_h, dilation_w,
+            fused_activation, context);
+    }
+    if (!compute_size(out_shape))
+        return ok();
+
+    const auto in_c = in_shape[1], in_h = in_shape[2], in_w = in_shape[3];
+    const auto out_c = w_shape[0];
+    const auto w_size = compute_size(w_shape);
+    const auto span_h = (w_shape[2] - 1) * dilation_h + 1;
+    const auto band_rows = std::min(
+        out_h, std::max((size_t)1, fp16_band_size / (in_c * stride_h * in_w)));
+    const auto band_in_h = (band_rows - 1) * stride_h + span_h;
+    std::unique_ptr<float[]> buffer(
+        new (std::nothrow) float[w_size + out_c + in_c * band_in_h * in_w +
+                                 out_c * band_rows * out_w]);
+    if (!buffer)
+        return err(std::errc::not_enough_memory);
+    auto weights_fp32 = buffer.get();
+    auto bias_fp32 = weights_fp32 + w_size;
+    auto in_band = bias_fp32 + out_c;
+    auto out_band = in_band + in_c * band_in_h * in_w;
+    fp16_to_fp32(IN_CAST(half, weights), weights_fp32, w_size);
+    fp16_to_fp32(IN_CAST(half, bias), bias_fp32, out_c);
+
+    auto in = IN_CAST(half, input);
+    auto out = OUT_CAST(half, output);
+    for (size_t n = 0; n < in_shape[0]; n++) {
+        for (size_t row = 0; row < out_h; row += band_rows) {
+            auto rows = std::min(band_rows, out_h - row);
+            // The rows of the band outside the input are its padding
+            auto first = (int64_t)(row * stride_h) - padding_h.before;
+            auto last = first + (int64_t)((rows - 1) * stride_h + span_h);
+            auto begin = std::clamp(first, (int64_t)0, (int64_t)in_h);
+            auto end = std::clamp(last, begin, (int64_t)in_h);
+            padding band_padding{(int32_t)(begin - first),
+                                 (int32_t)(last - end)};
+            auto band_h = (size_t)(end - begin);
+            for (size_t c = 0; c < in_c; c++) {
+                fp16_to_fp32(in + ((n * in_c + c) * in_h + begin) * in_w,
+                             in_band + c * band_h * in_w, band_h * in_w);
+            }
+
+            dims_t band_shape{1, in_c, band_h, in_w};
+            dims_t out_band_shape{1, out_c, rows, out_w};
+            try_(optimized::conv2d(
+                dt_float32, IN_BYTE_CAST(in_band), IN_BYTE_CAST(weights_fp32),
+                IN_BYTE_CAST(bias_fp32), OUT_BYTE_CAST(out_band), band_shape,
+                get_default_strides(band_shape), w_shape, w_strides,
+                bias_strides, get_default_strides(out_band_shape),
+                band_padding, padding_w, groups, stride_h, stride_w,
+                dilation_h, dilation_w, fused_activation, context,
+                tile_rows));
+            for (size_t c = 0; c < out_c; c++) {
+                fp32_to_fp16(out_band + c * rows * out_w,
+                             out + ((n * out_c + c) * out_h + row) * out_w,
+                             rows * out_w);
+            }
+        }
+    }
+    return ok();
+}
+} // namespace
+
 result<void> optimized::conv2d(
     [[maybe_unused]] typecode_t typecode, const gsl::byte *input1,
     const gsl::byte *weights1, const gsl::byte *bias1, gsl::byte *output1,
@@ -619,7 +719,15 @@ result<void> optimized::conv2d(
     const padding &padding_w, int32_t groups, int32_t stride_h,
     int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
     value_range<float> fused_activation,
-    NNCASE_UNUSED kernels::kernel_context &context) noexcept {
+    NNCASE_UNUSED kernels::kernel_context &context,
+    [[maybe_unused]] size_t tile_rows) noexcept {
+    if (typecode == dt_float16) {
+        return conv2d_fp16(input1, weights1, bias1, output1, in_shape,
+                           in_strides, w_shape, w_strides, bias_strides,
+                           out_strides, padding_h, padding_w, groups,
+                           stride_h, stride_w, dilation_h, dilation_w,
+                           fused_activation, context, tile_rows);
+    }
     [[maybe_unused]] auto input = IN_CAST(float, input1);
     [[maybe_unused]] auto weights = IN_CAST(float, weights1);
     [[maybe_unused]] auto bias = IN_CAST(float, bias1);
@@ -648,8 +756,11 @@ result<void> optimized::conv2d(
     }
 
 #else
-    if (groups == 1 && padding_h.before == 0 && padding_h.after == 0 &&
-        padding_w.before == 0 && padding_w.after == 0) {
+    // The direct kernels below support neither padding nor dilation
+    auto direct = padding_h.before == 0 && padding_h.after == 0 &&
+                  padding_w.before == 0 && padding_w.after == 0 &&
+                  dilation_h == 1 && dilation_w == 1;
+    if (groups == 1 && direct) {
         if (filter_h == 1 && filter_w == 1) {
             if (stride_h == 1 && stride_w == 1) {
                 return conv2d_1x1_s1(CONV_ARGS);
@@ -667,8 +778,7 @@ result<void> optimized::conv2d(
     }
 
     if ((size_t)groups == in_shape[1] && (size_t)groups == w_shape[0] &&
-        padding_h.before == 0 && padding_h.after == 0 &&
-        padding_w.before == 0 && padding_w.after == 0) {
+        direct) {
         // clang-format off
         CONV2D_DEPTHWISE_NXM_S1_S2(1, 3)
         else CONV2D_DEPTHWISE_NXM_S1_S2(3, 1) 
@@ -0,0 +1,175 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_ops.h"
+#include <algorithm>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Columns of one [depth, post] slice scanned together, a unit of work
+constexpr size_t column_block = 1024;
+
+template <class T>
+void scan_line_scalar(const T *input, T *output, size_t n, bool exclusive,
+                      bool reverse) noexcept {
+    T acc = 0;
+    for (size_t s = 0; s < n; s++) {
+        auto i = reverse ? n - 1 - s : s;
+        if (exclusive) {
+            output[i] = acc;
+            acc += input[i];
+        } else {
+            acc += input[i];
+            output[i] = acc;
+        }
+    }
+}
+
+/** @brief Prefix sum of one contiguous line of n elements */
+template <class T>
+void scan_line(const T *input, T *output, size_t n, bool exclusive,
+               bool reverse) noexcept {
+    scan_line_scalar(input, output, n, exclusive, reverse);
+}
+
+#if __AVX__
+/** @brief Inclusive prefix sum of the 4 lanes of x */
+__m128 scan4(__m128 x) noexcept {
+    x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+    return _mm_add_ps(x,
+                      _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+}
+
+/** @brief Inclusive prefix sum of the 8 lanes of x, AVX has no 256 bit byte
+ * shifts so the halves are scanned apart and the low total is carried */
+__m256 scan8(__m256 x) noexcept {
+    auto low = scan4(_mm256_castps256_ps128(x));
+    auto high = _mm_add_ps(scan4(_mm256_extractf128_ps(x, 1)),
+                           _mm_shuffle_ps(low, low, _MM_SHUFFLE(3, 3, 3, 3)));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+template <>
+void scan_line(const float *input, float *output, size_t n, bool exclusive,
+               bool reverse) noexcept {
+    if (exclusive || reverse)
+        return scan_line_scalar(input, output, n, exclusive, reverse);
+
+    auto carry = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto sum = _mm256_add_ps(scan8(_mm256_loadu_ps(input + i)), carry);
+        _mm256_storeu_ps(output + i, sum);
+        auto last = _mm256_permute_ps(sum, _MM_SHUFFLE(3, 3, 3, 3));
+        carry = _mm256_permute2f128_ps(last, last, 0x11);
+    }
+
+    auto acc = _mm256_cvtss_f32(carry);
+    for (; i < n; i++) {
+        acc += input[i];
+        output[i] = acc;
+    }
+}
+#endif
+
+/** @brief Scans columns [begin, end) of a [depth, post] slice, each step
+ * adds one input row to the last output row */
+template <class T>
+void scan_columns(const T *input, T *output, size_t depth, size_t post,
+                  size_t begin, size_t end, bool exclusive,
+                  bool reverse) noexcept {
+    auto n = end - begin;
+    for (size_t s = 0; s < depth; s++) {
+        auto d = reverse ? depth - 1 - s : s;
+        auto out = output + d * post + begin;
+        if (s == 0) {
+            if (exclusive)
+                std::fill_n(out, n, T(0));
+            else
+                std::copy_n(input + d * post + begin, n, out);
+            continue;
+        }
+
+        auto prev = reverse ? d + 1 : d - 1;
+        auto prev_out = output + prev * post + begin;
+        auto in = input + (exclusive ? prev : d) * post + begin;
+        for (size_t i = 0; i < n; i++)
+            out[i] = prev_out[i] + in[i];
+    }
+}
+
+template <class T>
+result<void> cumsum_impl(const T *input, T *output,
+                         gsl::span<const size_t> in_shape, int32_t axis,
+                         bool exclusive, bool reverse,
+                         NNCASE_UNUSED kernel_context &context) noexcept {
+    size_t pre = 1, post = 1;
+    for (int32_t i = 0; i < (int32_t)in_shape.size(); i++) {
+        if (i < axis)
+            pre *= in_shape[i];
+        else if (i > axis)
+            post *= in_shape[i];
+    }
+    auto depth = in_shape[axis];
+    auto slice = depth * post;
+
+    // Scanning along the innermost axis works on whole lines, otherwise
+    // the slices are cut into column blocks scanned row by row
+    if (post == 1) {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t o = 0; o < (int64_t)pre; o++)
+            scan_line(input + o * depth, output + o * depth, depth, exclusive,
+                      reverse);
+    } else {
+        auto blocks = (post + column_block - 1) / column_block;
+        auto units = (int64_t)(pre * blocks);
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t unit = 0; unit < units; unit++) {
+            auto o = (size_t)unit / blocks;
+            auto begin = ((size_t)unit % blocks) * column_block;
+            scan_columns(input + o * slice, output + o * slice, depth, post,
+                         begin, std::min(post, begin + column_block),
+                         exclusive, reverse);
+        }
+    }
+    return ok();
+}
+} // namespace
+
+#define CUMSUM_IMPL(_ty)                                                       \
+    return cumsum_impl(IN_CAST(_ty, input), OUT_CAST(_ty, output), in_shape,   \
+                       axis, exclusive, reverse, context);
+
+result<void> optimized::cumsum(typecode_t typecode, const gsl::byte *input,
+                               gsl::byte *output,
+                               gsl::span<const size_t> in_shape, int32_t axis,
+                               bool exclusive, bool reverse,
+                               kernel_context &context) noexcept {
+    TYPE_SELECT(typecode, CUMSUM_IMPL)
+}
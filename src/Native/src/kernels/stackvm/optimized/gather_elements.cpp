@@ -0,0 +1,125 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+template <class T>
+void gather_row(const T *input, T *output, const size_t *offsets,
+                size_t count) noexcept {
+    for (size_t i = 0; i < count; i++)
+        output[i] = input[offsets[i]];
+}
+
+#if __AVX2__
+template <>
+void gather_row(const uint32_t *input, uint32_t *output,
+                const size_t *offsets, size_t count) noexcept {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto index = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(offsets + i));
+        auto values = _mm256_i64gather_epi32(
+            reinterpret_cast<const int *>(input), index, 4);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), values);
+    }
+    for (; i < count; i++)
+        output[i] = input[offsets[i]];
+}
+#endif
+
+/* Only handles outputs which match the input shape except on the axis, so
+ * every output row along the inner dims reads the same inner slice. */
+template <class T, class IndicesT>
+result<void> gather_elements_impl(
+    const T *input, T *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> out_shape, const IndicesT *indices, size_t axis,
+    NNCASE_UNUSED kernel_context &context) noexcept {
+    auto outer_size =
+        std::accumulate(out_shape.begin(), out_shape.begin() + axis,
+                        (size_t)1, std::multiplies<size_t>{});
+    auto inner_size =
+        std::accumulate(out_shape.begin() + axis + 1, out_shape.end(),
+                        (size_t)1, std::multiplies<size_t>{});
+    auto in_axis_dim = in_shape[axis];
+    auto out_axis_dim = out_shape[axis];
+    auto rows = (int64_t)(outer_size * out_axis_dim);
+
+    // 1. Validate the indices and turn them into input offsets once
+    std::vector<size_t> offsets((size_t)rows * inner_size);
+    for (int64_t row = 0; row < rows; row++) {
+        auto in_base = (row / out_axis_dim) * in_axis_dim * inner_size;
+        auto indices_row = indices + row * inner_size;
+        auto offsets_row = offsets.data() + row * inner_size;
+        for (size_t i = 0; i < inner_size; i++) {
+            size_t index;
+            if (!normalize_index(indices_row[i], in_axis_dim, index))
+                return err(std::errc::result_out_of_range);
+            offsets_row[i] = in_base + index * inner_size + i;
+        }
+    }
+
+    // 2. Gather the elements
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t row = 0; row < rows; row++) {
+        gather_row(input, output + row * inner_size,
+                   offsets.data() + row * inner_size, inner_size);
+    }
+    return ok();
+}
+} // namespace
+
+#define GATHER_ELEMENTS_IMPL(size, type)                                       \
+    case size:                                                                 \
+        return integer_cast(indices_type, indices, [&](auto &&indices_value) { \
+            return gather_elements_impl(reinterpret_cast<const type *>(input), \
+                                        reinterpret_cast<type *>(output),      \
+                                        in_shape, out_shape, indices_value,    \
+                                        axis, context);                        \
+        });
+
+result<void> optimized::gather_elements(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    datatype_t indices_type, const gsl::byte *indices,
+    gsl::span<const size_t> indices_shape, size_t axis,
+    kernel_context &context) noexcept {
+    for (size_t i = 0; i < in_shape.size(); i++) {
+        if (i != axis && in_shape[i] != out_shape[i]) {
+            return reference::gather_elements(
+                type, input, output, in_shape, out_shape, in_strides,
+                out_strides, indices_type, indices, indices_shape, axis,
+                context);
+        }
+    }
+
+    TYPE_IMPL_SELECT(type, GATHER_ELEMENTS_IMPL);
+}
@@ -12,8 +12,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "opt_common.h"
 #include "opt_ops.h"
-#include <cstring>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
 #include <nncase/runtime/util.h>
@@ -34,49 +34,51 @@ gather_nd_impl(const T *input, T *output, gsl::span<const size_t> in_shape,
                const IndicesT *indices, gsl::span<const size_t> indices_shape,
                size_t batch_dims,
                NNCASE_UNUSED kernel_context &context) noexcept {
-    auto last_indices_index = indices_shape.size() - 1;
-    auto indices_list_size = indices_shape[last_indices_index];
+    auto indices_list_size = indices_shape.back();
     size_t indices_block_count =
         std::accumulate(indices_shape.begin() + batch_dims,
                         indices_shape.end() - 1, 1, std::multiplies<size_t>{});
-
     size_t block_size = std::accumulate(
-        in_shape.begin() + indices_shape[last_indices_index] + batch_dims,
-        in_shape.end(), 1, std::multiplies<size_t>{});
-
+        in_shape.begin() + indices_list_size + batch_dims, in_shape.end(), 1,
+        std::multiplies<size_t>{});
     size_t batch_size =
         std::accumulate(in_shape.begin(), in_shape.begin() + batch_dims, 1,
                         std::multiplies<size_t>{});
-
     size_t input_batch_block_size =
         std::accumulate(in_shape.begin() + batch_dims, in_shape.end(), 1,
                         std::multiplies<size_t>{});
-    size_t output_batch_block_size =
-        std::accumulate(out_shape.begin() + batch_dims, out_shape.end(), 1,
-                        std::multiplies<size_t>{});
-    size_t indices_batch_block_size =
-        std::accumulate(indices_shape.begin() + batch_dims, indices_shape.end(),
-                        1, std::multiplies<size_t>{});
+
+    // 1. Validate the indices and turn them into input offsets once
+    std::vector<size_t> offsets(batch_size * indices_block_count);
     for (size_t i = 0; i < batch_size; ++i) {
+        for (size_t j = 0; j < indices_block_count; ++j) {
+            auto n = i * indices_block_count + j;
+            const auto *indices_ptr = indices + n * indices_list_size;
+            auto offset = i * input_batch_block_size;
+            for (size_t k = 0; k < indices_list_size; ++k) {
+                size_t index;
+                if (!normalize_index(indices_ptr[k], in_shape[k + batch_dims],
+                                     index))
+                    return err(std::errc::result_out_of_range);
+                offset += index * in_strides[k + batch_dims];
+            }
+            offsets[n] = offset;
+        }
+    }
+
+    // 2. Copy the selected slices
+    auto count = (int64_t)offsets.size();
+    if (block_size == 1) {
+        for (int64_t n = 0; n < count; ++n)
+            output[n] = input[offsets[n]];
+    } else {
 #ifdef NNCASE_OPENMP
 #pragma omp parallel for num_threads(context.num_threads)
 #endif
-        for (int j = 0; j < indices_block_count; ++j) {
-            const auto *indices_ptr = indices + j * indices_list_size;
-            auto *out_ptr = output + j * block_size;
-            auto *batch_begin_input = input;
-            // set batch_dims value used for select input
-
-            // get offset
-            for (size_t k = 0; k < indices_list_size; ++k) {
-                batch_begin_input +=
-                    indices_ptr[k] * in_strides[k + batch_dims];
-            }
-            memcpy(out_ptr, batch_begin_input, block_size * sizeof(T));
+        for (int64_t n = 0; n < count; ++n) {
+            opt_memcpy(output + n * block_size, input + offsets[n],
+                       block_size * sizeof(T));
         }
-        input += input_batch_block_size;
-        output += output_batch_block_size;
-        indices += indices_batch_block_size;
     }
     return ok();
 }
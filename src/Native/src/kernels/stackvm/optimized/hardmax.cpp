@@ -0,0 +1,115 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_ops.h"
+#include <algorithm>
+#include <limits>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Columns of the inner dims scanned together by one thread
+constexpr size_t column_block = 256;
+
+/* The input is viewed as [outer, axis, inner]. Each column of the axis keeps
+ * its running max while the rows stream by, then the column is written as
+ * zeros with a single one at its first max, so the input is read once and the
+ * output written once. */
+template <class T>
+void hardmax_impl(const T *input, T *output, gsl::span<const size_t> in_shape,
+                  size_t axis, NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto outer = compute_size(in_shape.first(axis));
+    const auto dim = in_shape[axis];
+    const auto inner = compute_size(in_shape.subspan(axis + 1));
+    if (inner == 1) {
+        const auto rows = (int64_t)outer;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t row = 0; row < rows; row++) {
+            auto in = input + (size_t)row * dim;
+            auto out = output + (size_t)row * dim;
+            auto best = std::numeric_limits<T>::lowest();
+            auto best_index = dim;
+            for (size_t k = 0; k < dim; k++) {
+                if (in[k] > best) {
+                    best = in[k];
+                    best_index = k;
+                }
+            }
+            std::fill_n(out, dim, T(0));
+            if (best_index != dim)
+                out[best_index] = T(1);
+        }
+        return;
+    }
+
+    const auto column_blocks = (inner + column_block - 1) / column_block;
+    const auto units = (int64_t)(outer * column_blocks);
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t unit = 0; unit < units; unit++) {
+        const auto o = (size_t)unit / column_blocks;
+        const auto begin = (size_t)unit % column_blocks * column_block;
+        const auto count = std::min(column_block, inner - begin);
+        auto in = input + o * dim * inner + begin;
+        auto out = output + o * dim * inner + begin;
+
+        T best[column_block];
+        size_t best_index[column_block];
+        std::fill_n(best, count, std::numeric_limits<T>::lowest());
+        std::fill_n(best_index, count, dim);
+        for (size_t k = 0; k < dim; k++) {
+            auto row = in + k * inner;
+            for (size_t j = 0; j < count; j++) {
+                if (row[j] > best[j]) {
+                    best[j] = row[j];
+                    best_index[j] = k;
+                }
+            }
+            std::fill_n(out + k * inner, count, T(0));
+        }
+        for (size_t j = 0; j < count; j++) {
+            if (best_index[j] != dim)
+                out[best_index[j] * inner + j] = T(1);
+        }
+    }
+}
+
+#define HARDMAX_IMPL(_ty)                                                      \
+    hardmax_impl(IN_CAST(_ty, input), OUT_CAST(_ty, output), in_shape,         \
+                 (size_t)axis, context);                                       \
+    return ok();
+} // namespace
+
+result<void>
+optimized::hardmax(typecode_t typecode, const gsl::byte *input,
+                   gsl::span<const size_t> in_shape,
+                   NNCASE_UNUSED gsl::span<const size_t> in_strides,
+                   gsl::byte *output, int32_t axis,
+                   kernel_context &context) noexcept {
+    if (axis < 0 || (size_t)axis >= in_shape.size())
+        return err(std::errc::invalid_argument);
+    if (compute_size(in_shape) == 0)
+        return ok();
+    TYPE_SELECT(typecode, HARDMAX_IMPL);
+}
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "../reference/ref_ops.h"
+#include "opt_fp16.h"
 #include "opt_ops.h"
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
@@ -28,6 +29,29 @@ result<void> nncase::kernels::stackvm::optimized::layer_norm(
     typecode_t typecode, const gsl::byte *input, gsl::byte *output,
     const gsl::byte *scale, const gsl::byte *bias,
     gsl::span<const size_t> in_shape, int32_t axis, float epsilon) {
+    if (typecode == dt_float16) {
+        // Normalize one row at a time in fp32, scale and bias are widened once.
+        auto positive_axis = axis < 0 ? in_shape.size() + axis : (size_t)axis;
+        size_t norm_size = 1;
+        for (auto i = positive_axis; i < in_shape.size(); i++)
+            norm_size *= in_shape[i];
+        auto rows = norm_size ? compute_size(in_shape) / norm_size : 0;
+        auto scale_fp32 = fp16_to_fp32(IN_CAST(half, scale), norm_size);
+        auto bias_fp32 = fp16_to_fp32(IN_CAST(half, bias), norm_size);
+        std::vector<float> row(norm_size);
+        dims_t row_shape{1, norm_size};
+        auto in = IN_CAST(half, input);
+        auto out = OUT_CAST(half, output);
+        for (size_t i = 0; i < rows; i++) {
+            fp16_to_fp32(in + i * norm_size, row.data(), norm_size);
+            try_(optimized::layer_norm(
+                dt_float32, IN_BYTE_CAST(row.data()), OUT_BYTE_CAST(row.data()),
+                IN_BYTE_CAST(scale_fp32.data()), IN_BYTE_CAST(bias_fp32.data()),
+                row_shape, 1, epsilon));
+            fp32_to_fp16(row.data(), out + i * norm_size, norm_size);
+        }
+        return ok();
+    }
     return reference::layer_norm(typecode, input, output, scale, bias, in_shape,
                                  axis, epsilon);
 }
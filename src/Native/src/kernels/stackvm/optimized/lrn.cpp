@@ -0,0 +1,147 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_fp16.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+#if __AVX__
+#include "x86_64/avx_mathfun.h"
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Spatial positions normalized together by one thread
+constexpr size_t column_block = 256;
+
+/** @brief sum += sign * x * x */
+void accumulate_square(const float *x, float *sum, size_t count,
+                       float sign) noexcept {
+    size_t i = 0;
+#if __AVX__
+    auto vsign = _mm256_set1_ps(sign);
+    for (; i + 8 <= count; i += 8) {
+        auto v = _mm256_loadu_ps(x + i);
+        _mm256_storeu_ps(sum + i,
+                         _mm256_comp_fmadd_ps(_mm256_mul_ps(v, v), vsign,
+                                              _mm256_loadu_ps(sum + i)));
+    }
+#endif
+    for (; i < count; i++)
+        sum[i] += sign * x[i] * x[i];
+}
+
+/** @brief y = x * (bias + scale * sum) ^ -beta */
+void lrn_row(const float *x, const float *sum, float *y, size_t count,
+             float scale, float bias, float beta) noexcept {
+    size_t i = 0;
+#if __AVX__
+    auto vscale = _mm256_set1_ps(scale);
+    auto vbias = _mm256_set1_ps(bias);
+    auto vbeta = _mm256_set1_ps(-beta);
+    for (; i + 8 <= count; i += 8) {
+        auto base = _mm256_comp_fmadd_ps(_mm256_loadu_ps(sum + i), vscale,
+                                         vbias);
+        auto factor = exp256_ps(_mm256_mul_ps(log256_ps(base), vbeta));
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), factor));
+    }
+#endif
+    for (; i < count; i++)
+        y[i] = x[i] * std::pow(sum[i] * scale + bias, -beta);
+}
+
+/* x and y are [channels, spatial] of one batch, normalized for the spatial
+ * columns [begin, begin + count). */
+void lrn_columns(const float *x, float *y, int64_t channels, size_t spatial,
+                 size_t begin, size_t count, int64_t before, int64_t after,
+                 float scale, float bias, float beta) noexcept {
+    x += begin;
+    y += begin;
+    float sum[column_block] = {};
+    for (int64_t c = 0; c < std::min(after, channels - 1) + 1; c++)
+        accumulate_square(x + c * spatial, sum, count, 1.f);
+    for (int64_t c = 0; c < channels; c++) {
+        lrn_row(x + c * spatial, sum, y + c * spatial, count, scale, bias,
+                beta);
+        if (c + after + 1 < channels)
+            accumulate_square(x + (c + after + 1) * spatial, sum, count, 1.f);
+        if (c - before >= 0)
+            accumulate_square(x + (c - before) * spatial, sum, count, -1.f);
+    }
+}
+} // namespace
+
+/* The input is viewed as [batch, channels, spatial]. The window of channel c
+ * covers [c - (size - 1) / 2, c + size / 2], so the squared sum of channel c
+ * + 1 is that of c plus the channel entering the window minus the one leaving
+ * it, and every channel costs one add and one subtract per position
+ * whatever the window size. */
+result<void> optimized::lrn(typecode_t typecode, const gsl::byte *input,
+                            float alpha, float beta, float bias, int size,
+                            gsl::byte *output, gsl::span<const size_t> in_shape,
+                            gsl::span<const size_t> in_strides,
+                            gsl::span<const size_t> out_strides,
+                            kernel_context &context) noexcept {
+    if ((typecode != dt_float32 && typecode != dt_float16) ||
+        in_shape.size() < 2 || size <= 0 ||
+        !is_contiguous(in_shape, out_strides)) {
+        return reference::lrn(typecode, input, alpha, beta, bias, size, output,
+                              in_shape, in_strides, out_strides, context);
+    }
+
+    const auto batch = in_shape[0];
+    const auto channels = (int64_t)in_shape[1];
+    const auto spatial = compute_size(in_shape.subspan(2));
+    const auto before = (int64_t)(size - 1) / 2;
+    const auto after = (int64_t)size - 1 - before;
+    const auto scale = alpha / size;
+    const auto column_blocks = (spatial + column_block - 1) / column_block;
+    // float16 batches are widened once and normalized in fp32 as a whole
+    const auto unit_blocks = typecode == dt_float32 ? column_blocks : 1;
+    const auto units = (int64_t)(batch * unit_blocks);
+    const auto slab = (size_t)channels * spatial;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t unit = 0; unit < units; unit++) {
+        const auto n = (size_t)unit / unit_blocks;
+        if (typecode == dt_float32) {
+            const auto begin = (size_t)unit % unit_blocks * column_block;
+            lrn_columns(IN_CAST(float, input) + n * slab,
+                        OUT_CAST(float, output) + n * slab, channels, spatial,
+                        begin, std::min(column_block, spatial - begin), before,
+                        after, scale, bias, beta);
+        } else {
+            auto x = fp16_to_fp32(IN_CAST(half, input) + n * slab, slab);
+            std::vector<float> y(slab);
+            for (size_t begin = 0; begin < spatial; begin += column_block) {
+                lrn_columns(x.data(), y.data(), channels, spatial, begin,
+                            std::min(column_block, spatial - begin), before,
+                            after, scale, bias, beta);
+            }
+            fp32_to_fp16(y.data(), OUT_CAST(half, output) + n * slab, slab);
+        }
+    }
+    return ok();
+}
@@ -0,0 +1,101 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_fp16.h"
+#include "opt_ops.h"
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/* One [m, k] x [k, n] unit. b is widened once per unit, every a row is widened
+ * before its pass over b and the output row is accumulated in fp32. */
+void matmul_fp16_unit(const half *a, const half *b, half *output, size_t m,
+                      size_t k, size_t n, std::vector<float> &b_fp32,
+                      std::vector<float> &a_row,
+                      std::vector<float> &out_row) noexcept {
+    fp16_to_fp32(b, b_fp32.data(), k * n);
+    for (size_t oy = 0; oy < m; oy++) {
+        fp16_to_fp32(a + oy * k, a_row.data(), k);
+        auto *CXX_RESTRICT acc = out_row.data();
+        std::fill_n(acc, n, 0.f);
+        for (size_t i = 0; i < k; i++) {
+            auto value = a_row[i];
+            const auto *CXX_RESTRICT b_row = b_fp32.data() + i * n;
+            for (size_t ox = 0; ox < n; ox++)
+                acc[ox] += value * b_row[ox];
+        }
+        fp32_to_fp16(acc, output + oy * n, n);
+    }
+}
+
+result<void> matmul_fp16_impl(const half *input_a, const half *input_b,
+                              half *output, gsl::span<const size_t> in_a_shape_,
+                              gsl::span<const size_t> in_b_shape_) {
+    dims_t in_a_shape(in_a_shape_.begin(), in_a_shape_.end());
+    dims_t in_b_shape(in_b_shape_.begin(), in_b_shape_.end());
+    if (in_a_shape.size() == 1)
+        in_a_shape.insert(in_a_shape.begin(), 1);
+    if (in_b_shape.size() == 1)
+        in_b_shape.insert(in_b_shape.end(), 1);
+    auto new_a_shape = to_4d(in_a_shape);
+    auto new_b_shape = to_4d(in_b_shape);
+    auto m = new_a_shape[2];
+    auto k = new_a_shape[3];
+    auto n = new_b_shape[3];
+    auto a_unit_size = m * k;
+    auto b_unit_size = k * n;
+    auto out_unit_size = m * n;
+
+    auto batches = std::max(new_a_shape[0], new_b_shape[0]);
+    auto channels = std::max(new_a_shape[1], new_b_shape[1]);
+    auto ab_size = a_unit_size * new_a_shape[1];
+    auto bb_size = b_unit_size * new_b_shape[1];
+    auto ob_size = out_unit_size * channels;
+    std::vector<float> b_fp32(b_unit_size), a_row(k), out_row(n);
+    for (size_t bn = 0; bn < batches; ++bn) {
+        auto an = new_a_shape[0] == 1 ? 0 : bn;
+        auto wn = new_b_shape[0] == 1 ? 0 : bn;
+        for (size_t c = 0; c < channels; ++c) {
+            auto ac = new_a_shape[1] == 1 ? 0 : c;
+            auto bc = new_b_shape[1] == 1 ? 0 : c;
+            matmul_fp16_unit(input_a + an * ab_size + ac * a_unit_size,
+                             input_b + wn * bb_size + bc * b_unit_size,
+                             output + bn * ob_size + c * out_unit_size, m, k,
+                             n, b_fp32, a_row, out_row);
+        }
+    }
+    return ok();
+}
+} // namespace
+
+result<void> optimized::matmul(typecode_t typecode, const gsl::byte *input_a,
+                               const gsl::byte *input_b, gsl::byte *output,
+                               gsl::span<const size_t> in_a_shape,
+                               gsl::span<const size_t> in_b_shape,
+                               kernel_context &context) noexcept {
+    if (typecode == dt_float16)
+        return matmul_fp16_impl(IN_CAST(half, input_a), IN_CAST(half, input_b),
+                                OUT_CAST(half, output), in_a_shape,
+                                in_b_shape);
+    return reference::matmul(typecode, input_a, input_b, output, in_a_shape,
+                             in_b_shape, context);
+}
@@ -0,0 +1,177 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_fp16.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+#if __AVX__
+#include "x86_64/avx_mathfun.h"
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Inner positions normalized together by one thread
+constexpr size_t column_block = 256;
+
+#if __AVX__
+__m256 abs256_ps(__m256 x) noexcept {
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+}
+
+float hsum256_ps(__m256 x) noexcept {
+    auto sum = _mm_add_ps(_mm256_castps256_ps128(x),
+                          _mm256_extractf128_ps(x, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum);
+}
+#endif
+
+/** @brief sum += |x| for p == 1 or x * x for p == 2, per element */
+void accumulate_norm(const float *x, float *sum, size_t count,
+                     bool l1) noexcept {
+    size_t i = 0;
+#if __AVX__
+    for (; i + 8 <= count; i += 8) {
+        auto v = _mm256_loadu_ps(x + i);
+        auto s = _mm256_loadu_ps(sum + i);
+        s = l1 ? _mm256_add_ps(s, abs256_ps(v))
+               : _mm256_comp_fmadd_ps(v, v, s);
+        _mm256_storeu_ps(sum + i, s);
+    }
+#endif
+    for (; i < count; i++)
+        sum[i] += l1 ? std::abs(x[i]) : x[i] * x[i];
+}
+
+/** @brief Sum of |x| for p == 1 or x * x for p == 2 over count elements */
+float reduce_norm(const float *x, size_t count, bool l1) noexcept {
+    size_t i = 0;
+    float sum = 0.f;
+#if __AVX__
+    auto vsum = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        auto v = _mm256_loadu_ps(x + i);
+        vsum = l1 ? _mm256_add_ps(vsum, abs256_ps(v))
+                  : _mm256_comp_fmadd_ps(v, v, vsum);
+    }
+    sum = hsum256_ps(vsum);
+#endif
+    for (; i < count; i++)
+        sum += l1 ? std::abs(x[i]) : x[i] * x[i];
+    return sum;
+}
+
+/** @brief y = x * scale, scale broadcast or one per element */
+void scale_row(const float *x, float *y, size_t count, const float *scales,
+               bool broadcast) noexcept {
+    size_t i = 0;
+#if __AVX__
+    auto vscale = _mm256_set1_ps(scales[0]);
+    for (; i + 8 <= count; i += 8) {
+        auto s = broadcast ? vscale : _mm256_loadu_ps(scales + i);
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), s));
+    }
+#endif
+    for (; i < count; i++)
+        y[i] = x[i] * scales[broadcast ? 0 : i];
+}
+
+/** @brief 1 / norm, or 0 when the norm is 0 */
+float inverse_norm(float sum, bool l1, float epsilon) noexcept {
+    sum = std::max(sum, epsilon);
+    auto norm = l1 ? sum : std::sqrt(sum);
+    return norm > 0.f ? 1.f / norm : 0.f;
+}
+
+/* x is [dim, inner] of one outer index, normalized along dim for the inner
+ * columns [begin, begin + count). */
+void normalize_columns(const float *x, float *y, size_t dim, size_t inner,
+                       size_t begin, size_t count, bool l1,
+                       float epsilon) noexcept {
+    if (inner == 1) {
+        auto scale = inverse_norm(reduce_norm(x, dim, l1), l1, epsilon);
+        scale_row(x, y, dim, &scale, true);
+        return;
+    }
+
+    float scales[column_block] = {};
+    for (size_t k = 0; k < dim; k++)
+        accumulate_norm(x + k * inner + begin, scales, count, l1);
+    for (size_t j = 0; j < count; j++)
+        scales[j] = inverse_norm(scales[j], l1, epsilon);
+    for (size_t k = 0; k < dim; k++) {
+        scale_row(x + k * inner + begin, y + k * inner + begin, count, scales,
+                  false);
+    }
+}
+} // namespace
+
+/* The input is viewed as [outer, dim, inner] where dim is the product of the
+ * normalized axes [axis_begin, axis_end). The sum of |x| or x * x is raised
+ * to at least epsilon before taking the norm, and a zero norm gives zeros. */
+result<void> optimized::lp_normalization(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, size_t axis_begin, size_t axis_end,
+    float p, float epsilon, NNCASE_UNUSED kernel_context &context) noexcept {
+    if (axis_begin >= axis_end || axis_end > in_shape.size())
+        return err(std::errc::invalid_argument);
+    if ((typecode != dt_float32 && typecode != dt_float16) ||
+        (p != 1.f && p != 2.f))
+        return err(std::errc::not_supported);
+
+    const auto l1 = p == 1.f;
+    const auto outer = compute_size(in_shape.first(axis_begin));
+    const auto dim =
+        compute_size(in_shape.subspan(axis_begin, axis_end - axis_begin));
+    const auto inner = compute_size(in_shape.subspan(axis_end));
+    const auto slab = dim * inner;
+    const auto column_blocks =
+        inner == 1 ? 1 : (inner + column_block - 1) / column_block;
+    // float16 slabs are widened once and normalized in fp32 as a whole
+    const auto unit_blocks = typecode == dt_float32 ? column_blocks : 1;
+    const auto units = (int64_t)(outer * unit_blocks);
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t unit = 0; unit < units; unit++) {
+        const auto o = (size_t)unit / unit_blocks;
+        if (typecode == dt_float32) {
+            const auto begin = (size_t)unit % unit_blocks * column_block;
+            normalize_columns(IN_CAST(float, input) + o * slab,
+                              OUT_CAST(float, output) + o * slab, dim, inner,
+                              begin, std::min(column_block, inner - begin), l1,
+                              epsilon);
+        } else {
+            auto x = fp16_to_fp32(IN_CAST(half, input) + o * slab, slab);
+            for (size_t begin = 0; begin < inner; begin += column_block) {
+                normalize_columns(x.data(), x.data(), dim, inner, begin,
+                                  std::min(column_block, inner - begin), l1,
+                                  epsilon);
+            }
+            fp32_to_fp16(x.data(), OUT_CAST(half, output) + o * slab, slab);
+        }
+    }
+    return ok();
+}
@@ -17,8 +17,7 @@
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
 #include <nncase/runtime/util.h>
-#include <sstream>
-#include <string>
+#include <numeric>
 
 using namespace nncase;
 using namespace nncase::runtime;
@@ -27,17 +26,9 @@ using namespace nncase::kernels::stackvm;
 using namespace nncase::kernels::stackvm::optimized;
 
 namespace {
-// if constexpr can be used in C++17
-// but k210 runtime only support C++14
-template <class T> void memset_(T *output, size_t output_size, T off_value) {
-    std::fill_n(output, output_size, off_value);
-}
-
-template <>
-void memset_(int32_t *output, size_t output_size, int32_t off_value) {
-    memset(output, off_value, output_size);
-}
-
+/* The output is [outer, depth, inner] with inner the indices dims from axis
+ * on. Every outer block is filled with off_value, a memset for zero, then
+ * gets one on_value per index scattered into it. */
 template <class T, class IndicesT>
 result<void> one_hot_impl(const IndicesT *indices, T *output,
                           gsl::span<const size_t> indices_shape,
@@ -46,78 +37,35 @@ result<void> one_hot_impl(const IndicesT *indices, T *output,
                           NNCASE_UNUSED size_t depth, T off_value, T on_value,
                           size_t axis, runtime::stackvm::one_hot_mode_t mode,
                           NNCASE_UNUSED kernel_context &context) {
-    auto output_size = compute_size(out_shape);
-    memset_(output, output_size, off_value);
-    auto indices_size = compute_size(indices_shape);
-
-    size_t out_size =
-        std::accumulate(indices_shape.begin(), indices_shape.begin() + axis, 1,
-                        std::multiplies<size_t>{});
-    size_t inner_size =
-        std::accumulate(indices_shape.begin() + axis, indices_shape.end(), 1,
-                        std::multiplies<size_t>{});
-    auto indices_dims = indices_shape.size();
-    auto onehot_dims = indices_dims - axis;
+    const auto outer =
+        std::accumulate(indices_shape.begin(), indices_shape.begin() + axis,
+                        (size_t)1, std::multiplies<size_t>{});
+    const auto inner =
+        std::accumulate(indices_shape.begin() + axis, indices_shape.end(),
+                        (size_t)1, std::multiplies<size_t>{});
+    const auto depth_size = (int64_t)out_shape[axis];
+    const auto block_size = depth_size * inner;
+    const auto process_neg =
+        mode == runtime::stackvm::one_hot_mode_t::process_neg;
 
-    auto neg_max_len = static_cast<int32_t>(out_shape[axis]);
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t o = 0; o < (int64_t)outer; o++) {
+        auto block = output + o * block_size;
+        if (off_value == T(0))
+            std::memset(block, 0, block_size * sizeof(T));
+        else
+            std::fill_n(block, block_size, off_value);
 
-    auto set_output = [&](auto indices_v, auto offset) {
-        if (indices_v < 0) {
-            if (mode == runtime::stackvm::one_hot_mode_t::process_neg) {
-                indices_v += neg_max_len;
-            } else {
-                return;
-            }
-        }
-        output[indices_v * inner_size + offset] = on_value;
-    };
-
-    if (onehot_dims == 0) {
-        // a depth is a line, set a value per line
-        // next line
-        for (size_t i = 0; i < indices_size; ++i, ++indices) {
-            set_output(*indices, 0);
-            output += depth;
-        }
-    } else if (onehot_dims == 1) {
-        const auto x_size = indices_shape[indices_shape.size() - 1];
-        // next indices_inner_size
-        for (size_t i = 0; i < out_size; ++i) {
-            for (size_t x = 0; x < x_size; ++x, ++indices) {
-                set_output(*indices, x);
-            }
-            output += inner_size * depth;
-        }
-    } else if (onehot_dims == 2) {
-        const auto y_size = indices_shape[indices_shape.size() - 2];
-        const auto x_size = indices_shape[indices_shape.size() - 1];
-        for (size_t i = 0; i < out_size; ++i) {
-            for (size_t y = 0; y < y_size; ++y) {
-                for (size_t x = 0; x < x_size; ++x, ++indices) {
-                    set_output(*indices, y * x_size + x);
-                }
-            }
-            output += inner_size * depth;
-        }
-    } else if (onehot_dims == 3) {
-        const auto c_size = indices_shape[indices_shape.size() - 3];
-        const auto y_size = indices_shape[indices_shape.size() - 2];
-        const auto x_size = indices_shape[indices_shape.size() - 1];
-        const auto y_block_size = out_strides[out_strides.size() - 2];
-        const auto c_block_size = out_strides[out_strides.size() - 3];
-        for (size_t i = 0; i < out_size; ++i) {
-            for (size_t c = 0; c < c_size; ++c) {
-                for (size_t y = 0; y < y_size; ++y) {
-                    for (size_t x = 0; x < x_size; ++x, ++indices) {
-                        set_output(*indices,
-                                   c * c_block_size + y * y_block_size + x);
-                    }
-                }
-            }
-            output += inner_size * depth;
+        auto block_indices = indices + o * inner;
+        for (size_t i = 0; i < inner; i++) {
+            auto index = (int64_t)block_indices[i];
+            if (index < 0 && process_neg)
+                index += depth_size;
+            if (index >= 0 && index < depth_size)
+                block[index * inner + i] = on_value;
         }
-    } else {
-        return err(std::errc::result_out_of_range);
     }
     return ok();
 }
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #pragma once
+#include <cstdint>
 #include <cstring>
 #if __riscv_vector
 #include "riscv64/utils.h"
@@ -91,4 +92,15 @@ inline void *opt_memcpy(void *dst, const void *src, size_t n) {
 #else
     return memcpy(dst, src, n);
 #endif
-}
\ No newline at end of file
+}
+/** @brief Wraps a negative index and checks it falls in [0, dim) */
+template <class TIndex>
+inline bool normalize_index(TIndex index, size_t dim, size_t &result) noexcept {
+    auto value = (int64_t)index;
+    if (value < 0)
+        value += (int64_t)dim;
+    if (value < 0 || value >= (int64_t)dim)
+        return false;
+    result = (size_t)value;
+    return true;
+}
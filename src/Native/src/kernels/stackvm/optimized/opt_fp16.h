@@ -0,0 +1,76 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <nncase/runtime/half.h>
+#include <vector>
+#if __F16C__
+#include <immintrin.h>
+#endif
+
+BEGIN_NS_NNCASE_KERNELS_MODULE(stackvm)
+namespace optimized {
+/* fp16 kernels keep half in memory only, they compute on fp32 tiles and round
+ * once when storing the results. */
+NNCASE_INLINE_VAR constexpr size_t fp16_tile_size = 512;
+
+inline void fp16_to_fp32(const half *src, float *dest, size_t count) noexcept {
+    size_t i = 0;
+#if __F16C__
+    for (; i + 8 <= count; i += 8) {
+        auto h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm256_storeu_ps(dest + i, _mm256_cvtph_ps(h));
+    }
+#endif
+    for (; i < count; i++)
+        dest[i] = (float)src[i];
+}
+
+inline void fp32_to_fp16(const float *src, half *dest, size_t count) noexcept {
+    size_t i = 0;
+#if __F16C__
+    for (; i + 8 <= count; i += 8) {
+        auto h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                 _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), h);
+    }
+#endif
+    for (; i < count; i++)
+        dest[i] = half::round_to_half(src[i]);
+}
+
+inline std::vector<float> fp16_to_fp32(const half *src, size_t count) {
+    std::vector<float> dest(count);
+    fp16_to_fp32(src, dest.data(), count);
+    return dest;
+}
+
+/** @brief Calls fn(in, out, count) on fp32 tiles of count contiguous halfs,
+ * in and out never alias */
+template <class TFunc>
+void fp16_map(const half *input, half *output, size_t count,
+              TFunc &&fn) noexcept {
+    float in_tile[fp16_tile_size];
+    float out_tile[fp16_tile_size];
+    for (size_t i = 0; i < count; i += fp16_tile_size) {
+        auto n = std::min(fp16_tile_size, count - i);
+        fp16_to_fp32(input + i, in_tile, n);
+        fn(in_tile, out_tile, n);
+        fp32_to_fp16(out_tile, output + i, n);
+    }
+}
+} // namespace optimized
+END_NS_NNCASE_KERNELS_MODULE
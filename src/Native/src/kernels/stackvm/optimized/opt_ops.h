@@ -27,6 +27,10 @@
 BEGIN_NS_NNCASE_KERNELS_MODULE(stackvm)
 namespace optimized {
 
+/** @brief Output rows computed together by the direct fp32 convolutions, the
+ * autotuner picks one per shape */
+NNCASE_INLINE_VAR constexpr size_t conv2d_tile_rows[] = {8, 4};
+
 NNCASE_API result<void>
 conv2d(typecode_t typecode, const gsl::byte *input, const gsl::byte *weights,
        const gsl::byte *bias, gsl::byte *output,
@@ -38,7 +42,112 @@ conv2d(typecode_t typecode, const gsl::byte *input, const gsl::byte *weights,
        const padding &padding_h, const padding &padding_w, int32_t groups,
        int32_t stride_h, int32_t stride_w, int32_t dilation_h,
        int32_t dilation_w, value_range<float> fused_activation,
-       NNCASE_UNUSED kernels::kernel_context &context) noexcept;
+       NNCASE_UNUSED kernels::kernel_context &context,
+       size_t tile_rows = conv2d_tile_rows[0]) noexcept;
+
+NNCASE_API result<void> conv2d_transpose(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *weights, const gsl::byte *bias,
+    gsl::span<const size_t> in_shape, int32_t groups,
+    gsl::span<const size_t> out_shape, int32_t filter_h, int32_t filter_w,
+    int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    const padding &padding_h, const padding &padding_w,
+    const value_range<float> &fused_activation,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+cumsum(typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+       gsl::span<const size_t> in_shape, int32_t axis, bool exclusive,
+       bool reverse,
+       kernel_context &context = default_kernel_context()) noexcept;
+
+/** @brief Elementwise activations with a vectorized float implementation */
+enum class activation_op_t {
+    celu,
+    elu,
+    erf,
+    gelu,
+    hard_sigmoid,
+    hard_swish,
+    leaky_relu,
+    relu,
+    selu,
+    sigmoid,
+    softplus,
+    softsign,
+    swish,
+};
+
+/** @brief Activation of count contiguous float32 or float16 elements.
+ * alpha and gamma point to scalars of the input type, nullptr for the ops
+ * without them. Other types are not_supported. */
+NNCASE_API result<void>
+activation(activation_op_t op, typecode_t type, const gsl::byte *input,
+           gsl::byte *output, size_t count, const gsl::byte *alpha,
+           const gsl::byte *gamma,
+           kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+batchnorm(typecode_t typecode, const gsl::byte *input, const gsl::byte *scale,
+          const gsl::byte *bias, const gsl::byte *input_mean,
+          const gsl::byte *input_var, gsl::byte *output,
+          gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+          gsl::span<const size_t> out_strides, float epsilon,
+          kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> clamp(
+    typecode_t type, const gsl::byte *input, const gsl::byte *min,
+    const gsl::byte *max, gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+prelu(typecode_t type, const gsl::byte *input, const gsl::byte *slope,
+      gsl::byte *output, gsl::span<const size_t> in_shape,
+      gsl::span<const size_t> input_strides,
+      gsl::span<const size_t> slope_shape,
+      gsl::span<const size_t> slope_strides, gsl::span<const size_t> out_shape,
+      gsl::span<const size_t> out_strides,
+      kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> batch_to_space(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &crops, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> space_to_batch(
+    datatype_t dt, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &paddings, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+tile(datatype_t dt, const gsl::byte *input, gsl::byte *output,
+     gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
+     gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+     gsl::span<const size_t> repeats,
+     kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+hardmax(typecode_t typecode, const gsl::byte *input,
+        gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+        gsl::byte *output, int32_t axis,
+        kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> lp_normalization(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, size_t axis_begin, size_t axis_end,
+    float p, float epsilon,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+lrn(typecode_t typecode, const gsl::byte *input, float alpha, float beta,
+    float bias, int size, gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
 
 NNCASE_API result<void>
 gather_nd(datatype_t type, const gsl::byte *input, gsl::byte *output,
@@ -56,6 +165,14 @@ reduce(typecode_t typecode, nncase::runtime::stackvm::reduce_op_t op,
        bool keep_dims,
        kernel_context &context = default_kernel_context()) noexcept;
 
+NNCASE_API result<void> reduce_arg(
+    typecode_t input_typecode, typecode_t output_typecode,
+    runtime::stackvm::reduce_arg_op_t op, const gsl::byte *input,
+    gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    gsl::span<const size_t> axes, bool keep_dims, bool select_last_idx,
+    kernel_context &context = default_kernel_context()) noexcept;
+
 NNCASE_API result<void>
 concat(datatype_t type, gsl::span<const gsl::byte *const> inputs,
        gsl::byte *output, gsl::span<const size_t> out_shape,
@@ -78,6 +195,21 @@ gather(datatype_t type, const gsl::byte *input, gsl::byte *output,
        gsl::span<const size_t> indices_shape, size_t axis,
        kernel_context &context) noexcept;
 
+NNCASE_API result<void> gather_elements(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    datatype_t indices_type, const gsl::byte *indices,
+    gsl::span<const size_t> indices_shape, size_t axis,
+    kernel_context &context) noexcept;
+
+NNCASE_API result<void>
+scatter_nd(datatype_t type, const gsl::byte *input, gsl::byte *output,
+           gsl::span<const size_t> in_shape, datatype_t indices_type,
+           const gsl::byte *indices, gsl::span<const size_t> indices_shape,
+           const gsl::byte *updates, gsl::span<const size_t> updates_shape,
+           kernel_context &context) noexcept;
+
 NNCASE_API result<void> layer_norm(typecode_t typecode, const gsl::byte *input,
                                    gsl::byte *output, const gsl::byte *scale,
                                    const gsl::byte *bias,
@@ -117,6 +249,13 @@ NNCASE_API result<void> resize_nearest_neighbor(
     get_nearest_pixel_func_t get_nearset_func,
     kernel_context &context) noexcept;
 
+NNCASE_API result<void> reverse_sequence(
+    datatype_t dt, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> sequence_lens,
+    int64_t batch_axis, int64_t time_axis, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
 NNCASE_API result<void>
 slice(datatype_t type, const gsl::byte *input, gsl::byte *output,
       gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
@@ -132,6 +271,12 @@ binary(typecode_t typecode, runtime::stackvm::binary_op_t op,
        gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
        NNCASE_UNUSED kernel_context &context) noexcept;
 
+NNCASE_API result<void>
+trilu(datatype_t type, const gsl::byte *input, gsl::byte *output,
+      gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+      gsl::span<const size_t> out_strides, int64_t k, bool upper,
+      kernel_context &context = default_kernel_context()) noexcept;
+
 NNCASE_API result<void>
 unary(typecode_t dtype, runtime::stackvm::unary_op_t op, const gsl::byte *in,
       gsl::byte *out, gsl::span<const size_t> shape,
@@ -139,15 +284,11 @@ unary(typecode_t dtype, runtime::stackvm::unary_op_t op, const gsl::byte *in,
       gsl::span<const size_t> out_strides,
       kernel_context &context = default_kernel_context()) noexcept;
 
-// template <typename T>
-// NNCASE_API result<void> matmul(const T *input_a, const T *input_b, const T
-// *bias, T *output,
-//                               gsl::span<const size_t> in_a_shape, const
-//                               dims_t &in_a_strides, gsl::span<const size_t>
-//                               in_b_shape, const dims_t &in_b_strides,
-//                               gsl::span<const size_t> out_shape,
-//                               gsl::span<const size_t> out_strides,
-//                               value_range<float> fused_activation) noexcept;
+NNCASE_API result<void>
+matmul(typecode_t typecode, const gsl::byte *input_a, const gsl::byte *input_b,
+       gsl::byte *output, gsl::span<const size_t> in_a_shape,
+       gsl::span<const size_t> in_b_shape,
+       kernel_context &context = default_kernel_context()) noexcept;
 
 // template <typename T>
 NNCASE_API result<void>
@@ -177,6 +318,19 @@ where(datatype_t dt, const bool *cond, const gsl::byte *x, const gsl::byte *y,
       gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
       gsl::span<const size_t> out_strides);
 
+NNCASE_API result<void> variable_update(
+    datatype_t type, const gsl::byte *update, gsl::byte *state,
+    gsl::span<const size_t> update_shape,
+    gsl::span<const size_t> update_strides,
+    gsl::span<const size_t> state_shape, gsl::span<const size_t> state_strides,
+    size_t axis, size_t start, kernel_context &context) noexcept;
+
+NNCASE_API result<void> weight_only_matmul(
+    const float *input, const gsl::byte *weights, const float *scales,
+    float *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, size_t out_channels, int32_t bits,
+    int32_t group_size, kernel_context &context) noexcept;
+
 NNCASE_API result<void> transpose(datatype_t type, const gsl::byte *src,
                                   gsl::byte *dest, const dims_t &in_shape,
                                   const dims_t &perm,
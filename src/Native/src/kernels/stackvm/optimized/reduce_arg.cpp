@@ -0,0 +1,366 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/* Same tie rule as the reference: a value within epsilon of the current best
+ * is a tie, the last tie wins when select_last_idx is set. */
+constexpr float tie_epsilon = 0.000001f;
+
+// Innermost reductions split long rows so that one row still uses every thread
+constexpr size_t min_chunk_size = 4096;
+
+// Lanes of the strided path updated together
+constexpr size_t lane_block = 256;
+
+template <class T> bool is_tie(T a, T b) noexcept {
+    return std::fabs(a - b) < tie_epsilon;
+}
+
+template <bool IsMax, class T> bool is_better(T a, T b) noexcept {
+    return IsMax ? a > b : a < b;
+}
+
+template <bool IsMax, class T> T init_value() noexcept {
+    return IsMax ? std::numeric_limits<T>::lowest()
+                 : std::numeric_limits<T>::max();
+}
+
+/** @brief Extreme value of a contiguous row, NaN never wins */
+template <bool IsMax, class T>
+T row_extreme(const T *input, size_t count, T best) noexcept {
+    constexpr size_t lanes = 8;
+    size_t i = 0;
+    if (count >= lanes) {
+        T acc[lanes];
+        std::fill_n(acc, lanes, best);
+        for (; i + lanes <= count; i += lanes) {
+            for (size_t l = 0; l < lanes; l++) {
+                auto v = input[i + l];
+                acc[l] = is_better<IsMax>(v, acc[l]) ? v : acc[l];
+            }
+        }
+        for (size_t l = 0; l < lanes; l++)
+            best = is_better<IsMax>(acc[l], best) ? acc[l] : best;
+    }
+    for (; i < count; i++)
+        best = is_better<IsMax>(input[i], best) ? input[i] : best;
+    return best;
+}
+
+/** @brief First index of value in a contiguous row, count if not found */
+template <class T>
+size_t find_first(const T *input, size_t count, T value) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        if (input[i] == value)
+            return i;
+    }
+    return count;
+}
+
+/** @brief Last index of a tie with value in a contiguous row, count if not
+ * found */
+template <class T>
+size_t find_last_tie(const T *input, size_t count, T value) noexcept {
+    for (size_t i = count; i > 0; i--) {
+        if (is_tie(input[i - 1], value))
+            return i - 1;
+    }
+    return count;
+}
+
+#if __AVX__
+template <>
+float row_extreme<true, float>(const float *input, size_t count,
+                               float best) noexcept {
+    size_t i = 0;
+    if (count >= 16) {
+        // maxps returns its second operand when the first one is NaN
+        auto acc0 = _mm256_set1_ps(best);
+        auto acc1 = acc0;
+        for (; i + 16 <= count; i += 16) {
+            acc0 = _mm256_max_ps(_mm256_loadu_ps(input + i), acc0);
+            acc1 = _mm256_max_ps(_mm256_loadu_ps(input + i + 8), acc1);
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, _mm256_max_ps(acc0, acc1));
+        for (auto v : lanes)
+            best = v > best ? v : best;
+    }
+    for (; i < count; i++)
+        best = input[i] > best ? input[i] : best;
+    return best;
+}
+
+template <>
+float row_extreme<false, float>(const float *input, size_t count,
+                                float best) noexcept {
+    size_t i = 0;
+    if (count >= 16) {
+        auto acc0 = _mm256_set1_ps(best);
+        auto acc1 = acc0;
+        for (; i + 16 <= count; i += 16) {
+            acc0 = _mm256_min_ps(_mm256_loadu_ps(input + i), acc0);
+            acc1 = _mm256_min_ps(_mm256_loadu_ps(input + i + 8), acc1);
+        }
+        float lanes[8];
+        _mm256_storeu_ps(lanes, _mm256_min_ps(acc0, acc1));
+        for (auto v : lanes)
+            best = v < best ? v : best;
+    }
+    for (; i < count; i++)
+        best = input[i] < best ? input[i] : best;
+    return best;
+}
+
+template <>
+size_t find_first(const float *input, size_t count, float value) noexcept {
+    auto target = _mm256_set1_ps(value);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto mask = _mm256_movemask_ps(
+            _mm256_cmp_ps(_mm256_loadu_ps(input + i), target, _CMP_EQ_OQ));
+        for (int b = 0; mask && b < 8; b++) {
+            if (mask & (1 << b))
+                return i + b;
+        }
+    }
+    for (; i < count; i++) {
+        if (input[i] == value)
+            return i;
+    }
+    return count;
+}
+
+template <>
+size_t find_last_tie(const float *input, size_t count, float value) noexcept {
+    auto target = _mm256_set1_ps(value);
+    auto epsilon = _mm256_set1_ps(tie_epsilon);
+    auto abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    size_t i = count;
+    for (; i >= 8; i -= 8) {
+        auto diff = _mm256_and_ps(
+            _mm256_sub_ps(_mm256_loadu_ps(input + i - 8), target), abs_mask);
+        auto mask =
+            _mm256_movemask_ps(_mm256_cmp_ps(diff, epsilon, _CMP_LT_OQ));
+        for (int b = 7; mask && b >= 0; b--) {
+            if (mask & (1 << b))
+                return i - 8 + b;
+        }
+    }
+    for (; i > 0; i--) {
+        if (is_tie(input[i - 1], value))
+            return i - 1;
+    }
+    return count;
+}
+#endif
+
+/* Reduces the contiguous rows of [outer, axis_dim]. Each row is split into
+ * chunks: the chunk extremes give the row extreme, then the chunks look for
+ * the first equal value or the last tie of it. */
+template <bool IsMax, class T, class TOutput>
+void reduce_arg_inner(const T *input, TOutput *output, size_t outer,
+                      size_t axis_dim, bool select_last_idx,
+                      NNCASE_UNUSED kernel_context &context) {
+    auto chunks = std::max((size_t)1, (size_t)context.num_threads / outer);
+    chunks = std::min(chunks, std::max((size_t)1, axis_dim / min_chunk_size));
+    auto chunk_size = (axis_dim + chunks - 1) / chunks;
+    auto tasks = (int64_t)(outer * chunks);
+
+    // Not a vector, boolean inputs must not share bytes between threads
+    std::unique_ptr<T[]> extremes(new T[tasks]);
+    std::vector<size_t> indices(tasks);
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t t = 0; t < tasks; t++) {
+        auto begin = std::min(axis_dim, (t % chunks) * chunk_size);
+        auto end = std::min(axis_dim, begin + chunk_size);
+        auto row = input + (t / chunks) * axis_dim + begin;
+        extremes[t] =
+            row_extreme<IsMax>(row, end - begin, init_value<IsMax, T>());
+    }
+
+    for (size_t o = 0; o < outer; o++) {
+        auto best = extremes[o * chunks];
+        for (size_t c = 1; c < chunks; c++) {
+            auto v = extremes[o * chunks + c];
+            best = is_better<IsMax>(v, best) ? v : best;
+        }
+        for (size_t c = 0; c < chunks; c++)
+            extremes[o * chunks + c] = best;
+    }
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t t = 0; t < tasks; t++) {
+        auto begin = std::min(axis_dim, (t % chunks) * chunk_size);
+        auto end = std::min(axis_dim, begin + chunk_size);
+        auto row = input + (t / chunks) * axis_dim + begin;
+        auto index = select_last_idx
+                         ? find_last_tie(row, end - begin, extremes[t])
+                         : find_first(row, end - begin, extremes[t]);
+        indices[t] = index == end - begin ? axis_dim : begin + index;
+    }
+
+    for (size_t o = 0; o < outer; o++) {
+        // Chunks without a match hold axis_dim, a row of NaNs picks 0
+        size_t index = axis_dim;
+        for (size_t c = 0; c < chunks; c++) {
+            auto i = select_last_idx ? indices[(o + 1) * chunks - c - 1]
+                                     : indices[o * chunks + c];
+            if (i != axis_dim) {
+                index = i;
+                break;
+            }
+        }
+        output[o] = (TOutput)(index == axis_dim ? 0 : index);
+    }
+}
+
+/* Reduces the middle axis of [outer, axis_dim, inner], keeping the best value
+ * and index of a block of inner lanes while it walks down the axis. */
+template <bool IsMax, class T, class TOutput>
+void reduce_arg_strided(const T *input, TOutput *output, size_t outer,
+                        size_t axis_dim, size_t inner, bool select_last_idx,
+                        NNCASE_UNUSED kernel_context &context) {
+    auto blocks = (inner + lane_block - 1) / lane_block;
+    auto tasks = (int64_t)(outer * blocks);
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t t = 0; t < tasks; t++) {
+        auto o = t / blocks;
+        auto begin = (t % blocks) * lane_block;
+        auto lanes = std::min(lane_block, inner - begin);
+        auto src = input + o * axis_dim * inner + begin;
+        auto dest = output + o * inner + begin;
+
+        T best[lane_block];
+        std::fill_n(best, lanes, init_value<IsMax, T>());
+        std::fill_n(dest, lanes, (TOutput)0);
+        for (size_t a = 0; a < axis_dim; a++) {
+            auto values = src + a * inner;
+            if (select_last_idx) {
+                for (size_t l = 0; l < lanes; l++) {
+                    auto v = values[l];
+                    auto better = is_better<IsMax>(v, best[l]);
+                    dest[l] =
+                        better || is_tie(v, best[l]) ? (TOutput)a : dest[l];
+                    best[l] = better ? v : best[l];
+                }
+            } else {
+                for (size_t l = 0; l < lanes; l++) {
+                    auto v = values[l];
+                    auto better = is_better<IsMax>(v, best[l]);
+                    dest[l] = better ? (TOutput)a : dest[l];
+                    best[l] = better ? v : best[l];
+                }
+            }
+        }
+    }
+}
+
+template <bool IsMax, class T, class TOutput>
+result<void> reduce_arg_impl(const T *input, TOutput *output,
+                             gsl::span<const size_t> in_shape, size_t axis,
+                             bool select_last_idx,
+                             kernel_context &context) noexcept {
+    auto outer = std::accumulate(in_shape.begin(), in_shape.begin() + axis,
+                                 (size_t)1, std::multiplies<size_t>{});
+    auto inner = std::accumulate(in_shape.begin() + axis + 1, in_shape.end(),
+                                 (size_t)1, std::multiplies<size_t>{});
+    auto axis_dim = in_shape[axis];
+    if (outer * inner == 0)
+        return ok();
+    if (axis_dim == 0)
+        return err(std::errc::invalid_argument);
+
+    if (inner == 1)
+        reduce_arg_inner<IsMax>(input, output, outer, axis_dim,
+                                select_last_idx, context);
+    else
+        reduce_arg_strided<IsMax>(input, output, outer, axis_dim, inner,
+                                  select_last_idx, context);
+    return ok();
+}
+
+template <class T, class TOutput>
+result<void> reduce_arg_op_impl(reduce_arg_op_t op, const T *input,
+                                TOutput *output,
+                                gsl::span<const size_t> in_shape, size_t axis,
+                                bool select_last_idx,
+                                kernel_context &context) noexcept {
+    switch (op) {
+    case reduce_arg_op_t::arg_min:
+        return reduce_arg_impl<false>(input, output, in_shape, axis,
+                                      select_last_idx, context);
+    case reduce_arg_op_t::arg_max:
+        return reduce_arg_impl<true>(input, output, in_shape, axis,
+                                     select_last_idx, context);
+    default:
+        return err(std::errc::not_supported);
+    }
+}
+} // namespace
+
+#define REDUCE_ARG_IMPL(_ty)                                                   \
+    return output_typecode == dt_int32                                         \
+               ? reduce_arg_op_impl(op, IN_CAST(_ty, input),                   \
+                                    OUT_CAST(int32_t, output), in_shape,       \
+                                    axes[0], select_last_idx, context)         \
+               : reduce_arg_op_impl(op, IN_CAST(_ty, input),                   \
+                                    OUT_CAST(int64_t, output), in_shape,       \
+                                    axes[0], select_last_idx, context);
+
+result<void> optimized::reduce_arg(
+    typecode_t input_typecode, typecode_t output_typecode, reduce_arg_op_t op,
+    const gsl::byte *input, gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    gsl::span<const size_t> axes, bool keep_dims, bool select_last_idx,
+    kernel_context &context) noexcept {
+    auto out_shape =
+        kernels::detail::get_reduced_shape(in_shape, axes, keep_dims);
+    if (axes.size() != 1 || !is_contiguous(out_shape, out_strides)) {
+        return reference::reduce_arg(input_typecode, output_typecode, op, input,
+                                     output, in_shape, in_strides, out_strides,
+                                     axes, keep_dims, select_last_idx,
+                                     context);
+    }
+
+    TYPE_SELECT(input_typecode, REDUCE_ARG_IMPL);
+}
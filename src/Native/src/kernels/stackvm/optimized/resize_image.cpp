@@ -23,61 +23,124 @@ using namespace nncase::kernels::stackvm::optimized;
 
 namespace {
 
+// Fixed-point interpolation weights for 8-bit images.
+constexpr int32_t resize_coef_bits = 11;
+constexpr int32_t resize_coef_one = 1 << resize_coef_bits;
+
+/** @brief Source indices and weight of each output coordinate along an axis */
+struct bilinear_table {
+    std::vector<int32_t> index0;
+    std::vector<int32_t> index1;
+    std::vector<float> weight;
+};
+
+bilinear_table make_bilinear_table(int32_t out_size, size_t in_size,
+                                   float scale, bool half_pixel_centers) {
+    bilinear_table table;
+    table.index0.resize(out_size);
+    table.index1.resize(out_size);
+    table.weight.resize(out_size);
+    for (int32_t o = 0; o < out_size; o++) {
+        float in;
+        int32_t in0, in1;
+        kernels::detail::set_resize_bilinear(o, scale, half_pixel_centers,
+                                             in_size, in, in0, in1);
+        table.index0[o] = in0;
+        table.index1[o] = in1;
+        // Both taps are the same pixel at the borders.
+        table.weight[o] = in0 == in1 ? 0.f : in - in0;
+    }
+    return table;
+}
+
+std::vector<int16_t> to_fixed_weights(const std::vector<float> &weights) {
+    std::vector<int16_t> fixed(weights.size());
+    for (size_t i = 0; i < weights.size(); i++)
+        fixed[i] = (int16_t)std::lround(weights[i] * resize_coef_one);
+    return fixed;
+}
+
+/** @brief Keeps the horizontally resized source rows needed by the current
+ * output row, consecutive output rows mostly share them */
+template <class TAcc> class bilinear_row_cache {
+  public:
+    bilinear_row_cache(int32_t out_w) : rows_((size_t)out_w * 2) {
+        row_[0] = rows_.data();
+        row_[1] = row_[0] + out_w;
+    }
+
+    template <class THorizontal>
+    void load(int32_t y0, int32_t y1, THorizontal &&horizontal) {
+        if (row_y_[0] != y0) {
+            if (row_y_[1] == y0) {
+                std::swap(row_[0], row_[1]);
+                std::swap(row_y_[0], row_y_[1]);
+            } else {
+                horizontal(y0, row_[0]);
+                row_y_[0] = y0;
+            }
+        }
+        if (row_y_[1] != y1) {
+            horizontal(y1, row_[1]);
+            row_y_[1] = y1;
+        }
+    }
+
+    const TAcc *row0() const noexcept { return row_[0]; }
+    const TAcc *row1() const noexcept { return row_[1]; }
+
+  private:
+    std::vector<TAcc> rows_;
+    TAcc *row_[2];
+    int32_t row_y_[2] = {-1, -1};
+};
+
 template <class T>
 result<void> resize_bilinear_impl(
-    const T *input, T *output, gsl::span<const size_t> in_shape,
-    NNCASE_UNUSED gsl::span<const size_t> in_strides,
-    NNCASE_UNUSED gsl::span<const size_t> out_strides, int32_t out_h,
-    int32_t out_w, bool align_corners, NNCASE_UNUSED bool half_pixel_centers,
+    const T *input, T *output, gsl::span<const size_t> in_shape, int32_t out_h,
+    int32_t out_w, bool align_corners, bool half_pixel_centers,
     NNCASE_UNUSED kernel_context &context) noexcept {
     auto scales = kernels::detail::get_resize_scales(in_shape, out_h, out_w,
                                                      align_corners);
-    auto height_scale = scales.first;
-    auto width_scale = scales.second;
-    const float rounding_offset =
-        std::numeric_limits<T>::is_integer ? .5f : .0f;
-    dims_t in_index(4), out_index(4);
+    auto y_table = make_bilinear_table(out_h, in_shape[2], scales.first,
+                                       half_pixel_centers);
+    auto x_table = make_bilinear_table(out_w, in_shape[3], scales.second,
+                                       half_pixel_centers);
 
+    const auto in_w = in_shape[3];
     const auto in_img_size = in_shape[2] * in_shape[3];
-    const auto out_img_size = out_w * out_h;
+    const auto out_img_size = (size_t)out_w * out_h;
+    const auto planes = (int32_t)(in_shape[0] * in_shape[1]);
+    auto x0 = x_table.index0.data();
+    auto x1 = x_table.index1.data();
+    auto wx = x_table.weight.data();
 
-    for (size_t batch = 0; batch < in_shape[0]; batch++) {
-        auto in_batch = input + (size_t)batch * in_shape[1] * in_img_size;
-        auto *begin_output_ptr = output + batch * in_shape[1] * out_w * out_h;
 #ifdef NNCASE_OPENMP
-#pragma omp parallel for num_threads(                                          \
-    kernels::default_kernel_context().num_threads)
+#pragma omp parallel for num_threads(context.num_threads)
 #endif
-        for (int oc = 0; oc < in_shape[1]; oc++) {
-            auto in_c = in_batch + (size_t)oc * in_img_size;
-            auto *output_ptr = begin_output_ptr + oc * out_img_size;
-            for (int oy = 0; oy < out_h; oy++) {
-                float in_y;
-                int32_t in_y0, in_y1;
-                kernels::detail::set_resize_bilinear(
-                    oy, height_scale, half_pixel_centers, in_shape[2], in_y,
-                    in_y0, in_y1);
-
-                for (int ox = 0; ox < out_w; ox++) {
-                    float in_x;
-                    int32_t in_x0, in_x1;
-                    kernels::detail::set_resize_bilinear(
-                        ox, width_scale, half_pixel_centers, in_shape[3], in_x,
-                        in_x0, in_x1);
-
-                    auto v0 = in_c[in_y0 * in_shape[3] + in_x0];
-                    auto v1 = in_c[in_y1 * in_shape[3] + in_x0];
-                    auto v2 = in_c[in_y0 * in_shape[3] + in_x1];
-                    auto v3 = in_c[in_y1 * in_shape[3] + in_x1];
-
-                    auto a0 = (1 - (in_y - in_y0)) * (1 - (in_x - in_x0));
-                    auto a1 = (in_y - in_y0) * (1 - (in_x - in_x0));
-                    auto a2 = (1 - (in_y - in_y0)) * (in_x - in_x0);
-                    auto a3 = (in_y - in_y0) * (in_x - in_x0);
-
-                    *output_ptr++ = T(v0 * a0 + v1 * a1 + v2 * a2 + v3 * a3 +
-                                      rounding_offset);
-                }
+    for (int32_t plane = 0; plane < planes; plane++) {
+        auto in_plane = input + (size_t)plane * in_img_size;
+        auto out_ptr = output + (size_t)plane * out_img_size;
+        bilinear_row_cache<float> rows(out_w);
+        // The taps are gathered through the index tables, so this pass stays
+        // scalar, the vertical blend below is the part that vectorizes.
+        auto horizontal = [&](int32_t y, float *row) {
+            auto in_row = in_plane + y * in_w;
+            for (int32_t ox = 0; ox < out_w; ox++) {
+                auto v0 = static_cast<float>(in_row[x0[ox]]);
+                auto v1 = static_cast<float>(in_row[x1[ox]]);
+                row[ox] = v0 + (v1 - v0) * wx[ox];
+            }
+        };
+
+        for (int32_t oy = 0; oy < out_h; oy++) {
+            rows.load(y_table.index0[oy], y_table.index1[oy], horizontal);
+            auto row0 = rows.row0();
+            auto row1 = rows.row1();
+            auto wy = y_table.weight[oy];
+            for (int32_t ox = 0; ox < out_w; ox++) {
+                *out_ptr++ = kernels::detail::resize_round<T>(
+                    row0[ox] + (row1[ox] - row0[ox]) * wy);
             }
         }
     }
@@ -85,160 +148,105 @@ result<void> resize_bilinear_impl(
 }
 
 template <class T>
-result<void> resize_nearest_neighbor_impl(
-    const T *input, T *output, gsl::span<const size_t> in_shape,
-    NNCASE_UNUSED gsl::span<const size_t> in_strides,
-    NNCASE_UNUSED gsl::span<const size_t> out_strides, int32_t out_h,
-    int32_t out_w, NNCASE_UNUSED bool align_corners,
-    NNCASE_UNUSED bool half_pixel_centers,
-    get_coordinate_func_t get_coordinate_func,
-    get_nearest_pixel_func_t get_nearset_func,
+result<void> resize_bilinear_fixed_impl(
+    const T *input, T *output, gsl::span<const size_t> in_shape, int32_t out_h,
+    int32_t out_w, bool align_corners, bool half_pixel_centers,
     NNCASE_UNUSED kernel_context &context) noexcept {
     auto scales = kernels::detail::get_resize_scales(in_shape, out_h, out_w,
                                                      align_corners);
-    auto height_scale = scales.first;
-    auto width_scale = scales.second;
+    auto y_table = make_bilinear_table(out_h, in_shape[2], scales.first,
+                                       half_pixel_centers);
+    auto x_table = make_bilinear_table(out_w, in_shape[3], scales.second,
+                                       half_pixel_centers);
+    auto wy = to_fixed_weights(y_table.weight);
+    auto wx = to_fixed_weights(x_table.weight);
+
+    const auto in_w = in_shape[3];
+    const auto in_img_size = in_shape[2] * in_shape[3];
+    const auto out_img_size = (size_t)out_w * out_h;
+    const auto planes = (int32_t)(in_shape[0] * in_shape[1]);
+    auto x0 = x_table.index0.data();
+    auto x1 = x_table.index1.data();
+    auto wx_ptr = wx.data();
+    constexpr int32_t shift = resize_coef_bits * 2;
+    constexpr int32_t round = 1 << (shift - 1);
 
-    const auto in_image_size = in_shape[2] * in_shape[3];
-    const auto out_image_size = out_h * out_w;
-    for (size_t batch = 0; batch < in_shape[0]; batch++) {
-        auto *begin_input_ptr = input + batch * in_shape[1] * in_image_size;
-        auto *begin_output_ptr = output + batch * in_shape[1] * out_image_size;
 #ifdef NNCASE_OPENMP
-#pragma omp parallel for num_threads(                                          \
-    kernels::default_kernel_context().num_threads)
+#pragma omp parallel for num_threads(context.num_threads)
 #endif
-        for (int oc = 0; oc < in_shape[1]; oc++) {
-            auto *input_ptr = begin_input_ptr + oc * in_image_size;
-            auto *output_ptr = begin_output_ptr + oc * out_image_size;
-
-            for (int oy = 0; oy < out_h; oy++) {
-                auto iy = get_coordinate_func(oy, height_scale, out_h,
-                                              in_shape[2], 0, 0);
-                int64_t in_y = get_nearset_func(iy);
-                if (in_y < 0)
-                    in_y = 0;
-                if (in_y >= in_shape[2])
-                    in_y = in_shape[2] - 1;
-                auto *in_row = input_ptr + in_y * in_shape[3];
-
-                for (int ox = 0; ox < out_w; ox++) {
-                    auto ix = get_coordinate_func(ox, width_scale, out_w,
-                                                  in_shape[3], 0, 0);
-                    int64_t in_x = get_nearset_func(ix);
-                    if (in_x < 0)
-                        in_x = 0;
-                    if (in_x >= in_shape[3])
-                        in_x = in_shape[3] - 1;
-                    *output_ptr++ = in_row[in_x];
-                }
+    for (int32_t plane = 0; plane < planes; plane++) {
+        auto in_plane = input + (size_t)plane * in_img_size;
+        auto out_ptr = output + (size_t)plane * out_img_size;
+        bilinear_row_cache<int32_t> rows(out_w);
+        auto horizontal = [&](int32_t y, int32_t *row) {
+            auto in_row = in_plane + y * in_w;
+            for (int32_t ox = 0; ox < out_w; ox++) {
+                int32_t v0 = in_row[x0[ox]];
+                int32_t v1 = in_row[x1[ox]];
+                row[ox] = v0 * resize_coef_one + (v1 - v0) * wx_ptr[ox];
             }
-        }
-    }
-    return ok();
-}
-
-inline result<void> gnne_resize_nearest_neighbor(
-    const bfloat16 *input, bfloat16 *output, gsl::span<const size_t> in_shape,
-    NNCASE_UNUSED gsl::span<const size_t> in_strides,
-    NNCASE_UNUSED gsl::span<const size_t> out_strides, int32_t out_h,
-    int32_t out_w, NNCASE_UNUSED bool align_corners,
-    NNCASE_UNUSED bool half_pixel_centers,
-    NNCASE_UNUSED kernel_context &context) {
-    if (align_corners || half_pixel_centers) {
-        return err(std::errc::not_supported);
-    }
-
-    auto height_scale = (float)in_shape[2] / out_h;
-    auto width_scale = (float)in_shape[3] / out_w;
-
-    const auto in_image_size = in_shape[2] * in_shape[3];
-    const auto out_image_size = out_h * out_w;
-    for (size_t batch = 0; batch < in_shape[0]; batch++) {
-        auto *begin_input_ptr = input + batch * in_shape[1] * in_image_size;
-        auto *begin_output_ptr = output + batch * in_shape[1] * out_image_size;
-#ifdef NNCASE_OPENMP
-#pragma omp parallel for num_threads(                                          \
-    kernels::default_kernel_context().num_threads)
-#endif
-        for (int oc = 0; oc < in_shape[1]; oc++) {
-            auto *input_ptr = begin_input_ptr + oc * in_image_size;
-            auto *output_ptr = begin_output_ptr + oc * out_image_size;
-
-            for (int oy = 0; oy < out_h; oy++) {
-                auto in_y = std::min((int32_t)floorf(oy * height_scale),
-                                     (int32_t)in_shape[2] - 1);
-                auto *in_row = input_ptr + in_y * in_shape[3];
-
-                for (int ox = 0; ox < out_w; ox++) {
-                    auto in_x = std::min((int32_t)floorf(ox * width_scale),
-                                         (int32_t)in_shape[3] - 1);
-                    *output_ptr++ = in_row[in_x];
-                }
+        };
+
+        for (int32_t oy = 0; oy < out_h; oy++) {
+            rows.load(y_table.index0[oy], y_table.index1[oy], horizontal);
+            auto row0 = rows.row0();
+            auto row1 = rows.row1();
+            int32_t w1 = wy[oy];
+            int32_t w0 = resize_coef_one - w1;
+            for (int32_t ox = 0; ox < out_w; ox++) {
+                auto value = (row0[ox] * w0 + row1[ox] * w1 + round) >> shift;
+                *out_ptr++ = (T)std::clamp(
+                    value, (int32_t)std::numeric_limits<T>::lowest(),
+                    (int32_t)std::numeric_limits<T>::max());
             }
         }
     }
     return ok();
 }
 
-inline result<void> resize_bilinear_impl(
-    const bfloat16 *input, bfloat16 *output, gsl::span<const size_t> in_shape,
-    NNCASE_UNUSED gsl::span<const size_t> in_strides,
-    NNCASE_UNUSED gsl::span<const size_t> out_strides, int32_t out_h,
-    int32_t out_w, bool align_corners, NNCASE_UNUSED bool half_pixel_centers,
-    NNCASE_UNUSED kernel_context &context) {
-    if (half_pixel_centers) {
-        return err(std::errc::not_supported);
-    }
-
-    auto height_scale = (float)in_shape[2] / out_h;
-    auto width_scale = (float)in_shape[3] / out_w;
-    if (align_corners && out_h > 1)
-        height_scale = (float)(in_shape[2] - 1) / (out_h - 1);
-    if (align_corners && out_w > 1)
-        width_scale = (float)(in_shape[3] - 1) / (out_w - 1);
+template <class T>
+result<void> resize_nearest_neighbor_impl(
+    const T *input, T *output, gsl::span<const size_t> in_shape,
+    int32_t out_h, int32_t out_w, bool align_corners,
+    get_coordinate_func_t get_coordinate_func,
+    get_nearest_pixel_func_t get_nearset_func,
+    NNCASE_UNUSED kernel_context &context) noexcept {
+    auto scales = kernels::detail::get_resize_scales(in_shape, out_h, out_w,
+                                                     align_corners);
+    auto get_index = [&](int32_t o, float scale, int32_t out_size,
+                         size_t in_size) {
+        auto in = get_coordinate_func(o, scale, out_size, in_size, 0, 0);
+        auto index = get_nearset_func(in);
+        return (int32_t)std::clamp(index, (int64_t)0, (int64_t)in_size - 1);
+    };
+
+    std::vector<int32_t> y_index(out_h), x_index(out_w);
+    for (int32_t oy = 0; oy < out_h; oy++)
+        y_index[oy] = get_index(oy, scales.first, out_h, in_shape[2]);
+    for (int32_t ox = 0; ox < out_w; ox++)
+        x_index[ox] = get_index(ox, scales.second, out_w, in_shape[3]);
 
-    const auto in_img_size = in_shape[2] * in_shape[3];
-    const auto out_img_size = out_w * out_h;
+    const auto in_image_size = in_shape[2] * in_shape[3];
+    const auto out_image_size = (size_t)out_h * out_w;
+    const auto planes = (int32_t)(in_shape[0] * in_shape[1]);
+    auto x_ptr = x_index.data();
 
-    for (size_t batch = 0; batch < in_shape[0]; batch++) {
-        auto in_batch = input + (size_t)batch * in_shape[1] * in_img_size;
-        auto *begin_output_ptr = output + batch * in_shape[1] * out_w * out_h;
 #ifdef NNCASE_OPENMP
-#pragma omp parallel for num_threads(                                          \
-    kernels::default_kernel_context().num_threads)
+#pragma omp parallel for num_threads(context.num_threads)
 #endif
-        for (int oc = 0; oc < in_shape[1]; oc++) {
-            auto in_c = in_batch + (size_t)oc * in_img_size;
-            auto *output_ptr = begin_output_ptr + oc * out_img_size;
-            for (int oy = 0; oy < out_h; oy++) {
-                auto in_y = oy * height_scale;
-                auto in_y0 = (int)floorf(in_y);
-                auto in_y1 = std::min(in_y0 + 1, (int32_t)in_shape[2] - 1);
-
-                for (int ox = 0; ox < out_w; ox++) {
-                    auto in_x = ox * width_scale;
-                    auto in_x0 = (int)floorf(in_x);
-                    auto in_x1 = std::min(in_x0 + 1, (int32_t)in_shape[3] - 1);
-
-                    auto v0 = in_c[in_y0 * in_shape[3] + in_x0];
-                    auto v1 = in_c[in_y1 * in_shape[3] + in_x0];
-                    auto v2 = in_c[in_y0 * in_shape[3] + in_x1];
-                    auto v3 = in_c[in_y1 * in_shape[3] + in_x1];
-
-                    auto a0 = (1 - (in_y - in_y0)) * (1 - (in_x - in_x0));
-                    auto a1 = (in_y - in_y0) * (1 - (in_x - in_x0));
-                    auto a2 = (1 - (in_y - in_y0)) * (in_x - in_x0);
-                    auto a3 = (in_y - in_y0) * (in_x - in_x0);
-
-                    *output_ptr = bfloat16::round_to_bfloat16(
-                        static_cast<float>(v0) * a0 +
-                        static_cast<float>(v1) * a1 +
-                        static_cast<float>(v2) * a2 +
-                        static_cast<float>(v3) * a3);
-                    ++output_ptr;
-                }
+    for (int32_t plane = 0; plane < planes; plane++) {
+        auto input_ptr = input + (size_t)plane * in_image_size;
+        auto output_ptr = output + (size_t)plane * out_image_size;
+        for (int32_t oy = 0; oy < out_h; oy++) {
+            auto in_row = input_ptr + (size_t)y_index[oy] * in_shape[3];
+            // Rows mapping to the same source row are identical.
+            if (oy && y_index[oy] == y_index[oy - 1]) {
+                std::copy_n(output_ptr - out_w, out_w, output_ptr);
+            } else {
+                for (int32_t ox = 0; ox < out_w; ox++)
+                    output_ptr[ox] = in_row[x_ptr[ox]];
             }
+            output_ptr += out_w;
         }
     }
     return ok();
@@ -253,15 +261,19 @@ inline result<void> resize_bilinear_impl(
     case dt_bfloat16:                                                          \
         return KERNEL(bfloat16);                                               \
     case dt_int8:                                                              \
+        return KERNEL(int8_t);                                                 \
     case dt_uint8:                                                             \
         return KERNEL(uint8_t);                                                \
     case dt_int16:                                                             \
+        return KERNEL(int16_t);                                                \
     case dt_uint16:                                                            \
         return KERNEL(uint16_t);                                               \
     case dt_int32:                                                             \
+        return KERNEL(int32_t);                                                \
     case dt_uint32:                                                            \
         return KERNEL(uint32_t);                                               \
     case dt_int64:                                                             \
+        return KERNEL(int64_t);                                                \
     case dt_uint64:                                                            \
         return KERNEL(uint64_t);                                               \
     default:                                                                   \
@@ -270,33 +282,48 @@ inline result<void> resize_bilinear_impl(
 
 #define RESIZE_BILINEAR_IMPL(type)                                             \
     resize_bilinear_impl(reinterpret_cast<const type *>(input),                \
-                         reinterpret_cast<type *>(output), in_shape,           \
-                         in_strides, out_strides, out_h, out_w, align_corners, \
-                         half_pixel_centers, context);
+                         reinterpret_cast<type *>(output), in_shape, out_h,    \
+                         out_w, align_corners, half_pixel_centers, context);
+
+#define RESIZE_BILINEAR_FIXED_IMPL(type)                                       \
+    resize_bilinear_fixed_impl(reinterpret_cast<const type *>(input),          \
+                               reinterpret_cast<type *>(output), in_shape,     \
+                               out_h, out_w, align_corners,                    \
+                               half_pixel_centers, context);
 
 #define RESIZE_NEAREST_NEIGHBOR_IMPL(type)                                     \
-    resize_nearest_neighbor_impl(                                              \
-        reinterpret_cast<const type *>(input),                                 \
-        reinterpret_cast<type *>(output), in_shape, in_strides, out_strides,   \
-        out_h, out_w, align_corners, half_pixel_centers, get_coordinate_func,  \
-        get_nearset_func, context);
+    resize_nearest_neighbor_impl(reinterpret_cast<const type *>(input),        \
+                                 reinterpret_cast<type *>(output), in_shape,   \
+                                 out_h, out_w, align_corners,                  \
+                                 get_coordinate_func, get_nearset_func,        \
+                                 context);
 
 result<void> optimized::resize_bilinear(
     typecode_t type, const gsl::byte *input, gsl::byte *output,
-    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
-    gsl::span<const size_t> out_strides, int32_t out_h, int32_t out_w,
-    bool align_corners, bool half_pixel_centers,
+    gsl::span<const size_t> in_shape,
+    NNCASE_UNUSED gsl::span<const size_t> in_strides,
+    NNCASE_UNUSED gsl::span<const size_t> out_strides, int32_t out_h,
+    int32_t out_w, bool align_corners, bool half_pixel_centers,
     kernel_context &context) noexcept {
-    FP_OR_Q_IMPL(type, RESIZE_BILINEAR_IMPL);
+    switch (type) {
+    case dt_int8:
+        return RESIZE_BILINEAR_FIXED_IMPL(int8_t);
+    case dt_uint8:
+        return RESIZE_BILINEAR_FIXED_IMPL(uint8_t);
+    default:
+        FP_OR_Q_IMPL(type, RESIZE_BILINEAR_IMPL);
+    }
 }
 
 result<void> optimized::resize_nearest_neighbor(
     typecode_t type, const gsl::byte *input, gsl::byte *output,
-    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
-    gsl::span<const size_t> out_strides, int32_t out_h, int32_t out_w,
-    bool align_corners, bool half_pixel_centers,
+    gsl::span<const size_t> in_shape,
+    NNCASE_UNUSED gsl::span<const size_t> in_strides,
+    NNCASE_UNUSED gsl::span<const size_t> out_strides, int32_t out_h,
+    int32_t out_w, bool align_corners,
+    NNCASE_UNUSED bool half_pixel_centers,
     get_coordinate_func_t get_coordinate_func,
     get_nearest_pixel_func_t get_nearset_func,
     kernel_context &context) noexcept {
     FP_OR_Q_IMPL(type, RESIZE_NEAREST_NEIGHBOR_IMPL);
-}
\ No newline at end of file
+}
@@ -0,0 +1,91 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_ops.h"
+#include <algorithm>
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+size_t dims_size(gsl::span<const size_t> shape, size_t begin,
+                 size_t end) noexcept {
+    size_t size = 1;
+    for (auto i = begin; i < end; i++)
+        size *= shape[i];
+    return size;
+}
+} // namespace
+
+/* The input is viewed as [pre, d0, mid, d1, post] where d0 and d1 are the
+ * batch and time axes in order. Each (pre, d0, mid, d1) element is a run of
+ * post contiguous elements that moves as a whole to its reversed time
+ * index, so every run is one memcpy. */
+result<void> optimized::reverse_sequence(
+    datatype_t dt, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> sequence_lens,
+    int64_t batch_axis, int64_t time_axis,
+    NNCASE_UNUSED gsl::span<const size_t> in_strides,
+    NNCASE_UNUSED gsl::span<const size_t> out_strides,
+    NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto rank = (int64_t)in_shape.size();
+    if (batch_axis == time_axis || batch_axis < 0 || batch_axis >= rank ||
+        time_axis < 0 || time_axis >= rank ||
+        sequence_lens.size() < in_shape[batch_axis]) {
+        return err(std::errc::invalid_argument);
+    }
+
+    const auto first = (size_t)std::min(batch_axis, time_axis);
+    const auto second = (size_t)std::max(batch_axis, time_axis);
+    const auto time_first = time_axis < batch_axis;
+    const auto pre = dims_size(in_shape, 0, first);
+    const auto d0 = in_shape[first];
+    const auto mid = dims_size(in_shape, first + 1, second);
+    const auto d1 = in_shape[second];
+    const auto run_bytes =
+        dims_size(in_shape, second + 1, in_shape.size()) * get_bytes(dt);
+    const auto time_steps = in_shape[time_axis];
+    const auto units = (int64_t)(pre * d0);
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t unit = 0; unit < units; unit++) {
+        const auto i0 = (size_t)unit % d0;
+        for (size_t m = 0; m < mid; m++) {
+            for (size_t i1 = 0; i1 < d1; i1++) {
+                auto t = time_first ? i0 : i1;
+                auto b = time_first ? i1 : i0;
+                auto len = std::min(sequence_lens[b], time_steps);
+                auto src_t = t < len ? len - 1 - t : t;
+                auto src_i0 = time_first ? src_t : i0;
+                auto src_i1 = time_first ? i1 : src_t;
+
+                auto row = (size_t)unit - i0;
+                auto dest = ((row + i0) * mid + m) * d1 + i1;
+                auto src = ((row + src_i0) * mid + m) * d1 + src_i1;
+                std::memcpy(output + dest * run_bytes, input + src * run_bytes,
+                            run_bytes);
+            }
+        }
+    }
+    return ok();
+}
@@ -0,0 +1,109 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+template <class T, class IndicesT>
+result<void>
+scatter_nd_impl(const T *input, T *output, gsl::span<const size_t> in_shape,
+                const IndicesT *indices, gsl::span<const size_t> indices_shape,
+                const T *updates,
+                NNCASE_UNUSED gsl::span<const size_t> updates_shape,
+                NNCASE_UNUSED kernel_context &context) noexcept {
+    auto indices_list_size = indices_shape.back();
+    auto updates_count =
+        std::accumulate(indices_shape.begin(), indices_shape.end() - 1,
+                        (size_t)1, std::multiplies<size_t>{});
+    auto block_size =
+        std::accumulate(in_shape.begin() + indices_list_size, in_shape.end(),
+                        (size_t)1, std::multiplies<size_t>{});
+    auto in_strides = get_default_strides(in_shape);
+
+    // 1. Validate the indices and turn them into output offsets once
+    std::vector<size_t> offsets(updates_count);
+    for (size_t n = 0; n < updates_count; ++n) {
+        const auto *indices_ptr = indices + n * indices_list_size;
+        size_t offset = 0;
+        for (size_t k = 0; k < indices_list_size; ++k) {
+            size_t index;
+            if (!normalize_index(indices_ptr[k], in_shape[k], index))
+                return err(std::errc::result_out_of_range);
+            offset += index * in_strides[k];
+        }
+        offsets[n] = offset;
+    }
+
+    if (output != input)
+        opt_memcpy(output, input, compute_size(in_shape) * sizeof(T));
+
+    // 2. Write the update slices
+#ifdef NNCASE_OPENMP
+    // Updates hitting the same slice must be applied in order, so only run in
+    // parallel when all targets differ.
+    bool parallel = false;
+    if (context.num_threads > 1 && updates_count > 1) {
+        auto sorted = offsets;
+        std::sort(sorted.begin(), sorted.end());
+        parallel =
+            std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+    }
+#endif
+
+    auto count = (int64_t)updates_count;
+    if (block_size == 1) {
+        for (int64_t n = 0; n < count; ++n)
+            output[offsets[n]] = updates[n];
+    } else {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads) if (parallel)
+#endif
+        for (int64_t n = 0; n < count; ++n) {
+            opt_memcpy(output + offsets[n], updates + n * block_size,
+                       block_size * sizeof(T));
+        }
+    }
+    return ok();
+}
+} // namespace
+
+#define SCATTER_ND_IMPL(size, type)                                            \
+    case size:                                                                 \
+        return integer_cast(indices_type, indices, [&](auto &&indices_value) { \
+            return scatter_nd_impl(reinterpret_cast<const type *>(input),      \
+                                   reinterpret_cast<type *>(output), in_shape, \
+                                   indices_value, indices_shape,               \
+                                   reinterpret_cast<const type *>(updates),    \
+                                   updates_shape, context);                    \
+        });
+
+result<void> optimized::scatter_nd(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, datatype_t indices_type,
+    const gsl::byte *indices, gsl::span<const size_t> indices_shape,
+    const gsl::byte *updates, gsl::span<const size_t> updates_shape,
+    kernel_context &context) noexcept {
+    TYPE_IMPL_SELECT(type, SCATTER_ND_IMPL);
+}
@@ -48,10 +48,11 @@ void _slice_contiguous_dim_copy(const axes_t &begins,
     }
 }
 
-// optimized for n c h 1
+// optimized for n c h 1, a [1] shape has no dim to squeeze into
 size_t inline squeeze_dims(const gsl::span<const size_t> &in_shape) {
-    return in_shape[in_shape.size() - 1] == 1 ? in_shape.size() - 1 - 1
-                                              : in_shape.size() - 1;
+    return in_shape.size() > 1 && in_shape[in_shape.size() - 1] == 1
+               ? in_shape.size() - 1 - 1
+               : in_shape.size() - 1;
 }
 
 template <class T>
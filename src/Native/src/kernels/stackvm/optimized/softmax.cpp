@@ -13,10 +13,12 @@
  * limitations under the License.
  */
 #include "../reference/ref_ops.h"
+#include "opt_fp16.h"
 #include "opt_ops.h"
 #include <iostream>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
 
 using namespace nncase;
 using namespace nncase::runtime;
@@ -36,6 +38,28 @@ result<void> optimized::softmax(typecode_t typecode, const gsl::byte *input,
                                 gsl::span<const size_t> in_strides,
                                 gsl::span<const size_t> out_strides,
                                 int32_t axis, float beta) noexcept {
+    if (typecode == dt_float16) {
+        // Softmax one [axis, inner] block at a time in fp32.
+        auto positive_axis = axis < 0 ? in_shape.size() + axis : (size_t)axis;
+        size_t inner_size = 1;
+        for (auto i = positive_axis + 1; i < in_shape.size(); i++)
+            inner_size *= in_shape[i];
+        dims_t block_shape{1, in_shape[positive_axis], inner_size};
+        auto block_strides = get_default_strides(block_shape);
+        auto block_size = compute_size(block_shape);
+        auto blocks = block_size ? compute_size(in_shape) / block_size : 0;
+        std::vector<float> block(block_size);
+        auto in = IN_CAST(half, input);
+        auto out = OUT_CAST(half, output);
+        for (size_t i = 0; i < blocks; i++) {
+            fp16_to_fp32(in + i * block_size, block.data(), block_size);
+            try_(optimized::softmax(dt_float32, IN_BYTE_CAST(block.data()),
+                                    OUT_BYTE_CAST(block.data()), block_shape,
+                                    block_strides, block_strides, 1, beta));
+            fp32_to_fp16(block.data(), out + i * block_size, block_size);
+        }
+        return ok();
+    }
     return stackvm::reference::softmax(typecode, input, output, in_shape,
                                        in_strides, out_strides, axis, beta);
 }
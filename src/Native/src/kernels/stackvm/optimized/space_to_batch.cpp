@@ -0,0 +1,128 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/* The input [batch, spatial..., remain...] is padded, each spatial axis is
+ * split into [spatial / block, block] and the block offsets move in front of
+ * the batch. Every output row of the last spatial axis reads one input row at
+ * a stride of the last block, and each element of the row carries the
+ * contiguous remain dims. Pads are zero. */
+template <class T>
+void space_to_batch_impl(const T *input, T *output,
+                         gsl::span<const size_t> in_shape,
+                         gsl::span<const size_t> block_shape,
+                         const paddings_t &paddings,
+                         gsl::span<const size_t> out_shape,
+                         NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto m = block_shape.size();
+    const auto batch = in_shape[0];
+    const auto inner = compute_size(in_shape.subspan(1 + m));
+    const auto last_block = block_shape[m - 1];
+    const auto last_pad = paddings[m - 1].before;
+    const auto last_in = (int64_t)in_shape[m];
+    const auto last_out = out_shape[m];
+    const auto row_size = last_out * inner;
+    const auto in_row_size = in_shape[m] * inner;
+
+    // Rows are indexed by [block offsets..., batch, out spatial[:-1]...]
+    const auto rows = (int64_t)(compute_size(block_shape) * batch *
+                                compute_size(out_shape.subspan(1, m - 1)));
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t row = 0; row < rows; row++) {
+        auto out_row = output + (size_t)row * row_size;
+        auto rest = (size_t)row;
+        dims_t out_index(m - 1);
+        for (size_t i = m - 1; i > 0; i--) {
+            out_index[i - 1] = rest % out_shape[i];
+            rest /= out_shape[i];
+        }
+        const auto n = rest % batch;
+        rest /= batch;
+        const auto last_offset = (int64_t)(rest % last_block);
+        rest /= last_block;
+
+        // Input row of the leading spatial axes, none when it is padding
+        bool padded = false;
+        for (size_t i = m - 1; i > 0; i--) {
+            auto offset = rest % block_shape[i - 1];
+            rest /= block_shape[i - 1];
+            out_index[i - 1] = out_index[i - 1] * block_shape[i - 1] + offset;
+            auto index = (int64_t)out_index[i - 1] - paddings[i - 1].before;
+            padded |= index < 0 || index >= (int64_t)in_shape[i];
+        }
+        if (padded) {
+            std::fill_n(out_row, row_size, T(0));
+            continue;
+        }
+        auto in_row = n;
+        for (size_t i = 1; i < m; i++) {
+            in_row = in_row * in_shape[i] + out_index[i - 1] -
+                     (size_t)paddings[i - 1].before;
+        }
+
+        auto in_begin = input + in_row * in_row_size;
+        for (size_t o = 0; o < last_out; o++) {
+            auto out = out_row + o * inner;
+            auto index = (int64_t)o * (int64_t)last_block + last_offset -
+                         last_pad;
+            if (index < 0 || index >= last_in)
+                std::fill_n(out, inner, T(0));
+            else if (inner == 1)
+                *out = in_begin[index];
+            else
+                std::copy_n(in_begin + index * inner, inner, out);
+        }
+    }
+}
+
+#define SPACE_TO_BATCH_IMPL(size, type)                                        \
+    case size:                                                                 \
+        space_to_batch_impl(IN_CAST(type, input), OUT_CAST(type, output),      \
+                            in_shape, block_shape, paddings, out_shape,        \
+                            context);                                          \
+        return ok()
+} // namespace
+
+result<void> optimized::space_to_batch(
+    datatype_t dt, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &paddings, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context) noexcept {
+    if (block_shape.empty() || in_shape.size() < 1 + block_shape.size() ||
+        paddings.size() < block_shape.size() ||
+        !is_contiguous(out_shape, out_strides) ||
+        compute_size(out_shape) == 0) {
+        return reference::space_to_batch(dt, input, output, in_shape,
+                                         block_shape, paddings, in_strides,
+                                         out_shape, out_strides, context);
+    }
+
+    TYPE_IMPL_SELECT(dt, SPACE_TO_BATCH_IMPL);
+}
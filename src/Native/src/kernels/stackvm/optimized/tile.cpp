@@ -0,0 +1,114 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/** @brief Fills count bytes of dest by repeating its first filled bytes,
+ * doubling the copied span on every memcpy */
+void repeat_bytes(gsl::byte *dest, size_t filled, size_t count) noexcept {
+    while (filled < count) {
+        auto n = std::min(filled, count - filled);
+        std::memcpy(dest + filled, dest, n);
+        filled += n;
+    }
+}
+} // namespace
+
+/* The input lands in the output corner first: every input row is copied once
+ * and repeated along the last axis. Then, from the innermost axis outwards,
+ * each filled block is repeated along its axis. Both steps write disjoint
+ * blocks, so they are split across threads. */
+result<void> optimized::tile(datatype_t dt, const gsl::byte *input,
+                             gsl::byte *output,
+                             gsl::span<const size_t> in_shape,
+                             gsl::span<const size_t> out_shape,
+                             gsl::span<const size_t> in_strides,
+                             gsl::span<const size_t> out_strides,
+                             gsl::span<const size_t> repeats,
+                             kernel_context &context) noexcept {
+    if (repeats.size() != in_shape.size())
+        return err(std::errc::invalid_argument);
+    if (!is_contiguous(out_shape, out_strides)) {
+        return reference::tile(dt, input, output, in_shape, out_shape,
+                               in_strides, out_strides, repeats, context);
+    }
+
+    const auto elem_size = runtime::get_bytes(dt);
+    if (in_shape.empty()) {
+        std::memcpy(output, input, elem_size);
+        return ok();
+    }
+    if (compute_size(out_shape) == 0)
+        return ok();
+
+    // Bytes of one step along each axis of the output
+    const auto rank = in_shape.size();
+    strides_t out_pitch(rank);
+    out_pitch[rank - 1] = elem_size;
+    for (size_t d = rank - 1; d > 0; d--)
+        out_pitch[d - 1] = out_pitch[d] * out_shape[d];
+
+    const auto row_bytes = in_shape[rank - 1] * elem_size;
+    const auto rows = (int64_t)compute_size(in_shape.first(rank - 1));
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t row = 0; row < rows; row++) {
+        size_t out_offset = 0;
+        auto rest = (size_t)row;
+        for (size_t d = rank - 1; d > 0; d--) {
+            out_offset += rest % in_shape[d - 1] * out_pitch[d - 1];
+            rest /= in_shape[d - 1];
+        }
+        auto dest = output + out_offset;
+        std::memcpy(dest, input + (size_t)row * row_bytes, row_bytes);
+        repeat_bytes(dest, row_bytes, row_bytes * repeats[rank - 1]);
+    }
+
+    for (size_t axis = rank - 1; axis > 0; axis--) {
+        const auto d = axis - 1;
+        if (repeats[d] == 1)
+            continue;
+
+        // Every filled block of axis d sits at an input index of axes < d
+        const auto block_bytes = in_shape[d] * out_pitch[d];
+        const auto blocks = (int64_t)compute_size(in_shape.first(d));
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t block = 0; block < blocks; block++) {
+            size_t out_offset = 0;
+            auto rest = (size_t)block;
+            for (size_t i = d; i > 0; i--) {
+                out_offset += rest % in_shape[i - 1] * out_pitch[i - 1];
+                rest /= in_shape[i - 1];
+            }
+            repeat_bytes(output + out_offset, block_bytes,
+                         block_bytes * repeats[d]);
+        }
+    }
+    return ok();
+}
@@ -0,0 +1,69 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+/* Every row of a matrix keeps one contiguous run of columns and zeroes the
+ * rest, so a row is at most one memcpy and one memset whatever the type:
+ * upper keeps columns [h + k, cols), lower keeps [0, h + k + 1). */
+result<void> optimized::trilu(datatype_t type, const gsl::byte *input,
+                              gsl::byte *output,
+                              gsl::span<const size_t> in_shape,
+                              gsl::span<const size_t> in_strides,
+                              gsl::span<const size_t> out_strides, int64_t k,
+                              bool upper,
+                              NNCASE_UNUSED kernel_context &context) noexcept {
+    if (in_shape.size() < 2) {
+        return reference::trilu(type, input, output, in_shape, in_strides,
+                                out_strides, k, upper, context);
+    }
+
+    const auto elem_size = runtime::get_bytes(type);
+    const auto rows = (int64_t)in_shape[in_shape.size() - 2];
+    const auto cols = (int64_t)in_shape[in_shape.size() - 1];
+    const auto units =
+        (int64_t)compute_size(in_shape.first(in_shape.size() - 1));
+    const auto row_bytes = cols * elem_size;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t unit = 0; unit < units; unit++) {
+        auto h = unit % rows;
+        auto src = input + unit * row_bytes;
+        auto dest = output + unit * row_bytes;
+        if (upper) {
+            auto begin = std::clamp(h + k, (int64_t)0, cols) * elem_size;
+            std::memset(dest, 0, begin);
+            std::memcpy(dest + begin, src + begin, row_bytes - begin);
+        } else {
+            auto end = std::clamp(h + k + 1, (int64_t)0, cols) * elem_size;
+            std::memcpy(dest, src, end);
+            std::memset(dest + end, 0, row_bytes - end);
+        }
+    }
+    return ok();
+}
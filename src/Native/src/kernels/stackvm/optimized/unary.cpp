@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "../reference/ref_ops.h"
+#include "opt_fp16.h"
 #include "opt_ops.h"
 #include <iostream>
 #include <nncase/kernels/kernel_utils.h>
@@ -33,6 +34,21 @@ result<void> optimized::unary(typecode_t dtype, runtime::stackvm::unary_op_t op,
                               gsl::span<const size_t> out_shape,
                               gsl::span<const size_t> out_strides,
                               kernel_context &context) noexcept {
+    if (dtype == dt_float16) {
+        result<void> ret = ok();
+        fp16_map(IN_CAST(half, in), OUT_CAST(half, out), compute_size(shape),
+                 [&](const float *input, float *output, size_t count) {
+                     if (ret.is_err())
+                         return;
+                     dims_t tile_shape{count};
+                     strides_t tile_strides{1};
+                     ret = stackvm::reference::unary(
+                         dt_float32, op, IN_BYTE_CAST(input),
+                         OUT_BYTE_CAST(output), tile_shape, tile_strides,
+                         tile_shape, tile_strides, context);
+                 });
+        return ret;
+    }
     return stackvm::reference::unary(dtype, op, in, out, shape, in_strides,
                                      out_shape, out_strides, context);
 }
@@ -0,0 +1,53 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+
+result<void> optimized::variable_update(
+    datatype_t type, const gsl::byte *update, gsl::byte *state,
+    gsl::span<const size_t> update_shape,
+    gsl::span<const size_t> update_strides,
+    gsl::span<const size_t> state_shape, gsl::span<const size_t> state_strides,
+    size_t axis, size_t start, kernel_context &context) noexcept {
+    if (!is_contiguous(state_shape, state_strides)) {
+        return reference::variable_update(type, update, state, update_shape,
+                                          update_strides, state_shape,
+                                          state_strides, axis, start, context);
+    }
+
+    // The dims behind axis are contiguous in both, so every outer index
+    // copies one block, e.g. the new tokens of a head of a kv cache.
+    auto elem_bytes = runtime::get_bytes(type);
+    auto outer = compute_size(state_shape.subspan(0, axis));
+    auto inner = compute_size(state_shape.subspan(axis + 1)) * elem_bytes;
+    auto update_block = update_shape[axis] * inner;
+    auto state_block = state_shape[axis] * inner;
+    auto dest = state + start * inner;
+    for (size_t i = 0; i < outer; i++) {
+        std::memcpy(dest, update, update_block);
+        update += update_block;
+        dest += state_block;
+    }
+    return ok();
+}
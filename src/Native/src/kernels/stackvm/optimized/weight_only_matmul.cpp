@@ -0,0 +1,189 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX__
+#include "x86_64/avx_mathfun.h"
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+#if __AVX__
+constexpr size_t block_rows = 4;
+
+template <int32_t Bits>
+float weight_at(const uint8_t *row, size_t k) noexcept {
+    if constexpr (Bits == 8) {
+        return (float)(int8_t)row[k];
+    } else {
+        int32_t nibble = (k & 1) ? row[k / 2] >> 4 : row[k / 2] & 0xF;
+        return (float)((nibble ^ 8) - 8);
+    }
+}
+
+/* Convert the 8 signed bytes at the bottom of a register, AVX has no 256 bit
+ * integer ops so each half is widened with SSE4.1. */
+__m256 bytes_to_ps(__m128i bytes) noexcept {
+    auto lo = _mm_cvtepi8_epi32(bytes);
+    auto hi = _mm_cvtepi8_epi32(_mm_srli_si128(bytes, 4));
+    return _mm256_cvtepi32_ps(_mm256_set_m128i(hi, lo));
+}
+
+/* Dequantize weights [k, k + 8) of a row in registers, k must be even for
+ * int4 weights so the nibbles start at a byte boundary. */
+template <int32_t Bits>
+__m256 load_weights(const uint8_t *row, size_t k) noexcept {
+    if constexpr (Bits == 8) {
+        return bytes_to_ps(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + k)));
+    } else {
+        int32_t packed;
+        std::memcpy(&packed, row + k / 2, sizeof(packed));
+        auto bytes = _mm_cvtsi32_si128(packed);
+        auto mask = _mm_set1_epi8(0xF);
+        auto eight = _mm_set1_epi8(8);
+        // The low nibble of every byte comes first.
+        auto w = _mm_unpacklo_epi8(_mm_and_si128(bytes, mask),
+                                   _mm_and_si128(_mm_srli_epi16(bytes, 4),
+                                                 mask));
+        return bytes_to_ps(_mm_sub_epi8(_mm_xor_si128(w, eight), eight));
+    }
+}
+
+float reduce_sum(__m256 v) noexcept {
+    auto x = _mm_add_ps(_mm256_castps256_ps128(v),
+                        _mm256_extractf128_ps(v, 1));
+    x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    x = _mm_add_ss(x, _mm_movehdup_ps(x));
+    return _mm_cvtss_f32(x);
+}
+
+/* One output channel of Rows input rows. Every weight vector is dequantized
+ * once and reused by all the rows, the group scale is applied to the group
+ * accumulators instead of the weights. */
+template <int32_t Bits, size_t Rows>
+void weight_only_micro_kernel(const float *input, const uint8_t *w_row,
+                              const float *scales, float *output,
+                              size_t k_size, size_t out_channels,
+                              size_t group_size) noexcept {
+    __m256 sum[Rows];
+    float tail_sum[Rows];
+    for (size_t r = 0; r < Rows; r++) {
+        sum[r] = _mm256_setzero_ps();
+        tail_sum[r] = 0;
+    }
+
+    for (size_t k_begin = 0; k_begin < k_size; k_begin += group_size) {
+        auto k_end = std::min(k_begin + group_size, k_size);
+        __m256 acc[Rows];
+        float tail[Rows];
+        for (size_t r = 0; r < Rows; r++) {
+            acc[r] = _mm256_setzero_ps();
+            tail[r] = 0;
+        }
+
+        auto k = k_begin;
+        for (; k + 8 <= k_end; k += 8) {
+            auto w = load_weights<Bits>(w_row, k);
+            for (size_t r = 0; r < Rows; r++) {
+                auto x = _mm256_loadu_ps(input + r * k_size + k);
+                acc[r] = _mm256_comp_fmadd_ps(x, w, acc[r]);
+            }
+        }
+        for (; k < k_end; k++) {
+            auto w = weight_at<Bits>(w_row, k);
+            for (size_t r = 0; r < Rows; r++)
+                tail[r] += input[r * k_size + k] * w;
+        }
+
+        auto scale = *scales++;
+        auto scale_v = _mm256_set1_ps(scale);
+        for (size_t r = 0; r < Rows; r++) {
+            sum[r] = _mm256_comp_fmadd_ps(acc[r], scale_v, sum[r]);
+            tail_sum[r] += tail[r] * scale;
+        }
+    }
+
+    for (size_t r = 0; r < Rows; r++)
+        output[r * out_channels] = reduce_sum(sum[r]) + tail_sum[r];
+}
+
+template <int32_t Bits>
+void weight_only_matmul_impl(const float *input, const uint8_t *weights,
+                             const float *scales, float *output, size_t rows,
+                             size_t k_size, size_t out_channels,
+                             size_t group_size,
+                             NNCASE_UNUSED kernel_context &context) noexcept {
+    auto row_bytes = Bits == 4 ? (k_size + 1) / 2 : k_size;
+    auto groups = (k_size + group_size - 1) / group_size;
+
+    // Split on the output channels so every weight row is read by one thread.
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t n = 0; n < (int64_t)out_channels; n++) {
+        auto w_row = weights + n * row_bytes;
+        auto n_scales = scales + n * groups;
+        size_t m = 0;
+        for (; m + block_rows <= rows; m += block_rows) {
+            weight_only_micro_kernel<Bits, block_rows>(
+                input + m * k_size, w_row, n_scales,
+                output + m * out_channels + n, k_size, out_channels,
+                group_size);
+        }
+        for (; m < rows; m++) {
+            weight_only_micro_kernel<Bits, 1>(
+                input + m * k_size, w_row, n_scales,
+                output + m * out_channels + n, k_size, out_channels,
+                group_size);
+        }
+    }
+}
+#endif
+} // namespace
+
+result<void> optimized::weight_only_matmul(
+    const float *input, const gsl::byte *weights, const float *scales,
+    float *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, size_t out_channels, int32_t bits,
+    int32_t group_size, kernel_context &context) noexcept {
+#if __AVX__
+    // int4 groups must start at a byte boundary.
+    auto k_size = in_shape.back();
+    if (k_size && (bits == 8 || group_size % 2 == 0)) {
+        auto rows = compute_size(in_shape) / k_size;
+        auto w = reinterpret_cast<const uint8_t *>(weights);
+        if (bits == 8)
+            weight_only_matmul_impl<8>(input, w, scales, output, rows, k_size,
+                                       out_channels, group_size, context);
+        else
+            weight_only_matmul_impl<4>(input, w, scales, output, rows, k_size,
+                                       out_channels, group_size, context);
+        return ok();
+    }
+#endif
+    return reference::weight_only_matmul(input, weights, scales, output,
+                                         in_shape, in_strides, out_channels,
+                                         bits, group_size, context);
+}
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "../../reference/ref_ops.h"
+#include "../opt_fp16.h"
 #include "../opt_ops.h"
 #include "avx_mathfun.h"
 #include <iostream>
@@ -202,11 +203,8 @@ struct unary_op_tanh {
 };
 
 template <typename Top>
-result<void> optimized_unary_impl(const float *CXX_RESTRICT input,
-                                  float *CXX_RESTRICT output,
-                                  gsl::span<const size_t> shape) noexcept {
-    Top op;
-    size_t n = compute_size(shape);
+void optimized_unary_impl(Top &op, const float *CXX_RESTRICT input,
+                          float *CXX_RESTRICT output, size_t n) noexcept {
     size_t n8 = (n >> 3);
     size_t n8_left = n & (8 - 1);
     for (size_t i = 0; i < n8; i++) {
@@ -218,7 +216,22 @@ result<void> optimized_unary_impl(const float *CXX_RESTRICT input,
     for (size_t i = 0; i < n8_left; i++) {
         output[i] = op(input[i]);
     }
+}
 
+template <typename Top>
+result<void> optimized_unary_impl(typecode_t dtype, const gsl::byte *in,
+                                  gsl::byte *out,
+                                  gsl::span<const size_t> shape) noexcept {
+    Top op;
+    size_t n = compute_size(shape);
+    if (dtype == dt_float16) {
+        fp16_map(IN_CAST(half, in), OUT_CAST(half, out), n,
+                 [&](const float *input, float *output, size_t count) {
+                     optimized_unary_impl(op, input, output, count);
+                 });
+    } else {
+        optimized_unary_impl(op, IN_CAST(float, in), OUT_CAST(float, out), n);
+    }
     return ok();
 }
 
@@ -229,51 +242,52 @@ result<void> optimized::unary(typecode_t dtype, runtime::stackvm::unary_op_t op,
                               gsl::span<const size_t> out_shape,
                               gsl::span<const size_t> out_strides,
                               kernel_context &context) noexcept {
-    auto *input = IN_CAST(float, in);
-    auto *output = OUT_CAST(float, out);
+    if (dtype != dt_float32 && dtype != dt_float16)
+        return stackvm::reference::unary(dtype, op, in, out, shape, in_strides,
+                                         out_shape, out_strides, context);
 
     switch (op) {
     case unary_op_t::abs: {
-        return optimized_unary_impl<unary_op_abs>(input, output, shape);
+        return optimized_unary_impl<unary_op_abs>(dtype, in, out, shape);
     }
     case unary_op_t::ceil: {
-        return optimized_unary_impl<unary_op_ceil>(input, output, shape);
+        return optimized_unary_impl<unary_op_ceil>(dtype, in, out, shape);
     }
     case unary_op_t::cos: {
-        return optimized_unary_impl<unary_op_cos>(input, output, shape);
+        return optimized_unary_impl<unary_op_cos>(dtype, in, out, shape);
     }
     case unary_op_t::exp: {
-        return optimized_unary_impl<unary_op_exp>(input, output, shape);
+        return optimized_unary_impl<unary_op_exp>(dtype, in, out, shape);
     }
     case unary_op_t::floor: {
-        return optimized_unary_impl<unary_op_floor>(input, output, shape);
+        return optimized_unary_impl<unary_op_floor>(dtype, in, out, shape);
     }
     case unary_op_t::log: {
-        return optimized_unary_impl<unary_op_log>(input, output, shape);
+        return optimized_unary_impl<unary_op_log>(dtype, in, out, shape);
     }
     case unary_op_t::neg: {
-        return optimized_unary_impl<unary_op_neg>(input, output, shape);
+        return optimized_unary_impl<unary_op_neg>(dtype, in, out, shape);
     }
     case unary_op_t::round: {
-        return optimized_unary_impl<unary_op_round>(input, output, shape);
+        return optimized_unary_impl<unary_op_round>(dtype, in, out, shape);
     }
     case unary_op_t::rsqrt: {
-        return optimized_unary_impl<unary_op_rsqrt>(input, output, shape);
+        return optimized_unary_impl<unary_op_rsqrt>(dtype, in, out, shape);
     }
     case unary_op_t::sign: {
-        return optimized_unary_impl<unary_op_sign>(input, output, shape);
+        return optimized_unary_impl<unary_op_sign>(dtype, in, out, shape);
     }
     case unary_op_t::sin: {
-        return optimized_unary_impl<unary_op_sin>(input, output, shape);
+        return optimized_unary_impl<unary_op_sin>(dtype, in, out, shape);
     }
     case unary_op_t::sqrt: {
-        return optimized_unary_impl<unary_op_sqrt>(input, output, shape);
+        return optimized_unary_impl<unary_op_sqrt>(dtype, in, out, shape);
     }
     case unary_op_t::square: {
-        return optimized_unary_impl<unary_op_square>(input, output, shape);
+        return optimized_unary_impl<unary_op_square>(dtype, in, out, shape);
     }
     case unary_op_t::tanh: {
-        return optimized_unary_impl<unary_op_tanh>(input, output, shape);
+        return optimized_unary_impl<unary_op_tanh>(dtype, in, out, shape);
     }
     default:
         return stackvm::reference::unary(dtype, op, in, out, shape, in_strides,
@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "../optimized/opt_ops.h"
 #include "../shape_infer.h"
 #include "ref_ops.h"
 #include <nncase/kernels/kernel_utils.h>
@@ -83,13 +84,12 @@ batch_to_space_impl(const T *input, T *output, gsl::span<const size_t> in_shape,
                                    block_shape, crops, in_strides,             \
                                    out_strides, context)
 
-result<void>
-batch_to_space_impl(datatype_t type, const gsl::byte *input, gsl::byte *output,
-                    gsl::span<const size_t> in_shape,
-                    gsl::span<const size_t> block_shape,
-                    const paddings_t &crops, gsl::span<const size_t> in_strides,
-                    gsl::span<const size_t> out_strides,
-                    NNCASE_UNUSED kernel_context &context) noexcept {
+result<void> nncase::kernels::stackvm::reference::batch_to_space(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &crops, gsl::span<const size_t> in_strides,
+    NNCASE_UNUSED gsl::span<const size_t> out_shape,
+    gsl::span<const size_t> out_strides, kernel_context &context) noexcept {
     switch (runtime::get_bytes(type)) {
         BATCH_TO_SPACE_IMPL(1, uint8_t);
         BATCH_TO_SPACE_IMPL(2, uint16_t);
@@ -141,9 +141,9 @@ result<value_t> kernels::stackvm::batch_to_space(value_t input,
     auto out_shape =
         infer_shape(input_tensor->shape(), block_shape_value, crops_value);
     try_output(out_mem, output, dtype, out_shape);
-    try_(batch_to_space_impl(dtype, input_mem, out_mem, input_tensor->shape(),
-                             block_shape_value, crops_value,
-                             input_tensor->strides(), output_tensor->strides(),
-                             context));
+    CONTIGUOUS_KERNEL(batch_to_space, input_tensor, dtype, input_mem, out_mem,
+                      input_tensor->shape(), block_shape_value, crops_value,
+                      input_tensor->strides(), output_tensor->shape(),
+                      output_tensor->strides(), context);
     return ok(output);
 }
@@ -61,6 +61,7 @@ result<void> nncase::kernels::stackvm::reference::batchnorm(
     const gsl::byte *bias, const gsl::byte *input_mean,
     const gsl::byte *input_var, gsl::byte *output,
     gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
-    gsl::span<const size_t> out_strides, float epsilon) {
+    gsl::span<const size_t> out_strides, float epsilon,
+    NNCASE_UNUSED kernel_context &context) {
     TYPE_SELECT(typecode, BATCHNORM_IMPL);
 }
\ No newline at end of file
@@ -12,9 +12,9 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-#include <nncase/kernels/apply.h>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
+#include <nncase/kernels/strided_apply.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/host_buffer.h>
 #include <nncase/runtime/runtime_op_utility.h>
@@ -27,62 +27,66 @@ using namespace nncase::kernels;
 using namespace nncase::kernels::stackvm;
 
 namespace {
-#define SCALAR_CAST_IMPL(f)                                                    \
-    if (is_scalar(in_shape)) {                                                 \
-        output[0] = f(input[0]);                                               \
-        return ok();                                                           \
-    }
+template <class TInput, class TOutput, class TConvert>
+result<void> cast_strided(const TInput *input, TOutput *output,
+                          gsl::span<const size_t> in_shape,
+                          gsl::span<const size_t> in_strides,
+                          gsl::span<const size_t> out_strides,
+                          TConvert &&convert,
+                          kernel_context &context) noexcept {
+    strided_plan<2> plan(in_shape, {out_strides, in_strides});
+    strided_apply(
+        plan,
+        [&](const strided_run<2> &run) {
+            auto out = output + run.offsets[0];
+            auto in = input + run.offsets[1];
+            if (run.contiguous()) {
+                for (size_t i = 0; i < run.count; i++)
+                    out[i] = convert(in[i]);
+            } else {
+                for (size_t i = 0; i < run.count; i++)
+                    out[i * run.strides[0]] = convert(in[i * run.strides[1]]);
+            }
+        },
+        context);
+    return ok();
+}
 
 template <class TInput, class TOutput>
 result<void> cast_impl(const TInput *input, TOutput *output,
                        gsl::span<const size_t> in_shape,
                        gsl::span<const size_t> in_strides,
                        gsl::span<const size_t> out_strides,
-                       NNCASE_UNUSED kernel_context &context) noexcept {
-    SCALAR_CAST_IMPL(static_cast<TOutput>);
-    return apply(in_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        auto value = input[offset(in_strides, index)];
-        output[offset(out_strides, index)] = static_cast<TOutput>(value);
-        return ok();
-    });
+                       kernel_context &context) noexcept {
+    return cast_strided(
+        input, output, in_shape, in_strides, out_strides,
+        [](TInput value) { return static_cast<TOutput>(value); }, context);
 }
 
-result<void> cast_f32_to_bf16_impl(
-    const float *input, bfloat16 *output, gsl::span<const size_t> in_shape,
-    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
-    NNCASE_UNUSED kernel_context &context) noexcept {
-    SCALAR_CAST_IMPL(bfloat16::round_to_bfloat16);
-    return apply(in_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        auto value = input[offset(in_strides, index)];
-        output[offset(out_strides, index)] = bfloat16::round_to_bfloat16(value);
-        return ok();
-    });
+result<void> cast_f32_to_bf16_impl(const float *input, bfloat16 *output,
+                                   gsl::span<const size_t> in_shape,
+                                   gsl::span<const size_t> in_strides,
+                                   gsl::span<const size_t> out_strides,
+                                   kernel_context &context) noexcept {
+    return cast_strided(input, output, in_shape, in_strides, out_strides,
+                        bfloat16::round_to_bfloat16, context);
 }
 
-result<void> cast_f32_to_fp16_impl(
-    const float *input, half *output, gsl::span<const size_t> in_shape,
-    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
-    NNCASE_UNUSED kernel_context &context) noexcept {
-    SCALAR_CAST_IMPL(half::round_to_half);
-    return apply(in_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        auto value = input[offset(in_strides, index)];
-        output[offset(out_strides, index)] = half::round_to_half(value);
-        return ok();
-    });
+result<void> cast_f32_to_fp16_impl(const float *input, half *output,
+                                   gsl::span<const size_t> in_shape,
+                                   gsl::span<const size_t> in_strides,
+                                   gsl::span<const size_t> out_strides,
+                                   kernel_context &context) noexcept {
+    return cast_strided(input, output, in_shape, in_strides, out_strides,
+                        half::round_to_half, context);
 }
 } // namespace
 
 #define CAST_IMPL_LV2(input_t, output_t)                                       \
     if (cmp_type<output_t>(out_type)) {                                        \
-        if (contiguous) {                                                      \
-            return cast_impl(reinterpret_cast<const input_t *>(input),         \
-                             reinterpret_cast<output_t *>(output), in_shape,   \
-                             in_strides, out_strides, context);                \
-        } else {                                                               \
-            return cast_impl(reinterpret_cast<const input_t *>(input),         \
-                             reinterpret_cast<output_t *>(output), in_shape,   \
-                             in_strides, out_strides, context);                \
-        }                                                                      \
+        return cast_impl(reinterpret_cast<const input_t *>(input),             \
+                         reinterpret_cast<output_t *>(output), in_shape,       \
+                         in_strides, out_strides, context);                    \
     }
 
 #define CAST_IMPL_LV1(input_t)                                                 \
@@ -114,7 +118,6 @@ result<void> cast_impl(datatype_t in_type, datatype_t out_type,
         return cast_f32_to_fp16_impl(reinterpret_cast<const float *>(input),
                                      reinterpret_cast<half *>(output), in_shape,
                                      in_strides, out_strides, context);
-    bool contiguous = is_contiguous(in_shape, in_strides);
     CAST_IMPL_LV1(bool);
     CAST_IMPL_LV1(uint8_t);
     CAST_IMPL_LV1(uint16_t);
@@ -14,6 +14,7 @@
  */
 #include "ref_ops.h"
 #include <nncase/kernels/kernel_utils.h>
+#include <nncase/kernels/strided_apply.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/host_buffer.h>
 #include <nncase/runtime/runtime_op_utility.h>
@@ -31,14 +32,29 @@ result<void> clamp_impl(const T *input, T min, T max, T *output,
                         gsl::span<const size_t> in_shape,
                         gsl::span<const size_t> in_strides,
                         gsl::span<const size_t> out_strides,
-                        NNCASE_UNUSED kernel_context &context) {
-    return apply(in_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        const auto v = input[offset(index, in_strides)];
-        output[offset(index, out_strides)] = static_cast<T>(
-            std::min(std::max(static_cast<float>(v), static_cast<float>(min)),
-                     static_cast<float>(max)));
-        return ok();
-    });
+                        kernel_context &context) {
+    auto low = static_cast<float>(min);
+    auto high = static_cast<float>(max);
+    auto clamp = [=](T v) {
+        return static_cast<T>(
+            std::min(std::max(static_cast<float>(v), low), high));
+    };
+    strided_plan<2> plan(in_shape, {out_strides, in_strides});
+    strided_apply(
+        plan,
+        [&](const strided_run<2> &run) {
+            auto out = output + run.offsets[0];
+            auto in = input + run.offsets[1];
+            if (run.contiguous()) {
+                for (size_t i = 0; i < run.count; i++)
+                    out[i] = clamp(in[i]);
+            } else {
+                for (size_t i = 0; i < run.count; i++)
+                    out[i * run.strides[0]] = clamp(in[i * run.strides[1]]);
+            }
+        },
+        context);
+    return ok();
 }
 } // namespace
 
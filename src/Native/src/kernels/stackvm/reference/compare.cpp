@@ -12,9 +12,9 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-#include <nncase/kernels/apply.h>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
+#include <nncase/kernels/strided_apply.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/util.h>
 
@@ -32,24 +32,41 @@ result<void> compare_impl(TOp &&op, const T *input_a, const T *input_b,
                           gsl::span<const size_t> in_b_shape,
                           gsl::span<const size_t> in_b_strides,
                           gsl::span<const size_t> out_shape,
-                          gsl::span<const size_t> out_strides) noexcept {
-    return apply(out_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        const auto in_a_index =
-            kernels::detail::get_reduced_offset(index, in_a_shape);
-        const auto in_b_index =
-            kernels::detail::get_reduced_offset(index, in_b_shape);
-        const auto a = input_a[offset(in_a_strides, in_a_index)];
-        const auto b = input_b[offset(in_b_strides, in_b_index)];
-        output[offset(out_strides, index)] = static_cast<bool>(op(a, b));
-        return ok();
-    });
+                          gsl::span<const size_t> out_strides,
+                          kernel_context &context) noexcept {
+    auto plan = strided_plan<3>::broadcast(
+        out_shape, {out_shape, in_a_shape, in_b_shape},
+        {out_strides, in_a_strides, in_b_strides});
+    strided_apply(
+        plan,
+        [&](const strided_run<3> &run) {
+            auto out = output + run.offsets[0];
+            auto a = input_a + run.offsets[1];
+            auto b = input_b + run.offsets[2];
+            auto &s = run.strides;
+            if (run.contiguous()) {
+                for (size_t i = 0; i < run.count; i++)
+                    out[i] = static_cast<bool>(op(a[i], b[i]));
+            } else if (s[0] == 1 && s[1] == 1 && s[2] == 0) {
+                auto value = *b;
+                for (size_t i = 0; i < run.count; i++)
+                    out[i] = static_cast<bool>(op(a[i], value));
+            } else {
+                for (size_t i = 0; i < run.count; i++)
+                    out[i * s[0]] =
+                        static_cast<bool>(op(a[i * s[1]], b[i * s[2]]));
+            }
+        },
+        context);
+    return ok();
 }
 } // namespace
 
 #define COMPARE_IMPL_OP(op, funct)                                             \
     case compare_op_t::op:                                                     \
         return compare_impl(funct, lhs, rhs, output, lhs_shape, lhs_strides,   \
-                            rhs_shape, rhs_strides, out_shape, out_strides)
+                            rhs_shape, rhs_strides, out_shape, out_strides,    \
+                            context)
 
 template <typename T>
 result<void> compare_impl(compare_op_t op, const T *lhs, const T *rhs,
@@ -58,7 +75,8 @@ result<void> compare_impl(compare_op_t op, const T *lhs, const T *rhs,
                           gsl::span<const size_t> rhs_shape,
                           gsl::span<const size_t> rhs_strides,
                           gsl::span<const size_t> out_shape,
-                          gsl::span<const size_t> out_strides) noexcept {
+                          gsl::span<const size_t> out_strides,
+                          kernel_context &context) noexcept {
     switch (op) {
         COMPARE_IMPL_OP(equal, std::equal_to<T>());
         COMPARE_IMPL_OP(not_equal, std::not_equal_to<T>());
@@ -74,7 +92,8 @@ result<void> compare_impl(compare_op_t op, const T *lhs, const T *rhs,
 #define COMPARE_IMPL(_ty)                                                      \
     return compare_impl(op, IN_CAST(_ty, lhs), IN_CAST(_ty, rhs),              \
                         OUT_CAST(bool, output), lhs_shape, lhs_strides,        \
-                        rhs_shape, rhs_strides, out_shape, out_strides);
+                        rhs_shape, rhs_strides, out_shape, out_strides,        \
+                        context);
 
 result<void> compare_impl(typecode_t typecode, compare_op_t op,
                           const gsl::byte *lhs, const gsl::byte *rhs,
@@ -84,14 +103,14 @@ result<void> compare_impl(typecode_t typecode, compare_op_t op,
                           gsl::span<const size_t> rhs_strides,
                           gsl::span<const size_t> out_shape,
                           gsl::span<const size_t> out_strides,
-                          NNCASE_UNUSED kernel_context &context) noexcept {
+                          kernel_context &context) noexcept {
     TYPE_SELECT(typecode, COMPARE_IMPL);
 }
 
 result<value_t>
 kernels::stackvm::compare(compare_op_t compare_op, value_t lhs, value_t rhs,
                           value_t output,
-                          [[maybe_unused]] kernel_context &context) {
+                          kernel_context &context) {
     try_input(lhs_mem, lhs);
     try_input(rhs_mem, rhs);
     if (!cmp_dt(lhs_tensor, rhs_tensor)) {
@@ -149,7 +149,7 @@ result<void> conv2d_transpose_impl(
     gsl::span<const size_t> out_shape, int32_t filter_h, int32_t filter_w,
     int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
     const padding &padding_h, const padding &padding_w,
-    [[maybe_unused]] const value_range<float> &fused_activation) noexcept {
+    const value_range<float> &fused_activation) noexcept {
     auto output_size = runtime::compute_size(out_shape);
     std::fill(output, output + output_size, 0.f);
     const auto g_ic = in_shape[1] / groups;
@@ -218,17 +218,12 @@ result<void> conv2d_transpose_impl(
         }
     }
 
-    // bias
+    // bias and fused clamp
     auto hw = out_shape[2] * out_shape[3];
     for (size_t i = 0; i < output_size; i++)
-        output[i] += bias[i / hw % out_shape[1]];
-
-    //    if (fused_activation != value_range<float>::full())
-    //    {
-    //        for (size_t i = 0; i < output_size; i++)
-    //            output[i] = detail::apply_activation(output[i],
-    //            fused_activation);
-    //    }
+        output[i] = kernels::detail::clamp(
+            (T)(output[i] + bias[i / hw % out_shape[1]]),
+            (T)fused_activation.min, (T)fused_activation.max);
     return ok();
 }
 
@@ -260,6 +255,7 @@ result<void> nncase::kernels::stackvm::reference::conv2d_transpose(
     gsl::span<const size_t> out_shape, int32_t filter_h, int32_t filter_w,
     int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
     const padding &padding_h, const padding &padding_w,
-    [[maybe_unused]] const value_range<float> &fused_activation) noexcept {
+    const value_range<float> &fused_activation,
+    NNCASE_UNUSED kernel_context &context) noexcept {
     TYPE_SELECT_CONV_TRANSPOSE(typecode, CONV2D_TRANSPOSE_IMPL);
 }
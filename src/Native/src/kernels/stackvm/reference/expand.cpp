@@ -14,6 +14,7 @@
  */
 #include "ref_ops.h"
 #include <nncase/kernels/kernel_utils.h>
+#include <nncase/kernels/strided_apply.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/host_buffer.h>
 #include <nncase/runtime/runtime_op_utility.h>
@@ -32,14 +33,25 @@ result<void> expand_impl(const T *input, T *output,
                          gsl::span<const size_t> input_strides,
                          gsl::span<const size_t> out_shape,
                          gsl::span<const size_t> out_strides,
-                         NNCASE_UNUSED kernel_context &context) noexcept {
-    return apply(out_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        const auto in_index =
-            kernels::detail::get_reduced_offset(index, in_shape);
-        output[offset(out_strides, index)] =
-            input[offset(input_strides, in_index)];
-        return ok();
-    });
+                         kernel_context &context) noexcept {
+    auto plan = strided_plan<2>::broadcast(out_shape, {out_shape, in_shape},
+                                           {out_strides, input_strides});
+    strided_apply(
+        plan,
+        [&](const strided_run<2> &run) {
+            auto out = output + run.offsets[0];
+            auto in = input + run.offsets[1];
+            if (run.strides[0] == 1 && run.strides[1] == 0) {
+                std::fill_n(out, run.count, *in);
+            } else if (run.contiguous()) {
+                std::copy_n(in, run.count, out);
+            } else {
+                for (size_t i = 0; i < run.count; i++)
+                    out[i * run.strides[0]] = in[i * run.strides[1]];
+            }
+        },
+        context);
+    return ok();
 }
 
 #define EXPAND_IMPL(size, type)                                                \
@@ -54,7 +66,7 @@ result<void> nncase::kernels::stackvm::reference::expand(
     typecode_t typecode, const gsl::byte *input, gsl::byte *output,
     gsl::span<const size_t> input_shape, gsl::span<const size_t> input_strides,
     gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
-    NNCASE_UNUSED kernel_context &context) noexcept {
+    kernel_context &context) noexcept {
     switch (typecode_bytes(typecode)) {
         EXPAND_IMPL(1, uint8_t);
         EXPAND_IMPL(2, uint16_t);
@@ -12,6 +12,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "../optimized/opt_ops.h"
+#include "ref_ops.h"
 #include <cstring>
 #include <limits>
 #include <nncase/kernels/apply.h>
@@ -78,21 +80,23 @@ result<void> hardmax_impl(const T *input, gsl::span<const size_t> in_shape,
     return hardmax_impl(IN_CAST(_ty, input), in_shape, in_strides,             \
                         OUT_CAST(_ty, output), axis);
 
-result<void> hardmax_impl(typecode_t typecode, const gsl::byte *input,
-                          gsl::span<const size_t> in_shape,
-                          gsl::span<const size_t> in_strides, gsl::byte *output,
-                          int32_t axis) noexcept {
-    TYPE_SELECT(typecode, HARDMAX_IMPL)} // namespace
+result<void> nncase::kernels::stackvm::reference::hardmax(
+    typecode_t typecode, const gsl::byte *input,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::byte *output, int32_t axis,
+    NNCASE_UNUSED kernel_context &context) noexcept {
+    TYPE_SELECT(typecode, HARDMAX_IMPL)
+}
 
 result<value_t> nncase::kernels::stackvm::hardmax(
-    value_t input, value_t axis, value_t output,
-    [[maybe_unused]] kernel_context &context) {
+    value_t input, value_t axis, value_t output, kernel_context &context) {
     try_input(input_mem, input);
     try_output(out_mem, output, input_tensor->dtype(), input_tensor->shape());
     try_positive_axis(axis_value, axis, input_tensor);
     try_typecode(typecode, input_tensor);
-    try_(hardmax_impl(typecode, input_mem, input_tensor->shape(),
-                      input_tensor->strides(), out_mem, axis_value));
+    CONTIGUOUS_KERNEL(hardmax, input_tensor, typecode, input_mem,
+                      input_tensor->shape(), input_tensor->strides(), out_mem,
+                      axis_value, context);
 
     return ok(output);
 }
@@ -14,6 +14,7 @@
  */
 #pragma once
 
+#include "../optimized/opt_ops.h"
 #include <nncase/runtime/util.h>
 
 #define UNARY_IMPL_TEMPLATE(_name, _compute)                                   \
@@ -49,6 +50,17 @@
         return ok();                                                           \
     }
 
+// Contiguous float tensors go to the vectorized optimized::activation
+#define ACTIVATION_OPT_DISPTCH(_name, _alpha_mem, _gamma_mem)                  \
+    if ((typecode == dt_float32 || typecode == dt_float16) &&                  \
+        is_contiguous(input_tensor) && is_contiguous(output_tensor)) {         \
+        try_(optimized::activation(                                            \
+            optimized::activation_op_t::_name, typecode, input_mem,            \
+            output_mem, compute_size(input_tensor->shape()), _alpha_mem,       \
+            _gamma_mem, context));                                             \
+        return ok(output);                                                     \
+    }
+
 #define UNARY_OP_TEMPLATE(_name)                                               \
     result<value_t> nncase::kernels::stackvm::_name(                           \
         value_t input, value_t output, kernel_context &context) {              \
@@ -56,6 +68,7 @@
         auto dtype = input_tensor->dtype();                                    \
         try_output_like_input(output_mem, output, input_tensor);               \
         try_var(typecode, to_typecode(input_tensor->dtype()));                 \
+        ACTIVATION_OPT_DISPTCH(_name, nullptr, nullptr);                       \
         if (is_contiguous(input_tensor)) {                                     \
             try_(UNARY_WITH_DISPTCH(_name##_opt_impl));                        \
         } else {                                                               \
@@ -234,6 +247,7 @@
         auto dtype = input_tensor->dtype();                                    \
         try_output_like_input(output_mem, output, input_tensor);               \
         try_var(typecode, to_typecode(input_tensor->dtype()));                 \
+        ACTIVATION_OPT_DISPTCH(_name, _alpha_name_mem, nullptr);               \
         if (is_contiguous(input_tensor)) {                                     \
             try_(UNARY_WITH_MUL_DISPTCH(_name##_contiguous_impl));             \
         } else {                                                               \
@@ -384,6 +398,7 @@
         try_input(_gamma_name_mem, _gamma_name);                               \
         try_var(typecode, to_typecode(input_tensor->dtype()));                 \
         try_output_like_input(output_mem, output, input_tensor);               \
+        ACTIVATION_OPT_DISPTCH(_name, _alpha_name_mem, _gamma_name_mem);       \
         try_(UNARY_WITH_DISPTCH_V2(_name##_impl));                             \
         return ok(output);                                                     \
     }
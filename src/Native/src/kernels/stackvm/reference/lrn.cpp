@@ -60,13 +60,15 @@ result<void> lrn_impl2(typecode_t type, const T *input, float alpha, float beta,
         type, runtime::stackvm::unary_op_t::square, IN_BYTE_CAST(input),
         OUT_BYTE_CAST(square_data.get()), in_shape, in_strides, in_shape,
         in_strides));
+    // The window of channel i is [i - floor((size - 1) / 2),
+    // i + ceil((size - 1) / 2)], wider after the channel for even sizes
+    const auto before = static_cast<int64_t>(std::floor((size - 1) / 2.0));
+    const auto after = static_cast<int64_t>(std::ceil((size - 1) / 2.0));
     for (size_t i = 0; i < in_shape[1]; ++i) {
-        auto beginV =
-            std::max(static_cast<int64_t>(0),
-                     static_cast<int64_t>(i - std::floor((size - 1) / 2)));
-        auto endV =
-            std::min(static_cast<int64_t>(in_shape[1] - 1),
-                     static_cast<int64_t>(i + std::ceil((size - 1) / 2)));
+        auto beginV = std::max(static_cast<int64_t>(0),
+                               static_cast<int64_t>(i) - before);
+        auto endV = std::min(static_cast<int64_t>(in_shape[1] - 1),
+                             static_cast<int64_t>(i) + after);
         auto begins = axes_t{0, (int64_t)beginV, 0, 0};
         auto ends = axes_t{static_cast<int64_t>(in_shape[0]),
                            static_cast<int64_t>(endV + 1),
@@ -79,7 +81,7 @@ result<void> lrn_impl2(typecode_t type, const T *input, float alpha, float beta,
             std::make_unique<T[]>(runtime::compute_size(tmp_out_shape));
         try_(slice(type, IN_BYTE_CAST(square_data.get()),
                    OUT_CAST(gsl::byte, slice_out.get()), in_shape, in_strides,
-                   out_strides, begins, ends, strides,
+                   tmp_out_strides, begins, ends, strides,
                    default_kernel_context()));
 
         auto keep_dims = true;
@@ -141,6 +143,7 @@ result<void> lrn_impl2(typecode_t type, const T *input, float alpha, float beta,
 result<void> nncase::kernels::stackvm::reference::lrn(
     typecode_t typecode, const gsl::byte *input, float alpha, float beta,
     float bias, int size, gsl::byte *output, gsl::span<const size_t> in_shape,
-    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides) {
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    NNCASE_UNUSED kernel_context &context) {
     TYPE_SELECT_LRN(typecode, LRN_IMPL)
 }
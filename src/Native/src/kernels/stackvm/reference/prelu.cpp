@@ -14,6 +14,7 @@
  */
 #include "ref_ops.h"
 #include <nncase/kernels/kernel_utils.h>
+#include <nncase/kernels/strided_apply.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/host_buffer.h>
 #include <nncase/runtime/runtime_op_utility.h>
@@ -33,18 +34,32 @@ result<void> prelu_impl(const T *input, const T *slope_mem, T *output,
                         gsl::span<const size_t> slope_strides,
                         gsl::span<const size_t> out_shape,
                         gsl::span<const size_t> out_strides,
-                        NNCASE_UNUSED kernel_context &context) {
-    return apply(out_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        const auto in_index =
-            kernels::detail::get_reduced_offset(index, in_shape);
-        const auto slope_index =
-            kernels::detail::get_reduced_offset(index, slope_shape);
-        const auto slope = slope_mem[offset(slope_strides, slope_index)];
-        const auto x = input[offset(input_strides, in_index)];
-        output[offset(out_strides, index)] =
-            x < static_cast<T>(0) ? slope * x : x;
-        return ok();
-    });
+                        kernel_context &context) {
+    auto plan = strided_plan<3>::broadcast(
+        out_shape, {out_shape, in_shape, slope_shape},
+        {out_strides, input_strides, slope_strides});
+    strided_apply(
+        plan,
+        [&](const strided_run<3> &run) {
+            auto out = output + run.offsets[0];
+            auto in = input + run.offsets[1];
+            auto slope = slope_mem + run.offsets[2];
+            auto &s = run.strides;
+            if (s[0] == 1 && s[1] == 1 && s[2] == 0) {
+                // Per channel slope, constant along the run
+                auto k = *slope;
+                for (size_t i = 0; i < run.count; i++)
+                    out[i] = in[i] < static_cast<T>(0) ? k * in[i] : in[i];
+            } else {
+                for (size_t i = 0; i < run.count; i++) {
+                    auto x = in[i * s[1]];
+                    out[i * s[0]] =
+                        x < static_cast<T>(0) ? slope[i * s[2]] * x : x;
+                }
+            }
+        },
+        context);
+    return ok();
 }
 
 #define PRELU_IMPL(type)                                                       \
@@ -88,7 +103,6 @@ result<void> nncase::kernels::stackvm::reference::prelu(
     gsl::byte *output, gsl::span<const size_t> in_shape,
     gsl::span<const size_t> input_strides, gsl::span<const size_t> slope_shape,
     gsl::span<const size_t> slope_strides, gsl::span<const size_t> out_shape,
-    gsl::span<const size_t> out_strides,
-    NNCASE_UNUSED kernel_context &context) {
+    gsl::span<const size_t> out_strides, kernel_context &context) {
     TYPE_SELECT_PRELU(typecode, PRELU_IMPL);
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "ref_ops.h"
 #include <limits>
 #include <nncase/kernels/apply.h>
 #include <nncase/kernels/kernel_utils.h>
@@ -115,7 +116,7 @@ result<void> reduce_arg_impl(TReducer &&reducer, T init_value, const T *input,
         }                                                                      \
     }
 
-result<void> reduce_arg_impl(
+result<void> nncase::kernels::stackvm::reference::reduce_arg(
     typecode_t input_typecode, typecode_t output_typecode, reduce_arg_op_t op,
     const gsl::byte *input, gsl::byte *output, gsl::span<const size_t> in_shape,
     gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
@@ -123,35 +124,3 @@ result<void> reduce_arg_impl(
     kernel_context &context) noexcept {
     TYPE_SELECT(input_typecode, REDUCE_ARG_IMPL);
 }
-
-dims_t infer_shape(gsl::span<const size_t> in_shape, int32_t axis,
-                   bool keep_dims) {
-    dims_t new_shape(in_shape);
-    if (keep_dims) {
-        new_shape[axis] = 1;
-    } else {
-        new_shape.erase(new_shape.begin() + axis);
-    }
-    return new_shape;
-}
-
-result<value_t> nncase::kernels::stackvm::reduce_arg(
-    reduce_arg_op_t reduce_arg_op, typecode_t dest_type, value_t input,
-    value_t axis, value_t keep_dims, value_t select_last_index, value_t output,
-    kernel_context &context) {
-    try_input(in_mem, input);
-    try_typecode(input_typecode, input_tensor);
-    try_positive_axis(axis_value, axis, input_tensor);
-    try_to_scalar(keep_dims_value, keep_dims, bool);
-    try_to_scalar(select_last_index_value, select_last_index, bool);
-    auto out_shape =
-        infer_shape(input_tensor->shape(), axis_value, keep_dims_value);
-    try_output(out_mem, output, dest_type, out_shape);
-    auto axes = dims_t{axis_value};
-    try_(reduce_arg_impl(input_typecode, dest_type, reduce_arg_op, in_mem,
-                         out_mem, input_tensor->shape(),
-                         input_tensor->strides(), output_tensor->strides(),
-                         axes, keep_dims_value, select_last_index_value,
-                         context));
-    return ok(output);
-}
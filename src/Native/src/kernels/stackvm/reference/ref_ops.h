@@ -34,7 +34,8 @@ batchnorm(typecode_t typecode, const gsl::byte *input, const gsl::byte *scale,
           const gsl::byte *bias, const gsl::byte *input_mean,
           const gsl::byte *input_var, gsl::byte *output,
           gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
-          gsl::span<const size_t> out_strides, float epsilon);
+          gsl::span<const size_t> out_strides, float epsilon,
+          kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void> layer_norm(typecode_t type, const gsl::byte *input,
                                    gsl::byte *output, const gsl::byte *scale,
@@ -47,6 +48,13 @@ batch_to_space(tensor input, tensor block_shape, tensor crops,
                tensor output = nullptr,
                kernel_context &context = default_kernel_context());
 
+NNCASE_API result<void> batch_to_space(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &crops, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
 NNCASE_API result<void> binary(
     typecode_t typecode, nncase::runtime::stackvm::binary_op_t op,
     const gsl::byte *lhs, const gsl::byte *rhs, gsl::byte *output,
@@ -73,7 +81,7 @@ NNCASE_API result<void> clamp(
     typecode_t type, const gsl::byte *input, const gsl::byte *min,
     const gsl::byte *max, gsl::byte *output, gsl::span<const size_t> in_shape,
     gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
-    NNCASE_UNUSED kernel_context &context = default_kernel_context()) noexcept;
+    kernel_context &context = default_kernel_context()) noexcept;
 
 NNCASE_API result<void> compare_impl(
     typecode_t typecode, nncase::runtime::stackvm::compare_op_t op,
@@ -81,7 +89,7 @@ NNCASE_API result<void> compare_impl(
     gsl::span<const size_t> lhs_shape, gsl::span<const size_t> lhs_strides,
     gsl::span<const size_t> rhs_shape, gsl::span<const size_t> rhs_strides,
     gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
-    NNCASE_UNUSED kernel_context &context = default_kernel_context()) noexcept;
+    kernel_context &context = default_kernel_context()) noexcept;
 
 NNCASE_API result<void>
 concat(datatype_t type, gsl::span<const gsl::byte *const> inputs,
@@ -112,12 +120,14 @@ NNCASE_API result<void> conv2d_transpose(
     gsl::span<const size_t> out_shape, int32_t filter_h, int32_t filter_w,
     int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
     const padding &padding_h, const padding &padding_w,
-    [[maybe_unused]] const value_range<float> &fused_activation) noexcept;
+    const value_range<float> &fused_activation,
+    NNCASE_UNUSED kernel_context &context = default_kernel_context()) noexcept;
 
-NNCASE_API result<void>
-cum_sum(tensor input, tensor axis, tensor exclusive, tensor reverse,
-        tensor output = nullptr,
-        kernel_context &context = default_kernel_context());
+NNCASE_API result<void> cumsum(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, int32_t axis, bool exclusive,
+    bool reverse,
+    NNCASE_UNUSED kernel_context &context = default_kernel_context()) noexcept;
 
 NNCASE_API result<void> dequantize(datatype_t in_type, datatype_t out_type,
                                    const gsl::byte *input, gsl::byte *output,
@@ -134,7 +144,7 @@ NNCASE_API result<void> expand(
     typecode_t typecode, const gsl::byte *input, gsl::byte *output,
     gsl::span<const size_t> input_shape, gsl::span<const size_t> input_strides,
     gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
-    NNCASE_UNUSED kernel_context &context = default_kernel_context()) noexcept;
+    kernel_context &context = default_kernel_context()) noexcept;
 
 NNCASE_API result<void>
 flatten(tensor input, tensor axis, tensor output = nullptr,
@@ -190,6 +200,12 @@ NNCASE_API result<void>
 hardmax(tensor input, tensor axis, tensor output = nullptr,
         kernel_context &context = default_kernel_context());
 
+NNCASE_API result<void>
+hardmax(typecode_t typecode, const gsl::byte *input,
+        gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+        gsl::byte *output, int32_t axis,
+        kernel_context &context = default_kernel_context()) noexcept;
+
 NNCASE_API result<void>
 instance_norm(typecode_t typecode, const gsl::byte *input,
               const gsl::byte *scale, const gsl::byte *bias, gsl::byte *output,
@@ -209,11 +225,11 @@ NNCASE_API result<void>
 lp_normalization(tensor input, tensor axis, tensor p, tensor output = nullptr,
                  kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void> lrn(typecode_t typecode, const gsl::byte *input,
-                            float alpha, float beta, float bias, int size,
-                            gsl::byte *output, gsl::span<const size_t> in_shape,
-                            gsl::span<const size_t> in_strides,
-                            gsl::span<const size_t> out_strides);
+NNCASE_API result<void>
+lrn(typecode_t typecode, const gsl::byte *input, float alpha, float beta,
+    float bias, int size, gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void>
 lstm(typecode_t typecode, const gsl::byte *input, const gsl::byte *w_xc,
@@ -315,6 +331,14 @@ reduce_arg(runtime::stackvm::reduce_arg_op_t reduce_arg_op, tensor input,
            tensor output = nullptr,
            kernel_context &context = default_kernel_context());
 
+NNCASE_API result<void> reduce_arg(
+    typecode_t input_typecode, typecode_t output_typecode,
+    runtime::stackvm::reduce_arg_op_t op, const gsl::byte *input,
+    gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    gsl::span<const size_t> axes, bool keep_dims, bool select_last_idx,
+    kernel_context &context = default_kernel_context()) noexcept;
+
 NNCASE_API result<void>
 reduce_window2d(runtime::stackvm::reduce_op_t reduce_op, tensor input,
                 tensor init_value, tensor filter, tensor stride, tensor padding,
@@ -443,7 +467,8 @@ NNCASE_API result<void>
 tile(datatype_t dt, const gsl::byte *input, gsl::byte *output,
      gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
      gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
-     gsl::span<const size_t> repeats);
+     gsl::span<const size_t> repeats,
+     kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void> topk(typecode_t typecode, const gsl::byte *input,
                              gsl::byte *output_values, int64_t *output_indices,
@@ -463,10 +488,11 @@ transpose(datatype_t type, const gsl::byte *src, gsl::byte *dest,
           gsl::span<const size_t> out_strides,
           kernel_context &context = default_kernel_context()) noexcept;
 
-NNCASE_API result<void>
-trilu(datatype_t type, const gsl::byte *input, gsl::byte *output,
-      gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
-      gsl::span<const size_t> out_strides, int64_t k, bool upper) noexcept;
+NNCASE_API result<void> trilu(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides, int64_t k, bool upper,
+    NNCASE_UNUSED kernel_context &context = default_kernel_context()) noexcept;
 
 NNCASE_API result<void>
 unary(typecode_t dtype, runtime::stackvm::unary_op_t op, const gsl::byte *input,
@@ -496,5 +522,20 @@ where(datatype_t dt, const bool *cond, const gsl::byte *x, const gsl::byte *y,
       gsl::span<const size_t> out_shape, gsl::span<const size_t> cond_strides,
       gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
       gsl::span<const size_t> out_strides);
+
+NNCASE_API result<void> variable_update(
+    datatype_t type, const gsl::byte *update, gsl::byte *state,
+    gsl::span<const size_t> update_shape,
+    gsl::span<const size_t> update_strides,
+    gsl::span<const size_t> state_shape, gsl::span<const size_t> state_strides,
+    size_t axis, size_t start,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> weight_only_matmul(
+    const float *input, const gsl::byte *weights, const float *scales,
+    float *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, size_t out_channels, int32_t bits,
+    int32_t group_size,
+    kernel_context &context = default_kernel_context()) noexcept;
 } // namespace reference
 END_NS_NNCASE_KERNELS_MODULE
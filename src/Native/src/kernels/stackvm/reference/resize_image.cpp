@@ -36,8 +36,6 @@ result<void> resize_bilinear_impl(
     auto height_scale = scales.first;
     auto width_scale = scales.second;
 
-    const float rounding_offset =
-        std::numeric_limits<T>::is_integer ? .5f : .0f;
     dims_t in_index(4), out_index(4);
 
     auto get_input = [&](int32_t in_y, int32_t in_x) {
@@ -78,8 +76,8 @@ result<void> resize_bilinear_impl(
                     auto a2 = (1 - (in_y - in_y0)) * (in_x - in_x0);
                     auto a3 = (in_y - in_y0) * (in_x - in_x0);
                     output[offset(out_strides, out_index)] =
-                        T(v0 * a0 + v1 * a1 + v2 * a2 + v3 * a3 +
-                          rounding_offset);
+                        kernels::detail::resize_round<T>(
+                            v0 * a0 + v1 * a1 + v2 * a2 + v3 * a3);
                 }
             }
         }
@@ -143,15 +141,19 @@ result<void> resize_nearest_neighbor_impl(
     case dt_float32:                                                           \
         return KERNEL(float);                                                  \
     case dt_int8:                                                              \
+        return KERNEL(int8_t);                                                 \
     case dt_uint8:                                                             \
         return KERNEL(uint8_t);                                                \
     case dt_int16:                                                             \
+        return KERNEL(int16_t);                                                \
     case dt_uint16:                                                            \
         return KERNEL(uint16_t);                                               \
     case dt_int32:                                                             \
+        return KERNEL(int32_t);                                                \
     case dt_uint32:                                                            \
         return KERNEL(uint32_t);                                               \
     case dt_int64:                                                             \
+        return KERNEL(int64_t);                                                \
     case dt_uint64:                                                            \
         return KERNEL(uint64_t);                                               \
     default:                                                                   \
@@ -54,7 +54,8 @@ trilu_impl(const T *input, T *output, gsl::span<const size_t> in_shape,
 result<void> nncase::kernels::stackvm::reference::trilu(
     datatype_t type, const gsl::byte *input, gsl::byte *output,
     gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
-    gsl::span<const size_t> out_strides, int64_t k, bool upper) noexcept {
+    gsl::span<const size_t> out_strides, int64_t k, bool upper,
+    NNCASE_UNUSED kernel_context &context) noexcept {
     switch (runtime::get_bytes(type)) {
         TRILU_IMPL(1, uint8_t);
         TRILU_IMPL(2, uint16_t);
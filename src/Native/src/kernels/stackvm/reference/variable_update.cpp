@@ -0,0 +1,65 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ref_ops.h"
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+
+namespace {
+template <class T>
+result<void> variable_update_impl(const T *update, T *state,
+                                  gsl::span<const size_t> update_shape,
+                                  gsl::span<const size_t> update_strides,
+                                  gsl::span<const size_t> state_strides,
+                                  size_t axis, size_t start) noexcept {
+    return apply(update_shape,
+                 [&](gsl::span<const size_t> index) -> result<void> {
+                     dims_t state_index(index.begin(), index.end());
+                     state_index[axis] += start;
+                     state[offset(state_strides, state_index)] =
+                         update[offset(update_strides, index)];
+                     return ok();
+                 });
+}
+} // namespace
+
+#define VARIABLE_UPDATE_IMPL(size, type)                                       \
+    case size:                                                                 \
+        return variable_update_impl(reinterpret_cast<const type *>(update),    \
+                                    reinterpret_cast<type *>(state),           \
+                                    update_shape, update_strides,              \
+                                    state_strides, axis, start)
+
+result<void> nncase::kernels::stackvm::reference::variable_update(
+    datatype_t type, const gsl::byte *update, gsl::byte *state,
+    gsl::span<const size_t> update_shape,
+    gsl::span<const size_t> update_strides,
+    NNCASE_UNUSED gsl::span<const size_t> state_shape,
+    gsl::span<const size_t> state_strides, size_t axis, size_t start,
+    NNCASE_UNUSED kernel_context &context) noexcept {
+    switch (runtime::get_bytes(type)) {
+        VARIABLE_UPDATE_IMPL(1, uint8_t);
+        VARIABLE_UPDATE_IMPL(2, uint16_t);
+        VARIABLE_UPDATE_IMPL(4, uint32_t);
+        VARIABLE_UPDATE_IMPL(8, uint64_t);
+    default:
+        return err(std::errc::not_supported);
+    }
+}
@@ -0,0 +1,70 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ref_ops.h"
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+
+namespace {
+// int8 weights are stored as is, int4 weights are packed two per byte with
+// the lower k in the low nibble.
+float weight_at(const uint8_t *row, int32_t bits, size_t k) noexcept {
+    if (bits == 8)
+        return (float)(int8_t)row[k];
+    int32_t nibble = (k & 1) ? row[k / 2] >> 4 : row[k / 2] & 0xF;
+    return (float)((nibble ^ 8) - 8);
+}
+} // namespace
+
+result<void> nncase::kernels::stackvm::reference::weight_only_matmul(
+    const float *input, const gsl::byte *weights, const float *scales,
+    float *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, size_t out_channels, int32_t bits,
+    int32_t group_size, NNCASE_UNUSED kernel_context &context) noexcept {
+    auto k_size = in_shape.back();
+    auto row_bytes = bits == 4 ? (k_size + 1) / 2 : k_size;
+    auto groups = ((int64_t)k_size + group_size - 1) / group_size;
+    auto w = reinterpret_cast<const uint8_t *>(weights);
+
+    dims_t rows_shape(in_shape.begin(), in_shape.end());
+    rows_shape.back() = 1;
+    gsl::span<const size_t> rows(rows_shape);
+    auto out_row = output;
+    return apply(rows, [&](gsl::span<const size_t> index) -> result<void> {
+        auto in_row = input + offset(in_strides, index);
+        for (size_t n = 0; n < out_channels; n++) {
+            auto w_row = w + n * row_bytes;
+            float sum = 0;
+            for (int64_t g = 0; g < groups; g++) {
+                auto k_begin = (size_t)(g * group_size);
+                auto k_end = std::min(k_begin + group_size, k_size);
+                float acc = 0;
+                for (auto k = k_begin; k < k_end; k++) {
+                    acc += in_row[k * in_strides.back()] *
+                           weight_at(w_row, bits, k);
+                }
+                sum += acc * scales[n * groups + g];
+            }
+            out_row[n] = sum;
+        }
+        out_row += out_channels;
+        return ok();
+    });
+}
@@ -14,6 +14,7 @@
  */
 #include "ref_ops.h"
 #include <nncase/kernels/kernel_utils.h>
+#include <nncase/kernels/strided_apply.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/datatypes.h>
 #include <nncase/runtime/host_buffer.h>
@@ -34,21 +35,24 @@ where_impl(const bool *cond, const T *x, const T *y, T *output,
            gsl::span<const size_t> cond_strides,
            gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
            gsl::span<const size_t> out_strides) {
-    return apply(out_shape, [&](const auto &index) -> result<void> {
-        const auto cond_index =
-            kernels::detail::get_reduced_offset(index, cond_shape);
-        const auto x_index =
-            kernels::detail::get_reduced_offset(index, x_shape);
-        const auto y_index =
-            kernels::detail::get_reduced_offset(index, y_shape);
-
-        const auto a = cond[offset(cond_strides, cond_index)];
-        const auto b = x[offset(x_strides, x_index)];
-        const auto c = y[offset(y_strides, y_index)];
-
-        output[offset(out_strides, index)] = a ? b : c;
-        return ok();
+    auto plan = strided_plan<4>::broadcast(
+        out_shape, {out_shape, cond_shape, x_shape, y_shape},
+        {out_strides, cond_strides, x_strides, y_strides});
+    strided_apply(plan, [&](const strided_run<4> &run) {
+        auto out = output + run.offsets[0];
+        auto c = cond + run.offsets[1];
+        auto a = x + run.offsets[2];
+        auto b = y + run.offsets[3];
+        if (run.contiguous()) {
+            for (size_t i = 0; i < run.count; i++)
+                out[i] = c[i] ? a[i] : b[i];
+        } else {
+            auto &s = run.strides;
+            for (size_t i = 0; i < run.count; i++)
+                out[i * s[0]] = c[i * s[1]] ? a[i * s[2]] : b[i * s[3]];
+        }
     });
+    return ok();
 }
 
 #define WHERE_IMPL(_ty)                                                        \
@@ -205,6 +205,17 @@ inline dims_t tile_infer_shape(gsl::span<const size_t> in_shape,
     return out_shape;
 }
 
+inline dims_t reduce_arg_infer_shape(gsl::span<const size_t> in_shape,
+                                     size_t axis, bool keep_dims) {
+    dims_t new_shape(in_shape);
+    if (keep_dims) {
+        new_shape[axis] = 1;
+    } else {
+        new_shape.erase(new_shape.begin() + axis);
+    }
+    return new_shape;
+}
+
 inline dims_t reduce_infer_shape(gsl::span<const size_t> in_shape,
                                  gsl::span<const size_t> axes, bool keep_dims) {
     dims_t tmp_shape(in_shape);
@@ -15,6 +15,7 @@
 #include "optimized/opt_ops.h"
 #include "reference/ref_ops.h"
 #include "shape_infer.h"
+#include <algorithm>
 #include <cstring>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
@@ -30,7 +31,7 @@ using namespace nncase::runtime::stackvm;
 result<value_t> nncase::kernels::stackvm::batch_normalization(
     value_t input, value_t scale, value_t bias, value_t input_mean,
     value_t input_var, value_t epsilon, [[maybe_unused]] value_t momentum,
-    value_t output, [[maybe_unused]] kernel_context &context) {
+    value_t output, kernel_context &context) {
     try_input(input_mem, input);
     try_input(scale_mem, scale);
     try_input(bias_mem, bias);
@@ -39,10 +40,10 @@ result<value_t> nncase::kernels::stackvm::batch_normalization(
     try_float_scalar(eps, epsilon);
     try_output_like_input(output_mem, output, input_tensor);
     try_typecode(typecode, input_tensor);
-    try_(reference::batchnorm(typecode, input_mem, scale_mem, bias_mem,
-                              mean_mem, var_mem, output_mem,
-                              input_tensor->shape(), input_tensor->strides(),
-                              output_tensor->strides(), eps));
+    CONTIGUOUS_KERNEL(batchnorm, input_tensor, typecode, input_mem, scale_mem,
+                      bias_mem, mean_mem, var_mem, output_mem,
+                      input_tensor->shape(), input_tensor->strides(),
+                      output_tensor->strides(), eps, context);
     KERNEL_FINISH;
 }
 
@@ -55,7 +56,7 @@ result<value_t> nncase::kernels::stackvm::layer_norm(
     try_input(bias_mem, bias);
     try_output_like_input(output_mem, output, input_tensor);
     try_typecode(typecode, input_tensor);
-    if (typecode == dt_float32) {
+    if (typecode == dt_float32 || typecode == dt_float16) {
         CONTIGUOUS_KERNEL(layer_norm, input_tensor, typecode, input_mem,
                           output_mem, scale_mem, bias_mem,
                           input_tensor->shape(), axis, epsilon);
@@ -112,16 +113,16 @@ result<value_t> kernels::stackvm::broadcast(value_t input, value_t shape,
 
 result<value_t>
 nncase::kernels::stackvm::clamp(value_t input, value_t min, value_t max,
-                                value_t output,
-                                [[maybe_unused]] kernel_context &context) {
+                                value_t output, kernel_context &context) {
     try_input(input_mem, input);
     try_input(min_mem, min);
     try_input(max_mem, max);
     try_output_like_input(output_mem, output, input_tensor);
     try_var(typecode, to_typecode(input_tensor->dtype()));
-    try_(reference::clamp(typecode, input_mem, min_mem, max_mem, output_mem,
-                          input_tensor->shape(), input_tensor->strides(),
-                          output_tensor->strides()));
+    CONTIGUOUS_KERNEL(clamp, input_tensor, typecode, input_mem, min_mem,
+                      max_mem, output_mem, input_tensor->shape(),
+                      input_tensor->strides(), output_tensor->strides(),
+                      context);
     KERNEL_FINISH;
 }
 
@@ -148,6 +149,27 @@ result<value_t> nncase::kernels::stackvm::concat(int32_t axis, value_t input,
     auto inputs_mem_span =
         gsl::make_span(inputs_mem).as_span<const gsl::byte *const>();
 
+    // Without outer dims every input is a contiguous range of the output.
+    // Producers which wrote theirs in place, e.g. into a view of the output,
+    // are skipped and the others are copied.
+    auto inputs_contiguous =
+        std::all_of(input_tuple->fields().begin(), input_tuple->fields().end(),
+                    [](const value_t &field) {
+                        return is_contiguous(field.as<tensor>().unwrap());
+                    });
+    if (inputs_contiguous && input0->shape().size() != 0 &&
+        is_contiguous(output_tensor) &&
+        compute_size(output_tensor->shape().first(axis_value)) == 1) {
+        size_t offset = 0;
+        for (size_t i = 0; i < inputs_mem.size(); i++) {
+            auto bytes = get_bytes(dtype, shapes[i]);
+            if (inputs_mem[i] != out_mem + offset)
+                std::memmove(out_mem + offset, inputs_mem[i], bytes);
+            offset += bytes;
+        }
+        return ok(output);
+    }
+
     if (is_contiguous(input0) && axis_value < 4) {
         try_(optimized::concat(
             dtype, inputs_mem_span, out_mem, output_tensor->shape(), strides,
@@ -208,14 +230,58 @@ result<value_t> nncase::kernels::stackvm::conv2d(
     //     pads[1], groups_value, strides[0], strides[1], dilations[0],
     //     dilations[1], value_range<float>{fused_clamp_value[0],
     //     fused_clamp_value[1]}, context);
-    try_(reference::conv2d(
-        typecode, input_mem, weights_mem, bias_mem, out_mem,
-        input_tensor->shape(), input_tensor->strides(), weights_tensor->shape(),
-        weights_tensor->strides(), bias_tensor->strides(),
-        output_tensor->strides(), pads[0], pads[1], groups_value, strides[0],
-        strides[1], dilations[0], dilations[1],
-        value_range<float>{fused_clamp_value[0], fused_clamp_value[1]},
-        context));
+    if (typecode == dt_float16) {
+        CONTIGUOUS_KERNEL(
+            conv2d, input_tensor, typecode, input_mem, weights_mem, bias_mem,
+            out_mem, input_tensor->shape(), input_tensor->strides(),
+            weights_tensor->shape(), weights_tensor->strides(),
+            bias_tensor->strides(), output_tensor->strides(), pads[0], pads[1],
+            groups_value, strides[0], strides[1], dilations[0], dilations[1],
+            value_range<float>{fused_clamp_value[0], fused_clamp_value[1]},
+            context);
+    } else if (typecode == dt_float32 && context.autotuner &&
+               is_contiguous(input_tensor)) {
+        // Variant 0 is the reference kernel, the others the optimized one
+        // with each of its row tiles.
+        autotune_key key("conv2d", typecode, context.num_threads);
+        key << input_tensor->shape() << weights_tensor->shape() << strides
+            << dilations << (int64_t)groups_value;
+        for (auto &pad : pads)
+            key << (int64_t)pad.before << (int64_t)pad.after;
+        auto activation =
+            value_range<float>{fused_clamp_value[0], fused_clamp_value[1]};
+        try_(context.autotuner->run(
+            key, 1 + std::size(optimized::conv2d_tile_rows),
+            [&](size_t variant) -> result<void> {
+                if (variant == 0) {
+                    return reference::conv2d(
+                        typecode, input_mem, weights_mem, bias_mem, out_mem,
+                        input_tensor->shape(), input_tensor->strides(),
+                        weights_tensor->shape(), weights_tensor->strides(),
+                        bias_tensor->strides(), output_tensor->strides(),
+                        pads[0], pads[1], groups_value, strides[0],
+                        strides[1], dilations[0], dilations[1], activation,
+                        context);
+                }
+                return optimized::conv2d(
+                    typecode, input_mem, weights_mem, bias_mem, out_mem,
+                    input_tensor->shape(), input_tensor->strides(),
+                    weights_tensor->shape(), weights_tensor->strides(),
+                    bias_tensor->strides(), output_tensor->strides(), pads[0],
+                    pads[1], groups_value, strides[0], strides[1],
+                    dilations[0], dilations[1], activation, context,
+                    optimized::conv2d_tile_rows[variant - 1]);
+            }));
+    } else {
+        try_(reference::conv2d(
+            typecode, input_mem, weights_mem, bias_mem, out_mem,
+            input_tensor->shape(), input_tensor->strides(),
+            weights_tensor->shape(), weights_tensor->strides(),
+            bias_tensor->strides(), output_tensor->strides(), pads[0], pads[1],
+            groups_value, strides[0], strides[1], dilations[0], dilations[1],
+            value_range<float>{fused_clamp_value[0], fused_clamp_value[1]},
+            context));
+    }
     return ok(output);
 }
 
@@ -223,8 +289,7 @@ result<value_t> nncase::kernels::stackvm::conv2d_transpose(
     pad_mode_t pad_mode, value_t input, value_t weights, value_t bias,
     value_t output_shape, value_t stride, value_t padding,
     [[maybe_unused]] value_t output_padding, value_t dilation, value_t groups,
-    value_t fused_clamp, value_t output,
-    [[maybe_unused]] kernel_context &context) {
+    value_t fused_clamp, value_t output, kernel_context &context) {
     if (pad_mode != pad_mode_t::constant) {
         return err(nncase_errc::runtime_not_found);
     }
@@ -240,12 +305,31 @@ result<value_t> nncase::kernels::stackvm::conv2d_transpose(
     try_dims(out_shape, output_shape);
     try_typecode(typecode, input_tensor);
     try_output(out_mem, output, typecode, out_shape);
-    try_(reference::conv2d_transpose(
-        typecode, input_mem, out_mem, weights_mem, bias_mem,
-        input_tensor->shape(), groups_value, output_tensor->shape(),
-        weights_tensor->shape()[2], weights_tensor->shape()[3], strides[0],
-        strides[1], dilations[0], dilations[1], pads[0], pads[1],
-        value_range<float>{fused_clamp_value[0], fused_clamp_value[1]}));
+    CONTIGUOUS_KERNEL(
+        conv2d_transpose, input_tensor, typecode, input_mem, out_mem,
+        weights_mem, bias_mem, input_tensor->shape(), groups_value,
+        output_tensor->shape(), weights_tensor->shape()[2],
+        weights_tensor->shape()[3], strides[0], strides[1], dilations[0],
+        dilations[1], pads[0], pads[1],
+        value_range<float>{fused_clamp_value[0], fused_clamp_value[1]},
+        context);
+    return ok(output);
+}
+
+result<value_t> nncase::kernels::stackvm::cum_sum(value_t input, value_t axis,
+                                                  value_t exclusive,
+                                                  value_t reverse,
+                                                  value_t output,
+                                                  kernel_context &context) {
+    try_input(input_mem, input);
+    try_output(out_mem, output, input_tensor->dtype(), input_tensor->shape());
+    try_positive_axis(axis_value, axis, input_tensor);
+    try_to_scalar(exclusive_value, exclusive, bool);
+    try_to_scalar(reverse_value, reverse, bool);
+    try_typecode(typecode, input_tensor);
+    CONTIGUOUS_KERNEL(cumsum, input_tensor, typecode, input_mem, out_mem,
+                      input_tensor->shape(), axis_value, exclusive_value,
+                      reverse_value, context);
     return ok(output);
 }
 
@@ -324,11 +408,11 @@ nncase::kernels::stackvm::gather_elements(value_t input, value_t axis,
     try_positive_axis(axis_value, axis, input_tensor);
     auto out_shape = indices_tensor->shape();
     try_output(out_mem, output, dtype, out_shape);
-    try_(reference::gather_elements(
-        dtype, input_mem, out_mem, input_tensor->shape(), out_shape,
-        input_tensor->strides(), output_tensor->strides(),
-        indices_tensor->dtype(), indices_mem, indices_tensor->shape(),
-        axis_value, context));
+    CONTIGUOUS_KERNEL(gather_elements, input_tensor, dtype, input_mem, out_mem,
+                      input_tensor->shape(), out_shape, input_tensor->strides(),
+                      output_tensor->strides(), indices_tensor->dtype(),
+                      indices_mem, indices_tensor->shape(), axis_value,
+                      context);
     return ok(output);
 }
 
@@ -364,10 +448,10 @@ result<value_t> nncase::kernels::stackvm::scatter_nd(value_t input,
     auto dtype = input_tensor->dtype();
     auto out_shape = input_tensor->shape();
     try_output(out_mem, output, dtype, out_shape);
-    try_(reference::scatter_nd(dtype, input_mem, out_mem, input_tensor->shape(),
-                               indices_tensor->dtype(), indices_mem,
-                               indices_tensor->shape(), updates_memm,
-                               updates_tensor->shape(), context));
+    CONTIGUOUS_KERNEL(scatter_nd, input_tensor, dtype, input_mem, out_mem,
+                      input_tensor->shape(), indices_tensor->dtype(),
+                      indices_mem, indices_tensor->shape(), updates_memm,
+                      updates_tensor->shape(), context);
     return ok(output);
 }
 
@@ -464,9 +548,20 @@ result<value_t> nncase::kernels::stackvm::instance_normalization(
 }
 
 result<value_t> nncase::kernels::stackvm::l2_normalization(
-    [[maybe_unused]] value_t input, [[maybe_unused]] value_t output,
-    [[maybe_unused]] kernel_context &context) {
-    return err(std::errc::not_supported);
+    value_t input, value_t output, kernel_context &context) {
+    try_input(in_mem, input);
+    try_output_like_input(out_mem, output, input_tensor);
+    try_typecode(type, input_tensor);
+    if (!is_contiguous(input_tensor) || !is_contiguous(output_tensor))
+        return err(std::errc::not_supported);
+
+    // Every axis but the batch one, the only axis of a 1-D input
+    auto rank = input_tensor->shape().size();
+    auto axis_begin = rank == 1 ? 0 : 1;
+    try_(optimized::lp_normalization(type, in_mem, out_mem,
+                                     input_tensor->shape(), axis_begin, rank,
+                                     2.f, 1e-10f, context));
+    return ok(output);
 }
 
 result<value_t> nncase::kernels::stackvm::log_softmax(
@@ -491,16 +586,26 @@ result<value_t> nncase::kernels::stackvm::log_softmax(
 }
 
 result<value_t> nncase::kernels::stackvm::lp_normalization(
-    [[maybe_unused]] value_t input, [[maybe_unused]] value_t axis,
-    [[maybe_unused]] value_t p, [[maybe_unused]] value_t output,
-    [[maybe_unused]] kernel_context &context) {
-    return err(std::errc::not_supported);
+    value_t input, value_t axis, value_t p, value_t output,
+    kernel_context &context) {
+    try_input(in_mem, input);
+    try_output_like_input(out_mem, output, input_tensor);
+    try_positive_axis(axis_value, axis, input_tensor);
+    try_float_scalar_v(p);
+    try_typecode(type, input_tensor);
+    if (!is_contiguous(input_tensor) || !is_contiguous(output_tensor))
+        return err(std::errc::not_supported);
+
+    try_(optimized::lp_normalization(type, in_mem, out_mem,
+                                     input_tensor->shape(), axis_value,
+                                     axis_value + 1, p_value, 0.f, context));
+    return ok(output);
 }
 
 result<value_t>
 nncase::kernels::stackvm::lrn(value_t input, value_t alpha, value_t beta,
                               value_t bias, value_t size, value_t output,
-                              [[maybe_unused]] kernel_context &context) {
+                              kernel_context &context) {
     try_in_mem(input);
     try_float_scalar_v(alpha);
     try_float_scalar_v(beta);
@@ -509,10 +614,10 @@ nncase::kernels::stackvm::lrn(value_t input, value_t alpha, value_t beta,
     auto out_shape = input_tensor->shape();
     try_typecode(typecode, input_tensor);
     try_out_mem(output, typecode, out_shape);
-    try_(reference::lrn(typecode, input_mem, alpha_value, beta_value,
-                        bias_value, size_value, output_mem,
-                        input_tensor->shape(), input_tensor->strides(),
-                        runtime::get_default_strides(out_shape)));
+    CONTIGUOUS_KERNEL(lrn, input_tensor, typecode, input_mem, alpha_value,
+                      beta_value, bias_value, size_value, output_mem,
+                      input_tensor->shape(), input_tensor->strides(),
+                      output_tensor->strides(), context);
     KERNEL_FINISH;
 }
 
@@ -559,8 +664,14 @@ nncase::kernels::stackvm::mat_mul(value_t lhs, value_t rhs, value_t output,
             matmul_infer_shape(lhs_tensor->shape(), rhs_tensor->shape()));
     try_output(out_mem, output, lhs_tensor->dtype(), out_shape);
     try_typecode(typecode, lhs_tensor);
-    try_(reference::matmul(typecode, lhs_mem, rhs_mem, out_mem,
-                           lhs_tensor->shape(), rhs_tensor->shape()));
+    if (typecode == dt_float16 && is_contiguous(rhs_tensor)) {
+        CONTIGUOUS_KERNEL(matmul, lhs_tensor, typecode, lhs_mem, rhs_mem,
+                          out_mem, lhs_tensor->shape(), rhs_tensor->shape(),
+                          context);
+    } else {
+        try_(reference::matmul(typecode, lhs_mem, rhs_mem, out_mem,
+                               lhs_tensor->shape(), rhs_tensor->shape()));
+    }
     return ok(output);
 }
 
@@ -664,10 +775,11 @@ result<value_t> kernels::stackvm::prelu(value_t input, value_t slope,
     try_in_mem(slope);
     try_output_like_input(out_mem, output, input_tensor);
     try_typecode(type, input_tensor);
-    try_(reference::prelu(
-        type, input_mem, slope_mem, out_mem, input_tensor->shape(),
-        input_tensor->strides(), slope_tensor->shape(), slope_tensor->strides(),
-        output_tensor->shape(), output_tensor->strides(), context));
+    CONTIGUOUS_KERNEL(prelu, input_tensor, type, input_mem, slope_mem, out_mem,
+                      input_tensor->shape(), input_tensor->strides(),
+                      slope_tensor->shape(), slope_tensor->strides(),
+                      output_tensor->shape(), output_tensor->strides(),
+                      context);
     return ok(output);
 }
 
@@ -756,6 +868,26 @@ result<value_t> nncase::kernels::stackvm::reduce(
     return ok(output);
 }
 
+result<value_t> nncase::kernels::stackvm::reduce_arg(
+    reduce_arg_op_t reduce_arg_op, typecode_t dest_type, value_t input,
+    value_t axis, value_t keep_dims, value_t select_last_index, value_t output,
+    kernel_context &context) {
+    try_input(in_mem, input);
+    try_typecode(input_typecode, input_tensor);
+    try_positive_axis(axis_value, axis, input_tensor);
+    try_to_scalar(keep_dims_value, keep_dims, bool);
+    try_to_scalar(select_last_index_value, select_last_index, bool);
+    auto out_shape = reduce_arg_infer_shape(input_tensor->shape(), axis_value,
+                                            keep_dims_value);
+    try_output(out_mem, output, dest_type, out_shape);
+    auto axes = dims_t{axis_value};
+    CONTIGUOUS_KERNEL(reduce_arg, input_tensor, input_typecode, dest_type,
+                      reduce_arg_op, in_mem, out_mem, input_tensor->shape(),
+                      input_tensor->strides(), output_tensor->strides(), axes,
+                      keep_dims_value, select_last_index_value, context);
+    return ok(output);
+}
+
 result<value_t>
 nncase::kernels::stackvm::relu6([[maybe_unused]] value_t input,
                                 [[maybe_unused]] value_t output,
@@ -936,17 +1068,18 @@ result<value_t> nncase::kernels::stackvm::resize_image(
 
 result<value_t> nncase::kernels::stackvm::reverse_sequence(
     value_t input, value_t seq_lens, value_t batch_axis, value_t time_axis,
-    value_t output, [[maybe_unused]] kernel_context &context) {
+    value_t output, kernel_context &context) {
     try_in_mem(input);
     try_integer_v(batch_axis);
     try_integer_v(time_axis);
     try_dims(seq_lens_value, seq_lens);
     auto out_shape = input_tensor->shape();
     try_out_mem(output, input_tensor->dtype(), out_shape);
-    try_(reference::reverse_sequence(
-        input_tensor->dtype(), input_mem, output_mem, input_tensor->shape(),
-        seq_lens_value, batch_axis_value, time_axis_value,
-        input_tensor->strides(), output_tensor->strides()));
+    CONTIGUOUS_KERNEL(reverse_sequence, input_tensor, input_tensor->dtype(),
+                      input_mem, output_mem, input_tensor->shape(),
+                      seq_lens_value, batch_axis_value, time_axis_value,
+                      input_tensor->strides(), output_tensor->strides(),
+                      context);
     KERNEL_FINISH;
 }
 
@@ -1042,6 +1175,26 @@ result<value_t> nncase::kernels::stackvm::slice(value_t input, value_t begins,
                               input_tensor->strides(), output_tensor->strides(),
                               begin_values, end_values, strides_values,
                               context));
+    } else if (context.autotuner) {
+        // Variant 0 is the optimized kernel, 1 the reference one
+        autotune_key key("slice", input_tensor->dtype()->typecode(),
+                         context.num_threads);
+        key << in_shape << input_tensor->strides() << begin_values
+            << end_values << strides_values;
+        try_(context.autotuner->run(
+            key, 2, [&](size_t variant) -> result<void> {
+                return variant == 0
+                           ? optimized::slice(
+                                 input_tensor->dtype(), in_mem, out_mem,
+                                 in_shape, input_tensor->strides(),
+                                 output_tensor->strides(), begin_values,
+                                 end_values, strides_values, context)
+                           : reference::slice(
+                                 input_tensor->dtype(), in_mem, out_mem,
+                                 in_shape, input_tensor->strides(),
+                                 output_tensor->strides(), begin_values,
+                                 end_values, strides_values, context);
+            }));
     } else {
         try_(optimized::slice(input_tensor->dtype(), in_mem, out_mem, in_shape,
                               input_tensor->strides(), output_tensor->strides(),
@@ -1058,7 +1211,7 @@ nncase::kernels::stackvm::softmax(value_t input, value_t axis, value_t output,
     try_output_like_input(out_mem, output, input_tensor);
     try_positive_axis(axis_value, axis, input_tensor);
     try_typecode(type, input_tensor);
-    if (type == dt_float32) {
+    if (type == dt_float32 || type == dt_float16) {
         CONTIGUOUS_KERNEL(softmax, input_tensor, type, in_mem, out_mem,
                           input_tensor->shape(), input_tensor->strides(),
                           output_tensor->strides(), axis_value, 1.f);
@@ -1073,7 +1226,7 @@ nncase::kernels::stackvm::softmax(value_t input, value_t axis, value_t output,
 result<value_t> nncase::kernels::stackvm::space_to_batch(
     [[maybe_unused]] value_t input, [[maybe_unused]] value_t block_shape,
     [[maybe_unused]] value_t paddings, [[maybe_unused]] value_t output,
-    [[maybe_unused]] kernel_context &context) {
+    kernel_context &context) {
     try_in_mem(input);
     try_paddings(paddings_value, paddings);
     try_dims_v(block_shape);
@@ -1081,10 +1234,11 @@ result<value_t> nncase::kernels::stackvm::space_to_batch(
         input_tensor->shape(), block_shape_value, paddings_value);
     try_out_mem(output, input_tensor->dtype(), out_shape);
 
-    try_(reference::space_to_batch(input_tensor->dtype(), input_mem, output_mem,
-                                   input_tensor->shape(), block_shape_value,
-                                   paddings_value, input_tensor->strides(),
-                                   out_shape, output_tensor->strides()));
+    CONTIGUOUS_KERNEL(space_to_batch, input_tensor, input_tensor->dtype(),
+                      input_mem, output_mem, input_tensor->shape(),
+                      block_shape_value, paddings_value,
+                      input_tensor->strides(), out_shape,
+                      output_tensor->strides(), context);
     KERNEL_FINISH;
 }
 
@@ -1097,6 +1251,21 @@ result<value_t> nncase::kernels::stackvm::split(value_t input, value_t axis,
     try_dims(sections_value, sections);
     auto shapes =
         split_shape_infer(input_tensor->shape(), axis_value, sections_value);
+
+    // Without outer dims every section is a contiguous range of the input,
+    // unless the caller gave outputs it is handed out as a view
+    if (output.empty() && is_contiguous(input_tensor) &&
+        compute_size(input_tensor->shape().first(axis_value)) == 1) {
+        std::vector<value_t> fields;
+        size_t offset = 0;
+        for (auto &shape : shapes) {
+            fields.emplace_back(tensor_view(input_tensor, shape, offset));
+            offset += get_bytes(input_tensor->dtype(), shape);
+        }
+        output = tuple(std::in_place, std::move(fields));
+        KERNEL_FINISH;
+    }
+
     try_tuple_output(outputs, output, input_tensor->dtype(), shapes);
     try_var(out_strides, get_strides(output_tuple));
     if (is_contiguous(input_tensor)) {
@@ -1160,15 +1329,15 @@ result<value_t> nncase::kernels::stackvm::stack(value_t inputs, value_t axis,
 
 result<value_t>
 nncase::kernels::stackvm::tile(value_t input, value_t repeats, value_t output,
-                               [[maybe_unused]] kernel_context &context) {
+                               kernel_context &context) {
     try_input(in_mem, input);
     try_dims(repeats_value, repeats);
     auto ty = input_tensor->dtype();
     auto out_shape = tile_infer_shape(input_tensor->shape(), repeats_value);
     try_output(out_mem, output, ty, out_shape);
-    try_(reference::tile(ty, in_mem, out_mem, input_tensor->shape(), out_shape,
-                         input_tensor->strides(), output_tensor->strides(),
-                         repeats_value));
+    CONTIGUOUS_KERNEL(tile, input_tensor, ty, in_mem, out_mem,
+                      input_tensor->shape(), out_shape, input_tensor->strides(),
+                      output_tensor->strides(), repeats_value, context);
     KERNEL_FINISH;
 }
 
@@ -1222,15 +1391,16 @@ nncase::kernels::stackvm::transpose(value_t input, value_t perm, value_t output,
 
 result<value_t> nncase::kernels::stackvm::trilu(value_t input, value_t k,
                                                 value_t upper, value_t output,
-                                                kernel_context &) {
+                                                kernel_context &context) {
     try_input(in_mem, input);
     try_integer_v(k);
     try_integer_v(upper);
     try_output(out_mem, output, input_tensor->dtype(), input_tensor->shape());
-    try_(reference::trilu(input_tensor->dtype(), in_mem, out_mem,
-                          input_tensor->shape(), input_tensor->strides(),
-                          output_tensor->strides(), k_value, upper_value == 1))
-        KERNEL_FINISH;
+    CONTIGUOUS_KERNEL(trilu, input_tensor, input_tensor->dtype(), in_mem,
+                      out_mem, input_tensor->shape(), input_tensor->strides(),
+                      output_tensor->strides(), k_value, upper_value == 1,
+                      context);
+    KERNEL_FINISH;
 }
 
 result<value_t>
@@ -1273,6 +1443,78 @@ nncase::kernels::stackvm::unsqueeze(value_t input, value_t dim, value_t output,
     KERNEL_FINISH;
 }
 
+result<value_t> nncase::kernels::stackvm::variable_update(
+    int32_t axis, value_t state, value_t update, value_t offset,
+    value_t output, kernel_context &context) {
+    try_input(update_mem, update);
+    try_to_integer(start, offset);
+    try_var(state_tensor, state.as<tensor>());
+    if (!cmp_dt(state_tensor, update_tensor))
+        return err(nncase_errc::datatype_mismatch);
+
+    auto state_shape = state_tensor->shape();
+    auto update_shape = update_tensor->shape();
+    if (update_shape.size() != state_shape.size())
+        return err(nncase_errc::shape_mismatch);
+    auto axis_value = positive_index(axis, state_shape.size());
+    for (size_t i = 0; i < state_shape.size(); i++) {
+        if (i != axis_value && update_shape[i] != state_shape[i])
+            return err(nncase_errc::shape_mismatch);
+    }
+    if (start < 0 ||
+        (size_t)start + update_shape[axis_value] > state_shape[axis_value])
+        return err(std::errc::result_out_of_range);
+
+    if (output.empty()) {
+        output = state;
+    } else if (output.get() != state.get()) {
+        try_(state_tensor->copy_to(output));
+    }
+    try_output(out_mem, output, state_tensor->dtype(), state_shape);
+    CONTIGUOUS_KERNEL(variable_update, update_tensor, state_tensor->dtype(),
+                      update_mem, out_mem, update_shape,
+                      update_tensor->strides(), state_shape,
+                      output_tensor->strides(), axis_value, (size_t)start,
+                      context);
+    KERNEL_FINISH;
+}
+
+result<value_t> nncase::kernels::stackvm::weight_only_mat_mul(
+    int32_t bits, int32_t group_size, value_t input, value_t weights,
+    value_t scales, value_t output, kernel_context &context) {
+    try_f32_input(input_mem, input);
+    try_input(weights_mem, weights);
+    try_f32_input(scales_mem, scales);
+    auto weights_type = weights_tensor->dtype();
+    if (!(bits == 8 && cmp_type<int8_t>(weights_type)) &&
+        !(bits == 4 && cmp_type<uint8_t>(weights_type)))
+        return err(std::errc::invalid_argument);
+
+    // weights: [N, K] int8 or [N, ceil(K / 2)] packed int4
+    // scales: [N, ceil(K / group_size)]
+    auto in_shape = input_tensor->shape();
+    auto w_shape = weights_tensor->shape();
+    auto scales_shape = scales_tensor->shape();
+    if (in_shape.empty() || w_shape.size() != 2 || group_size <= 0)
+        return err(std::errc::invalid_argument);
+    auto k_size = in_shape.back();
+    auto out_channels = w_shape[0];
+    auto groups = (k_size + group_size - 1) / group_size;
+    if (w_shape[1] != (bits == 4 ? (k_size + 1) / 2 : k_size) ||
+        scales_shape.size() != 2 || scales_shape[0] != out_channels ||
+        scales_shape[1] != groups || !is_contiguous(weights_tensor) ||
+        !is_contiguous(scales_tensor))
+        return err(nncase_errc::shape_mismatch);
+
+    dims_t out_shape(in_shape.begin(), in_shape.end());
+    out_shape.back() = out_channels;
+    try_f32_output(out_mem, output, out_shape);
+    CONTIGUOUS_KERNEL(weight_only_matmul, input_tensor, input_mem, weights_mem,
+                      scales_mem, out_mem, in_shape, input_tensor->strides(),
+                      out_channels, bits, group_size, context);
+    KERNEL_FINISH;
+}
+
 result<value_t> nncase::kernels::stackvm::where(
     [[maybe_unused]] bool is_tf_where, [[maybe_unused]] value_t cond,
     [[maybe_unused]] value_t x, [[maybe_unused]] value_t y,
@@ -1320,7 +1562,7 @@ result<value_t> kernels::stackvm::unary(unary_op_t unary_op, value_t input,
     auto dtype = input_tensor->dtype();
     try_output(out_mem, output, dtype, input_tensor->shape());
 
-    if (typoecode != dt_float32) {
+    if (typoecode != dt_float32 && typoecode != dt_float16) {
         try_(reference::unary(typoecode, unary_op, input_mem, out_mem,
                               input_tensor->shape(), input_tensor->strides(),
                               output_tensor->shape(), output_tensor->strides(),
@@ -0,0 +1,281 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <nncase/runtime/autotuner.h>
+#include <nncase/runtime/debug.h>
+#ifndef NNCASE_BAREMETAL
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#if defined(__nds_v5)
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+
+namespace {
+// Every timed variant runs at least once more after its warm up run, and
+// again while the total stays under the budget.
+constexpr size_t max_timed_runs = 3;
+constexpr double timing_budget_ms = 100;
+
+std::string sanitize(std::string_view name) {
+    std::string result;
+    for (auto c : name) {
+        if (std::isalnum((unsigned char)c) || c == '.' || c == '-')
+            result.push_back(c);
+        else if (!result.empty() && result.back() != '_')
+            result.push_back('_');
+    }
+    while (!result.empty() && result.back() == '_')
+        result.pop_back();
+    return result;
+}
+
+#ifndef NNCASE_BAREMETAL
+std::string read_cpu_model() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if ((unsigned)regs[0] >= 0x80000004) {
+        char brand[49] = {};
+        for (int i = 0; i < 3; i++)
+            __cpuid(reinterpret_cast<int *>(brand + i * 16), 0x80000002 + i);
+        return brand;
+    }
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned regs[4];
+    if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004) {
+        char brand[49] = {};
+        for (unsigned i = 0; i < 3; i++) {
+            __get_cpuid(0x80000002 + i, &regs[0], &regs[1], &regs[2],
+                        &regs[3]);
+            std::memcpy(brand + i * 16, regs, sizeof(regs));
+        }
+        return brand;
+    }
+#endif
+    // Arm and riscv linux name the cpu in one of these fields
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        for (auto field : {"model name", "uarch", "Hardware"}) {
+            if (line.rfind(field, 0) == 0) {
+                auto colon = line.find(':');
+                if (colon != std::string::npos)
+                    return line.substr(colon + 1);
+            }
+        }
+    }
+    return {};
+}
+#endif
+
+template <class T> void append_dims(std::string &key, gsl::span<const T> dims) {
+    key.push_back(':');
+    for (size_t i = 0; i < dims.size(); i++) {
+        if (i)
+            key.push_back('x');
+        key.append(std::to_string(dims[i]));
+    }
+}
+} // namespace
+
+autotune_key::autotune_key(std::string_view op, typecode_t type,
+                           uint32_t threads)
+    : key_(op) {
+    key_.append(":").append(to_string(type));
+    key_.append(":t").append(std::to_string(threads));
+}
+
+autotune_key &autotune_key::operator<<(gsl::span<const size_t> dims) {
+    append_dims(key_, dims);
+    return *this;
+}
+
+autotune_key &autotune_key::operator<<(gsl::span<const int64_t> axes) {
+    append_dims(key_, axes);
+    return *this;
+}
+
+autotune_key &autotune_key::operator<<(int64_t value) {
+    key_.append(":").append(std::to_string(value));
+    return *this;
+}
+
+uint64_t autotuner::hash(gsl::span<const gsl::byte> data,
+                         uint64_t seed) noexcept {
+    auto hash = seed;
+    for (auto b : data) {
+        hash ^= (uint8_t)b;
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+std::string autotuner::cpu_model() {
+#ifndef NNCASE_BAREMETAL
+    auto model = sanitize(read_cpu_model());
+    if (!model.empty())
+        return model;
+#endif
+    return "generic";
+}
+
+#ifndef NNCASE_BAREMETAL
+struct autotuner::impl {
+    std::string path;
+    std::mutex lock;
+    std::unordered_map<std::string, size_t> choices;
+
+    void load() {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            auto space = line.rfind(' ');
+            if (line.empty() || line[0] == '#' || space == std::string::npos)
+                continue;
+            char *end;
+            auto variant = std::strtoul(line.c_str() + space + 1, &end, 10);
+            if (end != line.c_str() + space + 1)
+                choices[line.substr(0, space)] = variant;
+        }
+    }
+
+    void store(const std::string &key, size_t variant) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (choices.emplace(key, variant).second) {
+            std::ofstream file(path, std::ios::app);
+            file << key << ' ' << variant << '\n';
+        }
+    }
+};
+
+autotuner::autotuner(std::shared_ptr<impl> impl) noexcept
+    : impl_(std::move(impl)) {}
+
+result<std::shared_ptr<autotuner>>
+autotuner::create(std::string_view cache_dir, uint64_t model_hash) noexcept {
+    try {
+        fs::path dir(std::string{cache_dir});
+        std::error_code ec;
+        fs::create_directories(dir, ec);
+        if (!fs::is_directory(dir))
+            return err(std::errc::no_such_file_or_directory);
+
+        char hash[17];
+        std::snprintf(hash, sizeof(hash), "%016llx",
+                      (unsigned long long)model_hash);
+        auto state = std::make_shared<impl>();
+        state->path =
+            (dir / (std::string(hash) + "-" + cpu_model() + ".tune")).string();
+        state->load();
+        return ok(std::shared_ptr<autotuner>(new autotuner(std::move(state))));
+    } catch (...) {
+        return err(std::errc::not_enough_memory);
+    }
+}
+
+const std::string &autotuner::cache_path() const noexcept {
+    return impl_->path;
+}
+
+int32_t autotuner::find(const autotune_key &key) const noexcept {
+    std::lock_guard<std::mutex> guard(impl_->lock);
+    auto it = impl_->choices.find(key.str());
+    return it == impl_->choices.end() ? -1 : (int32_t)it->second;
+}
+
+result<void> autotuner::run(const autotune_key &key, size_t variants,
+                            const variant_func &func) noexcept {
+    auto cached = find(key);
+    if (cached >= 0 && (size_t)cached < variants)
+        return func((size_t)cached);
+
+    using clock = std::chrono::steady_clock;
+    auto best = variants;
+    auto best_ms = std::numeric_limits<double>::infinity();
+    auto last_ok = variants;
+    for (size_t i = 0; i < variants; i++) {
+        if (func(i).is_err())
+            continue;
+        last_ok = i;
+        double total_ms = 0;
+        auto min_ms = std::numeric_limits<double>::infinity();
+        for (size_t r = 0; r < max_timed_runs && total_ms < timing_budget_ms;
+             r++) {
+            auto begin = clock::now();
+            try_(func(i));
+            auto ms = std::chrono::duration<double, std::milli>(clock::now() -
+                                                                begin)
+                          .count();
+            total_ms += ms;
+            min_ms = std::min(min_ms, ms);
+        }
+        if (min_ms < best_ms) {
+            best = i;
+            best_ms = min_ms;
+        }
+    }
+
+    // Every variant failed, report the error of the first one
+    if (best == variants)
+        return func(0);
+    try {
+        impl_->store(key.str(), best);
+    } catch (...) {
+        // The cache is only a hint, keep running without it
+    }
+    return best == last_ok ? ok() : func(best);
+}
+#else
+struct autotuner::impl {};
+
+autotuner::autotuner(std::shared_ptr<impl> impl) noexcept
+    : impl_(std::move(impl)) {}
+
+result<std::shared_ptr<autotuner>>
+autotuner::create(std::string_view, uint64_t) noexcept {
+    return err(std::errc::not_supported);
+}
+
+const std::string &autotuner::cache_path() const noexcept {
+    static std::string empty;
+    return empty;
+}
+
+int32_t autotuner::find(const autotune_key &) const noexcept { return -1; }
+
+result<void> autotuner::run(const autotune_key &, size_t,
+                            const variant_func &func) noexcept {
+    return func(0);
+}
+#endif
@@ -0,0 +1,247 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstring>
+#include <nncase/runtime/batching_executor.h>
+#include <nncase/runtime/dbg.h>
+#include <nncase/runtime/error.h>
+#include <nncase/runtime/runtime_op_utility.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+
+namespace {
+dims_t to_dims(gsl::span<const size_t> shape) {
+    return dims_t(shape.begin(), shape.end());
+}
+
+size_t row_bytes(const tensor &t) noexcept {
+    return get_bytes(t->dtype(), t->shape().subspan(1));
+}
+} // namespace
+
+batching_executor::batching_executor(interpreter &interp,
+                                     batching_options options) noexcept
+    : interp_(interp),
+      options_(options),
+      entry_(nullptr),
+      max_batch_size_(0),
+      queued_rows_(0),
+      stop_(false) {}
+
+result<std::unique_ptr<batching_executor>>
+batching_executor::create(interpreter &interp,
+                          batching_options options) noexcept {
+    std::unique_ptr<batching_executor> executor(
+        new (std::nothrow) batching_executor(interp, options));
+    CHECK_WITH_ERR(executor != nullptr, std::errc::not_enough_memory);
+    try_(executor->initialize());
+    return ok(std::move(executor));
+}
+
+batching_executor::~batching_executor() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+
+    for (auto &req : queue_)
+        req.callback(err(std::errc::operation_canceled));
+}
+
+result<void> batching_executor::initialize() noexcept {
+    try_set(entry_, interp_.entry_function());
+    CHECK_WITH_ERR(entry_->parameters_size(), std::errc::invalid_argument);
+    for (size_t i = 0; i < entry_->parameters_size(); i++) {
+        try_var(type, entry_->parameter_type(i));
+        try_var(ttype, type.as<tensor_type>());
+        try_var(dims, ttype->shape().as_fixed());
+        CHECK_WITH_ERR(!dims.empty() && dims[0], std::errc::invalid_argument);
+        if (i == 0)
+            max_batch_size_ = dims[0];
+        CHECK_WITH_ERR(dims[0] == max_batch_size_,
+                       std::errc::invalid_argument);
+        input_types_.emplace_back(std::move(ttype));
+        input_shapes_.emplace_back(std::move(dims));
+    }
+
+    try {
+        thread_ = std::thread([this] { executor_main(); });
+    } catch (...) {
+        return err(std::errc::resource_unavailable_try_again);
+    }
+    return ok();
+}
+
+result<size_t> batching_executor::validate(
+    gsl::span<const runtime_tensor> inputs) noexcept {
+    CHECK_WITH_ERR(inputs.size() == input_shapes_.size(),
+                   std::errc::invalid_argument);
+    size_t batch = 0;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        auto &input = inputs[i];
+        auto &expected = input_shapes_[i];
+        // runtime_tensor::is_host looks at the tensor, not at its buffer
+        CHECK_WITH_ERR(!input.empty() &&
+                           input.impl()->buffer().as_host().is_ok() &&
+                           input.is_contiguous(),
+                       std::errc::invalid_argument);
+        CHECK_WITH_ERR(input.datatype() ==
+                           input_types_[i]->dtype()->typecode(),
+                       nncase_errc::datatype_mismatch);
+        auto shape = input.shape();
+        CHECK_WITH_ERR(shape.size() == expected.size() &&
+                           std::equal(shape.begin() + 1, shape.end(),
+                                      expected.begin() + 1),
+                       nncase_errc::shape_mismatch);
+        if (i == 0)
+            batch = shape[0];
+        CHECK_WITH_ERR(shape[0] == batch, nncase_errc::shape_mismatch);
+    }
+
+    CHECK_WITH_ERR(batch && batch <= max_batch_size_,
+                   std::errc::invalid_argument);
+    return ok(batch);
+}
+
+result<void>
+batching_executor::submit(std::vector<runtime_tensor> inputs,
+                          callback_t callback) noexcept {
+    try_var(batch, validate(inputs));
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        CHECK_WITH_ERR(!stop_, std::errc::operation_canceled);
+        queue_.push_back({std::move(inputs), batch, std::move(callback),
+                          std::chrono::steady_clock::now()});
+        queued_rows_ += batch;
+    }
+    cond_.notify_all();
+    return ok();
+}
+
+std::future<result<batching_executor::outputs_t>>
+batching_executor::submit(std::vector<runtime_tensor> inputs) noexcept {
+    auto promise = std::make_shared<std::promise<result<outputs_t>>>();
+    auto future = promise->get_future();
+    auto submitted =
+        submit(std::move(inputs), [promise](result<outputs_t> outputs) {
+            promise->set_value(std::move(outputs));
+        });
+    if (submitted.is_err())
+        promise->set_value(err(std::move(submitted.unwrap_err())));
+    return future;
+}
+
+void batching_executor::executor_main() noexcept {
+    std::vector<request> batch;
+    while (true) {
+        size_t rows = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (stop_)
+                return;
+
+            // Wait for more requests until the bucket is full or the oldest
+            // request runs out of its latency budget.
+            auto deadline = queue_.front().arrival + options_.max_latency;
+            cond_.wait_until(lock, deadline, [this] {
+                return stop_ || queued_rows_ >= max_batch_size_;
+            });
+            if (stop_)
+                return;
+
+            while (!queue_.empty() &&
+                   rows + queue_.front().batch <= max_batch_size_) {
+                rows += queue_.front().batch;
+                queued_rows_ -= queue_.front().batch;
+                batch.emplace_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+
+        auto outputs = run_batch(batch, rows);
+        for (size_t i = 0; i < batch.size(); i++) {
+            if (outputs.is_ok())
+                batch[i].callback(ok(std::move(outputs.unwrap()[i])));
+            else
+                batch[i].callback(err(outputs.unwrap_err()));
+        }
+        batch.clear();
+    }
+}
+
+result<std::vector<batching_executor::outputs_t>>
+batching_executor::run_batch(std::vector<request> &batch,
+                             size_t rows) noexcept {
+    // 1. Gather the requests into the bucket sized inputs
+    std::vector<value_t> params(input_shapes_.size());
+    for (size_t i = 0; i < params.size(); i++) {
+        try_var(input, runtime::detail::create(input_types_[i]->dtype(),
+                                               input_shapes_[i]));
+        try_var(input_host, input->buffer().as_host());
+        try_var(input_map, input_host.map(map_write));
+        auto dest = input_map.buffer().data();
+        auto dest_row_bytes = row_bytes(input);
+        for (auto &req : batch) {
+            try_var(src_map, hrt::map(req.inputs[i], map_read));
+            auto size = req.batch * dest_row_bytes;
+            std::memcpy(dest, src_map.buffer().data(), size);
+            dest += size;
+        }
+
+        std::memset(dest, 0, (max_batch_size_ - rows) * dest_row_bytes);
+        params[i] = input;
+    }
+
+    // 2. Run the whole bucket at once
+    try_var(ret, entry_->invoke(params));
+    std::vector<tensor> batched_outputs;
+    if (ret.is_a<tensor>()) {
+        batched_outputs.emplace_back(ret.as<tensor>().unwrap());
+    } else {
+        try_var(fields, ret.as<tuple>());
+        for (auto &field : fields->fields()) {
+            try_var(t, field.as<tensor>());
+            batched_outputs.emplace_back(std::move(t));
+        }
+    }
+
+    // 3. Scatter outputs as views of the batched buffers
+    std::vector<outputs_t> outputs(batch.size());
+    for (auto &output : batched_outputs) {
+        CHECK_WITH_ERR(!output->shape().empty() &&
+                           output->shape()[0] == max_batch_size_ &&
+                           output->is_contiguous(),
+                       nncase_errc::shape_mismatch);
+        auto out_row_bytes = row_bytes(output);
+        auto start = output->buffer().start();
+        for (size_t r = 0; r < batch.size(); r++) {
+            auto shape = to_dims(output->shape());
+            shape[0] = batch[r].batch;
+            auto size = batch[r].batch * out_row_bytes;
+            buffer_slice slice(output->buffer().buffer(), start, size);
+            outputs[r].emplace_back(tensor(
+                std::in_place, output->dtype(), std::move(shape),
+                strides_t(output->strides().begin(), output->strides().end()),
+                std::move(slice)));
+            start += size;
+        }
+    }
+
+    return ok(std::move(outputs));
+}
@@ -5,9 +5,15 @@
 #else
 #include <filesystem>
 #endif
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <nncase/runtime/dbg.h>
 #include <nncase/runtime/dump_manager.h>
 #include <nncase/runtime/result.h>
 #include <nncase/runtime/stackvm/opcode.h>
+#include <thread>
 
 #if defined(__nds_v5)
 #include <experimental/filesystem>
@@ -20,6 +26,177 @@ namespace fs = std::filesystem;
 using namespace nncase;
 using namespace nncase::runtime;
 
+namespace {
+constexpr char async_dump_magic[8] = {'N', 'N', 'C', 'D', 'U', 'M', 'P', '1'};
+
+struct dump_record {
+    uint64_t request;
+    uint32_t op_index;
+    uint8_t kind;
+    uint8_t typecode;
+    std::string name;
+    dims_t shape;
+    strides_t strides;
+    std::vector<gsl::byte> data;
+};
+
+template <class T> void write_pod(std::ofstream &file, T value) {
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+} // namespace
+
+/* The inference thread only filters and copies the sampled tensors, the
+ * files are written by the writer thread. */
+struct dump_manager::async_writer {
+    dump_async_options options;
+    std::ofstream file;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<dump_record> queue;
+    size_t queued_bytes = 0;
+    size_t dropped = 0;
+    bool stopping = false;
+
+    // Owned by the inference thread.
+    std::string current_op;
+    uint64_t request = 0;
+    uint64_t next_request = 0;
+    bool request_sampled = true;
+    uint32_t op_index = 0;
+    bool op_sampled = false;
+
+    ~async_writer() {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cond.notify_one();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    void begin_op(const std::string &name) {
+        op_index++;
+        op_sampled =
+            request_sampled &&
+            (options.ops.empty() ||
+             std::find(options.ops.begin(), options.ops.end(), name) !=
+                 options.ops.end());
+    }
+
+    void dump(const value_t &value, const std::string &name, uint8_t kind) {
+        if (value.is_a<tensor>()) {
+            dump(value.as<tensor>().unwrap(), name, kind);
+        } else if (value.is_a<tuple>()) {
+            auto fields = value.as<tuple>().unwrap()->fields();
+            for (size_t i = 0; i < fields.size(); i++)
+                dump(fields[i], name + "_" + std::to_string(i), kind);
+        }
+    }
+
+    void dump(const tensor &t, const std::string &name, uint8_t kind) {
+        auto typecode = to_typecode(t->dtype());
+        auto host = t->buffer().as_host();
+        if (typecode.is_err() || host.is_err()) {
+            drop();
+            return;
+        }
+
+        auto shape = t->shape();
+        auto strides = t->strides();
+        size_t last = 0;
+        for (size_t i = 0; i < shape.size(); i++) {
+            if (!shape[i]) {
+                last = SIZE_MAX;
+                break;
+            }
+            last += (shape[i] - 1) * strides[i];
+        }
+        auto bytes =
+            last == SIZE_MAX ? 0 : (last + 1) * t->dtype()->size_bytes();
+        if (!reserve(bytes)) {
+            drop();
+            return;
+        }
+
+        auto map = host.unwrap().map(map_read);
+        if (map.is_err()) {
+            release(bytes);
+            drop();
+            return;
+        }
+        auto mapped = std::move(map.unwrap());
+        auto data = mapped.buffer().data();
+        dump_record record{request,
+                           op_index,
+                           kind,
+                           (uint8_t)typecode.unwrap(),
+                           current_op + "$" + name,
+                           dims_t(shape.begin(), shape.end()),
+                           strides_t(strides.begin(), strides.end()),
+                           std::vector<gsl::byte>(data, data + bytes)};
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queue.emplace_back(std::move(record));
+        }
+        cond.notify_one();
+    }
+
+    bool reserve(size_t bytes) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (queued_bytes + bytes > options.max_queue_bytes)
+            return false;
+        queued_bytes += bytes;
+        return true;
+    }
+
+    void release(size_t bytes) {
+        std::unique_lock<std::mutex> lock(mutex);
+        queued_bytes -= bytes;
+    }
+
+    void drop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        dropped++;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cond.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                file.flush();
+                return;
+            }
+
+            auto record = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            write(record);
+            lock.lock();
+            queued_bytes -= record.data.size();
+        }
+    }
+
+    void write(const dump_record &record) {
+        write_pod(file, record.request);
+        write_pod(file, record.op_index);
+        write_pod(file, record.kind);
+        write_pod(file, record.typecode);
+        write_pod(file, (uint16_t)record.name.size());
+        write_pod(file, (uint32_t)record.shape.size());
+        write_pod(file, (uint64_t)record.data.size());
+        file.write(record.name.data(), record.name.size());
+        for (auto dim : record.shape)
+            write_pod(file, (uint64_t)dim);
+        for (auto stride : record.strides)
+            write_pod(file, (uint64_t)stride);
+        file.write(reinterpret_cast<const char *>(record.data.data()),
+                   record.data.size());
+    }
+};
+
 void dump_manager::set_dump_root(std::string root) {
     dump_root_.clear();
     fs::path p(root);
@@ -40,6 +217,11 @@ void dump_manager::dump_op(
 
 void dump_manager::dump_op(const std::string &func_str) {
     set_current_op(func_str);
+    if (async_) {
+        async_->current_op = func_str;
+        async_->begin_op(func_str);
+        return;
+    }
     dump_append(*this, [&](auto &stream) { stream << func_str << std::endl; });
 }
 
@@ -106,11 +288,57 @@ void dump_output_impl(dump_manager &dump_manager_, nncase::value_t value,
 }
 
 void dump_manager::dump_output(nncase::value_t value) {
+    if (async_) {
+        if (async_->op_sampled)
+            async_->dump(value, "out", 1);
+        return;
+    }
     dump_output_impl(*this, value, fs::path(dump_path()).string(), true);
 }
 
 void dump_manager::dump_input(nncase::value_t value, std::string name) {
+    if (async_) {
+        if (async_->op_sampled)
+            async_->dump(value, name, 0);
+        return;
+    }
     dump_output_impl(*this, value, fs::path(dump_path() + "$" + name).string(),
                      false);
 }
+
+result<void> dump_manager::start_async(dump_async_options options) {
+    CHECK_WITH_ERR(!dump_root_.empty(), std::errc::invalid_argument);
+    CHECK_WITH_ERR(options.request_interval, std::errc::invalid_argument);
+    stop_async();
+
+    auto writer = std::make_shared<async_writer>();
+    writer->options = std::move(options);
+    writer->file.open((fs::path(dump_root_) / "dump.bin").string(),
+                      std::ios::binary | std::ios::app);
+    CHECK_WITH_ERR(writer->file.good(), std::errc::io_error);
+    if (writer->file.tellp() == 0)
+        writer->file.write(async_dump_magic, sizeof(async_dump_magic));
+    writer->thread = std::thread([w = writer.get()] { w->run(); });
+    async_ = std::move(writer);
+    return ok();
+}
+
+void dump_manager::stop_async() { async_.reset(); }
+
+void dump_manager::begin_request() {
+    if (async_) {
+        auto &writer = *async_;
+        writer.request = writer.next_request++;
+        writer.request_sampled =
+            writer.request % writer.options.request_interval == 0;
+        writer.op_index = 0;
+    }
+}
+
+size_t dump_manager::dropped_records() const noexcept {
+    if (!async_)
+        return 0;
+    std::unique_lock<std::mutex> lock(async_->mutex);
+    return async_->dropped;
+}
 #endif
\ No newline at end of file
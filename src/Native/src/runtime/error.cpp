@@ -49,6 +49,8 @@ class nncase_error_category : public std::error_category {
             return "StackVM stack overflow";
         case nncase_errc::stackvm_stack_underflow:
             return "StackVM stack underflow";
+        case nncase_errc::stackvm_custom_call_failed:
+            return "StackVM custom call failed";
         case nncase_errc::nnil_illegal_instruction:
             return "NNIL illegal instruction";
         default:
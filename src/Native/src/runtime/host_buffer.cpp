@@ -122,10 +122,11 @@ host_buffer_node::copy_to(buffer_t dest, size_t src_start, size_t dest_start,
     try_var(dest_host, dest.as<host_buffer_t>());
     try_var(src_map, map(map_read));
     try_var(dest_map, dest_host->map(map_write));
+    // Slices start at a byte offset, see host_buffer_slice::map
     return kernels::stackvm::optimized::slice(
-        datatype, src_map.buffer().data() + src_start * datatype->size_bytes(),
-        dest_map.buffer().data() + dest_start * datatype->size_bytes(), shape,
-        src_strides, dest_strides, begins, ends, strides,
+        datatype, src_map.buffer().data() + src_start,
+        dest_map.buffer().data() + dest_start, shape, src_strides,
+        dest_strides, begins, ends, strides,
         kernels::default_kernel_context());
 }
 
@@ -12,7 +12,9 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <nncase/runtime/char_array_buffer.h>
 #include <nncase/runtime/dbg.h>
@@ -26,6 +28,15 @@
 using namespace nncase;
 using namespace nncase::runtime;
 
+namespace {
+result<void> fill_zeros(runtime_tensor &tensor) noexcept {
+    try_var(map, hrt::map(tensor, map_write));
+    auto buffer = map.buffer();
+    std::memset(buffer.data(), 0, buffer.size_bytes());
+    return ok();
+}
+} // namespace
+
 interpreter::interpreter() noexcept : entry_function_(nullptr) {}
 
 result<void> interpreter::load_model(gsl::span<const gsl::byte> buffer,
@@ -39,6 +50,8 @@ result<void> interpreter::load_model(gsl::span<const gsl::byte> buffer,
     span_reader reader(buffer);
     auto &header = *reader.get_ref<model_header>();
     try_(initialize_model(header));
+    if (autotune_enabled())
+        try_(initialize_autotuner(autotuner::hash(buffer)));
 
     for (size_t i = 0; i < header.modules; i++) {
         auto mod_type = reader.peek_with_offset<decltype(module_header::kind)>(
@@ -63,11 +76,26 @@ result<void> interpreter::load_model(gsl::span<const gsl::byte> buffer,
 }
 
 result<void> interpreter::load_model(std::istream &stream) noexcept {
+    auto model_pos = stream.tellg();
     stream_reader reader(stream);
     auto header = reader.read<model_header>();
     try_(initialize_model(header));
 
     std::streampos module_pos = reader.tell();
+    if (autotune_enabled()) {
+        // Hash the whole model, then come back to the modules
+        auto hash = autotuner::hash({});
+        char chunk[4096];
+        stream.seekg(model_pos);
+        while (stream.read(chunk, sizeof(chunk)) || stream.gcount()) {
+            hash = autotuner::hash(
+                {reinterpret_cast<const gsl::byte *>(chunk),
+                 (size_t)stream.gcount()},
+                hash);
+        }
+        stream.clear();
+        try_(initialize_autotuner(hash));
+    }
     for (size_t i = 0; i < header.modules; i++) {
         reader.seek(module_pos);
 
@@ -93,6 +121,8 @@ result<void> interpreter::load_model(std::istream &stream) noexcept {
 result<void>
 interpreter::initialize_model(const model_header &header) noexcept {
     entry_function_ = nullptr;
+    states_.clear();
+    autotuner_.reset();
     // 1. Validate model
     if (header.identifier != MODEL_IDENTIFIER)
         return err(nncase_errc::invalid_model_indentifier);
@@ -109,6 +139,17 @@ interpreter::initialize_model(const model_header &header) noexcept {
     return ok();
 }
 
+bool interpreter::autotune_enabled() noexcept {
+    auto dir = options_.get<std::string>(autotune_cache_dir_option);
+    return dir.is_ok() && !dir.unwrap().empty();
+}
+
+result<void> interpreter::initialize_autotuner(uint64_t model_hash) noexcept {
+    try_var(dir, options_.get<std::string>(autotune_cache_dir_option));
+    try_set(autotuner_, autotuner::create(dir, model_hash));
+    return ok();
+}
+
 size_t interpreter::inputs_size() const noexcept {
     return entry_function_->parameters_size();
 }
@@ -257,6 +298,73 @@ result<size_t> interpreter::find_id_by_module(runtime_module *module) noexcept {
     return ok((it - modules_.begin()));
 }
 
+size_t interpreter::states_size() const noexcept { return states_.size(); }
+
+result<size_t>
+interpreter::find_state_by_name(std::string_view name) const noexcept {
+    for (size_t i = 0; i < states_.size(); i++) {
+        if (states_[i].name == name)
+            return ok(i);
+    }
+    return err(std::errc::result_out_of_range);
+}
+
+result<std::string_view>
+interpreter::state_name(size_t index) const noexcept {
+    CHECK_WITH_ERR(index < states_.size(), std::errc::result_out_of_range);
+    return ok(std::string_view(states_[index].name));
+}
+
+result<runtime_tensor> interpreter::state_tensor(size_t index) noexcept {
+    CHECK_WITH_ERR(index < states_.size(), std::errc::result_out_of_range);
+    return ok(states_[index].tensor);
+}
+
+result<void> interpreter::state_tensor(size_t index,
+                                       runtime_tensor tensor) noexcept {
+    CHECK_WITH_ERR(index < states_.size(), std::errc::result_out_of_range);
+    // The modules hold the state buffer, so it is filled instead of replaced.
+    auto &state = states_[index].tensor;
+    CHECK_WITH_ERR(tensor.datatype() == state.datatype(),
+                   std::errc::invalid_argument);
+    CHECK_WITH_ERR(tensor.shape().size() == state.shape().size() &&
+                       std::equal(tensor.shape().begin(), tensor.shape().end(),
+                                  state.shape().begin()),
+                   nncase_errc::shape_mismatch);
+    return tensor.copy_to(state);
+}
+
+result<void> interpreter::reset_states() noexcept {
+    for (auto &state : states_)
+        try_(fill_zeros(state.tensor));
+    return ok();
+}
+
+result<runtime_tensor>
+interpreter::add_state(std::string_view name, typecode_t datatype,
+                       gsl::span<const size_t> shape) noexcept {
+    auto index = find_state_by_name(name);
+    if (index.is_ok()) {
+        auto &state = states_[index.unwrap()].tensor;
+        CHECK_WITH_ERR(state.datatype() == datatype &&
+                           state.shape().size() == shape.size() &&
+                           std::equal(shape.begin(), shape.end(),
+                                      state.shape().begin()),
+                       nncase_errc::shape_mismatch);
+        return ok(state);
+    }
+
+    try_var(tensor, hrt::create(datatype, dims_t(shape.begin(), shape.end())));
+    try_(fill_zeros(tensor));
+
+    try {
+        states_.push_back({std::string(name), tensor});
+    } catch (...) {
+        return err(std::errc::not_enough_memory);
+    }
+    return ok(tensor);
+}
+
 options_dict &interpreter::options() noexcept { return options_; }
 
 result<runtime_function *> interpreter::entry_function() noexcept {
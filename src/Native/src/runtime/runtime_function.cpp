@@ -173,10 +173,17 @@ result<void> runtime_function::initialize(
 
 result<value_t> runtime_function::invoke(gsl::span<value_t> parameters,
                                          value_t return_value) noexcept {
+#ifdef NNCASE_DUMP_MANAGER
+    {
+        try_var(entry_func, module().interp().entry_function());
+        if (entry_func == this)
+            module().interp().dump_manager()->begin_request();
+    }
+#endif
     checked_try_var(retval, invoke_core(parameters, return_value));
 #ifdef ENABLE_OP_PROFILE
     try_var(entry_func, module().interp().entry_function());
-    if (entry_func == this) {
+    if (entry_func == this && op_profile::print_on_invoke) {
         op_profile::print();
     }
 #endif
@@ -41,7 +41,12 @@ stack_entry call_frame::field(size_t index) const noexcept {
 void call_frame::field(size_t index, stack_entry value) noexcept {
     if (fields_.size() <= index)
         fields_.resize(index + 1);
-    fields_[index] = value;
+    fields_[index] = std::move(value);
+}
+
+stack_entry call_frame::take_field(size_t index) noexcept {
+    dbg_check(index < fields_.size());
+    return std::move(fields_[index]);
 }
 
 bool call_frames::empty() const noexcept { return frames_.empty(); }
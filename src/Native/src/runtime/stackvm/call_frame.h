@@ -28,6 +28,8 @@ class call_frame {
 
     stack_entry field(size_t index) const noexcept;
     void field(size_t index, stack_entry value) noexcept;
+    /** @brief Move the field out, leaving null in its place */
+    stack_entry take_field(size_t index) noexcept;
 
     result<void> push_back_arg(stack_entry arg) noexcept;
 
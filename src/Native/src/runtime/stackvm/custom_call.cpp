@@ -0,0 +1,191 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "custom_call.h"
+#include <cerrno>
+#include <mutex>
+#include <nncase/runtime/dbg.h>
+#include <nncase/runtime/error.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/tensor.h>
+#include <unordered_map>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+
+namespace {
+constexpr size_t min_scratch_block_bytes = 64 * 1024;
+
+struct custom_call_registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, nncase_custom_call_fn> calls;
+};
+
+custom_call_registry &registry() {
+    static custom_call_registry instance;
+    return instance;
+}
+
+custom_call_invoker &invoker_of(nncase_custom_call_context_t *ctx) noexcept {
+    return *reinterpret_cast<custom_call_invoker *>(ctx->runtime_data);
+}
+} // namespace
+
+int nncase_register_custom_call(uint32_t abi_version, const char *name,
+                                nncase_custom_call_fn fn) {
+    if ((abi_version >> 16) != NNCASE_CUSTOM_CALL_ABI_VERSION_MAJOR)
+        return -ENOTSUP;
+    if (!name || !fn)
+        return -EINVAL;
+
+    auto &reg = registry();
+    std::unique_lock<std::mutex> lock(reg.mutex);
+    try {
+        if (!reg.calls.emplace(name, fn).second)
+            return -EEXIST;
+    } catch (...) {
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+std::vector<std::pair<std::string, nncase_custom_call_fn>>
+stackvm::registered_custom_calls() {
+    auto &reg = registry();
+    std::unique_lock<std::mutex> lock(reg.mutex);
+    return {reg.calls.begin(), reg.calls.end()};
+}
+
+result<value_t>
+custom_call_invoker::invoke(nncase_custom_call_fn fn,
+                            gsl::span<const gsl::byte> fields,
+                            gsl::span<const value_t> args,
+                            const kernels::kernel_context &context) noexcept {
+    // The arguments stay owned by the caller, only their buffers are mapped.
+    views_.resize(args.size());
+    for (size_t i = 0; i < args.size(); i++) {
+        auto mapped = map_arg(args[i], views_[i], map_read);
+        if (mapped.is_err()) {
+            release();
+            return err(std::move(mapped.unwrap_err()));
+        }
+    }
+
+    context_ = &context;
+    nncase_custom_call_context_t ctx{NNCASE_CUSTOM_CALL_ABI_VERSION,
+                                     context.num_threads,
+                                     scratch_alloc,
+                                     parallel_for,
+                                     alloc_output,
+                                     this};
+    auto ret = fn(&ctx, fields.data(), fields.size(), views_.data(),
+                  views_.size());
+    value_t output;
+    if (!ret && !outputs_.empty()) {
+        if (outputs_.size() == 1)
+            output = outputs_[0];
+        else
+            output = tuple(std::in_place, std::vector<value_t>(outputs_));
+    }
+
+    release();
+    CHECK_WITH_ERR(!ret, nncase_errc::stackvm_custom_call_failed);
+    CHECK_WITH_ERR(!output.empty(), nncase_errc::stackvm_custom_call_failed);
+    return ok(std::move(output));
+}
+
+result<void> custom_call_invoker::map_arg(const value_t &arg,
+                                          nncase_tensor_view_t &view,
+                                          map_access_t access) noexcept {
+    try_var(t, arg.as<tensor>());
+    try_var(host, t->buffer().as_host());
+    try_var(map, host.map(access));
+    view.typecode = t->dtype()->typecode();
+    view.rank = (uint32_t)t->shape().size();
+    view.shape = t->shape().data();
+    view.strides = t->strides().data();
+    view.data = map.buffer().data();
+    maps_.emplace_back(std::move(map));
+    return ok();
+}
+
+void custom_call_invoker::release() noexcept {
+    maps_.clear();
+    outputs_.clear();
+    scratch_block_ = 0;
+    scratch_used_ = 0;
+    context_ = nullptr;
+}
+
+void *custom_call_invoker::scratch_alloc(nncase_custom_call_context_t *ctx,
+                                         size_t bytes,
+                                         size_t alignment) noexcept {
+    auto &self = invoker_of(ctx);
+    if (!alignment)
+        alignment = alignof(std::max_align_t);
+    if (alignment & (alignment - 1))
+        return nullptr;
+
+    // Blocks are kept across calls, so steady state calls never allocate.
+    for (; self.scratch_block_ < self.scratch_.size(); self.scratch_block_++) {
+        auto &block = self.scratch_[self.scratch_block_];
+        auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        auto begin = (base + self.scratch_used_ + alignment - 1) &
+                     ~(uintptr_t)(alignment - 1);
+        if (begin + bytes <= base + block.size) {
+            self.scratch_used_ = begin + bytes - base;
+            return reinterpret_cast<void *>(begin);
+        }
+        self.scratch_used_ = 0;
+    }
+
+    auto size = std::max(bytes + alignment, min_scratch_block_bytes);
+    std::unique_ptr<gsl::byte[]> data(new (std::nothrow) gsl::byte[size]);
+    if (!data)
+        return nullptr;
+    try {
+        self.scratch_.push_back({std::move(data), size});
+    } catch (...) {
+        return nullptr;
+    }
+    return scratch_alloc(ctx, bytes, alignment);
+}
+
+void custom_call_invoker::parallel_for(nncase_custom_call_context_t *ctx,
+                                       size_t count,
+                                       nncase_parallel_body_t body,
+                                       void *user_data) noexcept {
+    kernels::parallel_for(*invoker_of(ctx).context_, count, body, user_data);
+}
+
+int custom_call_invoker::alloc_output(nncase_custom_call_context_t *ctx,
+                                      uint32_t typecode, uint32_t rank,
+                                      const size_t *shape,
+                                      nncase_tensor_view_t *view) noexcept {
+    auto &self = invoker_of(ctx);
+    if (!view || (rank && !shape))
+        return -EINVAL;
+
+    auto allocate = [&]() -> result<void> {
+        try_var(dtype, datatype_t::from_typecode((typecode_t)typecode));
+        try_var(output,
+                runtime::detail::create(dtype, dims_t(shape, shape + rank)));
+        self.outputs_.emplace_back(output);
+        return self.map_arg(output, *view, map_write);
+    };
+
+    auto ret = allocate();
+    return ret.is_ok() ? 0 : -ret.unwrap_err().value();
+}
@@ -0,0 +1,76 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <memory>
+#include <nncase/kernels/kernel_context.h>
+#include <nncase/runtime/custom_call.h>
+#include <nncase/runtime/host_buffer.h>
+#include <nncase/runtime/runtime_module.h>
+#include <nncase/value.h>
+#include <string>
+#include <vector>
+
+BEGIN_NS_NNCASE_RT_MODULE(stackvm)
+
+/** @brief Custom call kernel resolved at module load, one of the two is set */
+struct custom_call_entry {
+    runtime_module::custom_call_type call = nullptr;
+    nncase_custom_call_fn abi_call = nullptr;
+};
+
+/** @brief Kernels registered by nncase_register_custom_call */
+std::vector<std::pair<std::string, nncase_custom_call_fn>>
+registered_custom_calls();
+
+/** @brief Calls C ABI kernels, reusing its views and scratch memory across
+ * calls. Not thread safe, every function owns one. */
+class custom_call_invoker {
+  public:
+    result<value_t> invoke(nncase_custom_call_fn fn,
+                           gsl::span<const gsl::byte> fields,
+                           gsl::span<const value_t> args,
+                           const kernels::kernel_context &context) noexcept;
+
+  private:
+    struct scratch_block {
+        std::unique_ptr<gsl::byte[]> data;
+        size_t size;
+    };
+
+    static void *scratch_alloc(nncase_custom_call_context_t *ctx, size_t bytes,
+                               size_t alignment) noexcept;
+    static void parallel_for(nncase_custom_call_context_t *ctx, size_t count,
+                             nncase_parallel_body_t body,
+                             void *user_data) noexcept;
+    static int alloc_output(nncase_custom_call_context_t *ctx,
+                            uint32_t typecode, uint32_t rank,
+                            const size_t *shape,
+                            nncase_tensor_view_t *view) noexcept;
+
+    result<void> map_arg(const value_t &arg, nncase_tensor_view_t &view,
+                         map_access_t access) noexcept;
+    void release() noexcept;
+
+  private:
+    const kernels::kernel_context *context_ = nullptr;
+    std::vector<nncase_tensor_view_t> views_;
+    std::vector<mapped_buffer> maps_;
+    std::vector<value_t> outputs_;
+    std::vector<scratch_block> scratch_;
+    size_t scratch_block_ = 0;
+    size_t scratch_used_ = 0;
+};
+
+END_NS_NNCASE_RT_MODULE
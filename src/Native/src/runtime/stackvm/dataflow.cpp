@@ -0,0 +1,193 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "dataflow.h"
+#include <nncase/runtime/dbg.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+
+namespace nncase::runtime::stackvm {
+struct dataflow_task {
+    std::vector<value_t> inputs;
+    tensor_op_thunk thunk;
+    pending_value output;
+    // Unfinished pending inputs, plus one guard held during dispatch.
+    std::atomic<size_t> remaining;
+};
+} // namespace nncase::runtime::stackvm
+
+result<value_t> pending_value_node::wait() const noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return completed_; });
+    return value_;
+}
+
+result<void> pending_value_node::copy_to(value_t dest) const noexcept {
+    try_var(value, wait());
+    return value->copy_to(dest);
+}
+
+dataflow_scheduler::dataflow_scheduler(size_t num_threads,
+                                       size_t max_inflight) noexcept
+    : requested_threads_(std::max(num_threads, (size_t)1)),
+      max_inflight_(std::max(max_inflight, (size_t)1)),
+      inflight_(0),
+      stop_(false) {}
+
+dataflow_scheduler::~dataflow_scheduler() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cond_.wait(lock, [this] { return inflight_ == 0; });
+        stop_ = true;
+    }
+    work_cond_.notify_all();
+    for (auto &thread : threads_)
+        thread.join();
+}
+
+result<void> dataflow_scheduler::start() noexcept {
+    try {
+        threads_.reserve(requested_threads_);
+        for (size_t i = 0; i < requested_threads_; i++)
+            threads_.emplace_back([this] { worker_main(); });
+        return ok();
+    } catch (...) {
+        return err(std::errc::resource_unavailable_try_again);
+    }
+}
+
+result<value_t> dataflow_scheduler::resolve(value_t value) noexcept {
+    if (value.is_a<pending_value>()) {
+        return static_cast<pending_value_node *>(value.get())->wait();
+    }
+    return ok(std::move(value));
+}
+
+result<value_t>
+dataflow_scheduler::dispatch(std::vector<value_t> inputs,
+                             tensor_op_thunk thunk) noexcept {
+    auto task = std::make_shared<dataflow_task>();
+    task->inputs = std::move(inputs);
+    task->thunk = std::move(thunk);
+    task->output = pending_value(std::in_place);
+    task->remaining.store(1, std::memory_order_relaxed);
+
+    {
+        // Back-pressure: the oldest in-flight op is always runnable, so the
+        // VM thread never waits forever here.
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cond_.wait(lock, [this] { return inflight_ < max_inflight_; });
+        inflight_++;
+    }
+
+    for (auto &input : task->inputs) {
+        if (input.is_a<pending_value>()) {
+            auto &producer = *static_cast<pending_value_node *>(input.get());
+            std::unique_lock<std::mutex> lock(producer.mutex_);
+            if (!producer.completed_) {
+                task->remaining.fetch_add(1, std::memory_order_relaxed);
+                producer.continuations_.emplace_back(task);
+            }
+        }
+    }
+
+    value_t output = task->output;
+    if (task->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        enqueue(std::move(task));
+    return ok(std::move(output));
+}
+
+result<void> dataflow_scheduler::wait_all() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cond_.wait(lock, [this] { return inflight_ == 0; });
+    auto error = std::exchange(first_error_, {});
+    if (error)
+        return err(std::move(error));
+    return ok();
+}
+
+void dataflow_scheduler::enqueue(std::shared_ptr<dataflow_task> task) noexcept {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.emplace_back(std::move(task));
+    }
+    work_cond_.notify_one();
+}
+
+void dataflow_scheduler::worker_main() noexcept {
+    // Inter-op parallelism replaces intra-op threading inside the pool.
+    auto context = kernels::default_kernel_context();
+    context.num_threads = 1;
+    context.dump_manager = nullptr;
+
+    while (true) {
+        std::shared_ptr<dataflow_task> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cond_.wait(lock, [this] { return stop_ || !ready_.empty(); });
+            if (ready_.empty())
+                return;
+            task = std::move(ready_.front());
+            ready_.pop_front();
+        }
+
+        execute(*task, context);
+    }
+}
+
+void dataflow_scheduler::execute(dataflow_task &task,
+                                 kernels::kernel_context &context) noexcept {
+    auto run = [&]() -> result<value_t> {
+        // All producers have completed at this point, wait() won't block.
+        for (auto &input : task.inputs) {
+            try_set(input, resolve(std::move(input)));
+        }
+        return task.thunk(task.inputs, context);
+    };
+
+    auto value = run();
+    task.inputs.clear();
+    task.thunk = nullptr;
+    complete(*task.output.get(), std::move(value));
+}
+
+void dataflow_scheduler::complete(pending_value_node &output,
+                                  result<value_t> value) noexcept {
+    std::vector<std::shared_ptr<dataflow_task>> continuations;
+    bool failed = value.is_err();
+    std::error_condition error = failed ? value.unwrap_err()
+                                        : std::error_condition();
+    {
+        std::unique_lock<std::mutex> lock(output.mutex_);
+        output.value_ = std::move(value);
+        output.completed_ = true;
+        continuations.swap(output.continuations_);
+    }
+    output.cond_.notify_all();
+
+    for (auto &task : continuations) {
+        if (task->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            enqueue(std::move(task));
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (failed && !first_error_)
+            first_error_ = error;
+        inflight_--;
+    }
+    idle_cond_.notify_all();
+}
@@ -0,0 +1,107 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <nncase/kernels/kernel_context.h>
+#include <nncase/runtime/result.h>
+#include <nncase/value.h>
+#include <thread>
+#include <vector>
+
+BEGIN_NS_NNCASE_RT_MODULE(stackvm)
+
+using tensor_op_thunk = std::function<result<value_t>(
+    gsl::span<const value_t> inputs, kernels::kernel_context &context)>;
+
+struct dataflow_task;
+
+/** @brief Output of a tensor op which may still be computing */
+class pending_value_node : public value_node {
+    DEFINE_OBJECT_KIND(value_node, object_pending_value)
+
+  public:
+    pending_value_node() noexcept
+        : completed_(false), value_(err(std::errc::operation_in_progress)) {}
+
+    /** @brief Block until the producer finished */
+    result<value_t> wait() const noexcept;
+
+    result<void> copy_to(value_t dest) const noexcept override;
+
+  private:
+    friend class dataflow_scheduler;
+
+    mutable std::mutex mutex_;
+    mutable std::condition_variable cond_;
+    bool completed_;
+    result<value_t> value_;
+    std::vector<std::shared_ptr<dataflow_task>> continuations_;
+};
+
+using pending_value = object_t<pending_value_node>;
+
+/** @brief Executes tensor ops on a thread pool as soon as their operands are
+ * ready
+ *
+ * The VM thread keeps decoding instructions while kernels run, so ops whose
+ * operands do not depend on each other (inception branches, Q/K/V
+ * projections...) execute concurrently. The number of ops in flight is bounded
+ * by max_inflight, which also bounds the intermediate tensors kept alive.
+ */
+class dataflow_scheduler {
+  public:
+    dataflow_scheduler(size_t num_threads, size_t max_inflight) noexcept;
+    dataflow_scheduler(const dataflow_scheduler &) = delete;
+    ~dataflow_scheduler();
+
+    size_t num_threads() const noexcept { return threads_.size(); }
+
+    result<void> start() noexcept;
+
+    /** @brief Schedule a tensor op, returns a pending value of its output */
+    result<value_t> dispatch(std::vector<value_t> inputs,
+                             tensor_op_thunk thunk) noexcept;
+
+    /** @brief Wait for all in-flight ops and collect the first error */
+    result<void> wait_all() noexcept;
+
+    static result<value_t> resolve(value_t value) noexcept;
+
+  private:
+    void worker_main() noexcept;
+    void enqueue(std::shared_ptr<dataflow_task> task) noexcept;
+    void execute(dataflow_task &task,
+                 kernels::kernel_context &context) noexcept;
+    void complete(pending_value_node &output, result<value_t> value) noexcept;
+
+  private:
+    size_t requested_threads_;
+    size_t max_inflight_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable work_cond_;
+    std::condition_variable idle_cond_;
+    std::deque<std::shared_ptr<dataflow_task>> ready_;
+    size_t inflight_;
+    bool stop_;
+    std::error_condition first_error_;
+};
+
+END_NS_NNCASE_RT_MODULE
@@ -34,10 +34,19 @@ double get_ms_time() {
 double get_ms_time() { return (double)clock() / 1000; }
 #endif
 
-std::vector<std::tuple<std::string, uint8_t, double, double>>
-    op_profile::op_timing_;
+std::vector<op_profile::timing_t> op_profile::op_timing_;
+bool op_profile::print_on_invoke = true;
+std::mutex op_profile::lock_;
+
+std::vector<op_profile::timing_t> op_profile::take() {
+    std::lock_guard<std::mutex> guard(lock_);
+    std::vector<timing_t> timing;
+    timing.swap(op_timing_);
+    return timing;
+}
 
 void op_profile::print() {
+    std::lock_guard<std::mutex> guard(lock_);
     std::map<std::string, double> op_timing;
     std::unordered_map<std::string, size_t> op_count;
 
@@ -242,6 +242,15 @@ result<void> tensor_op_visitor::visit(tensor_function_t tensor_funct,
     case tensor_function_t::unsqueeze_shape:
         return visit(
             tensor_op_reader<tensor_function_t::unsqueeze_shape>()(reader));
+    case tensor_function_t::variable_read:
+        return visit(
+            tensor_op_reader<tensor_function_t::variable_read>()(reader));
+    case tensor_function_t::variable_update:
+        return visit(
+            tensor_op_reader<tensor_function_t::variable_update>()(reader));
+    case tensor_function_t::weight_only_mat_mul:
+        return visit(
+            tensor_op_reader<tensor_function_t::weight_only_mat_mul>()(reader));
     case tensor_function_t::where:
         return visit(tensor_op_reader<tensor_function_t::where>()(reader));
     default:
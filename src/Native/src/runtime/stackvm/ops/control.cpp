@@ -22,22 +22,62 @@ using namespace nncase;
 using namespace nncase::runtime;
 using namespace nncase::runtime::stackvm;
 
+namespace {
+bool is_reusable(const tensor &t) noexcept {
+    return t.unique() && t->buffer().buffer().unique();
+}
+} // namespace
+
+result<stackvm_runtime_function::extcall_site>
+stackvm_runtime_function::resolve_extcall(const extcall_op_t &op,
+                                          uintptr_t module_id,
+                                          uintptr_t func_id) noexcept {
+    try_var(mod, module().interp().find_module_by_id(module_id));
+    try_var(func, mod->find_function_by_id(func_id));
+    extcall_site site{module_id, func_id, func, {}, {}};
+    if (op.is_prim_func) {
+        for (size_t i = op.args; i < func->parameters_size(); i++) {
+            try_var(type, func->parameter_type(i));
+            try_var(ttype, type.as<tensor_type>());
+            auto &shape = ttype->shape();
+            CHECK_WITH_ERR(shape.is_fixed(), std::errc::invalid_argument);
+            dims_t dims;
+            for (auto &d : shape)
+                dims.push_back(d.fixed_value());
+            site.output_layouts.emplace_back(ttype->dtype(), std::move(dims));
+        }
+        site.outputs.resize(site.output_layouts.size());
+    }
+    return ok(std::move(site));
+}
+
 result<void>
 stackvm_runtime_function::visit(NNCASE_UNUSED const extcall_op_t &op) noexcept {
     auto module_id = stack_.pop().as_u();
     auto func_id = stack_.pop().as_u();
-    try_var(mod, module().interp().find_module_by_id(module_id));
-    try_var(func, mod->find_function_by_id(func_id));
+    auto it = extcall_sites_.find(pc_);
+    if (it == extcall_sites_.end() || it->second.module_id != module_id ||
+        it->second.func_id != func_id) {
+        try_var(site, resolve_extcall(op, module_id, func_id));
+        it = extcall_sites_.insert_or_assign(pc_, std::move(site)).first;
+    }
+    auto &site = it->second;
+    auto func = site.func;
 
 #ifdef NNCASE_DUMP_MANAGER
     auto dump_manager = module().interp().dump_manager();
-    auto idPath = lookup_path(dump_manager->dump_path());
+    // The asynchronous dump must not touch the file system.
+    auto idPath =
+        dump_manager->is_async() ? "" : lookup_path(dump_manager->dump_path());
     // todo: should do search and only once
     auto name = lookup(idPath, module_id, func_id);
     dump_manager->dump_op(name);
 #endif
 
-    std::vector<value_t> params(op.args);
+    // A nested call through the same function finds the vector empty and
+    // allocates its own.
+    auto params = std::move(extcall_args_);
+    params.resize(op.args);
     for (size_t i = 0; i < op.args; i++) {
         try_var(arg, pop_object<value_t>());
 #ifdef NNCASE_DUMP_MANAGER
@@ -46,30 +86,35 @@ stackvm_runtime_function::visit(NNCASE_UNUSED const extcall_op_t &op) noexcept {
         params[i] = std::move(arg);
     }
 
-    if (op.is_prim_func) {
-        std::vector<value_t> outputs;
-        for (size_t i = op.args; i < func->parameters_size(); i++) {
-            try_var(type, func->parameter_type(i));
-            try_var(ttype, type.as<tensor_type>());
-            auto &shape = ttype->shape();
-            CHECK_WITH_ERR(shape.is_fixed(), std::errc::invalid_argument);
-            dims_t dims;
-            for (auto &d : shape)
-                dims.push_back(d.fixed_value());
-            try_var(t, runtime::detail::create(ttype->dtype(), dims));
-            outputs.emplace_back(t);
-            params.emplace_back(t);
+    auto invoke = [&]() -> result<value_t> {
+        if (op.is_prim_func) {
+            // The outputs of the previous call are reused once released.
+            for (size_t i = 0; i < site.outputs.size(); i++) {
+                auto &output = site.outputs[i];
+                if (!is_reusable(output)) {
+                    auto &layout = site.output_layouts[i];
+                    try_set(output, runtime::detail::create(layout.first,
+                                                            layout.second));
+                }
+                params.emplace_back(output);
+            }
+
+            try_(func->invoke(params));
+            if (site.outputs.size() == 1)
+                return ok<value_t>(site.outputs[0]);
+            return ok<value_t>(tuple(std::in_place,
+                                     std::vector<value_t>(site.outputs.begin(),
+                                                          site.outputs.end())));
         }
+        return func->invoke(params);
+    };
 
-        try_var(retval, func->invoke(params));
-        if (outputs.size() == 1)
-            stack_.push(outputs[0]);
-        else
-            stack_.push(tuple(std::in_place, std::move(outputs)));
-    } else {
-        try_var(retval, func->invoke(params));
-        stack_.push(retval);
-    }
+    auto retval = invoke();
+    params.clear();
+    extcall_args_ = std::move(params);
+    if (retval.is_err())
+        return err(std::move(retval.unwrap_err()));
+    stack_.push(std::move(retval.unwrap()));
 
 #ifdef NNCASE_DUMP_MANAGER
     dump_manager->dump_output(stack_.peek().as_object().as<value_t>().unwrap());
@@ -79,7 +124,14 @@ stackvm_runtime_function::visit(NNCASE_UNUSED const extcall_op_t &op) noexcept {
 
 result<void>
 stackvm_runtime_function::visit(NNCASE_UNUSED const cuscall_op_t &op) noexcept {
-    std::vector<value_t> params(op.args);
+    auto it = custom_calls_.find(pc_);
+    if (it == custom_calls_.end()) {
+        try_var(entry, module().find_custom_call(op.registered_name));
+        it = custom_calls_.emplace(pc_, entry).first;
+    }
+
+    auto &params = custom_call_args_;
+    params.resize(op.args);
 #ifdef NNCASE_DUMP_MANAGER
     auto dump_manager = module().interp().dump_manager();
     dump_manager->dump_op(op.registered_name);
@@ -92,15 +144,18 @@ stackvm_runtime_function::visit(NNCASE_UNUSED const cuscall_op_t &op) noexcept {
         params[i] = std::move(arg);
     }
 
-    auto table = module().custom_call_table();
-    auto it = table.find(op.registered_name);
-    if (it == table.end())
-        return err(nncase_errc::stackvm_unknow_custom_call);
-    try_var(retval,
-            it->second(op.fields_span, params, module().kernel_context()));
+    auto &context = module().kernel_context();
+    auto retval =
+        it->second.abi_call
+            ? custom_call_invoker_.invoke(it->second.abi_call, op.fields_span,
+                                          params, context)
+            : it->second.call(op.fields_span, params, context);
+    params.clear();
+    if (retval.is_err())
+        return err(std::move(retval.unwrap_err()));
 #ifdef NNCASE_DUMP_MANAGER
-    dump_manager->dump_output(retval);
+    dump_manager->dump_output(retval.unwrap());
 #endif
-    stack_.push(retval);
+    stack_.push(std::move(retval.unwrap()));
     return ok();
 }
@@ -224,8 +224,7 @@ NNCASE_STACKVM_DISPATCH_END()
 
 NNCASE_STACKVM_DISPATCH_BEGIN(LDTUPLE_ELEM)
 auto index = stack_.pop_nonobject<size_t>();
-auto value = stack_.pop_object();
-try_var(t, value.as<tuple>());
+try_var(t, pop_object<tuple>());
 stack_.push(t->fields()[index]);
 NNCASE_STACKVM_DISPATCH_END()
 
@@ -233,8 +232,7 @@ NNCASE_STACKVM_DISPATCH_BEGIN(LDTUPLE)
 auto count = stack_.pop_nonobject<size_t>();
 std::vector<value_t> fields(count);
 for (auto &field : fields) {
-    auto value = stack_.pop_object();
-    try_set(field, value.as<value_t>());
+    try_set(field, pop_object<value_t>());
 }
 
 stack_.push(tuple(std::in_place, std::move(fields)));
@@ -292,8 +290,13 @@ NNCASE_STACKVM_DISPATCH_END()
 
 NNCASE_STACKVM_DISPATCH_BEGIN(LDLOCAL)
 try_var(frame, frames_.top());
-auto field = frame->field(op.index);
-stack_.push(std::move(field));
+if (is_local_released_next(op.index)) {
+    reader_.skip(local_release_size);
+    stack_.push(frame->take_field(op.index));
+} else {
+    auto field = frame->field(op.index);
+    stack_.push(std::move(field));
+}
 NNCASE_STACKVM_DISPATCH_END()
 
 NNCASE_STACKVM_DISPATCH_BEGIN(STLOCAL)
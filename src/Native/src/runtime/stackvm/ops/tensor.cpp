@@ -52,9 +52,19 @@ result<void> stackvm_runtime_function::visit(
     dump_input(epsilon);
     try_var(momentum, pop_value());
     dump_input(momentum);
-    try_var(output, kernels::stackvm::batch_normalization(
-                        input, scale, bias, input_mean, input_var, epsilon,
-                        momentum, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::batch_normalization(inputs[0], inputs[1],
+                                                     inputs[2], inputs[3],
+                                                     inputs[4], inputs[5],
+                                                     inputs[6], output,
+                                                     context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(scale),
+                                        std::move(bias), std::move(input_mean),
+                                        std::move(input_var),
+                                        std::move(epsilon),
+                                        std::move(momentum)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -69,9 +79,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(block_shape);
     try_var(crops, pop_value());
     dump_input(crops);
-    try_var(output,
-            kernels::stackvm::batch_to_space(input, block_shape, crops, nullptr,
-                                             module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::batch_to_space(inputs[0], inputs[1], inputs[2],
+                                                output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input),
+                                        std::move(block_shape),
+                                        std::move(crops)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -84,8 +99,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(lhs);
     try_var(rhs, pop_value());
     dump_input(rhs);
-    try_var(output, kernels::stackvm::binary(op.binary_op, lhs, rhs, nullptr,
-                                             module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::binary(op.binary_op, inputs[0], inputs[1],
+                                        output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(lhs), std::move(rhs)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -98,9 +118,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(new_shape, pop_value());
     dump_input(new_shape);
-    try_var(output,
-            kernels::stackvm::bitcast(op.type, op.new_type, input, new_shape,
-                                      nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::bitcast(op.type, op.new_type, inputs[0],
+                                         inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(new_shape)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -113,8 +137,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(shape, pop_value());
     dump_input(shape);
-    try_var(output, kernels::stackvm::broadcast(input, shape, nullptr,
-                                                module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::broadcast(inputs[0], inputs[1], output,
+                                           context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(shape)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -125,8 +154,12 @@ result<void> stackvm_runtime_function::visit(
     dump_op("broadcast_shape");
     try_var(inputs, pop_value());
     dump_input(inputs);
-    try_var(output, kernels::stackvm::broadcast_shape(
-                        inputs, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::broadcast_shape(inputs[0], output, context);
+    };
+    try_var(output, dispatch_shape_op({std::move(inputs)}, kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -139,8 +172,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(shape, pop_value());
     dump_input(shape);
-    try_var(output, kernels::stackvm::bucket_pad(input, shape, nullptr,
-                                                 module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::bucket_pad(inputs[0], inputs[1], output,
+                                            context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(shape)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -151,8 +189,12 @@ result<void> stackvm_runtime_function::visit(
     dump_op("cast");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::cast(op.new_type, op.cast_mode, input,
-                                           nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::cast(op.new_type, op.cast_mode, inputs[0],
+                                      output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -165,8 +207,12 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(alpha, pop_value());
     dump_input(alpha);
-    try_var(output, kernels::stackvm::celu(input, alpha, nullptr,
-                                           module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::celu(inputs[0], inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(alpha)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -181,8 +227,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(min);
     try_var(max, pop_value());
     dump_input(max);
-    try_var(output, kernels::stackvm::clamp(input, min, max, nullptr,
-                                            module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::clamp(inputs[0], inputs[1], inputs[2], output,
+                                       context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(min),
+                                        std::move(max)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -195,8 +246,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(lhs);
     try_var(rhs, pop_value());
     dump_input(rhs);
-    try_var(output, kernels::stackvm::compare(op.compare_op, lhs, rhs, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::compare(op.compare_op, inputs[0], inputs[1],
+                                         output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(lhs), std::move(rhs)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -207,8 +263,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("concat");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::concat(op.axis, input, nullptr,
-                                             module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::concat(op.axis, inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -221,9 +280,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(predicate);
     try_var(value, pop_value());
     dump_input(value);
-    try_var(output, kernels::stackvm::condition(op.can_fold_const_call,
-                                                predicate, value, nullptr,
-                                                module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::condition(op.can_fold_const_call, inputs[0],
+                                           inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(predicate), std::move(value)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -236,8 +299,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(shape);
     try_var(value, pop_value());
     dump_input(value);
-    try_var(output, kernels::stackvm::constant_of_shape(
-                        shape, value, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::constant_of_shape(inputs[0], inputs[1],
+                                                   output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(shape), std::move(value)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -262,10 +330,18 @@ result<void> stackvm_runtime_function::visit(
     dump_input(groups);
     try_var(fused_clamp, pop_value());
     dump_input(fused_clamp);
-    try_var(output,
-            kernels::stackvm::conv2d(op.pad_mode, input, weights, bias, stride,
-                                     padding, dilation, groups, fused_clamp,
-                                     nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::conv2d(op.pad_mode, inputs[0], inputs[1],
+                                        inputs[2], inputs[3], inputs[4],
+                                        inputs[5], inputs[6], inputs[7],
+                                        output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(weights),
+                                        std::move(bias), std::move(stride),
+                                        std::move(padding), std::move(dilation),
+                                        std::move(groups),
+                                        std::move(fused_clamp)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -286,9 +362,17 @@ result<void> stackvm_runtime_function::visit(
     dump_input(dilation);
     try_var(groups, pop_value());
     dump_input(groups);
-    try_var(output, kernels::stackvm::conv2d_shape(
-                        input, weights, padding, stride, dilation, groups,
-                        nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::conv2d_shape(inputs[0], inputs[1], inputs[2],
+                                              inputs[3], inputs[4], inputs[5],
+                                              output, context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input), std::move(weights),
+                                       std::move(padding), std::move(stride),
+                                       std::move(dilation), std::move(groups)},
+                                      kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -317,10 +401,22 @@ result<void> stackvm_runtime_function::visit(
     dump_input(groups);
     try_var(fused_clamp, pop_value());
     dump_input(fused_clamp);
-    try_var(output, kernels::stackvm::conv2d_transpose(
-                        op.pad_mode, input, weights, bias, output_shape, stride,
-                        padding, output_padding, dilation, groups, fused_clamp,
-                        nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::conv2d_transpose(op.pad_mode, inputs[0],
+                                                  inputs[1], inputs[2],
+                                                  inputs[3], inputs[4],
+                                                  inputs[5], inputs[6],
+                                                  inputs[7], inputs[8],
+                                                  inputs[9], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(weights),
+                                        std::move(bias),
+                                        std::move(output_shape),
+                                        std::move(stride), std::move(padding),
+                                        std::move(output_padding),
+                                        std::move(dilation), std::move(groups),
+                                        std::move(fused_clamp)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -343,10 +439,20 @@ result<void> stackvm_runtime_function::visit(
     dump_input(output_padding);
     try_var(groups, pop_value());
     dump_input(groups);
-    try_var(output,
-            kernels::stackvm::conv2d_transpose_shape(
-                input, weights, stride, dilation, padding, output_padding,
-                groups, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::conv2d_transpose_shape(inputs[0], inputs[1],
+                                                        inputs[2], inputs[3],
+                                                        inputs[4], inputs[5],
+                                                        inputs[6], output,
+                                                        context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input), std::move(weights),
+                                       std::move(stride), std::move(dilation),
+                                       std::move(padding),
+                                       std::move(output_padding),
+                                       std::move(groups)}, kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -363,9 +469,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(exclusive);
     try_var(reverse, pop_value());
     dump_input(reverse);
-    try_var(output,
-            kernels::stackvm::cum_sum(input, axis, exclusive, reverse, nullptr,
-                                      module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::cum_sum(inputs[0], inputs[1], inputs[2],
+                                         inputs[3], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis),
+                                        std::move(exclusive),
+                                        std::move(reverse)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -378,9 +489,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(dequant_param, pop_value());
     dump_input(dequant_param);
-    try_var(output,
-            kernels::stackvm::dequantize(op.target_type, input, dequant_param,
-                                         nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::dequantize(op.target_type, inputs[0],
+                                            inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input),
+                                        std::move(dequant_param)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -393,8 +508,12 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(alpha, pop_value());
     dump_input(alpha);
-    try_var(output, kernels::stackvm::elu(input, alpha, nullptr,
-                                          module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::elu(inputs[0], inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(alpha)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -405,8 +524,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("erf");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output,
-            kernels::stackvm::erf(input, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::erf(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -419,8 +541,12 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(shape, pop_value());
     dump_input(shape);
-    try_var(output, kernels::stackvm::expand(input, shape, nullptr,
-                                             module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::expand(inputs[0], inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(shape)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -433,9 +559,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(dequant_param, pop_value());
     dump_input(dequant_param);
-    try_var(output, kernels::stackvm::fake_dequantize(
-                        op.target_type, input, dequant_param, nullptr,
-                        module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::fake_dequantize(op.target_type, inputs[0],
+                                                 inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input),
+                                        std::move(dequant_param)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -448,9 +578,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(quant_param, pop_value());
     dump_input(quant_param);
-    try_var(output, kernels::stackvm::fake_quantize(op.target_type, input,
-                                                    quant_param, nullptr,
-                                                    module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::fake_quantize(op.target_type, inputs[0],
+                                               inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input),
+                                        std::move(quant_param)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -463,8 +597,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(shape, pop_value());
     dump_input(shape);
-    try_var(output, kernels::stackvm::fix_shape(input, shape, nullptr,
-                                                module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::fix_shape(inputs[0], inputs[1], output,
+                                           context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(shape)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -477,8 +616,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(axis, pop_value());
     dump_input(axis);
-    try_var(output, kernels::stackvm::flatten(input, axis, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::flatten(inputs[0], inputs[1], output,
+                                         context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -491,8 +635,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(index, pop_value());
     dump_input(index);
-    try_var(output, kernels::stackvm::gather(op.axis, input, index, nullptr,
-                                             module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::gather(op.axis, inputs[0], inputs[1], output,
+                                        context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(index)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -507,9 +656,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(axis);
     try_var(indices, pop_value());
     dump_input(indices);
-    try_var(output,
-            kernels::stackvm::gather_elements(input, axis, indices, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::gather_elements(inputs[0], inputs[1],
+                                                 inputs[2], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis),
+                                        std::move(indices)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -524,9 +677,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(batch_dims);
     try_var(index, pop_value());
     dump_input(index);
-    try_var(output,
-            kernels::stackvm::gather_nd(input, batch_dims, index, nullptr,
-                                        module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::gather_nd(inputs[0], inputs[1], inputs[2],
+                                           output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(batch_dims),
+                                        std::move(index)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -539,8 +696,12 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(alpha, pop_value());
     dump_input(alpha);
-    try_var(output, kernels::stackvm::gelu(input, alpha, nullptr,
-                                           module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::gelu(inputs[0], inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(alpha)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -553,8 +714,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(index, pop_value());
     dump_input(index);
-    try_var(output, kernels::stackvm::get_item(input, index, nullptr,
-                                               module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::get_item(inputs[0], inputs[1], output,
+                                          context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input), std::move(index)},
+                                      kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -575,9 +742,18 @@ result<void> stackvm_runtime_function::visit(
     dump_input(same);
     try_var(lower, pop_value());
     dump_input(lower);
-    try_var(output, kernels::stackvm::get_paddings(
-                        input_shape, weights_shape, strides, dilations, same,
-                        lower, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::get_paddings(inputs[0], inputs[1], inputs[2],
+                                              inputs[3], inputs[4], inputs[5],
+                                              output, context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input_shape),
+                                       std::move(weights_shape),
+                                       std::move(strides), std::move(dilations),
+                                       std::move(same), std::move(lower)},
+                                      kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -592,8 +768,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(alpha);
     try_var(beta, pop_value());
     dump_input(beta);
-    try_var(output, kernels::stackvm::hard_sigmoid(input, alpha, beta, nullptr,
-                                                   module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::hard_sigmoid(inputs[0], inputs[1], inputs[2],
+                                              output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(alpha),
+                                        std::move(beta)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -604,8 +785,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("hard_swish");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::hard_swish(input, nullptr,
-                                                 module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::hard_swish(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -618,8 +802,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(axis, pop_value());
     dump_input(axis);
-    try_var(output, kernels::stackvm::hardmax(input, axis, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::hardmax(inputs[0], inputs[1], output,
+                                         context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -632,8 +821,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(value, pop_value());
     dump_input(value);
-    try_var(output, kernels::stackvm::index_of(input, value, nullptr,
-                                               module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::index_of(inputs[0], inputs[1], output,
+                                          context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(value)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -650,9 +844,15 @@ result<void> stackvm_runtime_function::visit(
     dump_input(bias);
     try_var(epsilon, pop_value());
     dump_input(epsilon);
-    try_var(output, kernels::stackvm::instance_normalization(
-                        input, scale, bias, epsilon, nullptr,
-                        module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::instance_normalization(inputs[0], inputs[1],
+                                                        inputs[2], inputs[3],
+                                                        output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(scale),
+                                        std::move(bias), std::move(epsilon)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -663,8 +863,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("l2_normalization");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::l2_normalization(
-                        input, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::l2_normalization(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -679,9 +882,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(scale);
     try_var(bias, pop_value());
     dump_input(bias);
-    try_var(output, kernels::stackvm::layer_norm(
-                        op.axis, op.epsilon, op.use_mean, input, scale, bias,
-                        nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::layer_norm(op.axis, op.epsilon, op.use_mean,
+                                            inputs[0], inputs[1], inputs[2],
+                                            output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(scale),
+                                        std::move(bias)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -694,8 +902,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(alpha, pop_value());
     dump_input(alpha);
-    try_var(output, kernels::stackvm::leaky_relu(input, alpha, nullptr,
-                                                 module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::leaky_relu(inputs[0], inputs[1], output,
+                                            context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(alpha)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -708,8 +921,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(axis, pop_value());
     dump_input(axis);
-    try_var(output, kernels::stackvm::log_softmax(input, axis, nullptr,
-                                                  module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::log_softmax(inputs[0], inputs[1], output,
+                                             context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -724,8 +942,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(axis);
     try_var(p, pop_value());
     dump_input(p);
-    try_var(output, kernels::stackvm::lp_normalization(
-                        input, axis, p, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::lp_normalization(inputs[0], inputs[1],
+                                                  inputs[2], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis),
+                                        std::move(p)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -744,8 +967,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(bias);
     try_var(size, pop_value());
     dump_input(size);
-    try_var(output, kernels::stackvm::lrn(input, alpha, beta, bias, size,
-                                          nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::lrn(inputs[0], inputs[1], inputs[2], inputs[3],
+                                     inputs[4], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(alpha),
+                                        std::move(beta), std::move(bias),
+                                        std::move(size)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -782,12 +1011,25 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input_forget);
     try_var(output_size, pop_value());
     dump_input(output_size);
-    try_var(output,
-            kernels::stackvm::lstm(op.direction, op.layout, op.activations, x,
-                                   w, r, b, sequence_lens, initial_h, initial_c,
-                                   p, activation_alpha, activation_beta, clip,
-                                   hidden_size, input_forget, output_size,
-                                   nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::lstm(op.direction, op.layout, op.activations,
+                                      inputs[0], inputs[1], inputs[2],
+                                      inputs[3], inputs[4], inputs[5],
+                                      inputs[6], inputs[7], inputs[8],
+                                      inputs[9], inputs[10], inputs[11],
+                                      inputs[12], inputs[13], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(x), std::move(w),
+                                        std::move(r), std::move(b),
+                                        std::move(sequence_lens),
+                                        std::move(initial_h),
+                                        std::move(initial_c), std::move(p),
+                                        std::move(activation_alpha),
+                                        std::move(activation_beta),
+                                        std::move(clip), std::move(hidden_size),
+                                        std::move(input_forget),
+                                        std::move(output_size)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -800,8 +1042,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(lhs);
     try_var(rhs, pop_value());
     dump_input(rhs);
-    try_var(output, kernels::stackvm::mat_mul(lhs, rhs, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::mat_mul(inputs[0], inputs[1], output,
+                                         context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(lhs), std::move(rhs)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -814,8 +1061,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(lhs);
     try_var(rhs, pop_value());
     dump_input(rhs);
-    try_var(output, kernels::stackvm::mat_mul_shape(lhs, rhs, nullptr,
-                                                    module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::mat_mul_shape(inputs[0], inputs[1], output,
+                                               context);
+    };
+    try_var(output, dispatch_shape_op({std::move(lhs), std::move(rhs)}, kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -832,9 +1084,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(seed);
     try_var(shape, pop_value());
     dump_input(shape);
-    try_var(output,
-            kernels::stackvm::normal(op.type, mean, scale, seed, shape, nullptr,
-                                     module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::normal(op.type, inputs[0], inputs[1],
+                                        inputs[2], inputs[3], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(mean), std::move(scale),
+                                        std::move(seed), std::move(shape)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -851,9 +1108,15 @@ result<void> stackvm_runtime_function::visit(
     dump_input(scale);
     try_var(seed, pop_value());
     dump_input(seed);
-    try_var(output,
-            kernels::stackvm::normal_like(op.type, input, mean, scale, seed,
-                                          nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::normal_like(op.type, inputs[0], inputs[1],
+                                             inputs[2], inputs[3], output,
+                                             context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(mean),
+                                        std::move(scale), std::move(seed)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -870,9 +1133,15 @@ result<void> stackvm_runtime_function::visit(
     dump_input(values);
     try_var(axis, pop_value());
     dump_input(axis);
-    try_var(output, kernels::stackvm::one_hot(op.one_hot_mode, indices, depth,
-                                              values, axis, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::one_hot(op.one_hot_mode, inputs[0], inputs[1],
+                                         inputs[2], inputs[3], output,
+                                         context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(indices), std::move(depth),
+                                        std::move(values), std::move(axis)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -887,8 +1156,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(pads);
     try_var(value, pop_value());
     dump_input(value);
-    try_var(output, kernels::stackvm::pad(op.pad_mode, input, pads, value,
-                                          nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::pad(op.pad_mode, inputs[0], inputs[1],
+                                     inputs[2], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(pads),
+                                        std::move(value)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -901,8 +1175,12 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(slope, pop_value());
     dump_input(slope);
-    try_var(output, kernels::stackvm::prelu(input, slope, nullptr,
-                                            module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::prelu(inputs[0], inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(slope)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -913,8 +1191,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("prod");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output,
-            kernels::stackvm::prod(input, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::prod(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -927,9 +1208,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(range);
     try_var(bits, pop_value());
     dump_input(bits);
-    try_var(output, kernels::stackvm::quant_param_of(
-                        op.quant_mode, range, bits, nullptr,
-                        module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::quant_param_of(op.quant_mode, inputs[0],
+                                                inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(range), std::move(bits)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -942,9 +1227,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(quant_param, pop_value());
     dump_input(quant_param);
-    try_var(output,
-            kernels::stackvm::quantize(op.target_type, input, quant_param,
-                                       nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::quantize(op.target_type, inputs[0], inputs[1],
+                                          output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input),
+                                        std::move(quant_param)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -959,8 +1248,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(end);
     try_var(step, pop_value());
     dump_input(step);
-    try_var(output, kernels::stackvm::range(begin, end, step, nullptr,
-                                            module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::range(inputs[0], inputs[1], inputs[2], output,
+                                       context);
+    };
+    try_var(output, dispatch_shape_op({std::move(begin), std::move(end),
+                                       std::move(step)}, kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -971,9 +1266,12 @@ result<void> stackvm_runtime_function::visit(
     dump_op("range_of");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output,
-            kernels::stackvm::range_of(op.is_range_of_weight, input, nullptr,
-                                       module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::range_of(op.is_range_of_weight, inputs[0],
+                                          output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -984,8 +1282,12 @@ result<void> stackvm_runtime_function::visit(
     dump_op("rank");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output,
-            kernels::stackvm::rank(input, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::rank(inputs[0], output, context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input)}, kernel,
+                                      shape_op_kind::by_shape));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1002,9 +1304,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(init_value);
     try_var(keep_dims, pop_value());
     dump_input(keep_dims);
-    try_var(output, kernels::stackvm::reduce(op.reduce_op, input, axis,
-                                             init_value, keep_dims, nullptr,
-                                             module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::reduce(op.reduce_op, inputs[0], inputs[1],
+                                        inputs[2], inputs[3], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis),
+                                        std::move(init_value),
+                                        std::move(keep_dims)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1021,9 +1328,15 @@ result<void> stackvm_runtime_function::visit(
     dump_input(keep_dims);
     try_var(select_last_index, pop_value());
     dump_input(select_last_index);
-    try_var(output, kernels::stackvm::reduce_arg(
-                        op.reduce_arg_op, op.dest_type, input, axis, keep_dims,
-                        select_last_index, nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::reduce_arg(op.reduce_arg_op, op.dest_type,
+                                            inputs[0], inputs[1], inputs[2],
+                                            inputs[3], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis),
+                                        std::move(keep_dims),
+                                        std::move(select_last_index)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1048,10 +1361,19 @@ result<void> stackvm_runtime_function::visit(
     dump_input(ceil_mode);
     try_var(count_include_pad, pop_value());
     dump_input(count_include_pad);
-    try_var(output, kernels::stackvm::reduce_window2d(
-                        op.reduce_op, input, init_value, filter, stride,
-                        padding, dilation, ceil_mode, count_include_pad,
-                        nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::reduce_window2d(op.reduce_op, inputs[0],
+                                                 inputs[1], inputs[2],
+                                                 inputs[3], inputs[4],
+                                                 inputs[5], inputs[6],
+                                                 inputs[7], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(init_value),
+                                        std::move(filter), std::move(stride),
+                                        std::move(padding), std::move(dilation),
+                                        std::move(ceil_mode),
+                                        std::move(count_include_pad)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1062,8 +1384,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("relu");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output,
-            kernels::stackvm::relu(input, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::relu(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1074,8 +1399,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("relu6");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output,
-            kernels::stackvm::relu6(input, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::relu6(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1088,9 +1416,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(predicate);
     try_var(value, pop_value());
     dump_input(value);
-    try_var(output, kernels::stackvm::require(
-                        op.message, op.can_fold_const_call, predicate, value,
-                        nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::require(op.message, op.can_fold_const_call,
+                                         inputs[0], inputs[1], output,
+                                         context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(predicate), std::move(value)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1103,8 +1436,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(shape, pop_value());
     dump_input(shape);
-    try_var(output, kernels::stackvm::reshape(input, shape, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::reshape(inputs[0], inputs[1], output,
+                                         context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(shape)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1117,8 +1455,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input_shape);
     try_var(shape, pop_value());
     dump_input(shape);
-    try_var(output, kernels::stackvm::reshape_shape(input_shape, shape, nullptr,
-                                                    module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::reshape_shape(inputs[0], inputs[1], output,
+                                               context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input_shape),
+                                       std::move(shape)}, kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1139,11 +1483,21 @@ result<void> stackvm_runtime_function::visit(
     dump_input(exclude_outside);
     try_var(extrapolation_value, pop_value());
     dump_input(extrapolation_value);
-    try_var(output, kernels::stackvm::resize_image(
-                        op.resize_mode, op.transformation_mode, op.nearest_mode,
-                        op.is_tfresize, input, roi, new_size, cubic_coeff_a,
-                        exclude_outside, extrapolation_value, nullptr,
-                        module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::resize_image(op.resize_mode,
+                                              op.transformation_mode,
+                                              op.nearest_mode, op.is_tfresize,
+                                              inputs[0], inputs[1], inputs[2],
+                                              inputs[3], inputs[4], inputs[5],
+                                              output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(roi),
+                                        std::move(new_size),
+                                        std::move(cubic_coeff_a),
+                                        std::move(exclude_outside),
+                                        std::move(extrapolation_value)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1160,9 +1514,15 @@ result<void> stackvm_runtime_function::visit(
     dump_input(batch_axis);
     try_var(time_axis, pop_value());
     dump_input(time_axis);
-    try_var(output, kernels::stackvm::reverse_sequence(
-                        input, seq_lens, batch_axis, time_axis, nullptr,
-                        module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::reverse_sequence(inputs[0], inputs[1],
+                                                  inputs[2], inputs[3], output,
+                                                  context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(seq_lens),
+                                        std::move(batch_axis),
+                                        std::move(time_axis)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1177,9 +1537,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(indices);
     try_var(updates, pop_value());
     dump_input(updates);
-    try_var(output,
-            kernels::stackvm::scatter_nd(input, indices, updates, nullptr,
-                                         module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::scatter_nd(inputs[0], inputs[1], inputs[2],
+                                            output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(indices),
+                                        std::move(updates)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1194,9 +1558,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(true_value);
     try_var(false_value, pop_value());
     dump_input(false_value);
-    try_var(output,
-            kernels::stackvm::select(predicate, true_value, false_value,
-                                     nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::select(inputs[0], inputs[1], inputs[2],
+                                        output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(predicate),
+                                        std::move(true_value),
+                                        std::move(false_value)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1211,8 +1580,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(alpha);
     try_var(gamma, pop_value());
     dump_input(gamma);
-    try_var(output, kernels::stackvm::selu(input, alpha, gamma, nullptr,
-                                           module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::selu(inputs[0], inputs[1], inputs[2], output,
+                                      context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(alpha),
+                                        std::move(gamma)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1223,8 +1597,12 @@ result<void> stackvm_runtime_function::visit(
     dump_op("shape_of");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::shape_of(input, nullptr,
-                                               module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::shape_of(inputs[0], output, context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input)}, kernel,
+                                      shape_op_kind::by_shape));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1235,8 +1613,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("sigmoid");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::sigmoid(input, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::sigmoid(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1247,8 +1628,12 @@ result<void> stackvm_runtime_function::visit(
     dump_op("size_of");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::size_of(input, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::size_of(inputs[0], output, context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input)}, kernel,
+                                      shape_op_kind::by_shape));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1267,9 +1652,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(axes);
     try_var(strides, pop_value());
     dump_input(strides);
-    try_var(output,
-            kernels::stackvm::slice(input, begins, ends, axes, strides, nullptr,
-                                    module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::slice(inputs[0], inputs[1], inputs[2],
+                                       inputs[3], inputs[4], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(begins),
+                                        std::move(ends), std::move(axes),
+                                        std::move(strides)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1282,8 +1672,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(axis, pop_value());
     dump_input(axis);
-    try_var(output, kernels::stackvm::softmax(input, axis, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::softmax(inputs[0], inputs[1], output,
+                                         context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1294,8 +1689,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("softplus");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::softplus(input, nullptr,
-                                               module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::softplus(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1306,8 +1704,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("softsign");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::softsign(input, nullptr,
-                                               module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::softsign(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1322,9 +1723,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(block_shape);
     try_var(paddings, pop_value());
     dump_input(paddings);
-    try_var(output, kernels::stackvm::space_to_batch(
-                        input, block_shape, paddings, nullptr,
-                        module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::space_to_batch(inputs[0], inputs[1], inputs[2],
+                                                output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input),
+                                        std::move(block_shape),
+                                        std::move(paddings)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1339,8 +1745,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(axis);
     try_var(sections, pop_value());
     dump_input(sections);
-    try_var(output, kernels::stackvm::split(input, axis, sections, nullptr,
-                                            module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::split(inputs[0], inputs[1], inputs[2], output,
+                                       context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(axis),
+                                        std::move(sections)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1353,8 +1764,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(dim, pop_value());
     dump_input(dim);
-    try_var(output, kernels::stackvm::squeeze(input, dim, nullptr,
-                                              module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::squeeze(inputs[0], inputs[1], output,
+                                         context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(dim)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1367,8 +1783,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input_shape);
     try_var(dim, pop_value());
     dump_input(dim);
-    try_var(output, kernels::stackvm::squeeze_shape(input_shape, dim, nullptr,
-                                                    module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::squeeze_shape(inputs[0], inputs[1], output,
+                                               context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input_shape), std::move(dim)},
+                                      kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1381,8 +1803,12 @@ result<void> stackvm_runtime_function::visit(
     dump_input(inputs);
     try_var(axis, pop_value());
     dump_input(axis);
-    try_var(output, kernels::stackvm::stack(inputs, axis, nullptr,
-                                            module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::stack(inputs[0], inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(inputs), std::move(axis)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1393,8 +1819,11 @@ result<void> stackvm_runtime_function::visit(
     dump_op("swish");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output,
-            kernels::stackvm::swish(input, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::swish(inputs[0], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1407,8 +1836,12 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(repeats, pop_value());
     dump_input(repeats);
-    try_var(output, kernels::stackvm::tile(input, repeats, nullptr,
-                                           module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::tile(inputs[0], inputs[1], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(repeats)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1427,9 +1860,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(largest);
     try_var(sorted, pop_value());
     dump_input(sorted);
-    try_var(output,
-            kernels::stackvm::top_k(x, k, axis, largest, sorted, nullptr,
-                                    module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::top_k(inputs[0], inputs[1], inputs[2],
+                                       inputs[3], inputs[4], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(x), std::move(k),
+                                        std::move(axis), std::move(largest),
+                                        std::move(sorted)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1442,8 +1880,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(perm, pop_value());
     dump_input(perm);
-    try_var(output, kernels::stackvm::transpose(input, perm, nullptr,
-                                                module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::transpose(inputs[0], inputs[1], output,
+                                           context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(perm)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1456,8 +1899,14 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input_shape);
     try_var(perm, pop_value());
     dump_input(perm);
-    try_var(output, kernels::stackvm::transpose_shape(
-                        input_shape, perm, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::transpose_shape(inputs[0], inputs[1], output,
+                                                 context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input_shape), std::move(perm)},
+                                      kernel,
+                                      shape_op_kind::by_value));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1472,8 +1921,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(k);
     try_var(upper, pop_value());
     dump_input(upper);
-    try_var(output, kernels::stackvm::trilu(input, k, upper, nullptr,
-                                            module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::trilu(inputs[0], inputs[1], inputs[2], output,
+                                       context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(k),
+                                        std::move(upper)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1484,8 +1938,12 @@ result<void> stackvm_runtime_function::visit(
     dump_op("unary");
     try_var(input, pop_value());
     dump_input(input);
-    try_var(output, kernels::stackvm::unary(op.unary_op, input, nullptr,
-                                            module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::unary(op.unary_op, inputs[0], output,
+                                       context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1502,9 +1960,15 @@ result<void> stackvm_runtime_function::visit(
     dump_input(seed);
     try_var(shape, pop_value());
     dump_input(shape);
-    try_var(output,
-            kernels::stackvm::uniform(op.type, high, low, seed, shape, nullptr,
-                                      module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::uniform(op.type, inputs[0], inputs[1],
+                                         inputs[2], inputs[3], output,
+                                         context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(high), std::move(low),
+                                        std::move(seed), std::move(shape)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1521,9 +1985,15 @@ result<void> stackvm_runtime_function::visit(
     dump_input(low);
     try_var(seed, pop_value());
     dump_input(seed);
-    try_var(output,
-            kernels::stackvm::uniform_like(op.type, input, high, low, seed,
-                                           nullptr, module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::uniform_like(op.type, inputs[0], inputs[1],
+                                              inputs[2], inputs[3], output,
+                                              context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(high),
+                                        std::move(low), std::move(seed)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1536,8 +2006,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input);
     try_var(dim, pop_value());
     dump_input(dim);
-    try_var(output, kernels::stackvm::unsqueeze(input, dim, nullptr,
-                                                module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::unsqueeze(inputs[0], inputs[1], output,
+                                           context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(dim)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1550,8 +2025,79 @@ result<void> stackvm_runtime_function::visit(
     dump_input(input_shape);
     try_var(dim, pop_value());
     dump_input(dim);
-    try_var(output, kernels::stackvm::unsqueeze_shape(
-                        input_shape, dim, nullptr, module().kernel_context()));
+    auto kernel = [](gsl::span<const value_t> inputs, value_t output,
+                     kernels::kernel_context &context) {
+        return kernels::stackvm::unsqueeze_shape(inputs[0], inputs[1], output,
+                                                 context);
+    };
+    try_var(output, dispatch_shape_op({std::move(input_shape), std::move(dim)},
+                                      kernel,
+                                      shape_op_kind::by_value));
+    dump_output(output);
+    stack_.push(std::move(output));
+    return ok();
+}
+
+result<void> stackvm_runtime_function::visit(
+    [[maybe_unused]] const tensor_variable_read_op_t &op) noexcept {
+    dump_op("variable_read");
+    try_var(shape, pop_value());
+    dump_input(shape);
+    // The state is pushed itself, not a copy.
+    auto it = states_.find(pc_);
+    if (it == states_.end()) {
+        auto &interp = module().interp();
+        try_var(index, interp.find_state_by_name(op.name));
+        try_var(state, interp.state_tensor(index));
+        it = states_.emplace(pc_, state.impl()).first;
+    }
+    value_t output = it->second;
+    dump_output(output);
+    stack_.push(std::move(output));
+    return ok();
+}
+
+result<void> stackvm_runtime_function::visit(
+    [[maybe_unused]] const tensor_variable_update_op_t &op) noexcept {
+    dump_op("variable_update");
+    try_var(state, pop_value());
+    dump_input(state);
+    try_var(update, pop_value());
+    dump_input(update);
+    try_var(offset, pop_value());
+    dump_input(offset);
+    // The state is written in place, the in-flight ops may still read it.
+    if (dataflow_) {
+        try_(dataflow_->wait_all());
+        try_set(update, dataflow_scheduler::resolve(std::move(update)));
+        try_set(offset, dataflow_scheduler::resolve(std::move(offset)));
+    }
+    try_var(output, kernels::stackvm::variable_update(
+                        op.axis, std::move(state), std::move(update),
+                        std::move(offset), nullptr, module().kernel_context()));
+    dump_output(output);
+    stack_.push(std::move(output));
+    return ok();
+}
+
+result<void> stackvm_runtime_function::visit(
+    [[maybe_unused]] const tensor_weight_only_mat_mul_op_t &op) noexcept {
+    dump_op("weight_only_mat_mul");
+    try_var(input, pop_value());
+    dump_input(input);
+    try_var(weights, pop_value());
+    dump_input(weights);
+    try_var(scales, pop_value());
+    dump_input(scales);
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::weight_only_mat_mul(
+            op.bits, op.group_size, inputs[0], inputs[1], inputs[2], output,
+            context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(input), std::move(weights),
+                                        std::move(scales)},
+                                       kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
@@ -1566,8 +2112,13 @@ result<void> stackvm_runtime_function::visit(
     dump_input(x);
     try_var(y, pop_value());
     dump_input(y);
-    try_var(output, kernels::stackvm::where(op.is_tf_where, cond, x, y, nullptr,
-                                            module().kernel_context()));
+    auto kernel = [op](gsl::span<const value_t> inputs, value_t output,
+                       kernels::kernel_context &context) {
+        return kernels::stackvm::where(op.is_tf_where, inputs[0], inputs[1],
+                                       inputs[2], output, context);
+    };
+    try_var(output, dispatch_tensor_op({std::move(cond), std::move(x),
+                                        std::move(y)}, kernel));
     dump_output(output);
     stack_.push(std::move(output));
     return ok();
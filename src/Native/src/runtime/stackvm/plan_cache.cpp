@@ -0,0 +1,269 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "plan_cache.h"
+#include <cstring>
+#include <nncase/runtime/dbg.h>
+#include <nncase/runtime/host_buffer.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/tensor.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+
+namespace {
+// Shape arithmetic works on a handful of int64 elements, anything bigger is
+// real data and is not worth comparing.
+constexpr size_t max_signature_bytes = 1024;
+constexpr size_t max_output_bytes = 1024;
+constexpr size_t max_shape_argument_bytes = 64;
+
+enum class signature_tag : uint8_t { null, tensor, tuple };
+
+/** @brief Appends the signature of values to a buffer */
+class signature_writer {
+  public:
+    explicit signature_writer(std::vector<gsl::byte> &sig) noexcept
+        : sig_(sig) {}
+
+    size_t size() const noexcept { return sig_.size(); }
+
+    bool write(const gsl::byte *data, size_t bytes) {
+        sig_.insert(sig_.end(), data, data + bytes);
+        return true;
+    }
+
+  private:
+    std::vector<gsl::byte> &sig_;
+};
+
+/** @brief Compares the signature of values with a recorded one as it goes,
+ * so a hit copies nothing */
+class signature_reader {
+  public:
+    explicit signature_reader(const std::vector<gsl::byte> &sig) noexcept
+        : sig_(sig), pos_(0) {}
+
+    size_t size() const noexcept { return pos_; }
+
+    bool write(const gsl::byte *data, size_t bytes) noexcept {
+        if (sig_.size() - pos_ < bytes ||
+            std::memcmp(sig_.data() + pos_, data, bytes))
+            return false;
+        pos_ += bytes;
+        return true;
+    }
+
+    bool at_end() const noexcept { return pos_ == sig_.size(); }
+
+  private:
+    const std::vector<gsl::byte> &sig_;
+    size_t pos_;
+};
+
+template <class TSig, class T> bool append(TSig &sig, const T &value) {
+    return sig.write(reinterpret_cast<const gsl::byte *>(&value), sizeof(T));
+}
+
+template <class TSig>
+bool append_signature(TSig &sig, const value_t &value,
+                      shape_op_kind kind) noexcept {
+    if (value.empty()) {
+        return append(sig, signature_tag::null);
+    } else if (value.is_a<tensor>()) {
+        auto t = value.as<tensor>().unwrap();
+        if (!append(sig, signature_tag::tensor) ||
+            !append(sig, t->dtype()->typecode()) ||
+            !append(sig, t->shape().size()))
+            return false;
+        for (auto dim : t->shape()) {
+            if (!append(sig, dim))
+                return false;
+        }
+
+        if (kind == shape_op_kind::by_value) {
+            auto bytes = get_bytes(t->dtype(), t->shape());
+            if (!t->is_contiguous() ||
+                sig.size() + bytes > max_signature_bytes)
+                return false;
+            auto host = t->buffer().as_host();
+            if (host.is_err())
+                return false;
+            auto map = host.unwrap().map(map_read);
+            if (map.is_err())
+                return false;
+            if (!sig.write(map.unwrap().buffer().data(), bytes))
+                return false;
+        }
+        return kind == shape_op_kind::by_shape ||
+               sig.size() <= max_signature_bytes;
+    } else if (value.is_a<tuple>()) {
+        auto t = value.as<tuple>().unwrap();
+        if (!append(sig, signature_tag::tuple) ||
+            !append(sig, t->fields().size()))
+            return false;
+        for (auto &field : t->fields()) {
+            if (!append_signature(sig, field, kind))
+                return false;
+        }
+        return true;
+    }
+
+    // Pending values and other objects are never cached.
+    return false;
+}
+
+/** @brief Small integer tensors may be shape arguments, e.g. the new shape
+ * of a reshape */
+bool is_shape_argument(const value_t &value) noexcept {
+    auto t = value.as<tensor>();
+    if (t.is_err())
+        return false;
+    auto type = t.unwrap()->dtype()->typecode();
+    return (type == dt_int32 || type == dt_int64) &&
+           get_bytes(t.unwrap()->dtype(), t.unwrap()->shape()) <=
+               max_shape_argument_bytes;
+}
+
+template <class TSig>
+bool append_operands(TSig &sig, gsl::span<const value_t> inputs) noexcept {
+    for (auto &input : inputs) {
+        auto kind = is_shape_argument(input) ? shape_op_kind::by_value
+                                             : shape_op_kind::by_shape;
+        if (!append_signature(sig, input, kind))
+            return false;
+    }
+    return true;
+}
+
+bool is_cacheable_output(const value_t &output) noexcept {
+    if (output.is_a<tensor>()) {
+        auto t = output.as<tensor>().unwrap();
+        return get_bytes(t->dtype(), t->shape()) <= max_output_bytes;
+    }
+    return false;
+}
+
+/** @brief Contiguous host copy of a tensor, nullptr if it cannot be made */
+value_t clone(const value_t &value) noexcept {
+    auto t = value.as<tensor>().unwrap();
+    auto copy = runtime::detail::create(t->dtype(), t->shape());
+    if (copy.is_err() || t->copy_to(copy.unwrap()).is_err())
+        return nullptr;
+    return copy.unwrap();
+}
+
+const object_node *buffer_of(const value_t &value) noexcept {
+    auto t = value.as<tensor>();
+    return t.is_ok() ? t.unwrap()->buffer().buffer().get() : nullptr;
+}
+} // namespace
+
+value_t execution_plan::lookup(const gsl::byte *pc,
+                               gsl::span<const value_t> inputs,
+                               shape_op_kind kind) noexcept {
+    auto it = entries_.find(pc);
+    if (it != entries_.end()) {
+        signature_reader reader(it->second.signature);
+        auto matches = true;
+        for (auto &input : inputs)
+            matches = matches && append_signature(reader, input, kind);
+        if (matches && reader.at_end()) {
+            // Only the plan holds the output when no run still reads it, it
+            // is then handed out as is since nothing writes to it.
+            auto &output = it->second.output;
+            if (output.unique() &&
+                output.as<tensor>().unwrap()->buffer().buffer().unique())
+                return output;
+            return clone(output);
+        }
+    }
+
+    signature_.clear();
+    signature_valid_ = true;
+    signature_writer writer(signature_);
+    for (auto &input : inputs) {
+        if (!append_signature(writer, input, kind)) {
+            signature_valid_ = false;
+            break;
+        }
+    }
+    return nullptr;
+}
+
+void execution_plan::record(const gsl::byte *pc,
+                            const value_t &output) noexcept {
+    if (signature_valid_ && is_cacheable_output(output)) {
+        auto copy = clone(output);
+        if (!copy.empty()) {
+            auto &entry = entries_[pc];
+            entry.signature = signature_;
+            entry.output = std::move(copy);
+        }
+    }
+    signature_valid_ = false;
+}
+
+bool stackvm::operand_signature(std::vector<gsl::byte> &sig,
+                                gsl::span<const value_t> inputs) noexcept {
+    signature_writer writer(sig);
+    return append_operands(writer, inputs);
+}
+
+bool execution_plan::operands_match(
+    const gsl::byte *pc, gsl::span<const value_t> inputs) const noexcept {
+    auto it = operands_.find(pc);
+    if (it == operands_.end())
+        return false;
+    signature_reader reader(it->second);
+    return append_operands(reader, inputs) && reader.at_end();
+}
+
+bool execution_plan::is_recorded(const value_t &value) const noexcept {
+    auto buffer = buffer_of(value);
+    if (!buffer)
+        return false;
+    for (auto &entry : entries_) {
+        if (buffer_of(entry.second.output) == buffer)
+            return true;
+    }
+    return false;
+}
+
+execution_plan *
+plan_cache::select(gsl::span<const value_t> parameters) noexcept {
+    if (!capacity_)
+        return nullptr;
+
+    key_.clear();
+    signature_writer writer(key_);
+    for (auto &param : parameters) {
+        if (!append_signature(writer, param, shape_op_kind::by_shape))
+            return nullptr;
+    }
+
+    for (auto it = plans_.begin(); it != plans_.end(); ++it) {
+        if (it->first == key_) {
+            plans_.splice(plans_.begin(), plans_, it);
+            return &plans_.front().second;
+        }
+    }
+
+    if (plans_.size() == capacity_)
+        plans_.pop_back();
+    plans_.emplace_front(key_, execution_plan());
+    return &plans_.front().second;
+}
@@ -0,0 +1,167 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <list>
+#include <nncase/runtime/result.h>
+#include <nncase/value.h>
+#include <unordered_map>
+#include <vector>
+
+BEGIN_NS_NNCASE_RT_MODULE(stackvm)
+
+/** @brief What the output of a shape op depends on */
+enum class shape_op_kind {
+    /** @brief Shapes of the inputs only, e.g. shape_of */
+    by_shape,
+    /** @brief Shapes and contents of the inputs */
+    by_value,
+};
+
+/** @brief Tensor op producing one output of the function */
+struct output_producer {
+    /** @brief Address of the op, nullptr when the output has no single
+     * producer, e.g. it is a view or comes from a call */
+    const gsl::byte *pc;
+    typecode_t type;
+    dims_t shape;
+};
+
+/** @brief Concat whose output is allocated before its inputs are produced */
+struct concat_output {
+    const gsl::byte *pc;
+    typecode_t type;
+    dims_t shape;
+};
+
+/** @brief Tensor op writing its output into a range of a concat output */
+struct concat_slot {
+    const gsl::byte *pc;
+    /** @brief Index of the concat in the concat outputs of the plan */
+    size_t concat;
+    /** @brief Start of the range in bytes */
+    size_t offset;
+    dims_t shape;
+};
+
+/** @brief Signatures of the operands of tensor ops by their address */
+using operand_signatures =
+    std::unordered_map<const gsl::byte *, std::vector<gsl::byte>>;
+
+/** @brief Signature of the operands of a tensor op: the types and shapes of
+ * all of them and the contents of the small integer ones, which carry shape
+ * arguments. False when an operand cannot be described. */
+bool operand_signature(std::vector<gsl::byte> &sig,
+                       gsl::span<const value_t> inputs) noexcept;
+
+/** @brief Recorded outputs of the shape ops for one set of input shapes
+ *
+ * An entry is keyed by the instruction address and only reused when the
+ * operands match the recorded ones, so data dependent shapes are never served
+ * stale. Only small host tensors take part, large operands are never compared.
+ * Only pure shape arithmetic is recorded, never an op whose output can be a
+ * view of its input. The plan keeps its own copy of every output and shares it
+ * with the runs, which only read it. It never leaves a run, see is_recorded().
+ */
+class execution_plan {
+  public:
+    /** @brief The recorded output of the op at pc, empty on a miss. It is
+     * a copy when something besides the plan still holds the output.
+     *
+     * Also prepares the operand signature used by the following record().
+     */
+    value_t lookup(const gsl::byte *pc, gsl::span<const value_t> inputs,
+                   shape_op_kind kind) noexcept;
+
+    /** @brief Record a copy of the output of the op passed to the last
+     * lookup() */
+    void record(const gsl::byte *pc, const value_t &output) noexcept;
+
+    /** @brief Whether value shares the buffer of a recorded output, it is
+     * copied before it is returned to the caller */
+    bool is_recorded(const value_t &value) const noexcept;
+
+    /** @brief Whether the first run of the plan recorded the producers of
+     * the function outputs */
+    bool outputs_learned() const noexcept { return outputs_learned_; }
+
+    /** @brief Producers of the function outputs, by output index */
+    const std::vector<output_producer> &output_producers() const noexcept {
+        return output_producers_;
+    }
+
+    void output_producers(std::vector<output_producer> producers) noexcept {
+        output_producers_ = std::move(producers);
+        outputs_learned_ = true;
+    }
+
+    /** @brief Concats whose inputs are written in place, learned with the
+     * output producers */
+    const std::vector<concat_output> &concat_outputs() const noexcept {
+        return concat_outputs_;
+    }
+
+    const std::vector<concat_slot> &concat_slots() const noexcept {
+        return concat_slots_;
+    }
+
+    /** @brief Whether the operands of the op at pc match the ones it had
+     * when its output was planned, so the output still has the planned type
+     * and shape. Data dependent shapes can differ for the same parameters. */
+    bool operands_match(const gsl::byte *pc,
+                        gsl::span<const value_t> inputs) const noexcept;
+
+    void operands(operand_signatures signatures) noexcept {
+        operands_ = std::move(signatures);
+    }
+
+    void concats(std::vector<concat_output> outputs,
+                 std::vector<concat_slot> slots) noexcept {
+        concat_outputs_ = std::move(outputs);
+        concat_slots_ = std::move(slots);
+    }
+
+  private:
+    struct entry {
+        std::vector<gsl::byte> signature;
+        value_t output;
+    };
+
+    std::unordered_map<const gsl::byte *, entry> entries_;
+    std::vector<gsl::byte> signature_;
+    bool signature_valid_ = false;
+    std::vector<output_producer> output_producers_;
+    std::vector<concat_output> concat_outputs_;
+    std::vector<concat_slot> concat_slots_;
+    operand_signatures operands_;
+    bool outputs_learned_ = false;
+};
+
+/** @brief Execution plans of the most recently seen input shapes */
+class plan_cache {
+  public:
+    explicit plan_cache(size_t capacity) noexcept : capacity_(capacity) {}
+
+    /** @brief Plan of the parameter shapes, a new one is recorded on a miss.
+     * Returns nullptr when the cache is disabled. */
+    execution_plan *select(gsl::span<const value_t> parameters) noexcept;
+
+  private:
+    size_t capacity_;
+    // Most recently used first.
+    std::list<std::pair<std::vector<gsl::byte>, execution_plan>> plans_;
+    std::vector<gsl::byte> key_;
+};
+
+END_NS_NNCASE_RT_MODULE
@@ -13,16 +13,20 @@
  * limitations under the License.
  */
 #include "runtime_function.h"
+#include <algorithm>
 #include <nncase/runtime/dbg.h>
 #include <nncase/runtime/interpreter.h>
 #include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
 
 using namespace nncase;
 using namespace nncase::runtime;
 using namespace nncase::runtime::stackvm;
 
 stackvm_runtime_function::stackvm_runtime_function(runtime_module &rt_module)
-    : runtime_function(rt_module), reader_({}) {}
+    : runtime_function(rt_module), tensor_func_(), reader_({}),
+      dataflow_(nullptr), plan_(nullptr), learn_outputs_(false),
+      producers_lost_(false) {}
 
 stackvm_runtime_module &stackvm_runtime_function::module() const noexcept {
     return static_cast<stackvm_runtime_module &>(runtime_function::module());
@@ -38,21 +42,402 @@ result<void> stackvm_runtime_function::initialize_core(
 result<value_t> stackvm_runtime_function::invoke_core(
     gsl::span<value_t> parameters,
     [[maybe_unused]] value_t return_value) noexcept {
+    try_set(dataflow_, module().dataflow());
+    if (!plan_cache_) {
+        plan_cache_.reset(new (std::nothrow)
+                              plan_cache(module().plan_cache_capacity()));
+        CHECK_WITH_ERR(plan_cache_ != nullptr, std::errc::not_enough_memory);
+    }
+    plan_ = plan_cache_->select(parameters);
+    learn_outputs_ = plan_ && !plan_->outputs_learned();
+    producers_lost_ = false;
+    producers_.clear();
+    learned_operands_.clear();
+    bind_outputs(parameters, return_value);
+    prepare_concats();
     try_var(frame, frames_.push(0));
     for (auto arg : parameters) {
         try_(frame->push_back_arg(std::move(arg)));
     }
 
     //    module().interp().options().get<std::string>("dump_path");
-    try_(run(text_));
+    auto run_result = run(text_);
+    bound_outputs_.clear();
+    concat_parents_.clear();
+    if (dataflow_) {
+        // Ops whose outputs were dropped may still be running.
+        auto drain_result = dataflow_->wait_all();
+        if (run_result.is_ok())
+            run_result = std::move(drain_result);
+    }
+    try_(run_result);
 
     auto ret = stack_.pop();
     CHECK_WITH_ERR(ret.is_object(), nncase_errc::stackvm_illegal_instruction);
-    try_var(ret_val, ret.as_object().as<value_t>());
-    if (!return_value.empty()) {
-        try_(ret_val->copy_to(return_value));
+    try_var(ret_obj, resolve(std::move(ret).as_object()));
+    try_var(ret_val, ret_obj.as<value_t>());
+    try_(write_outputs(ret_val, return_value));
+    if (!return_value.empty())
         return ok(return_value);
+    return copy_shared_outputs(std::move(ret_val));
+}
+
+namespace {
+/** @brief The outputs of a function, a tuple or a single tensor */
+gsl::span<const value_t> output_fields(const value_t &value) noexcept {
+    if (value.is_a<tuple>())
+        return value.as<tuple>().unwrap()->fields();
+    return {&value, 1};
+}
+
+const object_node *buffer_of(const value_t &value) noexcept {
+    auto t = value.as<tensor>();
+    return t.is_ok() ? t.unwrap()->buffer().buffer().get() : nullptr;
+}
+
+/** @brief A copy of the tensor value in a buffer of its own */
+result<value_t> copy_of(const value_t &value) noexcept {
+    try_var(t, value.as<tensor>());
+    dims_t shape(t->shape().begin(), t->shape().end());
+    try_var(copy, runtime::detail::create(t->dtype(), shape));
+    try_(t->copy_to(copy));
+    return ok<value_t>(std::move(copy));
+}
+
+/** @brief A kernel may write to t in place of allocating its output */
+bool is_bindable(const value_t &value, const output_producer &producer) {
+    if (!producer.pc)
+        return false;
+    auto t = value.as<tensor>();
+    if (t.is_err())
+        return false;
+    auto &out = t.unwrap();
+    auto shape = out->shape();
+    return out->dtype()->typecode() == producer.type &&
+           std::equal(shape.begin(), shape.end(), producer.shape.begin(),
+                      producer.shape.end()) &&
+           out->is_contiguous() && out->buffer().as_host().is_ok();
+}
+
+/** @brief The inputs of a concat are contiguous ranges of its output, which
+ * holds when the output has no outer dims before the concat axis */
+bool is_concat_of_ranges(gsl::span<const value_t> inputs, const tensor &out) {
+    auto shape = out->shape();
+    auto axis = shape.size();
+    for (auto &input : inputs) {
+        auto t = input.as<tensor>();
+        if (t.is_err())
+            return false;
+        auto in_shape = t.unwrap()->shape();
+        if (t.unwrap()->dtype()->typecode() != out->dtype()->typecode() ||
+            in_shape.size() != shape.size())
+            return false;
+        for (size_t i = 0; i < std::min(axis, shape.size()); i++) {
+            if (in_shape[i] != shape[i])
+                axis = i;
+        }
     }
+    return axis == shape.size() || compute_size(shape.first(axis)) == 1;
+}
+} // namespace
+
+void stackvm_runtime_function::bind_outputs(
+    gsl::span<const value_t> parameters, const value_t &return_value) noexcept {
+    bound_outputs_.clear();
+    if (!plan_ || !plan_->outputs_learned() || return_value.empty())
+        return;
+
+    auto fields = output_fields(return_value);
+    auto &producers = plan_->output_producers();
+    if (fields.size() != producers.size())
+        return;
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (!is_bindable(fields[i], producers[i]))
+            continue;
+
+        // An output sharing memory with an input or another output would be
+        // overwritten while it is still read
+        auto buffer = buffer_of(fields[i]);
+        auto aliased = false;
+        for (auto &param : parameters)
+            aliased |= buffer_of(param) == buffer;
+        for (size_t j = 0; j < fields.size(); j++)
+            aliased |= j != i && buffer_of(fields[j]) == buffer;
+        if (!aliased)
+            bound_outputs_.emplace_back(producers[i].pc, fields[i]);
+    }
+}
+
+void stackvm_runtime_function::prepare_concats() noexcept {
+    concat_parents_.clear();
+    slots_taken_.clear();
+    learned_concats_.clear();
+    learned_slots_.clear();
+    if (!plan_)
+        return;
+    try {
+        concat_parents_.resize(plan_->concat_outputs().size());
+        slots_taken_.assign(plan_->concat_slots().size(), false);
+    } catch (...) {
+        // Every op allocates its output
+        concat_parents_.clear();
+        slots_taken_.clear();
+    }
+}
+
+value_t stackvm_runtime_function::take_output() noexcept {
+    if (plan_) {
+        auto &concats = plan_->concat_outputs();
+        for (size_t i = 0; i < concat_parents_.size(); i++) {
+            if (concats[i].pc == pc_) {
+                auto parent = concat_parent(i);
+                concat_parents_[i] = nullptr;
+                return parent;
+            }
+        }
+    }
+    return take_slot(pc_);
+}
+
+value_t stackvm_runtime_function::take_slot(const gsl::byte *pc) noexcept {
+    for (auto &binding : bound_outputs_) {
+        if (binding.first == pc)
+            return std::move(binding.second);
+    }
+
+    for (size_t i = 0; i < slots_taken_.size(); i++) {
+        auto &slot = plan_->concat_slots()[i];
+        if (slot.pc != pc || slots_taken_[i])
+            continue;
+        slots_taken_[i] = true;
+        auto parent = concat_parent(slot.concat);
+        if (parent.empty())
+            return nullptr;
+        return tensor_view(parent.as<tensor>().unwrap(), slot.shape,
+                           slot.offset);
+    }
+    return nullptr;
+}
+
+value_t stackvm_runtime_function::concat_parent(size_t index) noexcept {
+    auto &parent = concat_parents_[index];
+    if (parent.empty()) {
+        // A concat may itself write into a caller output or a range of the
+        // output of another concat
+        auto &concat = plan_->concat_outputs()[index];
+        parent = take_slot(concat.pc);
+        if (parent.empty()) {
+            auto t = hrt::create(concat.type, concat.shape);
+            if (t.is_ok())
+                parent = t.unwrap().impl();
+        }
+    }
+    return parent;
+}
 
-    return ok(ret_val);
+void stackvm_runtime_function::record_producer(
+    const value_t &output, const gsl::byte *pc,
+    gsl::span<const value_t> inputs) noexcept {
+    std::vector<gsl::byte> sig;
+    auto described = operand_signature(sig, inputs);
+    std::lock_guard<std::mutex> guard(producers_lock_);
+    try {
+        producers_.emplace_back(output.get(), pc);
+        // Ops without a signature never write in place
+        if (described)
+            learned_operands_.emplace(pc, std::move(sig));
+    } catch (...) {
+        // Unknown producers only cost the copy of their output
+        producers_lost_ = true;
+    }
+}
+
+void stackvm_runtime_function::record_concat(const value_t &input,
+                                             const value_t &output,
+                                             const gsl::byte *pc) noexcept {
+    auto in_tuple = input.as<tuple>();
+    auto out = output.as<tensor>();
+    if (in_tuple.is_err() || out.is_err())
+        return;
+    auto inputs = in_tuple.unwrap()->fields();
+    auto &out_tensor = out.unwrap();
+    if (!is_concat_of_ranges(inputs, out_tensor))
+        return;
+
+    std::lock_guard<std::mutex> guard(producers_lock_);
+    try {
+        auto index = learned_concats_.size();
+        learned_concats_.push_back({pc, out_tensor->dtype()->typecode(),
+                                    dims_t(out_tensor->shape())});
+        size_t offset = 0;
+        for (auto &field : inputs) {
+            // The input is alive, so is the last value recorded at its address
+            auto it = std::find_if(
+                producers_.rbegin(), producers_.rend(),
+                [&](auto &p) { return p.first == field.get(); });
+            auto t = field.as<tensor>().unwrap();
+            if (it != producers_.rend())
+                learned_slots_.push_back(
+                    {it->second, index, offset, dims_t(t->shape())});
+            offset += get_bytes(t->dtype(), t->shape());
+        }
+    } catch (...) {
+        producers_lost_ = true;
+    }
+}
+
+result<void>
+stackvm_runtime_function::write_outputs(const value_t &ret_val,
+                                        const value_t &return_value) noexcept {
+    auto fields = output_fields(ret_val);
+    if (!return_value.empty()) {
+        auto dests = output_fields(return_value);
+        CHECK_WITH_ERR(fields.size() == dests.size(),
+                       std::errc::invalid_argument);
+        // An output sharing the buffer of an input the caller also bound to
+        // an output, e.g. a view of it, is overwritten by that copy, so copy
+        // it first
+        std::vector<value_t> sources(fields.begin(), fields.end());
+        for (size_t i = 0; i < fields.size(); i++) {
+            auto buffer = buffer_of(fields[i]);
+            for (size_t j = 0; buffer && j < fields.size(); j++) {
+                if (fields[j].get() != dests[j].get() &&
+                    buffer_of(dests[j]) == buffer) {
+                    try_set(sources[i], copy_of(fields[i]));
+                    break;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < fields.size(); i++) {
+            if (fields[i].get() != dests[i].get())
+                try_(sources[i]->copy_to(dests[i]));
+        }
+    }
+
+    if (learn_outputs_ && !producers_lost_) {
+        try {
+            learn_concats();
+            auto producers = find_producers(fields);
+            plan_->operands(planned_operands(producers));
+            plan_->output_producers(std::move(producers));
+        } catch (...) {
+            // Learn again on the next run
+        }
+    }
+    learn_outputs_ = false;
+    producers_.clear();
+    learned_concats_.clear();
+    learned_slots_.clear();
+    learned_operands_.clear();
+    return ok();
+}
+
+result<value_t>
+stackvm_runtime_function::copy_shared_outputs(value_t ret_val) noexcept {
+    auto &interp = module().interp();
+    if (!interp.states_size() && !plan_)
+        return ok(std::move(ret_val));
+
+    std::vector<const object_node *> states;
+    for (size_t i = 0; i < interp.states_size(); i++) {
+        try_var(state, interp.state_tensor(i));
+        states.emplace_back(buffer_of(state.impl()));
+    }
+
+    auto fields = output_fields(ret_val);
+    std::vector<value_t> copies(fields.begin(), fields.end());
+    bool copied = false;
+    for (auto &field : copies) {
+        if (std::find(states.begin(), states.end(), buffer_of(field)) !=
+                states.end() ||
+            (plan_ && plan_->is_recorded(field))) {
+            try_set(field, copy_of(field));
+            copied = true;
+        }
+    }
+
+    if (!copied)
+        return ok(std::move(ret_val));
+    if (ret_val.is_a<tuple>())
+        return ok<value_t>(tuple(std::in_place, std::move(copies)));
+    return ok(std::move(copies[0]));
+}
+
+std::vector<output_producer> stackvm_runtime_function::find_producers(
+    gsl::span<const value_t> outputs) const {
+    std::vector<output_producer> producers(outputs.size());
+    for (size_t i = 0; i < outputs.size(); i++) {
+        auto &producer = producers[i];
+        auto t = outputs[i].as<tensor>();
+        producer.pc = nullptr;
+        if (t.is_err())
+            continue;
+
+        // Addresses are reused once a value is freed, the output is the last
+        // value recorded at its address
+        auto it = std::find_if(
+            producers_.rbegin(), producers_.rend(),
+            [&](auto &p) { return p.first == outputs[i].get(); });
+        if (it == producers_.rend())
+            continue;
+
+        // An op which ran more than once produced other values as well, it
+        // must keep allocating its output
+        auto pc = it->second;
+        auto runs = std::count_if(producers_.begin(), producers_.end(),
+                                  [&](auto &p) { return p.second == pc; });
+        if (runs == 1) {
+            producer.pc = pc;
+            producer.type = t.unwrap()->dtype()->typecode();
+            producer.shape = t.unwrap()->shape();
+        }
+    }
+    return producers;
+}
+
+operand_signatures stackvm_runtime_function::planned_operands(
+    gsl::span<const output_producer> producers) {
+    operand_signatures operands;
+    auto keep = [&](const gsl::byte *pc) {
+        auto it = learned_operands_.find(pc);
+        if (it != learned_operands_.end())
+            operands.emplace(pc, std::move(it->second));
+    };
+    for (auto &producer : producers) {
+        if (producer.pc)
+            keep(producer.pc);
+    }
+    for (auto &concat : plan_->concat_outputs())
+        keep(concat.pc);
+    for (auto &slot : plan_->concat_slots())
+        keep(slot.pc);
+    return operands;
+}
+
+void stackvm_runtime_function::learn_concats() {
+    auto runs = [&](const gsl::byte *pc) {
+        return std::count_if(producers_.begin(), producers_.end(),
+                             [&](auto &p) { return p.second == pc; });
+    };
+
+    // Only ops which ran once write in place, each into a single range
+    std::vector<concat_output> concats;
+    std::vector<concat_slot> slots;
+    for (size_t i = 0; i < learned_concats_.size(); i++) {
+        auto &concat = learned_concats_[i];
+        if (runs(concat.pc) != 1)
+            continue;
+        auto index = concats.size();
+        for (auto &slot : learned_slots_) {
+            if (slot.concat != i || runs(slot.pc) != 1 ||
+                std::any_of(slots.begin(), slots.end(),
+                            [&](auto &s) { return s.pc == slot.pc; }))
+                continue;
+            slots.push_back({slot.pc, index, slot.offset, slot.shape});
+        }
+        if (!slots.empty() && slots.back().concat == index)
+            concats.push_back(concat);
+    }
+    plan_->concats(std::move(concats), std::move(slots));
 }
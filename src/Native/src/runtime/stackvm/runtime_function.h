@@ -15,7 +15,9 @@
 #pragma once
 #include "call_frame.h"
 #include "evaluate_stack.h"
+#include "plan_cache.h"
 #include "runtime_module.h"
+#include <mutex>
 #include <nncase/kernels/kernel_context.h>
 #include <nncase/runtime/runtime_function.h>
 #include <nncase/runtime/stackvm/op_reader.h>
@@ -40,9 +42,21 @@ class stackvm_runtime_function final : public runtime_function,
 #include "runtime_function_ops.h"
 
   private:
+    struct extcall_site {
+        uintptr_t module_id;
+        uintptr_t func_id;
+        runtime_function *func;
+        // Prim func outputs, reused while nobody else holds them.
+        std::vector<std::pair<datatype_t, dims_t>> output_layouts;
+        std::vector<tensor> outputs;
+    };
+
     result<void> run(gsl::span<const gsl::byte> text) noexcept;
 
     result<void> visit(const extcall_op_t &op) noexcept;
+    result<extcall_site> resolve_extcall(const extcall_op_t &op,
+                                         uintptr_t module_id,
+                                         uintptr_t func_id) noexcept;
     result<void> visit(const cuscall_op_t &op) noexcept;
 
     uintptr_t pc() const noexcept;
@@ -55,31 +69,162 @@ class stackvm_runtime_function final : public runtime_function,
     template <class T> result<T> pop_object() noexcept {
 #ifndef NDEBUG
         auto var = stack_.pop();
-        if (var.is_object())
-            return var.as_object().as<T>();
+        if (var.is_object()) {
+            try_var(o, resolve(std::move(var).as_object()));
+            return std::move(o).as<T>();
+        }
         return err(std::errc::invalid_argument);
 #else
-        return stack_.pop_object().as<T>();
+        try_var(o, resolve(stack_.pop_object()));
+        return std::move(o).as<T>();
 #endif
     }
 
+    /** @brief Wait for the value if it is produced by an in-flight op */
+    result<object> resolve(object o) noexcept {
+        if (dataflow_ && o.is_a<pending_value>()) {
+            try_var(value,
+                    static_cast<pending_value_node *>(o.get())->wait());
+            return ok(object(std::move(value)));
+        }
+        return ok(std::move(o));
+    }
+
     result<tensor> pop_tensor() noexcept { return pop_object<tensor>(); }
 
     result<value_t> pop_value() noexcept {
 #ifndef NDEBUG
         auto var = stack_.pop();
         if (var.is_object()) {
-            auto o = var.as_object();
-            return !o.empty() ? o.as<value_t>() : ok<value_t>(nullptr);
+            auto o = std::move(var).as_object();
+            return !o.empty() ? std::move(o).as<value_t>()
+                              : ok<value_t>(nullptr);
         }
 
         return err(std::errc::invalid_argument);
 #else
         auto o = stack_.pop_object();
-        return !o.empty() ? o.as<value_t>() : ok<value_t>(nullptr);
+        return !o.empty() ? std::move(o).as<value_t>()
+                          : ok<value_t>(nullptr);
 #endif
     }
 
+    /** @brief Run the kernel of a tensor op, or schedule it on the dataflow
+     * workers when enabled. The kernel may only touch the op fields and its
+     * inputs. When the op produces a function output the caller bound or an
+     * input of a concat, the kernel writes it in place, as long as its
+     * operands match the ones the output was planned for. */
+    template <class TKernel>
+    result<value_t> dispatch_tensor_op(std::initializer_list<value_t> inputs,
+                                       TKernel &&kernel) noexcept {
+        return run_tensor_op(inputs, std::forward<TKernel>(kernel),
+                             take_output());
+    }
+
+    template <class TKernel>
+    result<value_t> run_tensor_op(std::initializer_list<value_t> inputs,
+                                  TKernel &&kernel, value_t output) noexcept {
+        auto thunk = [this, kernel = std::forward<TKernel>(kernel),
+                      output = std::move(output), pc = pc_, plan = plan_,
+                      learn = learn_outputs_,
+                      concat = tensor_func_ == tensor_function_t::concat](
+                         gsl::span<const value_t> inputs,
+                         kernels::kernel_context &context) {
+            // Data dependent shapes may differ for the same parameters, an
+            // output planned for other operands is left to the kernel
+            auto planned = output;
+            if (!planned.empty() && !plan->operands_match(pc, inputs))
+                planned = nullptr;
+            auto ret = kernel(inputs, planned, context);
+            if (learn && ret.is_ok()) {
+                record_producer(ret.unwrap(), pc, inputs);
+                if (concat)
+                    record_concat(inputs[0], ret.unwrap(), pc);
+            }
+            return ret;
+        };
+        if (dataflow_) {
+            return dataflow_->dispatch(inputs, std::move(thunk));
+        }
+        return thunk(gsl::make_span(inputs.begin(), inputs.size()),
+                     module().kernel_context());
+    }
+
+    /** @brief Run a shape arithmetic op, reusing the output recorded by the
+     * execution plan of the current input shapes when its operands match */
+    template <class TKernel>
+    result<value_t> dispatch_shape_op(std::initializer_list<value_t> inputs,
+                                      TKernel &&kernel,
+                                      shape_op_kind kind) noexcept {
+        if (plan_) {
+            auto span = gsl::make_span(inputs.begin(), inputs.size());
+            auto cached = plan_->lookup(pc_, span, kind);
+            if (!cached.empty())
+                return ok(std::move(cached));
+            // The plan records a copy, the output itself stays with the run
+            try_var(ret, run_tensor_op(inputs, kernel, take_output()));
+            plan_->record(pc_, ret);
+            return ok(std::move(ret));
+        }
+        return dispatch_tensor_op(inputs, std::forward<TKernel>(kernel));
+    }
+
+    /** @brief Bind the caller outputs of return_value whose producers the
+     * plan knows, so that they are written in place */
+    void bind_outputs(gsl::span<const value_t> parameters,
+                      const value_t &return_value) noexcept;
+
+    /** @brief The output the op at pc_ writes in place, nullptr when the
+     * kernel allocates it */
+    value_t take_output() noexcept;
+
+    /** @brief The caller output or the range of a concat output produced by
+     * the op at pc, handed out once per run */
+    value_t take_slot(const gsl::byte *pc) noexcept;
+
+    /** @brief Output of a concat of the plan, allocated by the first op
+     * writing into it */
+    value_t concat_parent(size_t index) noexcept;
+
+    void prepare_concats() noexcept;
+
+    /** @brief Record the op at pc as the producer of output, with the
+     * signature of the operands it ran on */
+    void record_producer(const value_t &output, const gsl::byte *pc,
+                         gsl::span<const value_t> inputs) noexcept;
+
+    /** @brief Record the producers of the inputs of the concat at pc which
+     * can write their outputs into its output */
+    void record_concat(const value_t &input, const value_t &output,
+                       const gsl::byte *pc) noexcept;
+
+    /** @brief Copy the outputs not written in place to return_value and
+     * record their producers on the first run of the plan */
+    result<void> write_outputs(const value_t &ret_val,
+                               const value_t &return_value) noexcept;
+    /** @brief Replace the outputs sharing a buffer with a state or with an
+     * output recorded by the plan by copies, later runs update the states in
+     * place and read the recorded outputs */
+    result<value_t> copy_shared_outputs(value_t ret_val) noexcept;
+    std::vector<output_producer>
+    find_producers(gsl::span<const value_t> outputs) const;
+    void learn_concats();
+    /** @brief Operand signatures of the ops the plan writes in place */
+    operand_signatures
+    planned_operands(gsl::span<const output_producer> producers);
+
+    /** @brief Codegen releases a local after its last load with
+     * "ldlocal i; ldnull; stlocal i", the value can be moved out instead. */
+    static constexpr size_t local_release_size =
+        sizeof(opcode_t) * 2 + sizeof(uint16_t);
+
+    bool is_local_released_next(uint16_t index) noexcept {
+        return reader_.avail() >= local_release_size &&
+               reader_.peek<opcode_t>() == opcode_t::LDNULL &&
+               reader_.peek_with_offset<opcode_t>(1) == opcode_t::STLOCAL &&
+               reader_.peek_unaligned_with_offset<uint16_t>(2) == index;
+    }
+
     template <class T> T pop_addr() noexcept {
         auto addr = pop_addr();
         return reinterpret_cast<T>(addr);
@@ -88,9 +233,37 @@ class stackvm_runtime_function final : public runtime_function,
   private:
     gsl::span<const gsl::byte> text_;
     const gsl::byte *pc_;
+    tensor_function_t tensor_func_;
     evaluate_stack stack_;
     call_frames frames_;
     span_reader reader_;
+    dataflow_scheduler *dataflow_;
+    std::unique_ptr<plan_cache> plan_cache_;
+    execution_plan *plan_;
+    // Call sites resolved by the address of their instruction.
+    std::unordered_map<const gsl::byte *, extcall_site> extcall_sites_;
+    std::vector<value_t> extcall_args_;
+    // Custom calls resolved by the address of their instruction.
+    std::unordered_map<const gsl::byte *, custom_call_entry> custom_calls_;
+    std::vector<value_t> custom_call_args_;
+    custom_call_invoker custom_call_invoker_;
+    // State variables resolved by the address of their instruction.
+    std::unordered_map<const gsl::byte *, tensor> states_;
+    // Caller outputs of the current run by the address of their producer.
+    std::vector<std::pair<const gsl::byte *, value_t>> bound_outputs_;
+    // Concat outputs of the current run by their index in the plan.
+    std::vector<value_t> concat_parents_;
+    std::vector<bool> slots_taken_;
+    bool learn_outputs_;
+    bool producers_lost_;
+    std::mutex producers_lock_;
+    // Tensor op outputs of a learning run, the last entry of an address wins.
+    std::vector<std::pair<const object_node *, const gsl::byte *>> producers_;
+    // Concats of a learning run and the input ranges with a known producer.
+    std::vector<concat_output> learned_concats_;
+    std::vector<concat_slot> learned_slots_;
+    // Operand signatures of the tensor ops of a learning run.
+    operand_signatures learned_operands_;
 };
 
 END_NS_NNCASE_RT_MODULE
@@ -54,6 +54,7 @@ stackvm_runtime_function::run(gsl::span<const gsl::byte> text) noexcept {
             }
         } else {
             auto tensor_func = reader_.read_unaligned<tensor_function_t>();
+            tensor_func_ = tensor_func;
 #ifdef ENABLE_OP_PROFILE
             op_profile p(to_string(tensor_func), (uint8_t)opcode);
 #endif
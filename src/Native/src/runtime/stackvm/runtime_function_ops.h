@@ -112,4 +112,9 @@ result<void> visit(const tensor_uniform_op_t &op) noexcept override;
 result<void> visit(const tensor_uniform_like_op_t &op) noexcept override;
 result<void> visit(const tensor_unsqueeze_op_t &op) noexcept override;
 result<void> visit(const tensor_unsqueeze_shape_op_t &op) noexcept override;
+result<void> visit(const tensor_variable_read_op_t &op) noexcept override;
+result<void>
+visit(const tensor_variable_update_op_t &op) noexcept override;
+result<void>
+visit(const tensor_weight_only_mat_mul_op_t &op) noexcept override;
 result<void> visit(const tensor_where_op_t &op) noexcept override;
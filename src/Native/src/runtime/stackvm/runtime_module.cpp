@@ -23,8 +23,30 @@ using namespace nncase;
 using namespace nncase::runtime;
 using namespace nncase::runtime::stackvm;
 
+namespace {
+size_t get_size_option(interpreter &interp, const char *name,
+                       size_t default_value) noexcept {
+    auto value = interp.options().get<scalar>(name);
+    if (value.is_err())
+        return default_value;
+
+    auto &s = value.unwrap();
+    switch (s.type) {
+    case dt_uint32:
+        return s.as<uint32_t>();
+    case dt_int32:
+        return (size_t)std::max(s.as<int32_t>(), 0);
+    default:
+        return default_value;
+    }
+}
+} // namespace
+
 result<void> stackvm_runtime_module::initialize_before_functions(
     runtime_module_init_context &context) noexcept {
+    // Other versions number the tensor functions differently
+    CHECK_WITH_ERR(context.header().version == stackvm_module_version,
+                   nncase_errc::invalid_model_version);
     try_set(text_, context.get_or_read_section(".text", text_storage_, false));
     try_set(rdata_,
             context.get_or_read_section(".rdata", rdata_storage_, false));
@@ -43,15 +65,47 @@ result<void> stackvm_runtime_module::initialize_before_functions(
                 auto kind = reader.template read<module_kind_t>();
                 try_var(table, runtime_module::collect(kind));
                 for (auto &&p : table) {
-                    if (custom_call_table_.find(p.first) !=
-                        custom_call_table_.end()) {
+                    if (!custom_call_table_
+                             .emplace(p.first, custom_call_entry{p.second})
+                             .second) {
                         return err(nncase_errc::stackvm_duplicate_custom_call);
                     }
-                    custom_call_table_.insert(p);
                 }
             }
             return ok();
         }));
+
+    // declare the state variables, the interpreter owns them.
+    try_(context.read_section(
+        ".states", [this](auto reader, size_t) -> result<void> {
+            // state section layout:
+            // 1. states count
+            // 2. states
+            //    - name, null terminated
+            //    - typecode
+            //    - rank, dims
+            // names break the alignment of the fields behind them.
+            auto states_count = reader.template read_unaligned<uint32_t>();
+            for (size_t i = 0; i < states_count; i++) {
+                auto name = reader.read_string();
+                auto type =
+                    (typecode_t)reader.template read_unaligned<uint8_t>();
+                dims_t shape(reader.template read_unaligned<uint32_t>());
+                for (auto &dim : shape)
+                    dim = (size_t)reader.template read_unaligned<uint64_t>();
+                try_(interp().add_state(name, type, shape));
+            }
+            return ok();
+        }));
+
+    // register the C ABI custom calls.
+    for (auto &&p : registered_custom_calls()) {
+        if (!custom_call_table_
+                 .emplace(p.first, custom_call_entry{nullptr, p.second})
+                 .second) {
+            return err(nncase_errc::stackvm_duplicate_custom_call);
+        }
+    }
     return ok();
 }
 
@@ -66,9 +120,38 @@ result<void> stackvm_runtime_module::reg(size_t id, uintptr_t value) noexcept {
     return ok();
 }
 
-const std::unordered_map<std::string, runtime_module::custom_call_type>
-stackvm_runtime_module::custom_call_table() const noexcept {
-    return custom_call_table_;
+result<custom_call_entry>
+stackvm_runtime_module::find_custom_call(
+    const std::string &name) const noexcept {
+    auto it = custom_call_table_.find(name);
+    if (it == custom_call_table_.end())
+        return err(nncase_errc::stackvm_unknow_custom_call);
+    return ok(it->second);
+}
+
+result<dataflow_scheduler *> stackvm_runtime_module::dataflow() noexcept {
+    if (!dataflow_initialized_) {
+        dataflow_initialized_ = true;
+#ifndef NNCASE_DUMP_MANAGER
+        auto threads =
+            get_size_option(interp(), stackvm_dataflow_threads_option, 0);
+        if (threads) {
+            auto max_inflight = get_size_option(
+                interp(), stackvm_dataflow_max_inflight_option, threads * 4);
+            std::unique_ptr<dataflow_scheduler> scheduler(
+                new (std::nothrow) dataflow_scheduler(threads, max_inflight));
+            CHECK_WITH_ERR(scheduler != nullptr, std::errc::not_enough_memory);
+            try_(scheduler->start());
+            dataflow_ = std::move(scheduler);
+        }
+#endif
+    }
+
+    return ok(dataflow_.get());
+}
+
+size_t stackvm_runtime_module::plan_cache_capacity() noexcept {
+    return get_size_option(interp(), stackvm_plan_cache_capacity_option, 16);
 }
 
 kernels::kernel_context &stackvm_runtime_module::kernel_context() noexcept {
@@ -76,6 +159,7 @@ kernels::kernel_context &stackvm_runtime_module::kernel_context() noexcept {
 #ifdef NNCASE_DUMP_MANAGER
     context.dump_manager = interp().dump_manager();
 #endif
+    context.autotuner = interp().autotuner();
     return context;
 }
 
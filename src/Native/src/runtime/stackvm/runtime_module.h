@@ -13,6 +13,8 @@
  * limitations under the License.
  */
 #pragma once
+#include "custom_call.h"
+#include "dataflow.h"
 #include "evaluate_stack.h"
 #include <nncase/kernels/kernel_context.h>
 #include <nncase/runtime/stackvm/runtime_module.h>
@@ -32,8 +34,15 @@ class stackvm_runtime_module : public runtime_module {
     result<uintptr_t> reg(size_t id) const noexcept;
     result<void> reg(size_t id, uintptr_t value) noexcept;
 
-    const std::unordered_map<std::string, custom_call_type>
-    custom_call_table() const noexcept;
+    /** @brief Custom call registered under name, resolved at module load */
+    result<custom_call_entry>
+    find_custom_call(const std::string &name) const noexcept;
+
+    /** @brief Scheduler for dataflow execution, nullptr if disabled */
+    result<dataflow_scheduler *> dataflow() noexcept;
+
+    /** @brief Max execution plans cached per function, 0 if disabled */
+    size_t plan_cache_capacity() noexcept;
 
   protected:
     result<void> initialize_before_functions(
@@ -46,8 +55,10 @@ class stackvm_runtime_module : public runtime_module {
     gsl::span<const gsl::byte> rdata_;
     host_buffer_t text_storage_;
     host_buffer_t rdata_storage_;
-    std::unordered_map<std::string, custom_call_type> custom_call_table_;
+    std::unordered_map<std::string, custom_call_entry> custom_call_table_;
     std::array<uintptr_t, MAX_GENERAL_REGS> regs_;
+    bool dataflow_initialized_ = false;
+    std::unique_ptr<dataflow_scheduler> dataflow_;
 };
 
 END_NS_NNCASE_RT_MODULE
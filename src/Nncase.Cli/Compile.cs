@@ -144,6 +144,18 @@ public CompileCommand()
             name: "--model-layout",
             description: "the model's input layout.",
             getDefaultValue: () => string.Empty).FromAmong("NCHW", "NHWC");
+        EGraphExtractTimeLimit = new Option<double>(
+            name: "--egraph-extract-time-limit",
+            description: "the egraph extraction solver time limit in seconds, regions unsolved in time keep the greedy extraction",
+            getDefaultValue: () => EGraphExtractOptions.Default.TimeLimit);
+        EGraphExtractRelativeGap = new Option<double>(
+            name: "--egraph-extract-relative-gap",
+            description: "the egraph extraction solver stops once the cost is within this relative gap of the optimum",
+            getDefaultValue: () => EGraphExtractOptions.Default.RelativeGap);
+        EGraphExtractGreedy = new Option<bool>(
+            name: "--egraph-extract-greedy",
+            description: "extract the egraph greedily without the sat solver",
+            getDefaultValue: () => false);
         AddArgument(InputFile);
         AddArgument(OutputFile);
         AddGlobalOption(InputFormat);
@@ -167,6 +179,9 @@ public CompileCommand()
         AddGlobalOption(Mean);
         AddGlobalOption(Std);
         AddGlobalOption(ModelLayout);
+        AddGlobalOption(EGraphExtractTimeLimit);
+        AddGlobalOption(EGraphExtractRelativeGap);
+        AddGlobalOption(EGraphExtractGreedy);
     }
 
     public Argument<string> InputFile { get; }
@@ -214,4 +229,10 @@ public CompileCommand()
     public Option<IEnumerable<float>> Std { get; }
 
     public Option<string> ModelLayout { get; }
+
+    public Option<double> EGraphExtractTimeLimit { get; }
+
+    public Option<double> EGraphExtractRelativeGap { get; }
+
+    public Option<bool> EGraphExtractGreedy { get; }
 }
@@ -121,6 +121,12 @@ private static CompileOptions ParseCompileOptions(System.CommandLine.Invocation.
                 },
                 ModelQuantMode = context.ParseResult.GetValueForOption(compilecmd.ModelQuantMode),
             },
+            EGraphExtractOptions = new()
+            {
+                TimeLimit = context.ParseResult.GetValueForOption(compilecmd.EGraphExtractTimeLimit),
+                RelativeGap = context.ParseResult.GetValueForOption(compilecmd.EGraphExtractRelativeGap),
+                GreedyOnly = context.ParseResult.GetValueForOption(compilecmd.EGraphExtractGreedy),
+            },
         };
 
         foreach (var item in context.ParseResult.GetValueForOption(compilecmd.FixedVars)!)
@@ -331,7 +331,16 @@ private async Task<IRModule> InitializeModuleAsync(IRModule module)
 
     private void RegisterTargetIndependQuantPass(IPassManager passManager)
     {
-        var quantMode = _compileSession.CompileOptions.QuantizeOptions.ModelQuantMode;
+        var quantizeOptions = _compileSession.CompileOptions.QuantizeOptions;
+        if (quantizeOptions.WeightOnlyQuantBits != 0)
+        {
+            passManager.AddWithName<DataflowPass>("WeightOnlyQuant").Configure(p =>
+            {
+                p.Add<WeightOnlyQuantMatMul>();
+            });
+        }
+
+        var quantMode = quantizeOptions.ModelQuantMode;
         if (quantMode == ModelQuantMode.UsePTQ)
         {
             passManager.AddWithName<DataflowPass>("AddRangeOfMarker").Configure(p =>
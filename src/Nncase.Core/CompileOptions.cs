@@ -115,6 +115,11 @@ public sealed record CompileOptions
     /// </summary>
     public ShapeBucketOptions ShapeBucketOptions { get; set; } = ShapeBucketOptions.Default;
 
+    /// <summary>
+    /// Gets or sets the egraph extract options.
+    /// </summary>
+    public EGraphExtractOptions EGraphExtractOptions { get; set; } = EGraphExtractOptions.Default;
+
     /// <summary>
     /// Gets or sets a value indicating whether is benchmark only.
     /// </summary>
@@ -0,0 +1,41 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+namespace Nncase;
+
+/// <summary>
+/// EGraph extraction options, they trade compile time against the quality of the extracted graph.
+/// </summary>
+public sealed record EGraphExtractOptions
+{
+    /// <summary>
+    /// Gets the default options.
+    /// </summary>
+    public static EGraphExtractOptions Default => new();
+
+    /// <summary>
+    /// Gets or sets the wall time limit in seconds of the sat solver, shared by all the regions.
+    /// Regions still unsolved when it runs out keep the greedy extraction.
+    /// </summary>
+    public double TimeLimit { get; set; } = 120;
+
+    /// <summary>
+    /// Gets or sets the relative gap between the cost and its lower bound at which the solver stops, 0 solves to optimal.
+    /// </summary>
+    public double RelativeGap { get; set; }
+
+    /// <summary>
+    /// Gets or sets the sat solver workers, 0 uses half of the processors.
+    /// </summary>
+    public int NumWorkers { get; set; }
+
+    /// <summary>
+    /// Gets or sets a value indicating whether the independent regions of the egraph are solved separately.
+    /// </summary>
+    public bool Partition { get; set; } = true;
+
+    /// <summary>
+    /// Gets or sets a value indicating whether to skip the sat solver and keep the greedy extraction.
+    /// </summary>
+    public bool GreedyOnly { get; set; }
+}
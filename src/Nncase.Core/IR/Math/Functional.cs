@@ -233,6 +233,17 @@ public static Call Clamp<T>(Expr input, ValueRange<T> range)
     /// <returns>Result expression.</returns>
     public static Call MatMul(Expr lhs, Expr rhs) => new(new MatMul(), lhs, rhs);
 
+    /// <summary>
+    /// Call weight-only quantized matMul.
+    /// </summary>
+    /// <param name="input">Float input [..., K].</param>
+    /// <param name="weights">Quantized weights [N, K], int4 weights are packed two per byte.</param>
+    /// <param name="scales">Per group scales [N, ceil(K / groupSize)].</param>
+    /// <param name="bits">Bits of the weights, 8 or 4.</param>
+    /// <param name="groupSize">Count of the weights along K sharing one scale.</param>
+    /// <returns>Result expression.</returns>
+    public static Call WeightOnlyMatMul(Expr input, Expr weights, Expr scales, int bits, int groupSize) => new(new WeightOnlyMatMul(bits, groupSize), input, weights, scales);
+
     /// <summary>
     /// Call max.
     /// </summary>
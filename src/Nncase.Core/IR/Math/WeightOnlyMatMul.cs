@@ -0,0 +1,43 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+using System;
+using Nncase.PatternMatch;
+using static Nncase.IR.TypePatternUtility;
+
+namespace Nncase.IR.Math;
+
+/// <summary>
+/// MatMul with weight-only quantized weights, the weights are dequantized on the fly.
+/// </summary>
+[PatternFunctionalGenerator]
+public sealed partial class WeightOnlyMatMul : Op
+{
+    /// <summary>
+    /// Gets input, float32 [..., K].
+    /// </summary>
+    public static readonly ParameterInfo Input = new(typeof(WeightOnlyMatMul), 0, "input", HasDataType(DataTypes.Float32));
+
+    /// <summary>
+    /// Gets weights, int8 [N, K] or uint8 [N, ceil(K / 2)] holding two int4 per byte, the lower k in the low nibble.
+    /// </summary>
+    public static readonly ParameterInfo Weights = new(typeof(WeightOnlyMatMul), 1, "weights", HasRank(2));
+
+    /// <summary>
+    /// Gets scales, float32 [N, ceil(K / GroupSize)].
+    /// </summary>
+    public static readonly ParameterInfo Scales = new(typeof(WeightOnlyMatMul), 2, "scales", HasRank(2) & HasDataType(DataTypes.Float32));
+
+    /// <summary>
+    /// Gets bits of the weights, 8 or 4.
+    /// </summary>
+    public int Bits { get; }
+
+    /// <summary>
+    /// Gets count of the weights along K sharing one scale.
+    /// </summary>
+    public int GroupSize { get; }
+
+    /// <inheritdoc/>
+    public override string DisplayProperty() => $"Bits: {Bits}, GroupSize: {GroupSize}";
+}
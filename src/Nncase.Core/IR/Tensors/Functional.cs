@@ -187,4 +187,23 @@ public static Call Slice(Expr input, Expr begins, Expr ends, int rank)
     public static Call IndexOf(Expr input, Expr value) => new Call(new IndexOf(), input, value);
 
     public static Call Trilu(Expr input, Expr k, Expr upper) => new Call(new Trilu(), input, k, upper);
+
+    /// <summary>
+    /// read the state variable of name, zero initialized when the model is loaded.
+    /// </summary>
+    /// <param name="name">state name.</param>
+    /// <param name="type">state data type.</param>
+    /// <param name="shape">state shape, must be constant.</param>
+    /// <returns>call.</returns>
+    public static Call VariableRead(string name, DataType type, Expr shape) => new Call(new VariableRead(name, type), shape);
+
+    /// <summary>
+    /// write update into the state at offset along axis in place.
+    /// </summary>
+    /// <param name="state">state returned by <see cref="IR.Tensors.VariableRead"/>.</param>
+    /// <param name="update">update.</param>
+    /// <param name="offset">offset along axis.</param>
+    /// <param name="axis">axis.</param>
+    /// <returns>the updated state.</returns>
+    public static Call VariableUpdate(Expr state, Expr update, Expr offset, int axis) => new Call(new VariableUpdate(axis), state, update, offset);
 }
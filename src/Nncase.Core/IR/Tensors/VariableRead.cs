@@ -0,0 +1,42 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Linq;
+using System.Text;
+using System.Threading.Tasks;
+using Nncase.PatternMatch;
+using static Nncase.IR.TypePatternUtility;
+
+namespace Nncase.IR.Tensors;
+
+/// <summary>
+/// Read a state variable, which persists across the runs of a model.
+/// States are declared in the kmodel by their reads, allocated once when the model is loaded and zero initialized.
+/// </summary>
+[PatternFunctionalGenerator]
+public sealed partial class VariableRead : Op
+{
+    /// <summary>
+    /// Gets shape of the state, must be constant.
+    /// </summary>
+    public static readonly ParameterInfo Shape = new(typeof(VariableRead), 0, "shape", IsIntegral() & HasRank(1));
+
+    /// <summary>
+    /// Gets name of the state, reads of the same name share one state.
+    /// </summary>
+    public string Name { get; }
+
+    /// <summary>
+    /// Gets data type of the state.
+    /// </summary>
+    public DataType Type { get; }
+
+    /// <inheritdoc/>
+    public override bool CanFoldConstCall => false;
+
+    /// <inheritdoc/>
+    public override string DisplayProperty() => $"{Name}, {Type.GetCSharpName()}";
+}
@@ -0,0 +1,47 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.Collections.Immutable;
+using System.Linq;
+using System.Text;
+using System.Threading.Tasks;
+using Nncase.PatternMatch;
+using static Nncase.IR.TypePatternUtility;
+
+namespace Nncase.IR.Tensors;
+
+/// <summary>
+/// Write update into a state variable at offset along axis, e.g. append the keys and values of new tokens to a kv cache.
+/// The state is updated in place and returned.
+/// </summary>
+[PatternFunctionalGenerator]
+public sealed partial class VariableUpdate : Op
+{
+    /// <summary>
+    /// Gets state, the output of a <see cref="VariableRead"/>.
+    /// </summary>
+    public static readonly ParameterInfo State = new(typeof(VariableUpdate), 0, "state", IsTensor());
+
+    /// <summary>
+    /// Gets update, has the shape of the state except on axis.
+    /// </summary>
+    public static readonly ParameterInfo Update = new(typeof(VariableUpdate), 1, "update", IsTensor());
+
+    /// <summary>
+    /// Gets offset along axis the update is written at.
+    /// </summary>
+    public static readonly ParameterInfo Offset = new(typeof(VariableUpdate), 2, "offset", IsIntegralScalar());
+
+    /// <summary>
+    /// Gets axis.
+    /// </summary>
+    public int Axis { get; }
+
+    /// <inheritdoc/>
+    public override bool CanFoldConstCall => false;
+
+    /// <inheritdoc/>
+    public override string DisplayProperty() => $"Axis: {Axis}";
+}
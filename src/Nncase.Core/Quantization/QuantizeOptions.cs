@@ -163,6 +163,23 @@ public class QuantizeOptions
     /// </summary>
     public bool ExportWeightRangeByChannel { get; set; }
 
+    /// <summary>
+    /// Gets or sets the max number of calibration samples evaluated concurrently, 0 to use all processors.
+    /// Only the activations of the samples in flight are kept in memory.
+    /// </summary>
+    public int CalibrationParallelism { get; set; }
+
+    /// <summary>
+    /// Gets or sets bits of the weight-only quantized matmul weights, 8 or 4, 0 to disable.
+    /// The constant weights of float32 matmuls are stored quantized and dequantized on the fly.
+    /// </summary>
+    public int WeightOnlyQuantBits { get; set; }
+
+    /// <summary>
+    /// Gets or sets count of the weight-only quantized weights along K sharing one scale.
+    /// </summary>
+    public int WeightOnlyQuantGroupSize { get; set; } = 128;
+
     /// <summary>
     /// Gets or sets a value indicating whether dump quant error.
     /// </summary>
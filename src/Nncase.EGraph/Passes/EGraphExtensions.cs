@@ -45,6 +45,8 @@ public static Expr Extract(this IEGraph eGraph, EClass root, Evaluator.IBaseFunc
         // 2. start the cost evaluator
         var costModel = new CostModel.EGraphCostEvaluator(root.Find(), basefunc_cost_evaluator, false).Evaluate();
 
-        return new EGraphExtractor(costModel).Extract(root.Find(), eGraph, constrains);
+        // 3. extract with the options of the current compile session.
+        var options = CompileSessionScope.Current?.CompileOptions.EGraphExtractOptions;
+        return new EGraphExtractor(costModel, options).Extract(root.Find(), eGraph, constrains);
     }
 }
@@ -3,9 +3,11 @@
 
 using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.IO;
 using System.Linq;
 using System.Text;
+using System.Threading.Tasks;
 using Google.OrTools.Sat;
 using Nncase.CostModel;
 using Nncase.Diagnostics;
@@ -18,85 +20,214 @@ namespace Nncase.Passes;
 internal class EGraphExtractor
 {
     private readonly EGraphCostModel _costModel;
+    private readonly EGraphExtractOptions _options;
 
-    public EGraphExtractor(EGraphCostModel costModel)
+    public EGraphExtractor(EGraphCostModel costModel, EGraphExtractOptions? options = null)
     {
         _costModel = costModel;
+        _options = options ?? EGraphExtractOptions.Default;
     }
 
     public Expr Extract(EClass root, IEGraph eGraph, EGraphExtractConstrains[] constrains)
     {
-        var cpmodel = new CpModel();
+        var classes = ReachableClasses(root);
+        var greedy = GreedyExtract(root, classes);
 
-        // 0. create bool var for all enode.
-        var varMemo = new Dictionary<ENode, BoolVar>();
-        foreach (var cls in eGraph.Classes)
+        // the user constrains may tie any enodes together, so they need the global model.
+        IReadOnlyDictionary<ENode, bool> picks;
+        if (constrains.Length == 0 && _options.GreedyOnly)
         {
-            foreach (var (e, i) in cls.Nodes.Select((e, i) => (e, i)))
+            picks = eGraph.Nodes.ToDictionary(e => e, greedy.Contains);
+        }
+        else if (constrains.Length == 0 && _options.Partition)
+        {
+            picks = PartitionExtract(root, eGraph, classes, greedy);
+        }
+        else
+        {
+            picks = GlobalExtract(root, eGraph, constrains, greedy);
+        }
+
+        var enableDump = DumpScope.Current.IsEnabled(DumpFlags.EGraphCost);
+        using (var dumpStream = enableDump ? DumpScope.Current.OpenFile("Costs/Pick.dot") : Stream.Null)
+        {
+            EGraphPrinter.DumpEgraphAsDot(eGraph, _costModel, picks, root.Find(), dumpStream);
+        }
+
+        return new SatExprBuildVisitor(picks).Visit(root);
+    }
+
+    private static List<EClass> ReachableClasses(EClass root)
+    {
+        var visited = new HashSet<EClass> { root };
+        var classes = new List<EClass> { root };
+        for (int i = 0; i < classes.Count; i++)
+        {
+            foreach (var node in classes[i].Nodes)
             {
-                varMemo.Add(e, cpmodel.NewBoolVar($"{cls.Id}_{i}"));
+                foreach (var ch in node.Children)
+                {
+                    if (visited.Add(ch))
+                    {
+                        classes.Add(ch);
+                    }
+                }
             }
         }
 
-        // 1. must pick one in root enode.
-        cpmodel.AddBoolOr(root.Nodes.Select(n => varMemo[n]).ToArray());
+        return classes;
+    }
 
-        // 2. when pick node, must pick one child node.
-        foreach (var n in eGraph.Nodes)
+    private static HyperGraph ToHyperGraph(IEnumerable<EClass> classes)
+    {
+        var hgraph = new HyperGraph();
+        var members = new HashSet<EClass>(classes);
+        foreach (var cls in members)
         {
-            var ns = new[] { varMemo[n].Not() };
-            foreach (var child in n.Children)
+            foreach (var node in cls.Nodes)
             {
-                cpmodel.AddBoolOr(ns.Concat(child.Nodes.Select(cn => varMemo[cn])));
+                foreach (var ch in node.Children.Where(members.Contains))
+                {
+                    hgraph.Connect(cls, ch, node);
+                }
             }
         }
 
-        // 3. no cycle
+        return hgraph;
+    }
+
+    /// <summary>
+    /// Forbid picking every enode of any eclass cycle.
+    /// </summary>
+    private static void AddCycleConstrains(CpModel cpmodel, HyperGraph hgraph, Func<ENode, BoolVar> literal)
+    {
+        var class_cycles = FindCycles(hgraph);
+        foreach (var cycle in class_cycles)
         {
-            var hgraph = ToHyperGraph(root);
-            var class_cycles = FindCycles(hgraph);
-            foreach (var cycle in class_cycles)
+            if (cycle.Count == 1)
             {
-                if (cycle.Count == 1)
+                foreach (var n in cycle[0].Nodes)
                 {
-                    foreach (var n in cycle[0].Nodes)
+                    if (n.Children.Contains(cycle[0]))
                     {
-                        if (n.Children.Contains(cycle[0]))
-                        {
-                            cpmodel.AddAssumption(varMemo[n].Not());
-                        }
+                        cpmodel.AddAssumption(literal(n).Not());
                     }
                 }
-                else
+            }
+            else
+            {
+                // build clauses.
+                var clauses = new List<List<BoolVar>>();
+                for (int i = 0; i < cycle.Count; i++)
                 {
-                    // build clauses.
-                    var clauses = new List<List<BoolVar>>();
-                    for (int i = 0; i < cycle.Count; i++)
+                    var next_hop = (i + 1) % cycle.Count;
+                    var u = hgraph.Edges(cycle[i])!;
+                    var v = u[cycle[next_hop]];
+                    clauses.Add(v.Select(literal).ToList());
+                }
+
+                var clauseMemo = new Dictionary<int, BoolVar>();
+                for (int i = 0; i < clauses.Count; i++)
+                {
+                    var clause = clauses[i];
+                    if (clause.Count > 1)
                     {
-                        var next_hop = (i + 1) % cycle.Count;
-                        var u = hgraph.Edges(cycle[i])!;
-                        var v = u[cycle[next_hop]];
-                        clauses.Add(v.Select(n => varMemo[n]).ToList());
+                        var tmpV = cpmodel.NewBoolVar(string.Empty);
+                        cpmodel.AddBoolAnd(clause.Select(c => c.Not())).OnlyEnforceIf(tmpV);
+                        cpmodel.AddBoolOr(clause).OnlyEnforceIf(tmpV.Not());
+                        clauseMemo.Add(i, tmpV);
                     }
+                }
 
-                    var clauseMemo = new Dictionary<int, BoolVar>();
-                    for (int i = 0; i < clauses.Count; i++)
+                cpmodel.AddBoolOr(clauses.Select((c, i) => (c, i)).Select(p => p.c.Count == 1 ? p.c[0].Not() : clauseMemo[p.i]));
+            }
+        }
+    }
+
+    /// <summary>
+    /// Pick the enode of least tree cost in every eclass, it's a valid acyclic extraction used to warm start the solver.
+    /// </summary>
+    private HashSet<ENode> GreedyExtract(EClass root, IReadOnlyList<EClass> classes)
+    {
+        var best = new Dictionary<EClass, (double Cost, ENode Node)>();
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+
+            // the children are mostly found after their parents, visit them first.
+            for (int i = classes.Count - 1; i >= 0; i--)
+            {
+                var cls = classes[i];
+                foreach (var node in cls.Nodes)
+                {
+                    var cost = (double)_costModel[node].Score;
+                    foreach (var ch in node.Children)
                     {
-                        var clause = clauses[i];
-                        if (clause.Count > 1)
-                        {
-                            var tmpV = cpmodel.NewBoolVar(string.Empty);
-                            cpmodel.AddBoolAnd(clause.Select(c => c.Not())).OnlyEnforceIf(tmpV);
-                            cpmodel.AddBoolOr(clause).OnlyEnforceIf(tmpV.Not());
-                            clauseMemo.Add(i, tmpV);
-                        }
+                        cost = best.TryGetValue(ch, out var chBest) ? cost + chBest.Cost : double.PositiveInfinity;
                     }
 
-                    cpmodel.AddBoolOr(clauses.Select((c, i) => (c, i)).Select(p => p.c.Count == 1 ? p.c[0].Not() : clauseMemo[p.i]));
+                    if (cost < (best.TryGetValue(cls, out var clsBest) ? clsBest.Cost : double.PositiveInfinity))
+                    {
+                        best[cls] = (cost, node);
+                        changed = true;
+                    }
                 }
             }
         }
 
+        var picks = new HashSet<ENode>();
+        var queue = new Queue<EClass>();
+        var visited = new HashSet<EClass> { root };
+        queue.Enqueue(root);
+        while (queue.TryDequeue(out var cls))
+        {
+            if (!best.TryGetValue(cls, out var clsBest))
+            {
+                throw new InvalidProgramException($"The eclass {cls.Id} only has cyclic enodes!");
+            }
+
+            picks.Add(clsBest.Node);
+            foreach (var ch in clsBest.Node.Children.Where(visited.Add))
+            {
+                queue.Enqueue(ch);
+            }
+        }
+
+        return picks;
+    }
+
+    private IReadOnlyDictionary<ENode, bool> GlobalExtract(EClass root, IEGraph eGraph, EGraphExtractConstrains[] constrains, HashSet<ENode> greedy)
+    {
+        var cpmodel = new CpModel();
+
+        // 0. create bool var for all enode.
+        var varMemo = new Dictionary<ENode, BoolVar>();
+        foreach (var cls in eGraph.Classes)
+        {
+            foreach (var (e, i) in cls.Nodes.Select((e, i) => (e, i)))
+            {
+                varMemo.Add(e, cpmodel.NewBoolVar($"{cls.Id}_{i}"));
+                cpmodel.AddHint(varMemo[e], greedy.Contains(e) ? 1 : 0);
+            }
+        }
+
+        // 1. must pick one in root enode.
+        cpmodel.AddBoolOr(root.Nodes.Select(n => varMemo[n]).ToArray());
+
+        // 2. when pick node, must pick one child node.
+        foreach (var n in eGraph.Nodes)
+        {
+            var ns = new[] { varMemo[n].Not() };
+            foreach (var child in n.Children)
+            {
+                cpmodel.AddBoolOr(ns.Concat(child.Nodes.Select(cn => varMemo[cn])));
+            }
+        }
+
+        // 3. no cycle
+        AddCycleConstrains(cpmodel, ToHyperGraph(ReachableClasses(root)), n => varMemo[n]);
+
         foreach (var constrain in constrains)
         {
             constrain(cpmodel, varMemo);
@@ -110,86 +241,247 @@ public Expr Extract(EClass root, IEGraph eGraph, EGraphExtractConstrains[] const
             throw new InvalidDataException("the sat model invalid: " + cpmodel.Validate());
         }
 
-        var solver = new CpSolver();
-        int max_time = 120;
-        if (System.Environment.GetEnvironmentVariable("SOLVE_MAX_TIME") is string s_solve_max_time)
+        var solver = CreateSolver(GetTimeLimit(), GetNumWorkers());
+        var enableDump = DumpScope.Current.IsEnabled(DumpFlags.EGraphCost);
+        CpSolverStatus status;
+        using (var dumpStream = enableDump ? DumpScope.Current.OpenFile("Costs/Solve.txt") : Stream.Null)
+        {
+            using var writer = new StreamWriter(dumpStream);
+            var cb = new PrintCostCallBack(varMemo, _costModel, writer, enableDump);
+            status = solver.Solve(cpmodel, cb);
+            writer.WriteLine($"Status : {status}");
+            dumpStream.Flush();
+        }
+
+        if (status is not (CpSolverStatus.Optimal or CpSolverStatus.Feasible))
+        {
+            throw new InvalidProgramException("SatExtract Failed!");
+        }
+
+        return eGraph.Nodes.ToDictionary(e => e, e => solver.BooleanValue(varMemo[e]));
+    }
+
+    /// <summary>
+    /// Solve the weakly connected regions of eclasses with choices independently.
+    /// The eclasses every extraction picks that have only one enode are fixed, they split the egraph into regions
+    /// that share no constrain as long as the eclass cycles are kept inside one region.
+    /// </summary>
+    private IReadOnlyDictionary<ENode, bool> PartitionExtract(EClass root, IEGraph eGraph, IReadOnlyList<EClass> classes, HashSet<ENode> greedy)
+    {
+        // 1. find the fixed eclasses and the eclasses that must pick one enode.
+        var required = new HashSet<EClass> { root };
+        var fixedClasses = new HashSet<EClass>();
+        var queue = new Queue<EClass>();
+        queue.Enqueue(root);
+        while (queue.TryDequeue(out var cls))
         {
-            try
+            if (cls.Nodes.Count == 1)
             {
-                var solve_max_time = int.Parse(s_solve_max_time);
-                max_time = solve_max_time;
+                fixedClasses.Add(cls);
+                foreach (var ch in cls.Nodes[0].Children.Where(required.Add))
+                {
+                    queue.Enqueue(ch);
+                }
             }
-            catch (System.Exception)
+        }
+
+        // 2. union the choice eclasses linked by an enode or by a cycle.
+        var ids = classes.Select((c, i) => (c, i)).ToDictionary(p => p.c, p => p.i);
+        var parents = Enumerable.Range(0, classes.Count).ToArray();
+        int FindSet(int i) => parents[i] == i ? i : parents[i] = FindSet(parents[i]);
+        void Union(EClass a, EClass b) => parents[FindSet(ids[a])] = FindSet(ids[b]);
+
+        foreach (var cls in classes.Where(c => !fixedClasses.Contains(c)))
+        {
+            foreach (var ch in cls.Nodes.SelectMany(n => n.Children).Where(c => !fixedClasses.Contains(c)))
             {
+                Union(cls, ch);
             }
         }
 
-        int processorCount = Math.Max(System.Environment.ProcessorCount / 2, 1);
-        if (System.Environment.GetEnvironmentVariable("SOLVE_PROCESSOR_COUNT") is string s_solve_processor_count)
+        var adjList = classes.Select(c => c.Nodes.SelectMany(n => n.Children).Select(ch => ids[ch]).Distinct().ToList()).ToList();
+        var (components, _) = StronglyConnectedComponents(adjList);
+        var cyclicClasses = new Dictionary<EClass, int>();
+        foreach (var (component, sccId) in components.Select((c, i) => (c, i)))
         {
-            try
+            var members = component.Select(i => classes[i]).ToList();
+            if (members.Count == 1 && !adjList[component[0]].Contains(component[0]))
+            {
+                continue;
+            }
+
+            foreach (var cls in members)
             {
-                var solve_processor_count = int.Parse(s_solve_processor_count);
-                processorCount = solve_processor_count;
+                cyclicClasses.Add(cls, sccId);
             }
-            catch (System.Exception)
+
+            var choices = members.Where(c => !fixedClasses.Contains(c)).ToList();
+            if (choices.Count == 0)
             {
+                throw new InvalidProgramException($"The eclass {members[0].Id} is in a cycle without choices!");
             }
+
+            foreach (var cls in choices.Skip(1))
+            {
+                Union(choices[0], cls);
+            }
+        }
+
+        var regions = classes.Where(c => !fixedClasses.Contains(c)).
+            GroupBy(c => FindSet(ids[c])).
+            Select(g => g.ToList()).
+            OrderByDescending(r => r.Sum(c => c.Nodes.Count)).
+            ToList();
+
+        // 3. solve the regions in parallel, the regions not solved in time keep the greedy picks.
+        var picks = eGraph.Nodes.ToDictionary(e => e, e => false);
+        foreach (var cls in fixedClasses)
+        {
+            picks[cls.Nodes[0]] = true;
         }
 
-        solver.StringParameters = $"max_time_in_seconds:{max_time},num_workers:{processorCount}";
+        var timeLimit = GetTimeLimit();
+        var numWorkers = GetNumWorkers();
+        var parallelism = Math.Max(Math.Min(regions.Count, numWorkers), 1);
+        var stopwatch = Stopwatch.StartNew();
+        var results = new (CpSolverStatus Status, ENode[] Picks)[regions.Count];
+        Parallel.For(0, regions.Count, new ParallelOptions { MaxDegreeOfParallelism = parallelism }, i =>
+        {
+            var remaining = timeLimit - stopwatch.Elapsed.TotalSeconds;
+            var workers = Math.Max(numWorkers / parallelism, 1);
+            results[i] = SolveRegion(regions[i], required, fixedClasses, cyclicClasses, greedy, remaining, workers);
+        });
 
         var enableDump = DumpScope.Current.IsEnabled(DumpFlags.EGraphCost);
-        CpSolverStatus status;
         using (var dumpStream = enableDump ? DumpScope.Current.OpenFile("Costs/Solve.txt") : Stream.Null)
         {
             using var writer = new StreamWriter(dumpStream);
-            var cb = new PrintCostCallBack(varMemo, _costModel, writer, enableDump);
-            status = solver.Solve(cpmodel, cb);
-            writer.WriteLine($"Status : {status}");
-            dumpStream.Flush();
+            for (int i = 0; i < regions.Count; i++)
+            {
+                var (status, regionPicks) = results[i];
+                if (status is not (CpSolverStatus.Optimal or CpSolverStatus.Feasible))
+                {
+                    regionPicks = regions[i].SelectMany(c => c.Nodes).Where(greedy.Contains).ToArray();
+                }
+
+                foreach (var n in regionPicks)
+                {
+                    picks[n] = true;
+                }
+
+                if (enableDump)
+                {
+                    var cost = regionPicks.Aggregate(Cost.Zero, (acc, n) => acc + _costModel[n]);
+                    writer.WriteLine($"Region {i}: classes {regions[i].Count}, status {status}, cost {cost}");
+                }
+            }
+
+            writer.WriteLine($"Regions : {regions.Count}, fixed classes : {fixedClasses.Count}, time : {stopwatch.Elapsed}");
         }
 
-        if (status is not (CpSolverStatus.Optimal or CpSolverStatus.Feasible))
+        return picks;
+    }
+
+    private (CpSolverStatus Status, ENode[] Picks) SolveRegion(List<EClass> region, HashSet<EClass> required, HashSet<EClass> fixedClasses, Dictionary<EClass, int> cyclicClasses, HashSet<ENode> greedy, double timeLimit, int numWorkers)
+    {
+        // a single eclass region only depends on fixed eclasses, pick its cheapest enode.
+        if (region.Count == 1 && !cyclicClasses.ContainsKey(region[0]))
         {
-            throw new InvalidProgramException("SatExtract Failed!");
+            return (CpSolverStatus.Optimal, new[] { region[0].Nodes.MinBy(n => _costModel[n].Score)! });
         }
 
-        var picks = eGraph.Nodes.ToDictionary(e => e, e => solver.BooleanValue(varMemo[e]));
-        using (var dumpStream = enableDump ? DumpScope.Current.OpenFile("Costs/Pick.dot") : Stream.Null)
+        if (timeLimit <= 0)
         {
-            EGraphPrinter.DumpEgraphAsDot(eGraph, _costModel, picks, root.Find(), dumpStream);
+            return (CpSolverStatus.Unknown, Array.Empty<ENode>());
         }
 
-        return new SatExprBuildVisitor(picks).Visit(root);
-    }
+        var cpmodel = new CpModel();
+        var varMemo = new Dictionary<ENode, BoolVar>();
+        foreach (var cls in region)
+        {
+            foreach (var (e, i) in cls.Nodes.Select((e, i) => (e, i)))
+            {
+                varMemo.Add(e, cpmodel.NewBoolVar($"{cls.Id}_{i}"));
+                cpmodel.AddHint(varMemo[e], greedy.Contains(e) ? 1 : 0);
+            }
+        }
 
-    private static HyperGraph ToHyperGraph(EClass root)
-    {
-        var hgraph = new HyperGraph();
-        var visited = new HashSet<EClass>();
-        var queue = new Queue<EClass>();
-        queue.Enqueue(root);
-        visited.Add(root);
-        while (queue.Any())
+        // fixed enodes are always picked, they only show up in the cycles.
+        BoolVar Literal(ENode n)
         {
-            var front = queue.Dequeue();
-            foreach (var node in front.Nodes)
+            if (!varMemo.TryGetValue(n, out var v))
             {
-                foreach (var ch in node.Children)
+                v = cpmodel.NewBoolVar(string.Empty);
+                cpmodel.AddBoolOr(new[] { v });
+                varMemo.Add(n, v);
+            }
+
+            return v;
+        }
+
+        foreach (var cls in region)
+        {
+            if (required.Contains(cls))
+            {
+                cpmodel.AddBoolOr(cls.Nodes.Select(n => varMemo[n]));
+            }
+
+            foreach (var n in cls.Nodes)
+            {
+                foreach (var child in n.Children.Where(c => !fixedClasses.Contains(c)))
                 {
-                    var canonical = ch;
-                    hgraph.Connect(front, canonical, node);
-                    if (!visited.Contains(canonical))
-                    {
-                        visited.Add(canonical);
-                        queue.Enqueue(canonical);
-                    }
+                    cpmodel.AddBoolOr(child.Nodes.Select(cn => (ILiteral)varMemo[cn]).Append(varMemo[n].Not()));
                 }
             }
         }
 
-        return hgraph;
+        var nodes = region.SelectMany(c => c.Nodes).ToArray();
+        var sccIds = region.Where(cyclicClasses.ContainsKey).Select(c => cyclicClasses[c]).ToHashSet();
+        if (sccIds.Count != 0)
+        {
+            var members = cyclicClasses.Where(p => sccIds.Contains(p.Value)).Select(p => p.Key);
+            AddCycleConstrains(cpmodel, ToHyperGraph(members), Literal);
+        }
+
+        cpmodel.Minimize(LinearExpr.WeightedSum(nodes.Select(n => varMemo[n]), nodes.Select(n => checked((long)_costModel[n].Score))));
+
+        var solver = CreateSolver(timeLimit, numWorkers);
+        var status = solver.Solve(cpmodel);
+        if (status is not (CpSolverStatus.Optimal or CpSolverStatus.Feasible))
+        {
+            return (status, Array.Empty<ENode>());
+        }
+
+        return (status, nodes.Where(n => solver.BooleanValue(varMemo[n])).ToArray());
+    }
+
+    private double GetTimeLimit()
+    {
+        if (System.Environment.GetEnvironmentVariable("SOLVE_MAX_TIME") is string s_solve_max_time
+            && double.TryParse(s_solve_max_time, out var solve_max_time))
+        {
+            return solve_max_time;
+        }
+
+        return _options.TimeLimit;
+    }
+
+    private int GetNumWorkers()
+    {
+        if (System.Environment.GetEnvironmentVariable("SOLVE_PROCESSOR_COUNT") is string s_solve_processor_count
+            && int.TryParse(s_solve_processor_count, out var solve_processor_count))
+        {
+            return solve_processor_count;
+        }
+
+        return _options.NumWorkers > 0 ? _options.NumWorkers : Math.Max(System.Environment.ProcessorCount / 2, 1);
+    }
+
+    private CpSolver CreateSolver(double timeLimit, int numWorkers)
+    {
+        var solver = new CpSolver();
+        solver.StringParameters = FormattableString.Invariant($"max_time_in_seconds:{timeLimit},num_workers:{numWorkers},relative_gap_limit:{_options.RelativeGap}");
+        return solver;
     }
 
     private static List<List<EClass>> FindCycles(HyperGraph hgraph)
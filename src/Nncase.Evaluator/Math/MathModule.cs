@@ -30,5 +30,6 @@ public void ConfigureServices(IRegistrator registrator)
         registrator.RegisterManyInterface<SelectEvaluator>(reuse: Reuse.Singleton);
         registrator.RegisterManyInterface<ConditionEvaluator>(reuse: Reuse.Singleton);
         registrator.RegisterManyInterface<RequireEvaluator>(reuse: Reuse.Singleton);
+        registrator.RegisterManyInterface<WeightOnlyMatMulEvaluator>(reuse: Reuse.Singleton);
     }
 }
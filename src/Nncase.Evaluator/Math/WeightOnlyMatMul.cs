@@ -0,0 +1,150 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Linq;
+using Nncase.CostModel;
+using Nncase.IR;
+using Nncase.IR.Math;
+using OrtKISharp;
+
+namespace Nncase.Evaluator.Math;
+
+/// <summary>
+/// Evaluator for <see cref="WeightOnlyMatMul"/>.
+/// </summary>
+public class WeightOnlyMatMulEvaluator : IEvaluator<WeightOnlyMatMul>, ITypeInferencer<WeightOnlyMatMul>, ICostEvaluator<WeightOnlyMatMul>, IMetricEvaluator<WeightOnlyMatMul>
+{
+    /// <summary>
+    /// Dequantize the weights to the float32 rhs [K, N] of a matmul.
+    /// </summary>
+    /// <param name="weights">Quantized weights [N, K], int4 weights are packed two per byte.</param>
+    /// <param name="scales">Per group scales [N, ceil(K / groupSize)].</param>
+    /// <param name="k">K of the weights.</param>
+    /// <param name="bits">Bits of the weights, 8 or 4.</param>
+    /// <param name="groupSize">Count of the weights along K sharing one scale.</param>
+    /// <returns>Dequantized weights.</returns>
+    public static Tensor<float> DequantizeWeights(Tensor weights, Tensor<float> scales, int k, int bits, int groupSize)
+    {
+        var n = weights.Dimensions[0];
+        var rowBytes = weights.Dimensions[1];
+        var groups = scales.Dimensions[1];
+        var data = weights.BytesBuffer;
+        var scale = scales.Buffer.Span;
+        var output = new float[k * n];
+        for (int i = 0; i < n; i++)
+        {
+            var row = data.Slice(i * rowBytes, rowBytes);
+            for (int j = 0; j < k; j++)
+            {
+                int q;
+                if (bits == 8)
+                {
+                    q = (sbyte)row[j];
+                }
+                else
+                {
+                    var nibble = (j & 1) == 0 ? row[j / 2] & 0xF : row[j / 2] >> 4;
+                    q = (nibble ^ 8) - 8;
+                }
+
+                output[(j * n) + i] = q * scale[(i * groups) + (j / groupSize)];
+            }
+        }
+
+        return Tensor.From(output, new[] { k, n });
+    }
+
+    /// <inheritdoc/>
+    public IValue Visit(IEvaluateContext context, WeightOnlyMatMul target)
+    {
+        var input = context.GetOrtArgumentValue(target, WeightOnlyMatMul.Input);
+        var weights = context.GetArgumentValueAsTensor(target, WeightOnlyMatMul.Weights);
+        var scales = context.GetArgumentValueAsTensor<float>(target, WeightOnlyMatMul.Scales);
+        var k = checked((int)input.Shape[^1]);
+        var rhs = DequantizeWeights(weights, scales, k, target.Bits, target.GroupSize);
+        return OrtKI.MatMul(input, rhs.ToOrtTensor()).ToValue();
+    }
+
+    /// <inheritdoc/>
+    public IRType Visit(ITypeInferenceContext context, WeightOnlyMatMul target)
+    {
+        var input = context.CheckArgumentType<TensorType>(target, WeightOnlyMatMul.Input);
+        var weights = context.CheckArgumentType<TensorType>(target, WeightOnlyMatMul.Weights);
+        var scales = context.CheckArgumentType<TensorType>(target, WeightOnlyMatMul.Scales);
+        return Visit(target, input, weights, scales);
+    }
+
+    /// <inheritdoc/>
+    public Cost Visit(ICostEvaluateContext context, WeightOnlyMatMul target)
+    {
+        var input = context.GetArgumentType<TensorType>(target, WeightOnlyMatMul.Input);
+        var weights = context.GetArgumentType<TensorType>(target, WeightOnlyMatMul.Weights);
+        var scales = context.GetArgumentType<TensorType>(target, WeightOnlyMatMul.Scales);
+        var outputType = context.GetReturnType<TensorType>();
+        var macPerElement = input.Shape[^1].IsFixed ? (uint)input.Shape[^1].FixedValue : 1U;
+
+        // Only the quantized weights are loaded, which is where the speed up comes from.
+        return new()
+        {
+            [CostFactorNames.MemoryLoad] = CostUtility.GetMemoryAccess(input, weights, scales),
+            [CostFactorNames.MemoryStore] = CostUtility.GetMemoryAccess(outputType),
+            [CostFactorNames.CPUCycles] = CostUtility.GetCPUCycles(outputType, macPerElement),
+        };
+    }
+
+    /// <inheritdoc/>
+    public Metric Visit(IMetricEvaluateContext context, WeightOnlyMatMul target)
+    {
+        var input = context.GetArgumentType<TensorType>(target, WeightOnlyMatMul.Input);
+        var weights = context.GetArgumentType<TensorType>(target, WeightOnlyMatMul.Weights);
+        var scales = context.GetArgumentType<TensorType>(target, WeightOnlyMatMul.Scales);
+        var outputType = context.GetReturnType<TensorType>();
+        var k = input.Shape[^1].FixedValue;
+        return new()
+        {
+            [MetricFactorNames.OffChipMemoryTraffic] = CostUtility.GetMemoryAccess(input, weights, scales, outputType),
+            [MetricFactorNames.FLOPs] = MetricUtility.GetFLOPs(outputType, 2 * k),
+            [MetricFactorNames.Parallel] = 4,
+        };
+    }
+
+    private IRType Visit(WeightOnlyMatMul target, TensorType input, TensorType weights, TensorType scales)
+    {
+        var weightsType = target.Bits == 4 ? DataTypes.UInt8 : DataTypes.Int8;
+        if ((target.Bits != 8 && target.Bits != 4) || weights.DType != weightsType)
+        {
+            return new InvalidType("WeightOnlyMatMul weights should be int8, or uint8 for packed int4");
+        }
+
+        if (target.GroupSize <= 0)
+        {
+            return new InvalidType("WeightOnlyMatMul group size should be positive");
+        }
+
+        if (input.Shape.IsUnranked)
+        {
+            return new TensorType(DataTypes.Float32, Shape.Unranked);
+        }
+
+        if (input.Shape.Rank == 0)
+        {
+            return new InvalidType("WeightOnlyMatMul input should not be a scalar");
+        }
+
+        var k = input.Shape[^1];
+        if (k.IsFixed && weights.Shape[1].IsFixed
+            && weights.Shape[1].FixedValue != (target.Bits == 4 ? (k.FixedValue + 1) / 2 : k.FixedValue))
+        {
+            return new InvalidType("WeightOnlyMatMul input and weights have not compatiable shape");
+        }
+
+        if (k.IsFixed && scales.Shape[1].IsFixed
+            && scales.Shape[1].FixedValue != (k.FixedValue + target.GroupSize - 1) / target.GroupSize)
+        {
+            return new InvalidType("WeightOnlyMatMul scales should have one value per group");
+        }
+
+        return new TensorType(DataTypes.Float32, input.Shape.SkipLast(1).Append(weights.Shape[0]).ToArray());
+    }
+}
@@ -41,6 +41,8 @@ public void ConfigureServices(IRegistrator registrator)
         registrator.RegisterManyInterface<TriluEvaluator>(reuse: Reuse.Singleton);
         registrator.RegisterManyInterface<TransposeEvaluator>(reuse: Reuse.Singleton);
         registrator.RegisterManyInterface<UnsqueezeEvaluator>(reuse: Reuse.Singleton);
+        registrator.RegisterManyInterface<VariableReadEvaluator>(reuse: Reuse.Singleton);
+        registrator.RegisterManyInterface<VariableUpdateEvaluator>(reuse: Reuse.Singleton);
         registrator.RegisterManyInterface<WhereEvaluator>(reuse: Reuse.Singleton);
         registrator.RegisterManyInterface<GetItemEvaluator>(reuse: Reuse.Singleton);
         registrator.RegisterManyInterface<IndexOfEvaluator>(reuse: Reuse.Singleton);
@@ -0,0 +1,48 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+using System.Linq;
+using Nncase.CostModel;
+using Nncase.IR;
+using Nncase.IR.Tensors;
+
+namespace Nncase.Evaluator.Tensors;
+
+/// <summary>
+/// Evaluator for <see cref="VariableRead"/>.
+/// </summary>
+public class VariableReadEvaluator : IEvaluator<VariableRead>, ITypeInferencer<VariableRead>, ICostEvaluator<VariableRead>, IMetricEvaluator<VariableRead>
+{
+    /// <inheritdoc/>
+    public IValue Visit(IEvaluateContext context, VariableRead target)
+    {
+        // No state is kept across evaluations, reads return the initial zeros.
+        var shape = context.GetArgumentValueAsArray<int>(target, VariableRead.Shape);
+        var bytes = new byte[shape.Aggregate(1, (a, b) => a * b) * target.Type.SizeInBytes];
+        return Value.FromTensor(Tensor.FromBytes(target.Type, bytes, shape));
+    }
+
+    /// <inheritdoc/>
+    public IRType Visit(ITypeInferenceContext context, VariableRead target)
+    {
+        _ = context.CheckArgumentType<TensorType>(target, VariableRead.Shape);
+        if (context.GetArgument(target, VariableRead.Shape) is TensorConst shapeValue)
+        {
+            return new TensorType(target.Type, shapeValue.Value.ToArray<int>());
+        }
+
+        return new InvalidType($"The shape of state {target.Name} must be constant");
+    }
+
+    /// <inheritdoc/>
+    public Cost Visit(ICostEvaluateContext context, VariableRead target)
+    {
+        return new()
+        {
+            [CostFactorNames.CPUCycles] = 1,
+        };
+    }
+
+    /// <inheritdoc/>
+    public Metric Visit(IMetricEvaluateContext context, VariableRead target) => Metric.Zero;
+}
@@ -0,0 +1,106 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Linq;
+using Nncase.CostModel;
+using Nncase.IR;
+using Nncase.IR.Tensors;
+
+namespace Nncase.Evaluator.Tensors;
+
+/// <summary>
+/// Evaluator for <see cref="VariableUpdate"/>.
+/// </summary>
+public class VariableUpdateEvaluator : IEvaluator<VariableUpdate>, ITypeInferencer<VariableUpdate>, ICostEvaluator<VariableUpdate>, IMetricEvaluator<VariableUpdate>
+{
+    /// <inheritdoc/>
+    public IValue Visit(IEvaluateContext context, VariableUpdate target)
+    {
+        var state = context.GetArgumentValueAsTensor(target, VariableUpdate.State);
+        var update = context.GetArgumentValueAsTensor(target, VariableUpdate.Update);
+        var offset = context.GetArgumentValueAsScalar<long>(target, VariableUpdate.Offset);
+        var axis = Util.PositiveIndex(target.Axis, state.Rank);
+        if (offset < 0 || offset + update.Dimensions[axis] > state.Dimensions[axis])
+        {
+            throw new ArgumentOutOfRangeException(nameof(offset), $"Update of {update.Dimensions[axis]} at {offset} is out of the state of {state.Dimensions[axis]}");
+        }
+
+        // Copy rows of the dimensions after axis, they are contiguous in both.
+        var outer = state.Dimensions[..axis].ToArray().Aggregate(1, (a, b) => a * b);
+        var inner = state.Dimensions[(axis + 1)..].ToArray().Aggregate(state.ElementType.SizeInBytes, (a, b) => a * b);
+        var stateRow = state.Dimensions[axis] * inner;
+        var updateRow = update.Dimensions[axis] * inner;
+        var output = state.BytesBuffer.ToArray();
+        var source = update.BytesBuffer;
+        for (int i = 0; i < outer; i++)
+        {
+            source.Slice(i * updateRow, updateRow).CopyTo(output.AsSpan((i * stateRow) + ((int)offset * inner), updateRow));
+        }
+
+        return Value.FromTensor(Tensor.FromBytes(state.ElementType, output, state.Dimensions));
+    }
+
+    /// <inheritdoc/>
+    public IRType Visit(ITypeInferenceContext context, VariableUpdate target)
+    {
+        var state = context.CheckArgumentType<TensorType>(target, VariableUpdate.State);
+        var update = context.CheckArgumentType<TensorType>(target, VariableUpdate.Update);
+        _ = context.CheckArgumentType<TensorType>(target, VariableUpdate.Offset);
+        return Visit(target, state, update);
+    }
+
+    /// <inheritdoc/>
+    public Cost Visit(ICostEvaluateContext context, VariableUpdate target)
+    {
+        var update = context.GetArgumentType<TensorType>(target, VariableUpdate.Update);
+        return new()
+        {
+            [CostFactorNames.MemoryLoad] = CostUtility.GetMemoryAccess(update),
+            [CostFactorNames.MemoryStore] = CostUtility.GetMemoryAccess(update),
+        };
+    }
+
+    /// <inheritdoc/>
+    public Metric Visit(IMetricEvaluateContext context, VariableUpdate target)
+    {
+        var update = context.GetArgumentType<TensorType>(target, VariableUpdate.Update);
+        return new()
+        {
+            [MetricFactorNames.OffChipMemoryTraffic] = CostUtility.GetMemoryAccess(update) * 2,
+        };
+    }
+
+    private IRType Visit(VariableUpdate target, TensorType state, TensorType update)
+    {
+        if (state.DType != update.DType)
+        {
+            return new InvalidType($"The update of {update.DType} doesn't match the state of {state.DType}");
+        }
+
+        if (!state.Shape.IsFixed)
+        {
+            return new InvalidType("The shape of state must be fixed");
+        }
+
+        if (update.Shape.IsRanked)
+        {
+            if (update.Shape.Rank != state.Shape.Rank)
+            {
+                return new InvalidType("The rank of update doesn't match the state");
+            }
+
+            var axis = Util.PositiveIndex(target.Axis, state.Shape.Rank);
+            for (int i = 0; i < state.Shape.Rank; i++)
+            {
+                var dim = update.Shape[i];
+                if (dim.IsFixed && (i == axis ? dim.FixedValue > state.Shape[i].FixedValue : dim.FixedValue != state.Shape[i].FixedValue))
+                {
+                    return new InvalidType($"The update dim {i} doesn't fit the state");
+                }
+            }
+        }
+
+        return state;
+    }
+}
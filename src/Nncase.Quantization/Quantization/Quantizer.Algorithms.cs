@@ -4,6 +4,8 @@
 using System;
 using System.Collections.Generic;
 using System.Linq;
+using System.Numerics;
+using System.Runtime.InteropServices;
 using System.Text;
 using System.Threading.Tasks;
 
@@ -16,9 +18,34 @@ private static ValueRange<float> GetMinMax(Tensor<float> tensor)
         var buffer = tensor.Buffer.Span;
         var min = float.MaxValue;
         var max = float.MinValue;
+        int i = 0;
 
-        foreach (var value in buffer)
+        if (Vector.IsHardwareAccelerated)
         {
+            var vectors = MemoryMarshal.Cast<float, Vector<float>>(buffer);
+            var finiteLimit = new Vector<float>(float.MaxValue);
+            var vmin = new Vector<float>(min);
+            var vmax = new Vector<float>(max);
+            foreach (var value in vectors)
+            {
+                // NaN and infinities fail the comparison.
+                var finite = Vector.LessThanOrEqual(Vector.Abs(value), finiteLimit);
+                vmin = Vector.Min(vmin, Vector.ConditionalSelect(finite, value, vmin));
+                vmax = Vector.Max(vmax, Vector.ConditionalSelect(finite, value, vmax));
+            }
+
+            for (int lane = 0; lane < Vector<float>.Count; lane++)
+            {
+                min = Math.Min(min, vmin[lane]);
+                max = Math.Max(max, vmax[lane]);
+            }
+
+            i = vectors.Length * Vector<float>.Count;
+        }
+
+        for (; i < buffer.Length; i++)
+        {
+            var value = buffer[i];
             if (float.IsFinite(value))
             {
                 min = Math.Min(min, value);
@@ -29,6 +56,49 @@ private static ValueRange<float> GetMinMax(Tensor<float> tensor)
         return new ValueRange<float>(min, max);
     }
 
+    private static void AccumulateHistogram(ReadOnlySpan<float> buffer, ValueRange<float> range, float binInterval, int[] bins)
+    {
+        var maxIndex = (float)bins.Length - 1;
+        int i = 0;
+
+        if (Vector.IsHardwareAccelerated)
+        {
+            var vectors = MemoryMarshal.Cast<float, Vector<float>>(buffer);
+            var vmin = new Vector<float>(range.Min);
+            var vinterval = new Vector<float>(binInterval);
+            var vmaxIndex = new Vector<float>(maxIndex);
+            var skipped = new Vector<int>(-1);
+            foreach (var value in vectors)
+            {
+                // Min and Max turn NaN into a bound, so NaN lanes are masked out first.
+                var offsets = (value - vmin) / vinterval;
+                var indices = Vector.ConditionalSelect(
+                    Vector.Equals(offsets, offsets),
+                    Vector.ConvertToInt32(Vector.Min(Vector.Max(offsets, Vector<float>.Zero), vmaxIndex)),
+                    skipped);
+                for (int lane = 0; lane < Vector<int>.Count; lane++)
+                {
+                    var index = indices[lane];
+                    if (index >= 0)
+                    {
+                        bins[index]++;
+                    }
+                }
+            }
+
+            i = vectors.Length * Vector<float>.Count;
+        }
+
+        for (; i < buffer.Length; i++)
+        {
+            var offset = (buffer[i] - range.Min) / binInterval;
+            if (!float.IsNaN(offset))
+            {
+                bins[(int)Math.Clamp(offset, 0F, maxIndex)]++;
+            }
+        }
+    }
+
     private static List<float> Smooth(List<float> p, int boxPts = 512)
     {
         var ret = new List<float>(new float[p.Count]);
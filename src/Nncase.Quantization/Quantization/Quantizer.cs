@@ -2,6 +2,7 @@
 // Licensed under the Apache license. See LICENSE file in the project root for full license information.
 
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Linq;
 using System.Runtime.InteropServices;
@@ -325,34 +326,73 @@ public async Task RunAsync(RunPassContext options)
         _graph.Rebuild();
     }
 
-    private async Task RunForHistogramsAsync(ICalibrationDatasetProvider calibrationDataset, Action<IReadOnlyDictionary<ENode, Tensor>> func)
+    private Task<IReadOnlyCollection<TAccumulator>> RunForHistogramsAsync<TAccumulator>(ICalibrationDatasetProvider calibrationDataset, Func<TAccumulator> createAccumulator, Action<TAccumulator, IReadOnlyDictionary<ENode, Tensor>> accumulate)
     {
-        await foreach (var sample in calibrationDataset.Samples)
-        {
-            IReadOnlyDictionary<ENode, Tensor> childrenValues;
-            using (var dumpScope2 = new DumpScope("ep2"))
+        return RunCalibrationAsync(
+            calibrationDataset,
+            "ep2",
+            sample =>
             {
-                var childrenEvaluator = new CalibrationEvaluator(sample, _childrenOfRangeOfs);
+                using var childrenEvaluator = new CalibrationEvaluator(sample, _childrenOfRangeOfs);
                 var tmpChildrenValues = childrenEvaluator.Evaluate().ToList();
-                childrenValues = tmpChildrenValues.Zip(_rangeOfs).ToDictionary(pair => pair.Second, pair => pair.First.Value);
-            }
 
-            // values are children op range values(only two scalars for each value: Min and Max), childrenValues are children op tensor values.
-            func(childrenValues);
-            GC.Collect();
-        }
+                // values are children op range values(only two scalars for each value: Min and Max), childrenValues are children op tensor values.
+                return tmpChildrenValues.Zip(_rangeOfs).ToDictionary(pair => pair.Second, pair => pair.First.Value);
+            },
+            createAccumulator,
+            accumulate);
     }
 
-    private async Task RunPassAsync(ICalibrationDatasetProvider calibrationDataset, Action<IReadOnlyDictionary<ENode, Tensor>> func)
+    private Task<IReadOnlyCollection<TAccumulator>> RunPassAsync<TAccumulator>(ICalibrationDatasetProvider calibrationDataset, Func<TAccumulator> createAccumulator, Action<TAccumulator, IReadOnlyDictionary<ENode, Tensor>> accumulate)
     {
-        await foreach (var sample in calibrationDataset.Samples)
+        return RunCalibrationAsync(
+            calibrationDataset,
+            "ep1",
+            sample =>
+            {
+                using var evaluator = new CalibrationEvaluator(sample, _rangeOfs);
+                return evaluator.Evaluate();
+            },
+            createAccumulator,
+            accumulate);
+    }
+
+    /// <summary>
+    /// Evaluate the calibration samples concurrently.
+    /// Samples are pulled from the dataset as workers become free, so only the activations of the samples in flight are alive.
+    /// Each worker folds them into an accumulator of its own, all accumulators are returned to be merged by the caller.
+    /// </summary>
+    private async Task<IReadOnlyCollection<TAccumulator>> RunCalibrationAsync<TAccumulator>(ICalibrationDatasetProvider calibrationDataset, string dumpName, Func<IReadOnlyDictionary<Var, IValue>, IReadOnlyDictionary<ENode, Tensor>> evaluate, Func<TAccumulator> createAccumulator, Action<TAccumulator, IReadOnlyDictionary<ENode, Tensor>> accumulate)
+    {
+        var parallelism = _quantizeOptions.CalibrationParallelism > 0 ? _quantizeOptions.CalibrationParallelism : Environment.ProcessorCount;
+
+        // Dumps of concurrent samples would overwrite each other.
+        if (DumpScope.Current.IsEnabled(DumpFlags.Calibration))
         {
-            using var dumpScope = new DumpScope("ep1");
-            var evaluator = new CalibrationEvaluator(sample, _rangeOfs);
-            var values = evaluator.Evaluate();
-            func(values);
-            GC.Collect();
+            parallelism = 1;
         }
+
+        var accumulators = new ConcurrentBag<TAccumulator>();
+        var idleAccumulators = new ConcurrentBag<TAccumulator>();
+        var options = new ParallelOptions { MaxDegreeOfParallelism = parallelism };
+        await Parallel.ForEachAsync(calibrationDataset.Samples, options, (sample, token) =>
+        {
+            if (!idleAccumulators.TryTake(out var accumulator))
+            {
+                accumulator = createAccumulator();
+                accumulators.Add(accumulator);
+            }
+
+            using (var dumpScope = new DumpScope(dumpName))
+            {
+                accumulate(accumulator, evaluate(sample));
+            }
+
+            idleAccumulators.Add(accumulator);
+            return ValueTask.CompletedTask;
+        });
+
+        return accumulators;
     }
 
     private ValueRange<float> FixUpRange(ValueRange<float> range, bool symmetric = false)
@@ -386,25 +426,41 @@ private ValueRange<float> FixUpRange(ValueRange<float> range, bool symmetric = f
         return range;
     }
 
-    private async Task<IDictionary<ENode, ValueRange<float>>> GetRangesAsync(ICalibrationDatasetProvider calibrationDataset)
+    internal async Task<IDictionary<ENode, ValueRange<float>>> GetRangesAsync(ICalibrationDatasetProvider calibrationDataset)
     {
-        var ranges = new Dictionary<ENode, ValueRange<float>>(ReferenceEqualityComparer.Instance);
-        await RunPassAsync(calibrationDataset, (values) =>
+        static void UnionRange(Dictionary<ENode, ValueRange<float>> target, ENode key, ValueRange<float> range)
         {
-            foreach (var value in values)
+            if (target.TryGetValue(key, out var oldRange))
             {
-                var tensor = value.Value.Cast<float>();
-                var range = GetMinMax(tensor);
-                if (ranges.TryGetValue(value.Key, out var oldRange))
-                {
-                    ranges[value.Key] = oldRange.Union(range);
-                }
-                else
+                target[key] = oldRange.Union(range);
+            }
+            else
+            {
+                target.Add(key, range);
+            }
+        }
+
+        var localRanges = await RunPassAsync(
+            calibrationDataset,
+            () => new Dictionary<ENode, ValueRange<float>>(ReferenceEqualityComparer.Instance),
+            (local, values) =>
+            {
+                foreach (var value in values)
                 {
-                    ranges.Add(value.Key, range);
+                    var tensor = value.Value.Cast<float>();
+                    UnionRange(local, value.Key, GetMinMax(tensor));
                 }
+            });
+
+        var ranges = new Dictionary<ENode, ValueRange<float>>(ReferenceEqualityComparer.Instance);
+        foreach (var local in localRanges)
+        {
+            foreach (var (key, range) in local)
+            {
+                UnionRange(ranges, key, range);
             }
-        });
+        }
+
         return ranges;
     }
 
@@ -505,7 +561,7 @@ private void AssignDataTypeFromConfig(QuantScheme quantScheme)
         }
     }
 
-    private async Task<IDictionary<ENode, QuantizeHistogram<float>>> GetHistogramsAsync(ICalibrationDatasetProvider calibrationDataset, IDictionary<ENode, ValueRange<float>> ranges, int srcBinSize, int dstBinSize)
+    internal async Task<IDictionary<ENode, QuantizeHistogram<float>>> GetHistogramsAsync(ICalibrationDatasetProvider calibrationDataset, IDictionary<ENode, ValueRange<float>> ranges, int srcBinSize, int dstBinSize)
     {
         var histograms = new Dictionary<ENode, QuantizeHistogram<float>>(ReferenceEqualityComparer.Instance);
         foreach (var (key, value) in ranges)
@@ -514,25 +570,39 @@ private void AssignDataTypeFromConfig(QuantScheme quantScheme)
             histograms[key] = new QuantizeHistogram<float>(initSrcBin, initSrcBin);
         }
 
-        await RunForHistogramsAsync(calibrationDataset, childrenValues =>
-        {
-            foreach (var (key, value) in childrenValues)
+        var localBins = await RunForHistogramsAsync(
+            calibrationDataset,
+            () => new Dictionary<ENode, int[]>(ReferenceEqualityComparer.Instance),
+            (bins, childrenValues) =>
             {
-                var r = ranges[key].Max - ranges[key].Min;
-                var srcBinInterval = r / srcBinSize;
+                foreach (var (key, value) in childrenValues)
+                {
+                    var r = ranges[key].Max - ranges[key].Min;
+                    var srcBinInterval = r / srcBinSize;
+
+                    if (!bins.TryGetValue(key, out var srcBin))
+                    {
+                        srcBin = new int[srcBinSize];
+                        bins.Add(key, srcBin);
+                    }
+
+                    var childrenTensor = value.Cast<float>();
+                    AccumulateHistogram(childrenTensor.Buffer.Span, ranges[key], srcBinInterval, srcBin);
+                }
+            });
 
-                var childrenTensor = value.Cast<float>();
-                var childrenBuffer = childrenTensor.Buffer.Span;
-                var valueRange = ranges[key];
+        foreach (var bins in localBins)
+        {
+            foreach (var (key, srcBin) in bins)
+            {
                 var histogram = histograms[key];
-                foreach (var buf in childrenBuffer)
+                for (int i = 0; i < srcBin.Length; i++)
                 {
-                    var r_index = (buf - valueRange.Min) / srcBinInterval;
-                    var index = (int)Math.Clamp((float)r_index, 0F, (float)srcBinSize - 1);
-                    histogram.SrcBin[index]++;
+                    histogram.SrcBin[i] += srcBin[i];
                 }
             }
-        });
+        }
+
         return histograms;
     }
 
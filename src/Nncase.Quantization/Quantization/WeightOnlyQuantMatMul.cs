@@ -0,0 +1,103 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Linq;
+using Nncase.IR;
+using Nncase.Passes;
+using Nncase.PatternMatch;
+using static Nncase.IR.TypePatternUtility;
+using static Nncase.PatternMatch.F.Math;
+using static Nncase.PatternMatch.Utility;
+using static Nncase.Utilities.MetadataUtility;
+
+namespace Nncase.Quantization;
+
+/// <summary>
+/// Quantize the constant weights of float32 matmuls to int8 or int4 with per group scales,
+/// the activations stay in float32 and the weights are dequantized on the fly.
+/// </summary>
+public sealed class WeightOnlyQuantMatMul : RewriteRule<Pattern>
+{
+    /// <inheritdoc/>
+    public override Pattern Pattern { get; } = IsMatMul(
+        null,
+        "matmul",
+        IsWildcard("input") with { TypePattern = HasDataType(DataTypes.Float32) & HasRank(r => r >= 1, "rank >= 1") },
+        IsTensorConst("weights") with { TypePattern = HasDataType(DataTypes.Float32) & HasRank(2) });
+
+    /// <summary>
+    /// Quantize the float32 rhs [K, N] of a matmul symmetrically.
+    /// </summary>
+    /// <param name="rhs">Rhs weights.</param>
+    /// <param name="bits">Bits of the weights, 8 or 4.</param>
+    /// <param name="groupSize">Count of the weights along K sharing one scale.</param>
+    /// <returns>Weights [N, K] int8 or [N, ceil(K / 2)] packed int4, and scales [N, ceil(K / groupSize)].</returns>
+    public static (Tensor Weights, Tensor<float> Scales) QuantizeWeights(Tensor<float> rhs, int bits, int groupSize)
+    {
+        var k = rhs.Dimensions[0];
+        var n = rhs.Dimensions[1];
+        var rowBytes = bits == 4 ? (k + 1) / 2 : k;
+        var groups = (k + groupSize - 1) / groupSize;
+        var qMax = (1 << (bits - 1)) - 1;
+        var weights = new byte[n * rowBytes];
+        var scales = new float[n * groups];
+
+        Parallel.For(0, n, i =>
+        {
+            var data = rhs.Buffer.Span;
+            var row = weights.AsSpan(i * rowBytes, rowBytes);
+            for (int g = 0; g < groups; g++)
+            {
+                var begin = g * groupSize;
+                var end = Math.Min(begin + groupSize, k);
+                var maxAbs = 0f;
+                for (int j = begin; j < end; j++)
+                {
+                    maxAbs = Math.Max(maxAbs, Math.Abs(data[(j * n) + i]));
+                }
+
+                var scale = maxAbs / qMax;
+                scales[(i * groups) + g] = scale;
+                for (int j = begin; j < end; j++)
+                {
+                    var q = scale == 0 ? 0 : (int)Math.Clamp(MathF.Round(data[(j * n) + i] / scale), -qMax, qMax);
+                    if (bits == 8)
+                    {
+                        row[j] = (byte)(sbyte)q;
+                    }
+                    else
+                    {
+                        row[j / 2] |= (byte)((q & 0xF) << ((j & 1) * 4));
+                    }
+                }
+            }
+        });
+
+        var weightsType = bits == 8 ? DataTypes.Int8 : DataTypes.UInt8;
+        return (Tensor.FromBytes(weightsType, weights, new[] { n, rowBytes }), Tensor.From(scales, new[] { n, groups }));
+    }
+
+    /// <inheritdoc/>
+    public override Expr? GetReplace(IMatchResult result, RunPassContext options)
+    {
+        var quantizeOptions = CompileSession.CompileOptions.QuantizeOptions;
+        var bits = quantizeOptions.WeightOnlyQuantBits;
+        var groupSize = quantizeOptions.WeightOnlyQuantGroupSize;
+        if ((bits != 8 && bits != 4) || groupSize <= 0)
+        {
+            return null;
+        }
+
+        var matmul = (Call)result["matmul"];
+        var input = (Expr)result["input"];
+        var rhs = ((TensorConst)result["weights"]).Value.Cast<float>();
+        if (input.CheckedShape[^1] is { IsFixed: true } k && k.FixedValue != rhs.Dimensions[0])
+        {
+            return null;
+        }
+
+        var (weights, scales) = QuantizeWeights(rhs, bits, groupSize);
+        return IR.F.Math.WeightOnlyMatMul(input, weights, scales, bits, groupSize).InheritMetaData(matmul);
+    }
+}
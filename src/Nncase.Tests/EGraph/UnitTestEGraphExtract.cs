@@ -0,0 +1,53 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using Nncase.IR;
+using Nncase.Passes;
+using Nncase.Tests.TestFixture;
+using Xunit;
+
+namespace Nncase.Tests.EGraphTest;
+
+[AutoSetupTestMethod(InitSession = true)]
+public class UnitTestEGraphExtract : TestClassBase
+{
+    public static TheoryData<bool, bool> ExtractModes => new()
+    {
+        { true, false },
+        { false, false },
+        { true, true },
+    };
+
+    [Theory]
+    [MemberData(nameof(ExtractModes))]
+    public void TestExtractIndependentRegions(bool partition, bool greedyOnly)
+    {
+        CompileOptions.EGraphExtractOptions = new() { Partition = partition, GreedyOnly = greedyOnly, TimeLimit = 10 };
+
+        var x = new Var("x", new TensorType(DataTypes.Float32, new[] { 1, 8 }));
+        var z = new Var("z", new TensorType(DataTypes.Float32, new[] { 1, 8 }));
+        Expr pre = (x * 2.0f) + (z * 2.0f);
+        Assert.True(pre.InferenceType());
+
+        // two regions of choices joined by the fixed add, the x eclass is also in a cycle with x * 1.
+        var egraph = new EGraph();
+        var root = egraph.Add(pre);
+        egraph.Union(egraph.Add(x * 2.0f), egraph.Add(x + x));
+        egraph.Union(egraph.Add(z * 2.0f), egraph.Add(z + z));
+        egraph.Union(egraph.Add(x), egraph.Add(x * 1.0f));
+        egraph.Rebuild();
+
+        var post = egraph.Extract(root, null, Array.Empty<EGraphExtractConstrains>());
+        Assert.True(post.InferenceType());
+
+        var feeds = new Dictionary<Var, IValue>
+        {
+            { x, Value.FromTensor(Testing.Rand<float>(1, 8)) },
+            { z, Value.FromTensor(Testing.Rand<float>(1, 8)) },
+        };
+        Assert.Equal(pre.Evaluate(feeds).AsTensor().ToArray<float>(), post.Evaluate(feeds).AsTensor().ToArray<float>());
+    }
+}
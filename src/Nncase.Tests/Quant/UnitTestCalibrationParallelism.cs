@@ -0,0 +1,118 @@
+﻿// Copyright (c) Canaan Inc. All rights reserved.
+// Licensed under the Apache license. See LICENSE file in the project root for full license information.
+
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading.Tasks;
+using Nncase.Diagnostics;
+using Nncase.IR;
+using Nncase.Passes;
+using Nncase.Passes.Rules.Neutral;
+using Nncase.Quantization;
+using Nncase.Tests.TestFixture;
+using Xunit;
+
+namespace Nncase.Tests.QuantTest;
+
+[AutoSetupTestMethod(InitSession = true)]
+public class UnitTestCalibrationParallelism : TestClassBase
+{
+    [Fact]
+    public async Task TestSameRangesAndHistograms()
+    {
+        CompileOptions.QuantizeOptions.ModelQuantMode = ModelQuantMode.UsePTQ;
+        CompileOptions.QuantizeOptions.QuantType = DataTypes.UInt8;
+        CompileOptions.QuantizeOptions.WQuantType = DataTypes.UInt8;
+
+        // Calibration dumps force sequential evaluation.
+        CompileOptions.DumpFlags = DumpFlags.None;
+
+        var input = new Var("input", new TensorType(DataTypes.Float32, new[] { 1, 3, 16, 16 }));
+
+        var weightsValue = new List<float>();
+        for (int i = 0; i < 8 * 3 * 3 * 3; i++)
+        {
+            weightsValue.Add(((i * 1.0f / (8 * 3 * 3 * 3)) - 0.5f) * 2);
+        }
+
+        var weights = Tensor.From<float>(weightsValue.ToArray(), new[] { 8, 3, 3, 3 });
+        var bias = Tensor.From<float>(Enumerable.Range(0, 8).Select(i => i * 0.25f).ToArray(), new[] { 8 });
+        var stride = Tensor.From<int>(new[] { 1, 1 }, new[] { 2 });
+        var dilation = Tensor.From<int>(new[] { 1, 1 }, new[] { 2 });
+        var padding = new[,] { { 1, 1 }, { 1, 1 } };
+
+        var conv = IR.F.NN.Conv2D(input, weights, bias, stride, padding, dilation, PadMode.Constant, 1);
+        var output = IR.F.Math.Abs(conv);
+        var module = new IRModule(new Function("main", output, new Var[] { input }));
+
+        var pmgr = CompileSession.CreatePassManager("Passes");
+        pmgr.AddWithName<DataflowPass>("TargetInDependent").Configure(p =>
+        {
+            p.Add<AddRangeOfAndMarker>();
+        });
+        await pmgr.RunAsync(module);
+
+        var graph = new EGraph(((Function)module.Functions[0]).Body);
+        var quantizer = new Quantizer(graph, CompileOptions.QuantizeOptions);
+        var dataset = new ScaledCalibrationDatasetProvider(new Var[] { input });
+
+        CompileOptions.QuantizeOptions.CalibrationParallelism = 1;
+        var sequentialRanges = await quantizer.GetRangesAsync(dataset);
+        var sequentialHistograms = await quantizer.GetHistogramsAsync(dataset, sequentialRanges, 8192, 256);
+
+        CompileOptions.QuantizeOptions.CalibrationParallelism = 4;
+        var parallelRanges = await quantizer.GetRangesAsync(dataset);
+        var parallelHistograms = await quantizer.GetHistogramsAsync(dataset, sequentialRanges, 8192, 256);
+
+        Assert.NotEmpty(sequentialRanges);
+        Assert.Equal(sequentialRanges.Count, parallelRanges.Count);
+        foreach (var (key, range) in sequentialRanges)
+        {
+            Assert.Equal(range, parallelRanges[key]);
+        }
+
+        Assert.Equal(sequentialHistograms.Count, parallelHistograms.Count);
+        foreach (var (key, histogram) in sequentialHistograms)
+        {
+            Assert.Equal(histogram.SrcBin, parallelHistograms[key].SrcBin);
+        }
+
+        Assert.Contains(sequentialHistograms.Values, histogram => histogram.SrcBin.Sum() > 0);
+    }
+
+    /// <summary>
+    /// Samples which differ in scale and offset, so each sample widens the ranges.
+    /// </summary>
+    internal sealed class ScaledCalibrationDatasetProvider : ICalibrationDatasetProvider
+    {
+        public const int CountValue = 12;
+
+        public ScaledCalibrationDatasetProvider(IEnumerable<Var> vars)
+        {
+            Samples = Enumerable.Range(0, CountValue).Select(i =>
+            {
+                var values = new Dictionary<Var, IValue>();
+                foreach (var var in vars)
+                {
+                    CompilerServices.InferenceType(var);
+                    var shape = var.CheckedShape.Select(d => d.IsUnknown ? 1 : d.FixedValue).ToArray();
+                    var shapeSize = shape.Aggregate(1, (x, y) => x * y);
+
+                    var tmpValue = new float[shapeSize];
+                    for (int j = 0; j < shapeSize; j++)
+                    {
+                        tmpValue[j] = ((((j * 7) % shapeSize * 1.0f / shapeSize) - 0.5f) * (i + 1)) + (i * 0.1f);
+                    }
+
+                    values.Add(var, Value.FromTensor(Tensor.From<float>(tmpValue, shape)));
+                }
+
+                return values;
+            }).ToAsyncEnumerable();
+        }
+
+        public int? Count => CountValue;
+
+        public IAsyncEnumerable<IReadOnlyDictionary<Var, IValue>> Samples { get; }
+    }
+}
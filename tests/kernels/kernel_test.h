@@ -1186,6 +1186,26 @@ class KernelTest {
         return cArray;
     }
 
+    std::vector<float> GetFloatArray(const char *key) {
+        if (!_document[key].is_array()) {
+            throw std::runtime_error("type error! it should be array.");
+        }
+
+        const auto &array = _document[key];
+        size_t arraySize = array.size();
+        std::vector<float> cArray(arraySize);
+        for (size_t i = 0; i < arraySize; i++) {
+            if (array[i].is_number()) {
+                cArray[i] = array[i].get<float>();
+            } else {
+                std::cout << "Invalid JSON format. Expected float values in "
+                             "the array."
+                          << std::endl;
+            }
+        }
+        return cArray;
+    }
+
     static std::string GetFileNameFromMacro(const char *filePath) {
         std::string fullFilePath(filePath);
         size_t lastSlashIndex = fullFilePath.find_last_of("/\\");
@@ -0,0 +1,126 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel_test.h"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <nncase/kernels/stackvm/tensor_ops.h>
+#include <nncase/runtime/datatypes.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/runtime/simple_types.h>
+#include <nncase/runtime/stackvm/opcode.h>
+#include <ortki/operators.h>
+
+#define TEST_CASE_NAME "test_lp_normalization"
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace ortki;
+
+class LpNormalizationTest : public KernelTest,
+                    public ::testing::TestWithParam<std::tuple<int>> {
+  public:
+    void SetUp() override {
+        READY_SUBCASE()
+
+        auto l_shape = GetShapeArray("lhs_shape");
+        auto typecode = GetDataType("lhs_type");
+        auto value = GetNumber("axis_value");
+        p_value = GetNumber("p_value");
+
+        input =
+            hrt::create(typecode, l_shape, host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+        init_tensor(input);
+
+        axis_value = value > 0 ? value < (int64_t)l_shape.size() ? value : 0
+                     : -value <= (int64_t)l_shape.size() ? value
+                                                         : 0;
+    }
+
+    void TearDown() override { CLEAR_SUBCASE() }
+
+  protected:
+    runtime_tensor input;
+    int64_t axis_value;
+    int64_t p_value;
+};
+
+INSTANTIATE_TEST_SUITE_P(lp_normalization, LpNormalizationTest,
+                         testing::Combine(testing::Range(0, MAX_CASE_NUM)));
+
+TEST_P(LpNormalizationTest, lp_normalization) {
+    auto l_ort = runtime_tensor_2_ort_tensor(input);
+
+    // expected
+    auto output_ort = ortki_LpNormalization(l_ort, axis_value, p_value);
+    size_t size = 0;
+    void *ptr_ort = tensor_buffer(output_ort, &size);
+    dims_t shape(tensor_rank(output_ort));
+    tensor_shape(output_ort, reinterpret_cast<int64_t *>(shape.data()));
+    auto expected = hrt::create(input.datatype(), shape,
+                                {reinterpret_cast<gsl::byte *>(ptr_ort), size},
+                                true, host_runtime_tensor::pool_cpu_only)
+                        .expect("create tensor failed");
+
+    // actual
+    int64_t axis_ptr[] = {axis_value};
+    auto axis =
+        hrt::create(nncase::dt_int64, {1},
+                    {reinterpret_cast<gsl::byte *>(axis_ptr), sizeof(axis_ptr)},
+                    true, host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+    float p_ptr[] = {(float)p_value};
+    auto p = hrt::create(nncase::dt_float32, {1},
+                         {reinterpret_cast<gsl::byte *>(p_ptr), sizeof(p_ptr)},
+                         true, host_runtime_tensor::pool_cpu_only)
+                 .expect("create tensor failed");
+    auto output =
+        kernels::stackvm::lp_normalization(input.impl(), axis.impl(), p.impl())
+            .expect("lp_normalization failed");
+    runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+
+    bool result = is_same_tensor(expected, actual) ||
+                  cosine_similarity_tensor(expected, actual);
+
+    if (!result) {
+        std::cout << "actual ";
+        print_runtime_tensor(actual);
+        std::cout << "expected ";
+        print_runtime_tensor(expected);
+    }
+
+    // compare
+    EXPECT_TRUE(result);
+}
+
+int main(int argc, char *argv[]) {
+    READY_TEST_CASE_GENERATE()
+    FOR_LOOP(lhs_shape, i)
+    FOR_LOOP(lhs_type, j)
+    FOR_LOOP(axis_value, k)
+    FOR_LOOP(p_value, l)
+    SPLIT_ELEMENT(lhs_shape, i)
+    SPLIT_ELEMENT(lhs_type, j)
+    SPLIT_ELEMENT(axis_value, k)
+    SPLIT_ELEMENT(p_value, l)
+    WRITE_SUB_CASE()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
\ No newline at end of file
@@ -36,6 +36,7 @@ class LrnTest : public KernelTest,
 
         auto l_shape = GetShapeArray("lhs_shape");
         auto typecode = GetDataType("lhs_type");
+        size_value = GetNumber("size_value");
 
         input =
             hrt::create(typecode, l_shape, host_runtime_tensor::pool_cpu_only)
@@ -47,6 +48,7 @@ class LrnTest : public KernelTest,
 
   protected:
     runtime_tensor input;
+    int64_t size_value;
 };
 
 INSTANTIATE_TEST_SUITE_P(lrn, LrnTest,
@@ -57,7 +59,7 @@ TEST_P(LrnTest, lrn) {
     auto alpha_value = 0.22f;
     auto beta_value = 0.20f;
     auto bias_value = 0.75f;
-    auto output_size_value = 3L;
+    auto output_size_value = size_value;
 
     // expected
     auto output_ort = ortki_LRN(l_ort, alpha_value, beta_value, bias_value,
@@ -123,11 +125,14 @@ int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_shape, i)
     FOR_LOOP(lhs_type, j)
+    FOR_LOOP(size_value, k)
     SPLIT_ELEMENT(lhs_shape, i)
     SPLIT_ELEMENT(lhs_type, j)
+    SPLIT_ELEMENT(size_value, k)
     WRITE_SUB_CASE()
     FOR_LOOP_END()
     FOR_LOOP_END()
+    FOR_LOOP_END()
 
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
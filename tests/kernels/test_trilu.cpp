@@ -56,26 +56,28 @@ class TriluTest
 };
 
 INSTANTIATE_TEST_SUITE_P(trilu, TriluTest,
-                         testing::Combine(testing::Values(dt_uint8),
-                                          testing::Values(dims_t{4, 5}),
-                                          testing::Values(0),
-                                          testing::Values(1)));
+                         testing::Combine(testing::Values(dt_boolean,
+                                                          dt_float32,
+                                                          dt_int64),
+                                          testing::Values(dims_t{4, 5},
+                                                          dims_t{2, 3, 7, 9}),
+                                          testing::Values(0, -2, 3),
+                                          testing::Values(0, 1)));
 
 TEST_P(TriluTest, trilu) {
-    //    auto l_ort = runtime_tensor_2_ort_tensor(input);
-    //    auto k_ort = runtime_tensor_2_ort_tensor(k);
-    //
-    //    // expected
-    //    auto output_ort = ortki_Trilu(l_ort, k_ort, upper);
-    //    size_t size = 0;
-    //    void *ptr_ort = tensor_buffer(output_ort, &size);
-    //    dims_t shape(tensor_rank(output_ort));
-    //    tensor_shape(output_ort, reinterpret_cast<int64_t *>(shape.data()));
-    //    auto expected = hrt::create(input.datatype(), shape,
-    //                                {reinterpret_cast<gsl::byte *>(ptr_ort),
-    //                                size}, true,
-    //                                host_runtime_tensor::pool_cpu_only)
-    //                        .expect("create tensor failed");
+    auto l_ort = runtime_tensor_2_ort_tensor(input);
+    auto k_ort = runtime_tensor_2_ort_tensor(k);
+
+    // expected
+    auto output_ort = ortki_Trilu(l_ort, k_ort, upper);
+    size_t size = 0;
+    void *ptr_ort = tensor_buffer(output_ort, &size);
+    dims_t shape(tensor_rank(output_ort));
+    tensor_shape(output_ort, reinterpret_cast<int64_t *>(shape.data()));
+    auto expected = hrt::create(input.datatype(), shape,
+                                {reinterpret_cast<gsl::byte *>(ptr_ort), size},
+                                true, host_runtime_tensor::pool_cpu_only)
+                        .expect("create tensor failed");
 
     // actual
     int32_t upper_ptr[] = {upper};
@@ -89,18 +91,18 @@ TEST_P(TriluTest, trilu) {
                       .expect("trilu failed");
     runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
 
-    //    bool result = is_same_tensor(expected, actual) ||
-    //                  cosine_similarity_tensor(expected, actual);
-    //
-    //    if (!result) {
-    //        std::cout << "actual ";
-    //        print_runtime_tensor(actual);
-    //        std::cout << "expected ";
-    //        print_runtime_tensor(expected);
-    //    }
-    //
-    //    // compare
-    //    EXPECT_TRUE(result);
+    bool result = is_same_tensor(expected, actual) ||
+                  cosine_similarity_tensor(expected, actual);
+
+    if (!result) {
+        std::cout << "actual ";
+        print_runtime_tensor(actual);
+        std::cout << "expected ";
+        print_runtime_tensor(expected);
+    }
+
+    // compare
+    EXPECT_TRUE(result);
 }
 
 int main(int argc, char *argv[]) {
@@ -0,0 +1,159 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel_test.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <nncase/kernels/stackvm/tensor_ops.h>
+#include <nncase/runtime/datatypes.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/runtime/simple_types.h>
+#include <nncase/runtime/stackvm/opcode.h>
+#include <ortki/operators.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace ortki;
+
+#define TEST_CASE_NAME "test_variable_update"
+
+class VariableUpdateTest : public KernelTest,
+                           public ::testing::TestWithParam<std::tuple<int>> {
+  public:
+    void SetUp() override {
+        READY_SUBCASE()
+
+        auto typecode = GetDataType("lhs_type");
+        auto state_shape = GetShapeArray("lhs_shape");
+        axis = positive_index((int)GetNumber("axis"), state_shape.size());
+        start = GetNumber("offset");
+        auto update_shape = state_shape;
+        update_shape[axis] = (size_t)GetNumber("update_len");
+
+        state = hrt::create(typecode, state_shape,
+                            host_runtime_tensor::pool_cpu_only)
+                    .expect("create tensor failed");
+        init_tensor(state);
+
+        update = hrt::create(typecode, update_shape,
+                             host_runtime_tensor::pool_cpu_only)
+                     .expect("create tensor failed");
+        init_tensor(update);
+    }
+
+    void TearDown() override { CLEAR_SUBCASE() }
+
+  protected:
+    runtime_tensor make_offset(int64_t value) {
+        return hrt::create(dt_int64, {1},
+                           {reinterpret_cast<gsl::byte *>(&value),
+                            sizeof(value)},
+                           true, host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+    }
+
+    // Write every element of update into a copy of the state
+    runtime_tensor expected_state() {
+        dims_t shape(state.shape().begin(), state.shape().end());
+        auto expected =
+            hrt::create(state.datatype(), shape,
+                        host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+        state.copy_to(expected).expect("copy failed");
+
+        auto elem_bytes = get_bytes(state.datatype());
+        auto src_map = std::move(hrt::map(update, map_read).unwrap_or_throw());
+        auto dest_map =
+            std::move(hrt::map(expected, map_write).unwrap_or_throw());
+        auto src = src_map.buffer().data();
+        auto dest = dest_map.buffer().data();
+        auto update_shape = update.shape();
+        auto state_strides = expected.strides();
+        dims_t index(update_shape.size());
+        for (size_t i = 0; i < compute_size(update_shape); i++) {
+            auto linear = i;
+            for (size_t d = update_shape.size(); d-- > 0;) {
+                index[d] = linear % update_shape[d];
+                linear /= update_shape[d];
+            }
+            index[axis] += start;
+            std::memcpy(dest + offset(state_strides, index) * elem_bytes,
+                        src + i * elem_bytes, elem_bytes);
+        }
+        return expected;
+    }
+
+    runtime_tensor state;
+    runtime_tensor update;
+    size_t axis;
+    int64_t start;
+};
+
+INSTANTIATE_TEST_SUITE_P(variable_update, VariableUpdateTest,
+                         testing::Combine(testing::Range(0, MAX_CASE_NUM)));
+
+TEST_P(VariableUpdateTest, variable_update) {
+    // expected
+    auto expected = expected_state();
+
+    // actual, the state is updated in place
+    auto output = kernels::stackvm::variable_update(
+                      (int32_t)axis, state.impl(), update.impl(),
+                      make_offset(start).impl())
+                      .expect("variable_update failed");
+    runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+    EXPECT_EQ(actual.impl().get(), state.impl().get());
+
+    bool result = is_same_tensor(expected, actual);
+    if (!result) {
+        std::cout << "actual ";
+        print_runtime_tensor(actual);
+        std::cout << "expected ";
+        print_runtime_tensor(expected);
+    }
+
+    // compare
+    EXPECT_TRUE(result);
+
+    // out of the state
+    auto past_end = (int64_t)(state.shape()[axis] - update.shape()[axis] + 1);
+    EXPECT_TRUE(kernels::stackvm::variable_update(
+                    (int32_t)axis, state.impl(), update.impl(),
+                    make_offset(past_end).impl())
+                    .is_err());
+}
+
+int main(int argc, char *argv[]) {
+    READY_TEST_CASE_GENERATE()
+    FOR_LOOP(lhs_type, i)
+    FOR_LOOP(lhs_shape, j)
+    FOR_LOOP(axis, k)
+    FOR_LOOP(update_len, l)
+    FOR_LOOP(offset, m)
+    SPLIT_ELEMENT(lhs_type, i)
+    SPLIT_ELEMENT(lhs_shape, j)
+    SPLIT_ELEMENT(axis, k)
+    SPLIT_ELEMENT(update_len, l)
+    SPLIT_ELEMENT(offset, m)
+    WRITE_SUB_CASE()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
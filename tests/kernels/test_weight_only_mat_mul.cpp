@@ -0,0 +1,158 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel_test.h"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <nncase/kernels/stackvm/tensor_ops.h>
+#include <nncase/runtime/datatypes.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/runtime/simple_types.h>
+#include <nncase/runtime/stackvm/opcode.h>
+#include <ortki/operators.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace ortki;
+
+#define TEST_CASE_NAME "test_weight_only_mat_mul"
+
+class WeightOnlyMatMulTest : public KernelTest,
+                             public ::testing::TestWithParam<std::tuple<int>> {
+  public:
+    void SetUp() override {
+        READY_SUBCASE()
+
+        auto l_shape = GetShapeArray("lhs_shape");
+        out_channels = (size_t)GetNumber("out_channels");
+        bits = (int32_t)GetNumber("bits");
+        group_size = (int32_t)GetNumber("group_size");
+        k_size = l_shape.back();
+        groups = (k_size + group_size - 1) / group_size;
+
+        lhs = hrt::create(dt_float32, l_shape,
+                          host_runtime_tensor::pool_cpu_only)
+                  .expect("create tensor failed");
+        init_tensor(lhs);
+
+        auto w_type = bits == 8 ? dt_int8 : dt_uint8;
+        auto row_bytes = bits == 8 ? k_size : (k_size + 1) / 2;
+        weights = hrt::create(w_type, {out_channels, row_bytes},
+                              host_runtime_tensor::pool_cpu_only)
+                      .expect("create tensor failed");
+        init_tensor(weights);
+
+        scales = hrt::create(dt_float32, {out_channels, groups},
+                             host_runtime_tensor::pool_cpu_only)
+                     .expect("create tensor failed");
+        init_tensor(scales);
+    }
+
+    void TearDown() override { CLEAR_SUBCASE() }
+
+  protected:
+    // Dequantized weights as the [K, N] rhs of a matmul
+    runtime_tensor dequantize_weights() {
+        std::vector<float> rhs(k_size * out_channels);
+        for (size_t n = 0; n < out_channels; n++) {
+            for (size_t k = 0; k < k_size; k++) {
+                int32_t q;
+                if (bits == 8) {
+                    q = get<int8_t>(weights, dims_t{n, k});
+                } else {
+                    auto b = get<uint8_t>(weights, dims_t{n, k / 2});
+                    int32_t nibble = (k & 1) ? b >> 4 : b & 0xF;
+                    q = (nibble ^ 8) - 8;
+                }
+                rhs[k * out_channels + n] =
+                    q * get<float>(scales, dims_t{n, k / group_size});
+            }
+        }
+
+        return hrt::create(dt_float32, {k_size, out_channels},
+                           {reinterpret_cast<gsl::byte *>(rhs.data()),
+                            rhs.size() * sizeof(float)},
+                           true, host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+    }
+
+    runtime_tensor lhs;
+    runtime_tensor weights;
+    runtime_tensor scales;
+    size_t out_channels;
+    size_t k_size;
+    size_t groups;
+    int32_t bits;
+    int32_t group_size;
+};
+
+INSTANTIATE_TEST_SUITE_P(weight_only_mat_mul, WeightOnlyMatMulTest,
+                         testing::Combine(testing::Range(0, MAX_CASE_NUM)));
+
+TEST_P(WeightOnlyMatMulTest, weight_only_mat_mul) {
+    auto rhs = dequantize_weights();
+    auto l_ort = runtime_tensor_2_ort_tensor(lhs);
+    auto r_ort = runtime_tensor_2_ort_tensor(rhs);
+
+    // expected
+    auto output_ort = ortki_MatMul(l_ort, r_ort);
+    size_t size = 0;
+    void *ptr_ort = tensor_buffer(output_ort, &size);
+    dims_t shape(tensor_rank(output_ort));
+    tensor_shape(output_ort, reinterpret_cast<int64_t *>(shape.data()));
+    auto expected = hrt::create(dt_float32, shape,
+                                {reinterpret_cast<gsl::byte *>(ptr_ort), size},
+                                true, host_runtime_tensor::pool_cpu_only)
+                        .expect("create tensor failed");
+
+    // actual
+    auto output = kernels::stackvm::weight_only_mat_mul(
+                      bits, group_size, lhs.impl(), weights.impl(),
+                      scales.impl())
+                      .expect("weight_only_mat_mul failed");
+    runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+
+    bool result = cosine_similarity_tensor(expected, actual) ||
+                  is_same_tensor(expected, actual);
+
+    if (!result) {
+        std::cout << "actual ";
+        print_runtime_tensor(actual);
+        std::cout << "expected ";
+        print_runtime_tensor(expected);
+    }
+
+    // compare
+    EXPECT_TRUE(result);
+}
+
+int main(int argc, char *argv[]) {
+    READY_TEST_CASE_GENERATE()
+    FOR_LOOP(lhs_shape, i)
+    FOR_LOOP(out_channels, j)
+    FOR_LOOP(bits, k)
+    FOR_LOOP(group_size, l)
+    SPLIT_ELEMENT(lhs_shape, i)
+    SPLIT_ELEMENT(out_channels, j)
+    SPLIT_ELEMENT(bits, k)
+    SPLIT_ELEMENT(group_size, l)
+    WRITE_SUB_CASE()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+    FOR_LOOP_END()
+
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,410 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <cstring>
+#include <gtest/gtest.h>
+#include <nncase/runtime/interpreter.h>
+#include <nncase/runtime/model.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/runtime/stackvm/opcode.h>
+#include <nncase/runtime/stackvm/runtime_module.h>
+#include <nncase/runtime/type_serializer.h>
+#include <string>
+#include <vector>
+
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+
+namespace nncase {
+/** @brief Serialized type of a function parameter or return value */
+class type_sig {
+  public:
+    static type_sig tensor(typecode_t type, const dims_t &shape) {
+        type_sig sig;
+        sig.bytes_.push_back(type_sig_tensor);
+        sig.bytes_.push_back(type);
+        sig.bytes_.push_back(shape.empty() ? 0 : 1);
+        for (auto dim : shape) {
+            sig.bytes_.push_back(dim_fixed);
+            auto value = (uint32_t)dim;
+            auto bytes = reinterpret_cast<const uint8_t *>(&value);
+            sig.bytes_.insert(sig.bytes_.end(), bytes, bytes + sizeof(value));
+        }
+        if (!shape.empty())
+            sig.bytes_.push_back(type_sig_end);
+        return sig;
+    }
+
+    static type_sig tuple(const std::vector<type_sig> &fields) {
+        type_sig sig;
+        sig.bytes_.push_back(type_sig_tuple);
+        for (auto &field : fields)
+            sig.bytes_.insert(sig.bytes_.end(), field.bytes_.begin(),
+                              field.bytes_.end());
+        sig.bytes_.push_back(type_sig_end);
+        return sig;
+    }
+
+    const std::vector<uint8_t> &bytes() const noexcept { return bytes_; }
+
+  private:
+    std::vector<uint8_t> bytes_;
+};
+
+/** @brief Tensor stored in the .rdata section */
+struct const_tensor {
+    uint32_t data;
+    uint32_t dtype;
+    dims_t shape;
+};
+
+/** @brief Assembles the StackVM bytecode of one function
+ *
+ * Ops pop their operands in order, so operands are pushed last first.
+ */
+class stackvm_emitter {
+  public:
+    void ldnull() { op(opcode_t::LDNULL); }
+
+    void ldc_i4(int32_t value) {
+        op(opcode_t::LDC_I4);
+        write(value);
+    }
+
+    void ldarg(uint16_t index) {
+        op(opcode_t::LDARG);
+        write(index);
+    }
+
+    void ldlocal(uint16_t index) {
+        op(opcode_t::LDLOCAL);
+        write(index);
+    }
+
+    void stlocal(uint16_t index) {
+        op(opcode_t::STLOCAL);
+        write(index);
+    }
+
+    /** @brief Load a local for the last time, the codegen releases it */
+    void ldlocal_last(uint16_t index) {
+        ldlocal(index);
+        ldnull();
+        stlocal(index);
+    }
+
+    /** @brief Pack the count objects on top of the stack, the top one
+     * becomes the first field */
+    void ldtuple(int32_t count) {
+        ldc_i4(count);
+        op(opcode_t::LDTUPLE);
+    }
+
+    /** @brief Replace the tuple on top of the stack by its field */
+    void ldtuple_elem(int32_t index) {
+        ldc_i4(index);
+        op(opcode_t::LDTUPLE_ELEM);
+    }
+
+    void ldconst(const const_tensor &t) {
+        lea_gp(t.data);
+        auto strides = get_default_strides(t.shape);
+        ldshape(strides);
+        ldshape(t.shape);
+        lea_gp(t.dtype);
+        op(opcode_t::LDDATATYPE);
+        op(opcode_t::LDTENSOR);
+    }
+
+    void ret() { op(opcode_t::RET); }
+
+    void extcall(uint32_t module_id, uint32_t func_id, uint16_t args,
+                 bool is_prim_func) {
+        ldc_i4((int32_t)func_id);
+        ldc_i4((int32_t)module_id);
+        op(opcode_t::EXTCALL);
+        write(args);
+        write(is_prim_func);
+    }
+
+    void cuscall(const std::string &name, const std::vector<uint8_t> &fields,
+                 uint16_t args) {
+        op(opcode_t::CUSCALL);
+        write_string(name);
+        write((uint32_t)fields.size());
+        text_.insert(text_.end(), fields.begin(), fields.end());
+        write(args);
+    }
+
+    void binary(binary_op_t binary_op) {
+        tensor(tensor_function_t::binary);
+        write(binary_op);
+    }
+
+    void unary(unary_op_t unary_op) {
+        tensor(tensor_function_t::unary);
+        write(unary_op);
+    }
+
+    void concat(int32_t axis) {
+        tensor(tensor_function_t::concat);
+        write(axis);
+    }
+
+    void reshape() { tensor(tensor_function_t::reshape); }
+    void shape_of() { tensor(tensor_function_t::shape_of); }
+    void slice() { tensor(tensor_function_t::slice); }
+    void split() { tensor(tensor_function_t::split); }
+
+    void variable_read(const std::string &name, typecode_t type) {
+        tensor(tensor_function_t::variable_read);
+        write_string(name);
+        write(type);
+        write(false);
+    }
+
+    void variable_update(int32_t axis) {
+        tensor(tensor_function_t::variable_update);
+        write(axis);
+        write(false);
+    }
+
+    const std::vector<uint8_t> &text() const noexcept { return text_; }
+
+  private:
+    void op(opcode_t opcode) { write(opcode); }
+
+    void tensor(tensor_function_t func) {
+        op(opcode_t::TENSOR);
+        write(func);
+    }
+
+    void lea_gp(uint32_t offset) {
+        op(opcode_t::LEA_GP);
+        write((uint8_t)0);
+        write((int32_t)offset);
+    }
+
+    void ldshape(gsl::span<const size_t> shape) {
+        for (auto it = shape.rbegin(); it != shape.rend(); ++it)
+            ldc_i4((int32_t)*it);
+        ldc_i4((int32_t)shape.size());
+    }
+
+    template <class T> void write(const T &value) {
+        auto bytes = reinterpret_cast<const uint8_t *>(&value);
+        text_.insert(text_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void write_string(const std::string &value) {
+        text_.insert(text_.end(), value.begin(), value.end());
+        text_.push_back(0);
+    }
+
+    std::vector<uint8_t> text_;
+};
+
+/** @brief Builds a kmodel holding one StackVM module, the first function is
+ * the entry */
+class kmodel_builder {
+  public:
+    template <class T>
+    const_tensor add_const(typecode_t type, const dims_t &shape,
+                           const std::vector<T> &data) {
+        const_tensor t;
+        t.dtype = append_rdata(&type, sizeof(type), 1);
+        t.data = append_rdata(data.data(), data.size() * sizeof(T), 16);
+        t.shape = shape;
+        return t;
+    }
+
+    void add_state(const std::string &name, typecode_t type,
+                   const dims_t &shape) {
+        states_.insert(states_.end(), name.begin(), name.end());
+        states_.push_back(0);
+        states_.push_back(type);
+        append(states_, (uint32_t)shape.size());
+        for (auto dim : shape)
+            append(states_, (uint64_t)dim);
+        states_count_++;
+    }
+
+    /** @brief Add a function, returns its id */
+    uint32_t add_function(const std::vector<type_sig> &parameters,
+                          const type_sig &return_type,
+                          const stackvm_emitter &emitter) {
+        function f{(uint32_t)parameters.size(), text_.size(),
+                   emitter.text().size(), {}};
+        for (auto &param : parameters)
+            f.types.insert(f.types.end(), param.bytes().begin(),
+                           param.bytes().end());
+        f.types.insert(f.types.end(), return_type.bytes().begin(),
+                       return_type.bytes().end());
+        text_.insert(text_.end(), emitter.text().begin(),
+                     emitter.text().end());
+        functions_.emplace_back(std::move(f));
+        return (uint32_t)functions_.size() - 1;
+    }
+
+    std::vector<gsl::byte> build() const {
+        std::vector<uint8_t> model;
+        model_header header{MODEL_IDENTIFIER, MODEL_VERSION, 0, 8, 1, 0, 0, 0};
+        append(model, header);
+
+        auto module_start = model.size();
+        module_header mod{};
+        mod.kind = stackvm_module_kind;
+        mod.version = stackvm_module_version;
+        mod.sections = 4;
+        mod.functions = (uint32_t)functions_.size();
+        append(model, mod);
+
+        for (auto &f : functions_) {
+            function_header fh{};
+            fh.parameters = f.parameters;
+            fh.entrypoint = f.entrypoint;
+            fh.text_size = f.text_size;
+            fh.size = sizeof(fh) + f.types.size();
+            append(model, fh);
+            model.insert(model.end(), f.types.begin(), f.types.end());
+        }
+
+        std::vector<uint8_t> custom_calls;
+        append(custom_calls, (uint32_t)0);
+        std::vector<uint8_t> states;
+        append(states, states_count_);
+        states.insert(states.end(), states_.begin(), states_.end());
+        append_section(model, ".text", text_);
+        append_section(model, ".rdata", rdata_);
+        append_section(model, ".custom_calls", custom_calls);
+        append_section(model, ".states", states);
+
+        auto module_size = (uint64_t)(model.size() - module_start);
+        std::memcpy(model.data() + module_start +
+                        offsetof(module_header, size),
+                    &module_size, sizeof(module_size));
+        auto bytes = reinterpret_cast<const gsl::byte *>(model.data());
+        return {bytes, bytes + model.size()};
+    }
+
+  private:
+    struct function {
+        uint32_t parameters;
+        size_t entrypoint;
+        size_t text_size;
+        std::vector<uint8_t> types;
+    };
+
+    template <class T> static void append(std::vector<uint8_t> &v, const T &x) {
+        auto bytes = reinterpret_cast<const uint8_t *>(&x);
+        v.insert(v.end(), bytes, bytes + sizeof(T));
+    }
+
+    uint32_t append_rdata(const void *data, size_t bytes, size_t alignment) {
+        rdata_.resize((rdata_.size() + alignment - 1) / alignment * alignment);
+        auto offset = (uint32_t)rdata_.size();
+        auto src = reinterpret_cast<const uint8_t *>(data);
+        rdata_.insert(rdata_.end(), src, src + bytes);
+        return offset;
+    }
+
+    /** @brief Section bodies start 16 bytes aligned in the model */
+    static void append_section(std::vector<uint8_t> &model, const char *name,
+                               const std::vector<uint8_t> &body) {
+        section_header header{};
+        std::strncpy(header.name, name, sizeof(header.name));
+        auto body_pos = model.size() + sizeof(header);
+        header.body_start = (16 - body_pos % 16) % 16;
+        header.body_size = body.size();
+        header.memory_size = body.size();
+        header.size = sizeof(header) + header.body_start + body.size();
+        append(model, header);
+        model.resize(model.size() + header.body_start);
+        model.insert(model.end(), body.begin(), body.end());
+    }
+
+    std::vector<uint8_t> text_;
+    std::vector<uint8_t> rdata_;
+    std::vector<uint8_t> states_;
+    uint32_t states_count_ = 0;
+    std::vector<function> functions_;
+};
+
+class RuntimeTest : public ::testing::Test {
+  public:
+    template <class T>
+    static runtime_tensor make_tensor(typecode_t type, const dims_t &shape,
+                                      std::vector<T> data) {
+        auto bytes = gsl::as_writeable_bytes(gsl::make_span(data));
+        return hrt::create(type, shape, bytes, true).unwrap_or_throw();
+    }
+
+    template <class T> static std::vector<T> read(runtime_tensor t) {
+        if (!t.is_contiguous()) {
+            auto dense = hrt::create(t.datatype(),
+                                     dims_t(t.shape().begin(), t.shape().end()))
+                             .unwrap_or_throw();
+            t.copy_to(dense).unwrap_or_throw();
+            t = dense;
+        }
+        auto map = hrt::map(t, map_read).unwrap_or_throw();
+        auto data = map.buffer().as_span<const T>();
+        return {data.begin(), data.end()};
+    }
+
+    template <class T>
+    static void write(runtime_tensor t, const std::vector<T> &data) {
+        auto map = hrt::map(t, map_write).unwrap_or_throw();
+        std::copy(data.begin(), data.end(), map.buffer().as_span<T>().begin());
+    }
+
+    /** @brief Outputs of the last run of the entry function */
+    static std::vector<runtime_tensor> outputs(interpreter &interp) {
+        std::vector<runtime_tensor> tensors;
+        for (size_t i = 0; i < interp.outputs_size(); i++)
+            tensors.emplace_back(interp.output_tensor(i).unwrap_or_throw());
+        return tensors;
+    }
+
+    /** @brief Run the entry function, inputs and outputs are not kept by the
+     * interpreter so each run allocates its outputs */
+    static std::vector<runtime_tensor>
+    invoke(interpreter &interp, std::vector<runtime_tensor> inputs) {
+        std::vector<value_t> params;
+        for (auto &input : inputs)
+            params.emplace_back(input.impl());
+        auto func = interp.entry_function().unwrap_or_throw();
+        auto ret = func->invoke(params).unwrap_or_throw();
+        std::vector<runtime_tensor> tensors;
+        if (ret.is_a<nncase::tensor>()) {
+            tensors.emplace_back(ret.as<nncase::tensor>().unwrap());
+        } else {
+            for (auto &field : ret.as<nncase::tuple>().unwrap()->fields())
+                tensors.emplace_back(field.as<nncase::tensor>().unwrap());
+        }
+        return tensors;
+    }
+
+    void load(interpreter &interp, const kmodel_builder &builder) {
+        models_.emplace_back(builder.build());
+        interp.load_model(models_.back()).unwrap_or_throw();
+    }
+
+  private:
+    // The interpreter keeps pointers into the model it loaded.
+    std::vector<std::vector<gsl::byte>> models_;
+};
+} // namespace nncase
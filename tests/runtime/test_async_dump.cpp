@@ -0,0 +1,257 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+using namespace nncase;
+namespace fs = std::filesystem;
+
+#ifdef NNCASE_DUMP_MANAGER
+namespace {
+/** @brief A record of dump.bin, see dump_manager.h for the layout */
+struct dump_record {
+    uint64_t request;
+    uint32_t op_index;
+    uint8_t kind;
+    uint8_t typecode;
+    std::string name;
+    std::vector<uint64_t> shape;
+    std::vector<uint64_t> strides;
+    std::vector<float> data;
+};
+
+template <class T> T read_pod(std::ifstream &file) {
+    T value{};
+    file.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return value;
+}
+
+std::vector<dump_record> read_records(const fs::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[8];
+    file.read(magic, sizeof(magic));
+    EXPECT_EQ(std::string(magic, sizeof(magic)), "NNCDUMP1");
+
+    std::vector<dump_record> records;
+    while (file.peek() != EOF) {
+        dump_record r;
+        r.request = read_pod<uint64_t>(file);
+        r.op_index = read_pod<uint32_t>(file);
+        r.kind = read_pod<uint8_t>(file);
+        r.typecode = read_pod<uint8_t>(file);
+        auto name_bytes = read_pod<uint16_t>(file);
+        auto rank = read_pod<uint32_t>(file);
+        auto data_bytes = read_pod<uint64_t>(file);
+        r.name.resize(name_bytes);
+        file.read(r.name.data(), name_bytes);
+        r.shape.resize(rank);
+        r.strides.resize(rank);
+        file.read(reinterpret_cast<char *>(r.shape.data()), rank * 8);
+        file.read(reinterpret_cast<char *>(r.strides.data()), rank * 8);
+        r.data.resize(data_bytes / sizeof(float));
+        file.read(reinterpret_cast<char *>(r.data.data()), data_bytes);
+        if (!file)
+            break;
+        records.emplace_back(std::move(r));
+    }
+    return records;
+}
+} // namespace
+#endif
+
+class AsyncDumpTest : public RuntimeTest {
+  public:
+    /** @brief f(x, y) = (abs(x - y), x + y) */
+    void load(interpreter &interp) {
+        stackvm_emitter e;
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::add);
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::sub);
+        e.unary(unary_op_t::abs);
+        e.ldtuple(2);
+        e.ret();
+
+        kmodel_builder builder;
+        auto x = type_sig::tensor(dt_float32, shape);
+        builder.add_function({x, x}, type_sig::tuple({x, x}), e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> data(float base) {
+        std::vector<float> v(size);
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = base - (float)i;
+        return v;
+    }
+
+    std::vector<runtime_tensor> inputs(float base) {
+        return {make_tensor(dt_float32, shape, data(base)),
+                make_tensor(dt_float32, shape, data(2 * base))};
+    }
+
+    std::vector<std::vector<float>> expected(float base) {
+        auto x = data(base);
+        auto y = data(2 * base);
+        std::vector<std::vector<float>> ret(2, std::vector<float>(size));
+        for (size_t i = 0; i < size; i++) {
+            ret[0][i] = std::abs(x[i] - y[i]);
+            ret[1][i] = x[i] + y[i];
+        }
+        return ret;
+    }
+
+    void check(const std::vector<runtime_tensor> &outs, float base) {
+        auto want = expected(base);
+        ASSERT_EQ(outs.size(), want.size());
+        for (size_t i = 0; i < outs.size(); i++)
+            EXPECT_EQ(read<float>(outs[i]), want[i]) << "output " << i;
+    }
+
+  protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() /
+                ("nncase_" + std::string(::testing::UnitTest::GetInstance()
+                                             ->current_test_info()
+                                             ->name()));
+        fs::remove_all(root_);
+        fs::create_directories(root_);
+    }
+
+    void TearDown() override {
+        if (!root_.empty())
+            fs::remove_all(root_);
+    }
+
+#ifdef NNCASE_DUMP_MANAGER
+    /** @brief Send the dump of interp to a directory of its own */
+    std::shared_ptr<dump_manager> dumper(interpreter &interp,
+                                         const std::string &name) {
+        auto dm = interp.dump_manager();
+        fs::create_directories(root_ / name);
+        dm->set_dump_root((root_ / name).string());
+        return dm;
+    }
+#endif
+
+    const dims_t shape{2, 4};
+    const size_t size = 2 * 4;
+    fs::path root_;
+};
+
+#ifdef NNCASE_DUMP_MANAGER
+TEST_F(AsyncDumpTest, same_outputs_as_text_dump) {
+    interpreter text, async;
+    load(text);
+    load(async);
+    dumper(text, "text");
+    dumper(async, "async")->start_async({}).unwrap_or_throw();
+
+    std::vector<runtime_tensor> first;
+    for (float base : {1.f, -3.f, 5.f}) {
+        auto in = inputs(base);
+        auto got = invoke(async, in);
+        auto want = invoke(text, in);
+        check(got, base);
+        for (size_t i = 0; i < got.size(); i++)
+            EXPECT_EQ(read<float>(got[i]), read<float>(want[i]));
+        if (first.empty())
+            first = got;
+    }
+    check(first, 1);
+    async.dump_manager()->stop_async();
+    EXPECT_FALSE(read_records(root_ / "async" / "Runtime" / "dump.bin")
+                     .empty());
+}
+
+TEST_F(AsyncDumpTest, sampled_records) {
+    interpreter interp;
+    load(interp);
+    dump_async_options options;
+    options.ops = {"unary"};
+    options.request_interval = 2;
+    auto dm = dumper(interp, "async");
+    dm->start_async(options).unwrap_or_throw();
+    for (float base : {1.f, 2.f, 3.f})
+        check(invoke(interp, inputs(base)), base);
+    EXPECT_EQ(dm->dropped_records(), 0);
+    dm->stop_async();
+
+    auto records = read_records(root_ / "async" / "Runtime" / "dump.bin");
+    ASSERT_EQ(records.size(), 4);
+    const float bases[] = {1.f, 3.f};
+    for (size_t i = 0; i < records.size(); i++) {
+        auto &r = records[i];
+        auto base = bases[i / 2];
+        EXPECT_EQ(r.request, i / 2 * 2);
+        // add, sub, then abs
+        EXPECT_EQ(r.op_index, 3);
+        EXPECT_EQ(r.typecode, dt_float32);
+        EXPECT_EQ(r.shape, (std::vector<uint64_t>{2, 4}));
+        EXPECT_EQ(r.strides, (std::vector<uint64_t>{4, 1}));
+        if (i % 2 == 0) {
+            EXPECT_EQ(r.kind, 0);
+            EXPECT_EQ(r.name, "unary$input");
+            std::vector<float> diff(size);
+            auto x = data(base);
+            auto y = data(2 * base);
+            for (size_t j = 0; j < size; j++)
+                diff[j] = x[j] - y[j];
+            EXPECT_EQ(r.data, diff);
+        } else {
+            EXPECT_EQ(r.kind, 1);
+            EXPECT_EQ(r.name, "unary$out");
+            EXPECT_EQ(r.data, expected(base)[0]);
+        }
+    }
+}
+
+TEST_F(AsyncDumpTest, full_queue_drops_records) {
+    interpreter interp;
+    load(interp);
+    dump_async_options options;
+    options.max_queue_bytes = sizeof(float);
+    auto dm = dumper(interp, "async");
+    dm->start_async(options).unwrap_or_throw();
+    auto out1 = invoke(interp, inputs(4));
+    auto out2 = invoke(interp, inputs(-4));
+    check(out1, 4);
+    check(out2, -4);
+    EXPECT_GT(dm->dropped_records(), 0);
+    dm->stop_async();
+}
+
+TEST_F(AsyncDumpTest, caller_bound_outputs) {
+    interpreter interp;
+    load(interp);
+    dumper(interp, "async")->start_async({}).unwrap_or_throw();
+    for (float base : {2.f, 9.f, 2.f}) {
+        auto in = inputs(base);
+        for (size_t i = 0; i < in.size(); i++)
+            interp.input_tensor(i, in[i]).unwrap_or_throw();
+        interp.run().unwrap_or_throw();
+        check(outputs(interp), base);
+    }
+    interp.dump_manager()->stop_async();
+}
+#else
+TEST_F(AsyncDumpTest, not_built_in) {
+    GTEST_SKIP() << "the runtime is built without ENABLE_DUMP_MANAGER";
+}
+#endif
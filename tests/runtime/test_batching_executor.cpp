@@ -0,0 +1,152 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+#include <nncase/runtime/batching_executor.h>
+
+using namespace nncase;
+using namespace std::chrono_literals;
+
+class BatchingExecutorTest : public RuntimeTest {
+  public:
+    /** @brief f(x, y) = (x + y, x * y) on a bucket of 4 rows */
+    void load(interpreter &interp) {
+        stackvm_emitter e;
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::mul);
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::add);
+        e.ldtuple(2);
+        e.ret();
+
+        kmodel_builder builder;
+        auto x = type_sig::tensor(dt_float32, {bucket, cols});
+        builder.add_function({x, x}, type_sig::tuple({x, x}), e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> data(size_t rows, float base) {
+        std::vector<float> v(rows * cols);
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = base + i;
+        return v;
+    }
+
+    std::vector<runtime_tensor> request(size_t rows, float base) {
+        return {make_tensor(dt_float32, {rows, cols}, data(rows, base)),
+                make_tensor(dt_float32, {rows, cols}, data(rows, 1))};
+    }
+
+    /** @brief Outputs of a request run alone on the bucket, the unused rows
+     * are zero like the ones the executor pads with */
+    std::vector<std::vector<float>> unbatched(size_t rows, float base) {
+        auto x = data(rows, base);
+        auto y = data(rows, 1);
+        x.resize(bucket * cols);
+        y.resize(bucket * cols);
+        auto outs =
+            invoke(reference_, {make_tensor(dt_float32, {bucket, cols}, x),
+                                make_tensor(dt_float32, {bucket, cols}, y)});
+        std::vector<std::vector<float>> ret;
+        for (auto &out : outs) {
+            auto v = read<float>(out);
+            v.resize(rows * cols);
+            ret.emplace_back(std::move(v));
+        }
+        return ret;
+    }
+
+    void check(const batching_executor::outputs_t &outs, size_t rows,
+               float base) {
+        ASSERT_EQ(outs.size(), 2);
+        auto want = unbatched(rows, base);
+        auto x = data(rows, base);
+        auto y = data(rows, 1);
+        for (size_t i = 0; i < x.size(); i++) {
+            EXPECT_EQ(want[0][i], x[i] + y[i]);
+            EXPECT_EQ(want[1][i], x[i] * y[i]);
+        }
+        for (size_t i = 0; i < 2; i++) {
+            EXPECT_EQ(outs[i].shape()[0], rows);
+            EXPECT_EQ(read<float>(outs[i]), want[i]);
+        }
+    }
+
+  protected:
+    void SetUp() override { load(reference_); }
+
+    static constexpr size_t bucket = 4;
+    static constexpr size_t cols = 3;
+    interpreter reference_;
+};
+
+TEST_F(BatchingExecutorTest, full_bucket) {
+    interpreter interp;
+    load(interp);
+    batching_options options;
+    options.max_latency = 10s;
+    auto executor =
+        batching_executor::create(interp, options).unwrap_or_throw();
+    ASSERT_EQ(executor->max_batch_size(), bucket);
+
+    // The bucket fills up, so the latency budget is never waited for
+    std::vector<std::future<result<batching_executor::outputs_t>>> futures;
+    for (size_t i = 0; i < bucket; i++)
+        futures.emplace_back(executor->submit(request(1, i * 10.f)));
+    for (size_t i = 0; i < bucket; i++)
+        check(futures[i].get().unwrap_or_throw(), 1, i * 10.f);
+}
+
+TEST_F(BatchingExecutorTest, mixed_request_sizes) {
+    interpreter interp;
+    load(interp);
+    batching_options options;
+    options.max_latency = 0us;
+    auto executor =
+        batching_executor::create(interp, options).unwrap_or_throw();
+
+    const size_t rows[] = {1, 3, 2, 4, 1};
+    std::vector<std::future<result<batching_executor::outputs_t>>> futures;
+    for (size_t i = 0; i < std::size(rows); i++)
+        futures.emplace_back(executor->submit(request(rows[i], i * 7.f)));
+    for (size_t i = 0; i < std::size(rows); i++)
+        check(futures[i].get().unwrap_or_throw(), rows[i], i * 7.f);
+}
+
+TEST_F(BatchingExecutorTest, outputs_survive_later_batches) {
+    interpreter interp;
+    load(interp);
+    batching_options options;
+    options.max_latency = 0us;
+    auto executor =
+        batching_executor::create(interp, options).unwrap_or_throw();
+
+    auto first = executor->submit(request(2, 1)).get().unwrap_or_throw();
+    auto second = executor->submit(request(2, 50)).get().unwrap_or_throw();
+    check(first, 2, 1);
+    check(second, 2, 50);
+}
+
+TEST_F(BatchingExecutorTest, invalid_requests) {
+    interpreter interp;
+    load(interp);
+    auto executor = batching_executor::create(interp).unwrap_or_throw();
+    EXPECT_TRUE(executor->submit(request(bucket + 1, 0)).get().is_err());
+    auto wide = make_tensor(dt_float32, {1, cols + 1},
+                            std::vector<float>(cols + 1));
+    auto x = make_tensor(dt_float32, {1, cols}, data(1, 0));
+    EXPECT_TRUE(executor->submit({wide, x}).get().is_err());
+}
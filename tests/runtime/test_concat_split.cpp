@@ -0,0 +1,347 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+#include <cmath>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+
+class ConcatSplitTest : public RuntimeTest {
+  public:
+    void options(interpreter &interp, uint32_t capacity, uint32_t threads) {
+        interp.options()
+            .set(stackvm_plan_cache_capacity_option, scalar(capacity))
+            .unwrap_or_throw();
+        interp.options()
+            .set(stackvm_dataflow_threads_option, scalar(threads))
+            .unwrap_or_throw();
+    }
+
+    /** @brief f(x, y) = (c, concat([c, x - y], 0), concat([x, y], 1)) with
+     * c = concat([x + y, abs(x * y)], 0). c is an output and the input of
+     * an enclosing concat, the last concat has outer dims. */
+    void load_concat(interpreter &interp, uint32_t capacity,
+                     uint32_t threads = 0) {
+        options(interp, capacity, threads);
+        stackvm_emitter e;
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::mul);
+        e.unary(unary_op_t::abs);
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::add);
+        e.ldtuple(2);
+        e.concat(0);
+        e.stlocal(0);
+
+        e.ldarg(1);
+        e.ldarg(0);
+        e.ldtuple(2);
+        e.concat(1);
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::sub);
+        e.ldlocal(0);
+        e.ldtuple(2);
+        e.concat(0);
+        e.ldlocal(0);
+        e.ldtuple(3);
+        e.ret();
+
+        kmodel_builder builder;
+        auto x = type_sig::tensor(dt_float32, shape);
+        builder.add_function(
+            {x, x},
+            type_sig::tuple({type_sig::tensor(dt_float32, {4, cols}),
+                             type_sig::tensor(dt_float32, {6, cols}),
+                             type_sig::tensor(dt_float32, {2, 2 * cols})}),
+            e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    /** @brief f(x) = (s0, s1, abs(s1)) with s0, s1 = split(x, axis, [1, 1])
+     * for x of [2, cols], the sections along axis 0 are views of x */
+    void load_split(interpreter &interp, int64_t axis, uint32_t capacity = 16) {
+        options(interp, capacity, 0);
+        kmodel_builder builder;
+        auto axis_const = builder.add_const(dt_int64, {},
+                                            std::vector<int64_t>{axis});
+        auto sections = builder.add_const(
+            dt_int64, {2},
+            std::vector<int64_t>{1, axis ? (int64_t)cols - 1 : 1});
+
+        stackvm_emitter e;
+        e.ldconst(sections);
+        e.ldconst(axis_const);
+        e.ldarg(0);
+        e.split();
+        e.stlocal(0);
+        e.ldlocal(0);
+        e.ldtuple_elem(1);
+        e.unary(unary_op_t::abs);
+        e.ldlocal(0);
+        e.ldtuple_elem(1);
+        e.ldlocal(0);
+        e.ldtuple_elem(0);
+        e.ldtuple(3);
+        e.ret();
+
+        auto s1_shape = axis ? dims_t{2, cols - 1} : dims_t{1, cols};
+        auto s0 = type_sig::tensor(dt_float32, axis ? dims_t{2, 1}
+                                                    : dims_t{1, cols});
+        auto s1 = type_sig::tensor(dt_float32, s1_shape);
+        builder.add_function({type_sig::tensor(dt_float32, shape)},
+                             type_sig::tuple({s0, s1, s1}), e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> data(float base) {
+        std::vector<float> v(size);
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = base + (float)(i % 5) - 2;
+        return v;
+    }
+
+    /** @brief Rows of [rows, cols] tensors joined along axis 0 or 1 */
+    static std::vector<float> join(const std::vector<float> &a,
+                                   const std::vector<float> &b, int axis) {
+        std::vector<float> ret(a);
+        if (axis == 0) {
+            ret.insert(ret.end(), b.begin(), b.end());
+            return ret;
+        }
+        ret.clear();
+        auto a_cols = a.size() / 2;
+        auto b_cols = b.size() / 2;
+        for (size_t r = 0; r < 2; r++) {
+            ret.insert(ret.end(), a.begin() + r * a_cols,
+                       a.begin() + (r + 1) * a_cols);
+            ret.insert(ret.end(), b.begin() + r * b_cols,
+                       b.begin() + (r + 1) * b_cols);
+        }
+        return ret;
+    }
+
+    std::vector<std::vector<float>> concat_expected(float x_base,
+                                                    float y_base) {
+        auto x = data(x_base);
+        auto y = data(y_base);
+        std::vector<float> sum(size), prod(size), diff(size);
+        for (size_t i = 0; i < size; i++) {
+            sum[i] = x[i] + y[i];
+            prod[i] = std::abs(x[i] * y[i]);
+            diff[i] = x[i] - y[i];
+        }
+        auto c = join(sum, prod, 0);
+        return {c, join(c, diff, 0), join(x, y, 1)};
+    }
+
+    std::vector<std::vector<float>> split_expected(float base, int axis) {
+        auto x = data(base);
+        std::vector<float> s0, s1;
+        for (size_t i = 0; i < size; i++) {
+            auto first = axis ? i % cols == 0 : i < cols;
+            (first ? s0 : s1).push_back(x[i]);
+        }
+        std::vector<float> abs1(s1);
+        for (auto &e : abs1)
+            e = std::abs(e);
+        return {s0, s1, abs1};
+    }
+
+    static void check(const std::vector<runtime_tensor> &outs,
+                      const std::vector<std::vector<float>> &want) {
+        ASSERT_EQ(outs.size(), want.size());
+        for (size_t i = 0; i < outs.size(); i++)
+            EXPECT_EQ(read<float>(outs[i]), want[i]) << "output " << i;
+    }
+
+    /** @brief Plans off, plans on, plans on with dataflow */
+    const std::pair<uint32_t, uint32_t> configs[3]{{0, 0}, {16, 0}, {16, 4}};
+    static constexpr size_t cols = 4;
+    const dims_t shape{2, cols};
+    const size_t size = 2 * cols;
+};
+
+TEST_F(ConcatSplitTest, concat_outputs_of_earlier_runs_are_kept) {
+    for (auto [capacity, threads] : configs) {
+        interpreter interp;
+        load_concat(interp, capacity, threads);
+        std::vector<std::vector<runtime_tensor>> outs;
+        const float bases[] = {1, -3, 1, 6};
+        for (auto base : bases) {
+            outs.emplace_back(
+                invoke(interp, {make_tensor(dt_float32, shape, data(base)),
+                                make_tensor(dt_float32, shape, data(2))}));
+        }
+        for (size_t run = 0; run < outs.size(); run++)
+            check(outs[run], concat_expected(bases[run], 2));
+    }
+}
+
+TEST_F(ConcatSplitTest, concat_caller_bound_outputs) {
+    for (auto [capacity, threads] : configs) {
+        interpreter interp;
+        load_concat(interp, capacity, threads);
+        for (float base : {2.f, -1.f, 2.f}) {
+            interp.input_tensor(0, make_tensor(dt_float32, shape, data(base)))
+                .unwrap_or_throw();
+            interp.input_tensor(1, make_tensor(dt_float32, shape, data(-2)))
+                .unwrap_or_throw();
+            interp.run().unwrap_or_throw();
+            check(outputs(interp), concat_expected(base, -2));
+        }
+    }
+}
+
+TEST_F(ConcatSplitTest, concat_output_bound_over_its_input) {
+    for (auto [capacity, threads] : configs) {
+        interpreter interp;
+        load_concat(interp, capacity, threads);
+        auto func = interp.entry_function().unwrap_or_throw();
+        for (float base : {0.f, 5.f, 0.f}) {
+            // x is a view of the start of the tensor the last output, which
+            // concats x, is bound to
+            auto joined = make_tensor(dt_float32, {2, 2 * cols},
+                                      std::vector<float>(2 * size));
+            auto x = tensor_view(joined.impl(), shape, 0);
+            write(runtime_tensor(x), data(base));
+            auto c = hrt::create(dt_float32, {4, cols}).unwrap_or_throw();
+            auto enclosing =
+                hrt::create(dt_float32, {6, cols}).unwrap_or_throw();
+            std::vector<value_t> params{
+                x, make_tensor(dt_float32, shape, data(1)).impl()};
+            value_t return_value = tuple(
+                std::in_place, std::vector<value_t>{c.impl(), enclosing.impl(),
+                                                    joined.impl()});
+            func->invoke(params, return_value).unwrap_or_throw();
+            check({c, enclosing, joined}, concat_expected(base, 1));
+        }
+    }
+}
+
+TEST_F(ConcatSplitTest, split_same_outputs_as_copies) {
+    for (int64_t axis : {0, 1}) {
+        interpreter interp;
+        load_split(interp, axis);
+        std::vector<std::vector<runtime_tensor>> outs;
+        const float bases[] = {1, 4, 1};
+        for (auto base : bases) {
+            outs.emplace_back(invoke(
+                interp, {make_tensor(dt_float32, shape, data(base))}));
+        }
+        for (size_t run = 0; run < outs.size(); run++)
+            check(outs[run], split_expected(bases[run], (int)axis));
+    }
+}
+
+TEST_F(ConcatSplitTest, split_outputs_fed_back_as_input) {
+    for (uint32_t capacity : {0, 16}) {
+        interpreter interp;
+        load_split(interp, 0, capacity);
+        // Output 0 and the input are [1, cols] and [2, cols], so feed a
+        // tensor holding both rows of the previous output 1 and 2
+        auto x = make_tensor(dt_float32, shape, data(3));
+        auto want = split_expected(3, 0);
+        for (size_t run = 0; run < 3; run++) {
+            interp.input_tensor(0, x).unwrap_or_throw();
+            interp.run().unwrap_or_throw();
+            auto outs = outputs(interp);
+            check(outs, want);
+
+            auto next = join(read<float>(outs[1]), read<float>(outs[2]), 0);
+            x = make_tensor(dt_float32, shape, next);
+            want = {std::vector<float>(next.begin(), next.begin() + cols),
+                    std::vector<float>(next.begin() + cols, next.end()),
+                    std::vector<float>(next.begin() + cols, next.end())};
+            for (auto &e : want[2])
+                e = std::abs(e);
+        }
+    }
+}
+
+TEST_F(ConcatSplitTest, split_views_bound_to_their_input) {
+    for (uint32_t capacity : {0, 16}) {
+        interpreter interp;
+        load_split(interp, 0, capacity);
+        auto func = interp.entry_function().unwrap_or_throw();
+        for (float base : {-2.f, 7.f, -2.f}) {
+            // The sections are views of x and are bound to its other row,
+            // which swaps the rows of x
+            auto x = make_tensor(dt_float32, shape, data(base));
+            auto row = [&](size_t index) {
+                dims_t row_shape{1, cols};
+                return tensor_view(x.impl(), row_shape,
+                                   index * cols * sizeof(float));
+            };
+            auto abs1 = hrt::create(dt_float32, {1, cols}).unwrap_or_throw();
+            std::vector<value_t> params{x.impl()};
+            value_t return_value = tuple(
+                std::in_place,
+                std::vector<value_t>{row(1), row(0), abs1.impl()});
+            func->invoke(params, return_value).unwrap_or_throw();
+
+            auto want = split_expected(base, 0);
+            EXPECT_EQ(read<float>(x), join(want[1], want[0], 0));
+            EXPECT_EQ(read<float>(abs1), want[2]);
+        }
+    }
+}
+
+TEST_F(ConcatSplitTest, concat_of_data_dependent_shapes) {
+    for (auto [capacity, threads] : configs) {
+        interpreter interp;
+        options(interp, capacity, threads);
+
+        // f(x, s) = concat([abs(r), r + r], 0) with r = reshape(x, s), the
+        // shapes of the concat inputs depend on the values of s
+        stackvm_emitter e;
+        e.ldarg(1);
+        e.ldarg(0);
+        e.reshape();
+        e.stlocal(0);
+        e.ldlocal(0);
+        e.ldlocal(0);
+        e.binary(binary_op_t::add);
+        e.ldlocal(0);
+        e.unary(unary_op_t::abs);
+        e.ldtuple(2);
+        e.concat(0);
+        e.ret();
+
+        kmodel_builder builder;
+        builder.add_function({type_sig::tensor(dt_float32, shape),
+                              type_sig::tensor(dt_int64, {2})},
+                             type_sig::tensor(dt_float32, {4, cols}), e);
+        RuntimeTest::load(interp, builder);
+        for (int64_t rows : {2, 4, 2, 1}) {
+            auto x = data(-1);
+            auto s = std::vector<int64_t>{rows, (int64_t)size / rows};
+            auto out = invoke(interp, {make_tensor(dt_float32, shape, x),
+                                       make_tensor(dt_int64, {2}, s)});
+            ASSERT_EQ(out.size(), 1);
+            EXPECT_EQ(out[0].shape()[0], 2 * rows);
+            EXPECT_EQ(out[0].shape()[1], s[1]);
+
+            std::vector<float> want(x);
+            for (auto &v : want)
+                v = std::abs(v);
+            for (auto v : x)
+                want.push_back(v + v);
+            EXPECT_EQ(read<float>(out[0]), want) << "rows " << rows;
+        }
+    }
+}
@@ -0,0 +1,264 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+#include <algorithm>
+#include <cerrno>
+#include <nncase/runtime/custom_call.h>
+
+using namespace nncase;
+
+namespace {
+size_t elements(const nncase_tensor_view_t &view) {
+    size_t size = 1;
+    for (uint32_t i = 0; i < view.rank; i++)
+        size *= view.shape[i];
+    return size;
+}
+
+struct binary_args {
+    binary_op_t op;
+    const float *x;
+    const float *y;
+    float *out;
+};
+
+/** @brief out = x op y, op is the field. x is staged through scratch memory
+ * and the elements are spread over the kernel threads */
+int binary_kernel(nncase_custom_call_context_t *ctx, const void *fields,
+                  size_t fields_bytes, const nncase_tensor_view_t *args,
+                  size_t args_count) {
+    if (fields_bytes != sizeof(binary_op_t) || args_count != 2 ||
+        args[0].typecode != dt_float32)
+        return -EINVAL;
+
+    auto size = elements(args[0]);
+    auto x = static_cast<float *>(
+        ctx->scratch_alloc(ctx, size * sizeof(float), 64));
+    if (!x || reinterpret_cast<uintptr_t>(x) % 64)
+        return -ENOMEM;
+    std::copy_n(static_cast<const float *>(args[0].data), size, x);
+
+    nncase_tensor_view_t out;
+    if (ctx->alloc_output(ctx, dt_float32, args[0].rank, args[0].shape,
+                          &out))
+        return -ENOMEM;
+
+    binary_args body{*static_cast<const binary_op_t *>(fields), x,
+                     static_cast<const float *>(args[1].data),
+                     static_cast<float *>(out.data)};
+    ctx->parallel_for(
+        ctx, size,
+        [](void *user_data, size_t i) {
+            auto &a = *static_cast<binary_args *>(user_data);
+            a.out[i] = a.op == binary_op_t::add ? a.x[i] + a.y[i]
+                                                : a.x[i] * a.y[i];
+        },
+        &body);
+    return 0;
+}
+
+/** @brief (min(x, y), max(x, y)), two outputs come back as a tuple */
+int min_max_kernel(nncase_custom_call_context_t *ctx,
+                   [[maybe_unused]] const void *fields,
+                   [[maybe_unused]] size_t fields_bytes,
+                   const nncase_tensor_view_t *args, size_t args_count) {
+    if (args_count != 2)
+        return -EINVAL;
+    nncase_tensor_view_t min, max;
+    if (ctx->alloc_output(ctx, dt_float32, args[0].rank, args[0].shape,
+                          &min) ||
+        ctx->alloc_output(ctx, dt_float32, args[0].rank, args[0].shape, &max))
+        return -ENOMEM;
+
+    auto x = static_cast<const float *>(args[0].data);
+    auto y = static_cast<const float *>(args[1].data);
+    for (size_t i = 0; i < elements(args[0]); i++) {
+        static_cast<float *>(min.data)[i] = std::min(x[i], y[i]);
+        static_cast<float *>(max.data)[i] = std::max(x[i], y[i]);
+    }
+    return 0;
+}
+
+int no_output_kernel(nncase_custom_call_context_t *, const void *, size_t,
+                     const nncase_tensor_view_t *, size_t) {
+    return 0;
+}
+
+int failing_kernel(nncase_custom_call_context_t *, const void *, size_t,
+                   const nncase_tensor_view_t *, size_t) {
+    return -EINVAL;
+}
+} // namespace
+
+class CustomCallTest : public RuntimeTest {
+  public:
+    static void SetUpTestSuite() {
+        for (auto [name, fn] :
+             {std::pair{"test.binary", binary_kernel},
+              {"test.min_max", min_max_kernel},
+              {"test.no_output", no_output_kernel},
+              {"test.failing", failing_kernel}}) {
+            auto ret = nncase_register_custom_call(
+                NNCASE_CUSTOM_CALL_ABI_VERSION, name, fn);
+            ASSERT_TRUE(ret == 0 || ret == -EEXIST);
+        }
+    }
+
+    static std::vector<uint8_t> fields(binary_op_t op) {
+        return {(uint8_t)op};
+    }
+
+    /** @brief f(x, y) = (x + y, x * y, min(x, y), max(x, y)), the binary
+     * ops run as custom calls or as built-in ops */
+    void load(interpreter &interp, bool custom) {
+        stackvm_emitter e;
+        if (custom) {
+            e.ldarg(1);
+            e.ldarg(0);
+            e.cuscall("test.min_max", {}, 2);
+            e.stlocal(0);
+            e.ldlocal(0);
+            e.ldtuple_elem(1);
+            e.ldlocal(0);
+            e.ldtuple_elem(0);
+            for (auto op : {binary_op_t::mul, binary_op_t::add}) {
+                e.ldarg(1);
+                e.ldarg(0);
+                e.cuscall("test.binary", fields(op), 2);
+            }
+        } else {
+            for (auto op : {binary_op_t::max, binary_op_t::min,
+                            binary_op_t::mul, binary_op_t::add}) {
+                e.ldarg(1);
+                e.ldarg(0);
+                e.binary(op);
+            }
+        }
+        e.ldtuple(4);
+        e.ret();
+
+        kmodel_builder builder;
+        auto x = type_sig::tensor(dt_float32, shape);
+        builder.add_function({x, x}, type_sig::tuple({x, x, x, x}), e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    /** @brief f(x) = name(x, x) */
+    void load_single(interpreter &interp, const char *name) {
+        stackvm_emitter e;
+        e.ldarg(0);
+        e.ldarg(0);
+        e.cuscall(name, fields(binary_op_t::add), 2);
+        e.ret();
+
+        kmodel_builder builder;
+        auto x = type_sig::tensor(dt_float32, shape);
+        builder.add_function({x}, x, e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> data(float base, float step) {
+        std::vector<float> v(size);
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = base + step * (float)(i % 13);
+        return v;
+    }
+
+    std::vector<std::vector<float>> run(interpreter &interp, float x_base) {
+        auto x = make_tensor(dt_float32, shape, data(x_base, 1));
+        auto y = make_tensor(dt_float32, shape, data(20, -2));
+        std::vector<std::vector<float>> ret;
+        for (auto &out : invoke(interp, {x, y}))
+            ret.emplace_back(read<float>(out));
+        return ret;
+    }
+
+    const dims_t shape{8, 64};
+    const size_t size = 8 * 64;
+};
+
+TEST_F(CustomCallTest, same_outputs_as_builtin_ops) {
+    interpreter custom, builtin;
+    load(custom, true);
+    load(builtin, false);
+    for (float base : {-5.f, 3.f, -5.f}) {
+        auto ret = run(custom, base);
+        ASSERT_EQ(ret.size(), 4);
+        EXPECT_EQ(ret, run(builtin, base));
+    }
+}
+
+TEST_F(CustomCallTest, outputs_of_earlier_runs_are_kept) {
+    interpreter custom, builtin;
+    load(custom, true);
+    load(builtin, false);
+    auto x1 = make_tensor(dt_float32, shape, data(1, 1));
+    auto x2 = make_tensor(dt_float32, shape, data(9, 3));
+    auto y = make_tensor(dt_float32, shape, data(20, -2));
+    auto out1 = invoke(custom, {x1, y});
+    auto out2 = invoke(custom, {x2, y});
+    auto want1 = invoke(builtin, {x1, y});
+    auto want2 = invoke(builtin, {x2, y});
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_EQ(read<float>(out1[i]), read<float>(want1[i]));
+        EXPECT_EQ(read<float>(out2[i]), read<float>(want2[i]));
+    }
+}
+
+TEST_F(CustomCallTest, caller_bound_outputs) {
+    interpreter custom, builtin;
+    load(custom, true);
+    load(builtin, false);
+    for (float base : {2.f, 30.f, 2.f}) {
+        for (auto interp : {&custom, &builtin}) {
+            interp->input_tensor(0, make_tensor(dt_float32, shape,
+                                                data(base, 1)))
+                .unwrap_or_throw();
+            interp->input_tensor(1, make_tensor(dt_float32, shape,
+                                                data(20, -2)))
+                .unwrap_or_throw();
+            interp->run().unwrap_or_throw();
+        }
+        auto got = outputs(custom);
+        auto want = outputs(builtin);
+        ASSERT_EQ(got.size(), 4);
+        for (size_t i = 0; i < 4; i++)
+            EXPECT_EQ(read<float>(got[i]), read<float>(want[i]));
+    }
+}
+
+TEST_F(CustomCallTest, kernel_errors) {
+    for (auto name : {"test.no_output", "test.failing", "test.unknown"}) {
+        interpreter interp;
+        load_single(interp, name);
+        std::vector<value_t> params{
+            make_tensor(dt_float32, shape, data(0, 1)).impl()};
+        auto func = interp.entry_function().unwrap_or_throw();
+        EXPECT_TRUE(func->invoke(params).is_err()) << name;
+    }
+}
+
+TEST_F(CustomCallTest, registration) {
+    EXPECT_EQ(nncase_register_custom_call(NNCASE_CUSTOM_CALL_ABI_VERSION,
+                                          "test.binary", binary_kernel),
+              -EEXIST);
+    EXPECT_EQ(nncase_register_custom_call(
+                  (NNCASE_CUSTOM_CALL_ABI_VERSION_MAJOR + 1) << 16,
+                  "test.next_major", binary_kernel),
+              -ENOTSUP);
+    EXPECT_EQ(nncase_register_custom_call(NNCASE_CUSTOM_CALL_ABI_VERSION,
+                                          nullptr, binary_kernel),
+              -EINVAL);
+}
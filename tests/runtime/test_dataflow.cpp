@@ -0,0 +1,145 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+#include <cmath>
+
+using namespace nncase;
+
+class DataflowTest : public RuntimeTest {
+  public:
+    /** @brief f(x, y) = (a, abs(a - b), a * b) with a = x + y, b = x * y,
+     * the branches of a and b are independent */
+    void load(interpreter &interp, uint32_t threads, uint32_t max_inflight) {
+        interp.options()
+            .set(stackvm_dataflow_threads_option, scalar(threads))
+            .unwrap_or_throw();
+        if (max_inflight)
+            interp.options()
+                .set(stackvm_dataflow_max_inflight_option,
+                     scalar(max_inflight))
+                .unwrap_or_throw();
+
+        stackvm_emitter e;
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::add);
+        e.stlocal(0);
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::mul);
+        e.stlocal(1);
+        e.ldlocal(1);
+        e.ldlocal(0);
+        e.binary(binary_op_t::mul);
+        e.ldlocal(1);
+        e.ldlocal(0);
+        e.binary(binary_op_t::sub);
+        e.unary(unary_op_t::abs);
+        e.ldlocal(0);
+        e.ldtuple(3);
+        e.ret();
+
+        kmodel_builder builder;
+        auto x = type_sig::tensor(dt_float32, shape);
+        builder.add_function({x, x}, type_sig::tuple({x, x, x}), e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> data(float base) {
+        std::vector<float> v(size);
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = base + (float)(i % 17);
+        return v;
+    }
+
+    std::vector<std::vector<float>> expected(float x_base, float y_base) {
+        auto x = data(x_base);
+        auto y = data(y_base);
+        std::vector<std::vector<float>> ret(3, std::vector<float>(size));
+        for (size_t i = 0; i < size; i++) {
+            auto a = x[i] + y[i];
+            auto b = x[i] * y[i];
+            ret[0][i] = a;
+            ret[1][i] = std::abs(a - b);
+            ret[2][i] = a * b;
+        }
+        return ret;
+    }
+
+    std::vector<std::vector<float>>
+    run(interpreter &interp, float x_base, float y_base) {
+        auto x = make_tensor(dt_float32, shape, data(x_base));
+        auto y = make_tensor(dt_float32, shape, data(y_base));
+        auto outs = invoke(interp, {x, y});
+        std::vector<std::vector<float>> ret;
+        for (auto &out : outs)
+            ret.emplace_back(read<float>(out));
+        return ret;
+    }
+
+    const dims_t shape{4, 256};
+    const size_t size = 4 * 256;
+};
+
+TEST_F(DataflowTest, same_outputs_as_sequential) {
+    interpreter sequential;
+    load(sequential, 0, 0);
+    for (auto [threads, max_inflight] :
+         {std::pair{1u, 0u}, {4u, 0u}, {4u, 1u}}) {
+        interpreter dataflow;
+        load(dataflow, threads, max_inflight);
+        for (float base : {1.f, -3.f, 1.f}) {
+            auto ret = run(dataflow, base, 2);
+            EXPECT_EQ(ret, run(sequential, base, 2));
+            EXPECT_EQ(ret, expected(base, 2));
+        }
+    }
+}
+
+TEST_F(DataflowTest, outputs_of_earlier_runs_are_kept) {
+    for (uint32_t threads : {0u, 4u}) {
+        interpreter interp;
+        load(interp, threads, 0);
+        auto x = make_tensor(dt_float32, shape, data(1));
+        auto out1 = invoke(interp, {x, x});
+        auto out2 = invoke(interp, {make_tensor(dt_float32, shape, data(5)),
+                                    make_tensor(dt_float32, shape, data(2))});
+        auto want1 = expected(1, 1);
+        auto want2 = expected(5, 2);
+        for (size_t i = 0; i < 3; i++) {
+            EXPECT_EQ(read<float>(out1[i]), want1[i]);
+            EXPECT_EQ(read<float>(out2[i]), want2[i]);
+        }
+    }
+}
+
+TEST_F(DataflowTest, caller_bound_outputs) {
+    for (uint32_t threads : {0u, 4u}) {
+        interpreter interp;
+        load(interp, threads, 0);
+        for (float base : {1.f, 7.f, 1.f}) {
+            interp.input_tensor(0, make_tensor(dt_float32, shape, data(base)))
+                .unwrap_or_throw();
+            interp.input_tensor(1, make_tensor(dt_float32, shape, data(3)))
+                .unwrap_or_throw();
+            interp.run().unwrap_or_throw();
+            auto outs = outputs(interp);
+            auto want = expected(base, 3);
+            ASSERT_EQ(outs.size(), 3);
+            for (size_t i = 0; i < 3; i++)
+                EXPECT_EQ(read<float>(outs[i]), want[i]);
+        }
+    }
+}
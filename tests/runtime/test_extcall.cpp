@@ -0,0 +1,210 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+#include <cerrno>
+#include <nncase/runtime/custom_call.h>
+
+using namespace nncase;
+
+namespace {
+/** @brief out = x + x written into the second argument, like a prim func
+ * fills the outputs it is passed. The returned tensor is a placeholder. */
+int double_into_kernel(nncase_custom_call_context_t *ctx,
+                       [[maybe_unused]] const void *fields,
+                       [[maybe_unused]] size_t fields_bytes,
+                       const nncase_tensor_view_t *args, size_t args_count) {
+    if (args_count != 2)
+        return -EINVAL;
+    size_t size = 1;
+    for (uint32_t i = 0; i < args[0].rank; i++)
+        size *= args[0].shape[i];
+    auto x = static_cast<const float *>(args[0].data);
+    auto out = static_cast<float *>(args[1].data);
+    for (size_t i = 0; i < size; i++)
+        out[i] = x[i] + x[i];
+
+    nncase_tensor_view_t placeholder;
+    return ctx->alloc_output(ctx, dt_float32, 0, nullptr, &placeholder);
+}
+} // namespace
+
+class ExtcallTest : public RuntimeTest {
+  public:
+    static void SetUpTestSuite() {
+        auto ret = nncase_register_custom_call(
+            NNCASE_CUSTOM_CALL_ABI_VERSION, "test.double_into",
+            double_into_kernel);
+        ASSERT_TRUE(ret == 0 || ret == -EEXIST);
+    }
+
+    /** @brief f(x) = g(x) with g a prim func writing x + x to its output,
+     * or f(x) = x + x when inlined */
+    void load_prim(interpreter &interp, bool extcall) {
+        auto x = type_sig::tensor(dt_float32, shape);
+        kmodel_builder builder;
+        stackvm_emitter f;
+        f.ldarg(0);
+        if (extcall)
+            f.extcall(0, 1, 1, true);
+        else {
+            f.ldarg(0);
+            f.binary(binary_op_t::add);
+        }
+        f.ret();
+        builder.add_function({x}, x, f);
+
+        stackvm_emitter g;
+        g.ldarg(1);
+        g.ldarg(0);
+        g.cuscall("test.double_into", {}, 2);
+        g.ret();
+        builder.add_function({x, x}, type_sig::tensor(dt_float32, {}), g);
+        RuntimeTest::load(interp, builder);
+    }
+
+    /** @brief f(x, y) = (a, b) with a = g(x, y), b = g(a, y) and
+     * g(x, y) = x * y + x, the two calls are separate call sites */
+    void load_func(interpreter &interp, bool extcall) {
+        auto x = type_sig::tensor(dt_float32, shape);
+        auto emit_g = [](stackvm_emitter &e, auto &&ld_x, auto &&ld_y) {
+            ld_x();
+            ld_y();
+            ld_x();
+            e.binary(binary_op_t::mul);
+            e.binary(binary_op_t::add);
+        };
+
+        kmodel_builder builder;
+        stackvm_emitter f;
+        if (extcall) {
+            f.ldarg(1);
+            f.ldarg(0);
+            f.extcall(0, 1, 2, false);
+            f.stlocal(0);
+            f.ldarg(1);
+            f.ldlocal(0);
+            f.extcall(0, 1, 2, false);
+        } else {
+            emit_g(
+                f, [&] { f.ldarg(0); }, [&] { f.ldarg(1); });
+            f.stlocal(0);
+            emit_g(
+                f, [&] { f.ldlocal(0); }, [&] { f.ldarg(1); });
+        }
+        f.ldlocal(0);
+        f.ldtuple(2);
+        f.ret();
+        builder.add_function({x, x}, type_sig::tuple({x, x}), f);
+
+        stackvm_emitter g;
+        emit_g(
+            g, [&] { g.ldarg(0); }, [&] { g.ldarg(1); });
+        g.ret();
+        builder.add_function({x, x}, x, g);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> data(float base) {
+        std::vector<float> v(size);
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = base + (float)(i % 5);
+        return v;
+    }
+
+    static const void *data_of(runtime_tensor t) {
+        return hrt::map(t, map_read).unwrap_or_throw().buffer().data();
+    }
+
+    const dims_t shape{2, 8};
+    const size_t size = 2 * 8;
+};
+
+TEST_F(ExtcallTest, prim_func_same_outputs_as_inlined) {
+    interpreter extcall, inlined;
+    load_prim(extcall, true);
+    load_prim(inlined, false);
+    for (float base : {1.f, -4.f, 1.f}) {
+        auto x = make_tensor(dt_float32, shape, data(base));
+        auto got = invoke(extcall, {x});
+        ASSERT_EQ(got.size(), 1);
+        EXPECT_EQ(read<float>(got[0]), read<float>(invoke(inlined, {x})[0]));
+    }
+}
+
+TEST_F(ExtcallTest, prim_func_outputs_held_by_the_caller_are_not_reused) {
+    interpreter interp;
+    load_prim(interp, true);
+    auto out1 = invoke(interp, {make_tensor(dt_float32, shape, data(1))});
+    auto out2 = invoke(interp, {make_tensor(dt_float32, shape, data(10))});
+    EXPECT_NE(data_of(out1[0]), data_of(out2[0]));
+
+    auto want = [&](float base) {
+        auto v = data(base);
+        for (auto &e : v)
+            e += e;
+        return v;
+    };
+    EXPECT_EQ(read<float>(out1[0]), want(1));
+    EXPECT_EQ(read<float>(out2[0]), want(10));
+}
+
+TEST_F(ExtcallTest, prim_func_outputs_are_reused_once_released) {
+    interpreter interp;
+    load_prim(interp, true);
+    auto out = invoke(interp, {make_tensor(dt_float32, shape, data(1))});
+    auto first = data_of(out[0]);
+    out.clear();
+    out = invoke(interp, {make_tensor(dt_float32, shape, data(3))});
+    EXPECT_EQ(data_of(out[0]), first);
+    auto want = data(3);
+    for (auto &e : want)
+        e += e;
+    EXPECT_EQ(read<float>(out[0]), want);
+}
+
+TEST_F(ExtcallTest, prim_func_caller_bound_outputs) {
+    interpreter extcall, inlined;
+    load_prim(extcall, true);
+    load_prim(inlined, false);
+    for (float base : {2.f, 7.f, 2.f}) {
+        for (auto interp : {&extcall, &inlined}) {
+            interp->input_tensor(0, make_tensor(dt_float32, shape, data(base)))
+                .unwrap_or_throw();
+            interp->run().unwrap_or_throw();
+        }
+        EXPECT_EQ(read<float>(outputs(extcall)[0]),
+                  read<float>(outputs(inlined)[0]));
+    }
+}
+
+TEST_F(ExtcallTest, call_sites_same_outputs_as_inlined) {
+    interpreter extcall, inlined;
+    load_func(extcall, true);
+    load_func(inlined, false);
+    auto y = make_tensor(dt_float32, shape, data(-1));
+    std::vector<runtime_tensor> kept;
+    for (float base : {1.f, 3.f, 1.f}) {
+        auto x = make_tensor(dt_float32, shape, data(base));
+        auto got = invoke(extcall, {x, y});
+        auto want = invoke(inlined, {x, y});
+        ASSERT_EQ(got.size(), 2);
+        for (size_t i = 0; i < 2; i++)
+            EXPECT_EQ(read<float>(got[i]), read<float>(want[i]));
+        kept.emplace_back(got[1]);
+    }
+    // Outputs of earlier calls are not overwritten by later ones
+    EXPECT_EQ(read<float>(kept[0]), read<float>(kept[2]));
+    EXPECT_NE(read<float>(kept[0]), read<float>(kept[1]));
+}
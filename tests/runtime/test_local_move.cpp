@@ -0,0 +1,140 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+
+using namespace nncase;
+
+class LocalMoveTest : public RuntimeTest {
+  public:
+    /** @brief f(x, y) = (c, abs(c), a, d) with a = x + y, b = a * y,
+     * c = b - a and d = c * x. d reuses the slot of b after its release.
+     * The last use of a local either moves it out of the frame or loads a
+     * copy and leaves the slot alone. */
+    void load(interpreter &interp, bool move) {
+        stackvm_emitter e;
+        auto last = [&](uint16_t index) {
+            if (move)
+                e.ldlocal_last(index);
+            else
+                e.ldlocal(index);
+        };
+
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::add);
+        e.stlocal(0);
+        e.ldarg(1);
+        e.ldlocal(0);
+        e.binary(binary_op_t::mul);
+        e.stlocal(1);
+        e.ldlocal(0);
+        last(1);
+        e.binary(binary_op_t::sub);
+        e.stlocal(2);
+        e.ldarg(0);
+        e.ldlocal(2);
+        e.binary(binary_op_t::mul);
+        e.stlocal(1);
+        last(1);
+        last(0);
+        e.ldlocal(2);
+        e.unary(unary_op_t::abs);
+        last(2);
+        e.ldtuple(4);
+        e.ret();
+
+        kmodel_builder builder;
+        auto x = type_sig::tensor(dt_float32, shape);
+        builder.add_function({x, x}, type_sig::tuple({x, x, x, x}), e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> data(float base) {
+        std::vector<float> v(size);
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = base + (float)(i % 7);
+        return v;
+    }
+
+    std::vector<std::vector<float>> expected(float x_base, float y_base) {
+        auto x = data(x_base);
+        auto y = data(y_base);
+        std::vector<std::vector<float>> ret(4, std::vector<float>(size));
+        for (size_t i = 0; i < size; i++) {
+            auto a = x[i] + y[i];
+            auto c = a * y[i] - a;
+            ret[0][i] = c;
+            ret[1][i] = std::abs(c);
+            ret[2][i] = a;
+            ret[3][i] = c * x[i];
+        }
+        return ret;
+    }
+
+    void check(const std::vector<runtime_tensor> &outs, float x_base,
+               float y_base) {
+        auto want = expected(x_base, y_base);
+        ASSERT_EQ(outs.size(), want.size());
+        for (size_t i = 0; i < outs.size(); i++)
+            EXPECT_EQ(read<float>(outs[i]), want[i]) << "output " << i;
+    }
+
+    const dims_t shape{3, 5};
+    const size_t size = 3 * 5;
+};
+
+TEST_F(LocalMoveTest, same_outputs_as_copies) {
+    interpreter moved, copied;
+    load(moved, true);
+    load(copied, false);
+    for (float base : {1.f, -2.f, 1.f}) {
+        auto x = make_tensor(dt_float32, shape, data(base));
+        auto y = make_tensor(dt_float32, shape, data(3));
+        auto got = invoke(moved, {x, y});
+        auto want = invoke(copied, {x, y});
+        check(got, base, 3);
+        for (size_t i = 0; i < got.size(); i++)
+            EXPECT_EQ(read<float>(got[i]), read<float>(want[i]));
+    }
+}
+
+TEST_F(LocalMoveTest, outputs_of_earlier_runs_are_kept) {
+    for (bool move : {false, true}) {
+        interpreter interp;
+        load(interp, move);
+        auto y = make_tensor(dt_float32, shape, data(2));
+        auto out1 =
+            invoke(interp, {make_tensor(dt_float32, shape, data(1)), y});
+        auto out2 =
+            invoke(interp, {make_tensor(dt_float32, shape, data(4)), y});
+        check(out1, 1, 2);
+        check(out2, 4, 2);
+    }
+}
+
+TEST_F(LocalMoveTest, caller_bound_outputs) {
+    for (bool move : {false, true}) {
+        interpreter interp;
+        load(interp, move);
+        for (float base : {1.f, 6.f, 1.f}) {
+            interp.input_tensor(0, make_tensor(dt_float32, shape, data(base)))
+                .unwrap_or_throw();
+            interp.input_tensor(1, make_tensor(dt_float32, shape, data(-1)))
+                .unwrap_or_throw();
+            interp.run().unwrap_or_throw();
+            check(outputs(interp), base, -1);
+        }
+    }
+}
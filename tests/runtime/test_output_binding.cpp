@@ -0,0 +1,190 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+#include <cmath>
+
+using namespace nncase;
+
+class OutputBindingTest : public RuntimeTest {
+  public:
+    /** @brief f(x, y) = (a, abs(a * y), a, x) with a = x + y. a is read by
+     * a later op and returned twice, x is returned as is */
+    void load(interpreter &interp, uint32_t capacity, uint32_t threads = 0) {
+        interp.options()
+            .set(stackvm_plan_cache_capacity_option, scalar(capacity))
+            .unwrap_or_throw();
+        interp.options()
+            .set(stackvm_dataflow_threads_option, scalar(threads))
+            .unwrap_or_throw();
+
+        stackvm_emitter e;
+        e.ldarg(1);
+        e.ldarg(0);
+        e.binary(binary_op_t::add);
+        e.stlocal(0);
+        e.ldarg(0);
+        e.ldlocal(0);
+        e.ldarg(1);
+        e.ldlocal(0);
+        e.binary(binary_op_t::mul);
+        e.unary(unary_op_t::abs);
+        e.ldlocal(0);
+        e.ldtuple(4);
+        e.ret();
+
+        kmodel_builder builder;
+        auto x = type_sig::tensor(dt_float32, shape);
+        builder.add_function({x, x}, type_sig::tuple({x, x, x, x}), e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> data(float base) {
+        std::vector<float> v(size);
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = base + (float)(i % 11) - 5;
+        return v;
+    }
+
+    static std::vector<std::vector<float>>
+    expected(const std::vector<float> &x, const std::vector<float> &y) {
+        std::vector<std::vector<float>> ret(4, std::vector<float>(x.size()));
+        for (size_t i = 0; i < x.size(); i++) {
+            auto a = x[i] + y[i];
+            ret[0][i] = a;
+            ret[1][i] = std::abs(a * y[i]);
+            ret[2][i] = a;
+            ret[3][i] = x[i];
+        }
+        return ret;
+    }
+
+    static void check(const std::vector<runtime_tensor> &outs,
+                      const std::vector<std::vector<float>> &want) {
+        ASSERT_EQ(outs.size(), want.size());
+        for (size_t i = 0; i < outs.size(); i++)
+            EXPECT_EQ(read<float>(outs[i]), want[i]) << "output " << i;
+    }
+
+    runtime_tensor empty_output() {
+        return hrt::create(dt_float32, shape).unwrap_or_throw();
+    }
+
+    /** @brief Plans off, plans on, plans on with dataflow */
+    const std::pair<uint32_t, uint32_t> configs[3]{{0, 0}, {16, 0}, {16, 4}};
+    const dims_t shape{4, 16};
+    const size_t size = 4 * 16;
+};
+
+TEST_F(OutputBindingTest, interpreter_outputs) {
+    for (auto [capacity, threads] : configs) {
+        interpreter interp;
+        load(interp, capacity, threads);
+        for (float base : {1.f, -2.f, 1.f, 4.f}) {
+            auto x = data(base);
+            auto y = data(3);
+            interp.input_tensor(0, make_tensor(dt_float32, shape, x))
+                .unwrap_or_throw();
+            interp.input_tensor(1, make_tensor(dt_float32, shape, y))
+                .unwrap_or_throw();
+            interp.run().unwrap_or_throw();
+            check(outputs(interp), expected(x, y));
+        }
+    }
+}
+
+TEST_F(OutputBindingTest, outputs_fed_back_as_inputs) {
+    for (auto [capacity, threads] : configs) {
+        interpreter interp;
+        load(interp, capacity, threads);
+        auto x = data(1);
+        auto y = data(-1);
+        interp.input_tensor(0, make_tensor(dt_float32, shape, x))
+            .unwrap_or_throw();
+        interp.input_tensor(1, make_tensor(dt_float32, shape, y))
+            .unwrap_or_throw();
+        for (size_t run = 0; run < 4; run++) {
+            interp.run().unwrap_or_throw();
+            auto outs = outputs(interp);
+            auto want = expected(x, y);
+            check(outs, want);
+
+            // Both inputs are outputs of this run next time
+            x = want[1];
+            y = want[0];
+            interp.input_tensor(0, outs[1]).unwrap_or_throw();
+            interp.input_tensor(1, outs[0]).unwrap_or_throw();
+        }
+    }
+}
+
+TEST_F(OutputBindingTest, invoke_with_return_value) {
+    for (auto [capacity, threads] : configs) {
+        interpreter interp;
+        load(interp, capacity, threads);
+        auto func = interp.entry_function().unwrap_or_throw();
+
+        std::vector<runtime_tensor> first;
+        std::vector<std::vector<float>> first_want;
+        for (float base : {2.f, 6.f, 2.f}) {
+            std::vector<runtime_tensor> outs;
+            std::vector<value_t> fields;
+            for (size_t i = 0; i < 4; i++) {
+                outs.emplace_back(empty_output());
+                fields.emplace_back(outs.back().impl());
+            }
+            auto x = data(base);
+            auto y = data(-4);
+            std::vector<value_t> params{
+                make_tensor(dt_float32, shape, x).impl(),
+                make_tensor(dt_float32, shape, y).impl()};
+            value_t return_value = tuple(std::in_place, std::move(fields));
+            auto ret = func->invoke(params, return_value).unwrap_or_throw();
+            EXPECT_EQ(ret.get(), return_value.get());
+            check(outs, expected(x, y));
+            if (first.empty()) {
+                first = outs;
+                first_want = expected(x, y);
+            }
+        }
+        // Outputs bound by an earlier run are not written by later ones
+        check(first, first_want);
+    }
+}
+
+TEST_F(OutputBindingTest, aliased_return_value) {
+    for (auto [capacity, threads] : configs) {
+        interpreter interp;
+        load(interp, capacity, threads);
+        auto func = interp.entry_function().unwrap_or_throw();
+        for (float base : {0.f, 3.f, 0.f}) {
+            // The first and third outputs share a tensor, the last output is
+            // the first input
+            auto shared = empty_output();
+            auto other = empty_output();
+            auto x = data(base);
+            auto y = data(2);
+            auto x_tensor = make_tensor(dt_float32, shape, x);
+            std::vector<value_t> params{
+                x_tensor.impl(), make_tensor(dt_float32, shape, y).impl()};
+            value_t return_value =
+                tuple(std::in_place, std::vector<value_t>{shared.impl(),
+                                                          other.impl(),
+                                                          shared.impl(),
+                                                          x_tensor.impl()});
+            func->invoke(params, return_value).unwrap_or_throw();
+            check({shared, other, shared, x_tensor}, expected(x, y));
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+
+using namespace nncase;
+
+class PlanCacheTest : public RuntimeTest {
+  public:
+    /** @brief f(x) = (reshape(x, shape_of(x)), reshape(...) + x, shape_of(x)),
+     * the reshape output is a view of x */
+    void load(interpreter &interp, uint32_t capacity) {
+        interp.options()
+            .set(stackvm_plan_cache_capacity_option, scalar(capacity))
+            .unwrap_or_throw();
+
+        stackvm_emitter e;
+        e.ldarg(0);
+        e.shape_of();
+        e.ldarg(0);
+        e.reshape();
+        e.stlocal(0);
+        e.ldarg(0);
+        e.ldlocal(0);
+        e.binary(binary_op_t::add);
+        e.stlocal(1);
+        e.ldarg(0);
+        e.shape_of();
+        e.ldlocal(1);
+        e.ldlocal(0);
+        e.ldtuple(3);
+        e.ret();
+
+        kmodel_builder builder;
+        auto x = type_sig::tensor(dt_float32, shape);
+        builder.add_function(
+            {x},
+            type_sig::tuple({x, x, type_sig::tensor(dt_int64, {2})}), e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> data(float base) {
+        std::vector<float> v(6);
+        for (size_t i = 0; i < v.size(); i++)
+            v[i] = base + i;
+        return v;
+    }
+
+    std::vector<float> twice(std::vector<float> v) {
+        for (auto &x : v)
+            x *= 2;
+        return v;
+    }
+
+    void check(std::vector<runtime_tensor> &outputs, float base) {
+        ASSERT_EQ(outputs.size(), 3);
+        EXPECT_EQ(read<float>(outputs[0]), data(base));
+        EXPECT_EQ(read<float>(outputs[1]), twice(data(base)));
+        EXPECT_EQ(read<int64_t>(outputs[2]), (std::vector<int64_t>{2, 3}));
+    }
+
+    const dims_t shape{2, 3};
+};
+
+TEST_F(PlanCacheTest, different_data_same_shape) {
+    for (uint32_t capacity : {0u, 16u}) {
+        interpreter interp;
+        load(interp, capacity);
+        auto x1 = make_tensor(dt_float32, shape, data(1));
+        auto x2 = make_tensor(dt_float32, shape, data(10));
+        auto out1 = invoke(interp, {x1});
+        auto out2 = invoke(interp, {x2});
+        check(out1, 1);
+        check(out2, 10);
+    }
+}
+
+TEST_F(PlanCacheTest, outputs_are_not_shared_across_runs) {
+    for (uint32_t capacity : {0u, 16u}) {
+        interpreter interp;
+        load(interp, capacity);
+        auto x1 = make_tensor(dt_float32, shape, data(1));
+        auto out1 = invoke(interp, {x1});
+
+        // Same operands, a hit when the cache is on
+        auto x2 = make_tensor(dt_float32, shape, data(1));
+        auto out2 = invoke(interp, {x2});
+        check(out2, 1);
+
+        // The caller owns the outputs of the first run and its input
+        write(x1, data(100));
+        write(out1[2], std::vector<int64_t>{7, 7});
+        check(out2, 1);
+
+        auto out3 = invoke(interp, {make_tensor(dt_float32, shape, data(1))});
+        check(out3, 1);
+    }
+}
+
+TEST_F(PlanCacheTest, views_of_recorded_outputs_are_copied) {
+    for (uint32_t capacity : {0u, 16u}) {
+        interpreter interp;
+        interp.options()
+            .set(stackvm_plan_cache_capacity_option, scalar(capacity))
+            .unwrap_or_throw();
+
+        // f(x) = reshape(shape_of(x), shape_of(shape_of(x))), a view of the
+        // recorded shape
+        stackvm_emitter e;
+        e.ldarg(0);
+        e.shape_of();
+        e.shape_of();
+        e.ldarg(0);
+        e.shape_of();
+        e.reshape();
+        e.ret();
+
+        kmodel_builder builder;
+        builder.add_function({type_sig::tensor(dt_float32, shape)},
+                             type_sig::tensor(dt_int64, {2}), e);
+        RuntimeTest::load(interp, builder);
+        for (size_t run = 0; run < 3; run++) {
+            auto x = make_tensor(dt_float32, shape, data(1));
+            auto out = invoke(interp, {x});
+            ASSERT_EQ(out.size(), 1);
+            EXPECT_EQ(read<int64_t>(out[0]), (std::vector<int64_t>{2, 3}));
+            write(out[0], std::vector<int64_t>{9, 9});
+        }
+    }
+}
+
+TEST_F(PlanCacheTest, interpreter_outputs) {
+    std::vector<std::vector<float>> results[2];
+    for (uint32_t capacity : {0u, 16u}) {
+        interpreter interp;
+        load(interp, capacity);
+        for (float base : {1.f, 5.f, 1.f}) {
+            interp.input_tensor(0, make_tensor(dt_float32, shape, data(base)))
+                .unwrap_or_throw();
+            interp.run().unwrap_or_throw();
+            auto outs = outputs(interp);
+            check(outs, base);
+            results[capacity ? 1 : 0].emplace_back(read<float>(outs[1]));
+        }
+    }
+    EXPECT_EQ(results[0], results[1]);
+}
@@ -0,0 +1,157 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "runtime_test.h"
+
+using namespace nncase;
+
+class StatesTest : public RuntimeTest {
+  public:
+    /** @brief f(x, pos) = (cache, cache + cache) after writing the row x at
+     * pos of the cache state, like a KV cache appends a step */
+    void load(interpreter &interp) {
+        stackvm_emitter e;
+        e.ldarg(1);
+        e.ldarg(0);
+        e.ldnull();
+        e.variable_read("cache", dt_float32);
+        e.variable_update(0);
+        e.stlocal(0);
+        e.ldlocal(0);
+        e.ldlocal(0);
+        e.binary(binary_op_t::add);
+        e.ldlocal(0);
+        e.ldtuple(2);
+        e.ret();
+
+        kmodel_builder builder;
+        builder.add_state("cache", dt_float32, shape);
+        auto cache = type_sig::tensor(dt_float32, shape);
+        builder.add_function({type_sig::tensor(dt_float32, {1, cols}),
+                              type_sig::tensor(dt_int64, {})},
+                             type_sig::tuple({cache, cache}), e);
+        RuntimeTest::load(interp, builder);
+    }
+
+    std::vector<float> row(float base) {
+        std::vector<float> v(cols);
+        for (size_t i = 0; i < cols; i++)
+            v[i] = base + i;
+        return v;
+    }
+
+    std::vector<runtime_tensor> inputs(float base, int64_t pos) {
+        return {make_tensor(dt_float32, {1, cols}, row(base)),
+                make_tensor(dt_int64, {}, std::vector<int64_t>{pos})};
+    }
+
+    /** @brief The cache on the host, the reference the state must match */
+    void append(std::vector<float> &cache, float base, size_t pos) {
+        auto r = row(base);
+        std::copy(r.begin(), r.end(), cache.begin() + pos * cols);
+    }
+
+    std::vector<float> twice(std::vector<float> v) {
+        for (auto &e : v)
+            e += e;
+        return v;
+    }
+
+    static constexpr size_t rows = 4;
+    static constexpr size_t cols = 3;
+    const dims_t shape{rows, cols};
+};
+
+TEST_F(StatesTest, state_persists_across_runs) {
+    interpreter interp;
+    load(interp);
+    auto index = interp.find_state_by_name("cache").unwrap_or_throw();
+    EXPECT_EQ(interp.state_name(index).unwrap_or_throw(), "cache");
+    EXPECT_EQ(read<float>(interp.state_tensor(index).unwrap_or_throw()),
+              std::vector<float>(rows * cols));
+
+    std::vector<float> cache(rows * cols);
+    std::vector<std::vector<runtime_tensor>> outs;
+    std::vector<std::vector<float>> wants;
+    for (size_t pos = 0; pos < rows; pos++) {
+        auto base = 10.f * (pos + 1);
+        append(cache, base, pos);
+        outs.emplace_back(invoke(interp, inputs(base, pos)));
+        wants.emplace_back(cache);
+        EXPECT_EQ(read<float>(interp.state_tensor(index).unwrap_or_throw()),
+                  cache);
+    }
+
+    // Outputs handed out by earlier runs are not the state itself
+    for (size_t pos = 0; pos < rows; pos++) {
+        EXPECT_EQ(read<float>(outs[pos][0]), wants[pos]) << "run " << pos;
+        EXPECT_EQ(read<float>(outs[pos][1]), twice(wants[pos]))
+            << "run " << pos;
+    }
+}
+
+TEST_F(StatesTest, caller_bound_outputs) {
+    interpreter interp;
+    load(interp);
+    std::vector<float> cache(rows * cols);
+    for (size_t pos : {0, 2, 1, 2}) {
+        auto base = 3.f * (pos + 1);
+        append(cache, base, pos);
+        auto in = inputs(base, pos);
+        for (size_t i = 0; i < in.size(); i++)
+            interp.input_tensor(i, in[i]).unwrap_or_throw();
+        interp.run().unwrap_or_throw();
+        auto outs = outputs(interp);
+        ASSERT_EQ(outs.size(), 2);
+        EXPECT_EQ(read<float>(outs[0]), cache);
+        EXPECT_EQ(read<float>(outs[1]), twice(cache));
+    }
+}
+
+TEST_F(StatesTest, set_and_reset) {
+    interpreter interp;
+    load(interp);
+    auto index = interp.find_state_by_name("cache").unwrap_or_throw();
+    EXPECT_TRUE(interp.find_state_by_name("missing").is_err());
+
+    std::vector<float> cache(rows * cols);
+    for (size_t i = 0; i < cache.size(); i++)
+        cache[i] = -(float)i;
+    interp.state_tensor(index, make_tensor(dt_float32, shape, cache))
+        .unwrap_or_throw();
+    append(cache, 5, 3);
+    auto outs = invoke(interp, inputs(5, 3));
+    EXPECT_EQ(read<float>(outs[0]), cache);
+
+    interp.reset_states().unwrap_or_throw();
+    std::vector<float> zeros(rows * cols);
+    EXPECT_EQ(read<float>(interp.state_tensor(index).unwrap_or_throw()),
+              zeros);
+    append(zeros, 1, 0);
+    EXPECT_EQ(read<float>(invoke(interp, inputs(1, 0))[0]), zeros);
+}
+
+TEST_F(StatesTest, out_of_range_update) {
+    interpreter interp;
+    load(interp);
+    std::vector<value_t> params;
+    for (auto &input : inputs(1, rows))
+        params.emplace_back(input.impl());
+    auto func = interp.entry_function().unwrap_or_throw();
+    EXPECT_TRUE(func->invoke(params).is_err());
+
+    auto index = interp.find_state_by_name("cache").unwrap_or_throw();
+    EXPECT_EQ(read<float>(interp.state_tensor(index).unwrap_or_throw()),
+              std::vector<float>(rows * cols));
+}
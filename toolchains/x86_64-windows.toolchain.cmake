@@ -1,2 +1,2 @@
 add_compile_options(/arch:AVX2)
-add_compile_definitions(__SSE2__ __SSE4_1__ __FMA__ __AVX__ __AVX2__)
\ No newline at end of file
+add_compile_definitions(__SSE2__ __SSE4_1__ __FMA__ __AVX__ __AVX2__ __F16C__)
\ No newline at end of file
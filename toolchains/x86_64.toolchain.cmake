@@ -1,5 +1,5 @@
 if (MSVC)
     add_compile_options(/arch:AVX)
 else()
-    add_compile_options(-mavx)
+    add_compile_options(-mavx -mf16c)
 endif()